@@ -2,40 +2,13 @@
 #include <trico_io/ioply.h>
 #include <trico_io/iostl.h>
 #include <trico/trico.h>
+#include <trico/mesh_connectivity.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
-#ifdef _WIN32
-#include <sys/types.h>
-#include <sys/stat.h>
-#else
-#include <sys/stat.h>
-#endif
-
-#ifdef _WIN32
-static inline long long fsize(const char *filename)
-  {
-  struct _stat64 st;
-
-  if (_stat64(filename, &st) == 0)
-    return st.st_size;
-
-  return -1;
-  }
-#else
-static inline long long fsize(const char *filename)
-  {
-  struct stat st;
-
-  if (stat(filename, &st) == 0)
-    return st.st_size;
-
-  return -1;
-  }
-#endif
-
 static int extension_is_stl(const char* filename)
   {
   const char* filename_ptr = filename;
@@ -148,12 +121,35 @@ static void change_extension_to_ply(char* new_filename, const char* filename)
     }
   }
 
+/*
+Moves element i of *data to element original_indices[i], for a mesh that was renumbered before it was written.
+*/
+static int restore_vertex_order(void* data_pointer, uint32_t element_size, const uint32_t* original_indices, uint32_t nr_of_vertices)
+  {
+  void** data = (void**)data_pointer;
+  if (!*data)
+    return 1;
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    {
+    if (original_indices[i] >= nr_of_vertices)
+      return 0;
+    }
+  void* restored = calloc(nr_of_vertices, element_size);
+  if (!restored)
+    return 0;
+  trico_scatter_elements(restored, *data, element_size, original_indices, nr_of_vertices);
+  free(*data);
+  *data = restored;
+  return 1;
+  }
+
 static void print_help()
   {
   printf("Usage: trico_decoder -i <input> [options]\n\n");
   printf("Options:\n");
   printf("  -i <input>           input file name.\n");
   printf("  -o <output>          output file name of type stl or ply.\n");
+  printf("  -t <threads>         number of decompression threads, 0 uses all hardware threads (default 1).\n");
   printf("\n");
   }
 
@@ -166,6 +162,7 @@ int main(int argc, const char** argv)
     }
   const char* filename = NULL;
   int output_filename = 0;
+  uint32_t nr_of_threads = 1;
   char new_filename[1024];
   for (int j = 1; j < argc; ++j)
     {
@@ -194,6 +191,16 @@ int main(int argc, const char** argv)
       new_filename[idx] = 0;
       output_filename = 1;
       }
+    else if (strcmp(argv[j], "-t") == 0)
+      {
+      if (j == argc - 1)
+        {
+        printf("I expect a number after command -t\n");
+        return -1;
+        }
+      ++j;
+      nr_of_threads = (uint32_t)atoi(argv[j]);
+      }
     else
       {
       printf("Unknown command %s\n", argv[j]);
@@ -208,35 +215,13 @@ int main(int argc, const char** argv)
     }
 
 
-  long long size = fsize(filename);
-  if (size < 0)
-    {
-    printf("There was an error reading file %s\n", filename);
-    return -1;
-    }
-
-  FILE* f = fopen(filename, "rb");
-  if (!f)
-    {
-    printf("Cannot open file: %s\n", filename);
-    return -1;
-    }
-  char* buffer = (char*)malloc(size);
-  long long fl = (long long)fread(buffer, 1, size, f);
-  if (fl != size)
-    {
-    printf("There was an error reading file %s\n", filename);
-    fclose(f);
-    return -1;
-    }
-  fclose(f);
-
-  void* arch = trico_open_archive_for_reading((const uint8_t*)buffer, size);
+  void* arch = trico_open_archive_for_reading_from_file(filename);
   if (!arch)
     {
-    printf("The input file %s is not a trico archive.\n", filename);
+    printf("Cannot open file %s, or it is not a trico archive.\n", filename);
     return -1;
     }
+  trico_set_number_of_threads(arch, nr_of_threads);
 
   float* vertices = NULL;
   uint32_t* tria_indices = NULL;
@@ -252,6 +237,8 @@ int main(int argc, const char** argv)
   uint32_t nr_of_vertex_colors = 0;
   uint32_t nr_of_texcoords = 0;
   uint32_t nr_of_attributes = 0;
+  uint32_t* original_indices = NULL;
+  uint32_t nr_of_original_indices = 0;
 
   enum trico_stream_type st = trico_get_next_stream_type(arch);
   while (!st == trico_empty)
@@ -272,7 +259,25 @@ int main(int argc, const char** argv)
         free(tria_indices);
         free(attributes);
         trico_close_archive(arch);
-        free(buffer);
+        printf("Something went wrong when reading the vertices\n");
+        return -1;
+        }
+      break;
+      }
+      case trico_vertex_float_parallelogram_stream:
+      {
+      nr_of_vertices = trico_get_number_of_vertices(arch);
+      vertices = (float*)malloc(nr_of_vertices * 3 * sizeof(float));
+      if (!trico_read_vertices_parallelogram(arch, &vertices, tria_indices, nr_of_triangles))
+        {
+        free(vertices);
+        free(triangle_normals);
+        free(vertex_normals);
+        free(vertex_colors);
+        free(texcoords);
+        free(tria_indices);
+        free(attributes);
+        trico_close_archive(arch);
         printf("Something went wrong when reading the vertices\n");
         return -1;
         }
@@ -292,7 +297,6 @@ int main(int argc, const char** argv)
         free(tria_indices);
         free(attributes);
         trico_close_archive(arch);
-        free(buffer);
         printf("Something went wrong when reading the triangle normals\n");
         return -1;
         }
@@ -312,7 +316,6 @@ int main(int argc, const char** argv)
         free(tria_indices);
         free(attributes);
         trico_close_archive(arch);
-        free(buffer);
         printf("Something went wrong when reading the vertex normals\n");
         return -1;
         }
@@ -332,13 +335,13 @@ int main(int argc, const char** argv)
         free(tria_indices);
         free(attributes);
         trico_close_archive(arch);
-        free(buffer);
         printf("Something went wrong when reading the vertex colors\n");
         return -1;
         }
       break;
       }
       case trico_triangle_uint32_stream:
+      case trico_triangle_uint32_delta_stream:
       {
       nr_of_triangles = trico_get_number_of_triangles(arch);
       tria_indices = (uint32_t*)malloc(nr_of_triangles * 3 * sizeof(uint32_t));
@@ -352,7 +355,6 @@ int main(int argc, const char** argv)
         free(tria_indices);
         free(attributes);
         trico_close_archive(arch);
-        free(buffer);
         printf("Something went wrong when reading the triangles\n");
         return -1;
         }
@@ -372,7 +374,6 @@ int main(int argc, const char** argv)
         free(tria_indices);
         free(attributes);
         trico_close_archive(arch);
-        free(buffer);
         printf("Something went wrong when reading the attributes\n");
         return -1;
         }
@@ -392,12 +393,31 @@ int main(int argc, const char** argv)
         free(tria_indices);
         free(attributes);
         trico_close_archive(arch);
-        free(buffer);
         printf("Something went wrong when reading the texture coordinates\n");
         return -1;
         }
       break;
       }
+      case trico_vertex_remap_stream:
+      {
+      nr_of_original_indices = trico_get_number_of_vertices(arch);
+      original_indices = (uint32_t*)malloc(nr_of_original_indices * sizeof(uint32_t));
+      if (!trico_read_vertex_remap(arch, &original_indices))
+        {
+        free(vertices);
+        free(triangle_normals);
+        free(vertex_normals);
+        free(vertex_colors);
+        free(texcoords);
+        free(tria_indices);
+        free(attributes);
+        free(original_indices);
+        trico_close_archive(arch);
+        printf("Something went wrong when reading the vertex remap\n");
+        return -1;
+        }
+      break;
+      }
       default:
       {
       trico_skip_next_stream(arch);
@@ -409,7 +429,20 @@ int main(int argc, const char** argv)
     }
 
   trico_close_archive(arch);
-  free(buffer);
+
+  if (original_indices && nr_of_original_indices == nr_of_vertices)
+    {
+    if (!restore_vertex_order(&vertices, 3 * sizeof(float), original_indices, nr_of_vertices) ||
+      !restore_vertex_order(&vertex_normals, 3 * sizeof(float), original_indices, nr_of_vertices) ||
+      !restore_vertex_order(&vertex_colors, sizeof(uint32_t), original_indices, nr_of_vertices))
+      {
+      printf("Invalid vertex remap\n");
+      return -1;
+      }
+    for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+      tria_indices[i] = original_indices[tria_indices[i]];
+    }
+  free(original_indices);
 
   int output_as_stl = 0;
   int output_as_ply = 0;
@@ -2,8 +2,10 @@
 #include <trico_io/iostl.h>
 #include <trico_io/ioply.h>
 #include <trico/trico.h>
+#include <trico/mesh_connectivity.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 static void change_extension_to_trc(char* new_filename, const char* filename)
@@ -87,14 +89,39 @@ static int extension_is_ply(const char* filename)
   return 0;
   }
 
+/*
+Replaces *data by its elements in the order of indices.
+*/
+static int reorder_elements(void* data_pointer, uint32_t element_size, const uint32_t* indices, uint32_t count)
+  {
+  void** data = (void**)data_pointer;
+  if (!*data)
+    return 1;
+  void* reordered = trico_malloc((uint64_t)element_size * count);
+  if (!reordered)
+    return 0;
+  trico_gather_elements(reordered, *data, element_size, indices, count);
+  trico_free(*data);
+  *data = reordered;
+  return 1;
+  }
+
 static void print_help()
   {
   printf("Usage: trico_encoder -i <input> [options]\n\n");
   printf("Options:\n");
-  printf("  -i <input>           input file name of type binary stl or binary/ascii ply.\n");
+  printf("  -i <input>           input file name of type binary/ascii stl or binary/ascii ply.\n");
   printf("  -o <output>          output file name.\n");
   printf("  -stladd <attribute>  add a given stl attribute (normal, uint16).\n");
   printf("  -plyskip <attribute> skip a given ply attribute (normal, tex_coord, color).\n");
+  printf("  -version <version>   archive format version: 0 (default) or 1 (with stream directory).\n");
+  printf("  -parallelogram       compress the vertices with parallelogram prediction over the triangles.\n");
+  printf("  -triangles <coding>  triangle coding: planes (default), delta or connectivity.\n");
+  printf("  -reorder             reorder the triangles for vertex cache locality and renumber the vertices in order of first use.\n");
+  printf("  -remap               with -reorder, also store the original vertex indices, so that the decoder restores them.\n");
+  printf("  -entropy             entropy code all streams with rans.\n");
+  printf("  -lz4 <level>         lz4 level of the integer streams: 0 (default), negative for faster, 1 to 12 for smaller.\n");
+  printf("  -codec <selection>   codec selection: compressed (default), smallest or stored.\n");
   printf("\n");
   }
 
@@ -113,6 +140,14 @@ int main(int argc, const char** argv)
   int skip_ply_normals = 0;
   int skip_ply_texcoords = 0;
   int skip_ply_color = 0;
+  uint32_t version = 0;
+  int parallelogram = 0;
+  enum trico_triangle_coding triangle_coding = trico_triangle_coding_byte_planes;
+  int reorder = 0;
+  int remap = 0;
+  int entropy = 0;
+  enum trico_codec_selection codec_selection = trico_codec_selection_compressed;
+  int lz4_level = 0;
 
   for (int j = 1; j < argc; ++j)
     {
@@ -189,6 +224,94 @@ int main(int argc, const char** argv)
         return -1;
         }
       }
+    else if (strcmp(argv[j], "-version") == 0)
+      {
+      if (j == argc - 1)
+        {
+        printf("I expect a version after command -version\n");
+        return -1;
+        }
+      ++j;
+      version = (uint32_t)atoi(argv[j]);
+      }
+    else if (strcmp(argv[j], "-parallelogram") == 0)
+      {
+      parallelogram = 1;
+      }
+    else if (strcmp(argv[j], "-reorder") == 0)
+      {
+      reorder = 1;
+      }
+    else if (strcmp(argv[j], "-remap") == 0)
+      {
+      remap = 1;
+      }
+    else if (strcmp(argv[j], "-entropy") == 0)
+      {
+      entropy = 1;
+      }
+    else if (strcmp(argv[j], "-lz4") == 0)
+      {
+      if (j == argc - 1)
+        {
+        printf("I expect a level after command -lz4\n");
+        return -1;
+        }
+      ++j;
+      lz4_level = atoi(argv[j]);
+      }
+    else if (strcmp(argv[j], "-codec") == 0)
+      {
+      if (j == argc - 1)
+        {
+        printf("I expect a codec selection after command -codec\n");
+        return -1;
+        }
+      ++j;
+      if (strcmp(argv[j], "compressed") == 0)
+        {
+        codec_selection = trico_codec_selection_compressed;
+        }
+      else if (strcmp(argv[j], "smallest") == 0)
+        {
+        codec_selection = trico_codec_selection_smallest;
+        }
+      else if (strcmp(argv[j], "stored") == 0)
+        {
+        codec_selection = trico_codec_selection_stored;
+        }
+      else
+        {
+        printf("Unknown codec selection %s\n", argv[j]);
+        return -1;
+        }
+      }
+    else if (strcmp(argv[j], "-triangles") == 0)
+      {
+      if (j == argc - 1)
+        {
+        printf("I expect a triangle coding after command -triangles\n");
+        return -1;
+        }
+      ++j;
+      if (strcmp(argv[j], "planes") == 0)
+        {
+        triangle_coding = trico_triangle_coding_byte_planes;
+        }
+      else if (strcmp(argv[j], "delta") == 0)
+        {
+        triangle_coding = trico_triangle_coding_delta;
+        }
+      else if (strcmp(argv[j], "connectivity") == 0)
+        {
+        triangle_coding = trico_triangle_coding_connectivity;
+        }
+      else
+        {
+        printf("Unknown triangle coding %s\n", argv[j]);
+        return -1;
+        }
+      }
     else
       {
       printf("Unknown command %s\n", argv[j]);
@@ -250,15 +373,86 @@ int main(int argc, const char** argv)
       }
     }  
 
-  void* arch = trico_open_archive_for_writing(1024 * 1024);
-  if (nr_of_vertices && vertices && !trico_write_vertices(arch, vertices, nr_of_vertices))
+  uint32_t* original_indices = NULL;
+  if (reorder && nr_of_triangles && triangles)
     {
-    printf("Something went wrong when writing the vertices\n");
+    void* context = trico_create_context();
+    uint32_t* triangle_order = (uint32_t*)trico_malloc((uint64_t)nr_of_triangles * sizeof(uint32_t));
+    original_indices = (uint32_t*)trico_malloc((uint64_t)nr_of_vertices * sizeof(uint32_t));
+    int reordered = triangle_order && original_indices &&
+      trico_optimize_triangle_order(context, triangle_order, triangles, nr_of_triangles, nr_of_vertices, 16) &&
+      reorder_elements(&triangles, 3 * sizeof(uint32_t), triangle_order, nr_of_triangles) &&
+      reorder_elements(&triangle_normals, 3 * sizeof(float), triangle_order, nr_of_triangles) &&
+      reorder_elements(&attributes, sizeof(uint16_t), triangle_order, nr_of_triangles) &&
+      reorder_elements(&texcoords, 6 * sizeof(float), triangle_order, nr_of_triangles) &&
+      trico_renumber_vertices(context, original_indices, triangles, nr_of_triangles, nr_of_vertices) &&
+      reorder_elements(&vertices, 3 * sizeof(float), original_indices, nr_of_vertices) &&
+      reorder_elements(&vertex_normals, 3 * sizeof(float), original_indices, nr_of_vertices) &&
+      reorder_elements(&vertex_colors, sizeof(uint32_t), original_indices, nr_of_vertices);
+    trico_free(triangle_order);
+    trico_destroy_context(context);
+    if (!reordered)
+      {
+      printf("Something went wrong when reordering the mesh\n");
+      return -1;
+      }
+    }
+
+  FILE* f = fopen(new_filename, "wb");
+  if (!f)
+    {
+    printf("Cannot write to file %s\n", new_filename);
     return -1;
     }
-  if (nr_of_triangles && triangles && !trico_write_triangles(arch, triangles, nr_of_triangles))
+
+  void* arch = trico_open_archive_for_writing_to_file(f, 1024 * 1024);
+  if (!trico_set_version(arch, version))
     {
-    printf("Something went wrong when writing the triangles\n");
+    printf("Unsupported archive version %d\n", (int)version);
+    trico_close_archive(arch);
+    fclose(f);
+    return -1;
+    }
+  struct trico_encoder_options options;
+  trico_get_encoder_options(arch, &options);
+  options.triangle_coding = triangle_coding;
+  for (uint32_t st = 0; st < TRICO_NUMBER_OF_STREAM_TYPES; ++st)
+    {
+    options.entropy_coding[st] = entropy ? trico_entropy_coding_rans : trico_entropy_coding_none;
+    options.codec_selection[st] = codec_selection;
+    options.lz4_level[st] = lz4_level;
+    }
+  trico_set_encoder_options(arch, &options);
+  if (parallelogram && nr_of_triangles && triangles)
+    {
+    // the decoder needs the triangles before the vertices
+    if (!trico_write_triangles(arch, triangles, nr_of_triangles))
+      {
+      printf("Something went wrong when writing the triangles\n");
+      return -1;
+      }
+    if (nr_of_vertices && vertices && !trico_write_vertices_parallelogram(arch, vertices, nr_of_vertices, triangles, nr_of_triangles))
+      {
+      printf("Something went wrong when writing the vertices\n");
+      return -1;
+      }
+    }
+  else
+    {
+    if (nr_of_vertices && vertices && !trico_write_vertices(arch, vertices, nr_of_vertices))
+      {
+      printf("Something went wrong when writing the vertices\n");
+      return -1;
+      }
+    if (nr_of_triangles && triangles && !trico_write_triangles(arch, triangles, nr_of_triangles))
+      {
+      printf("Something went wrong when writing the triangles\n");
+      return -1;
+      }
+    }
+  if (remap && original_indices && !trico_write_vertex_remap(arch, original_indices, nr_of_vertices))
+    {
+    printf("Something went wrong when writing the vertex remap\n");
     return -1;
     }
   if (is_stl && include_stl_normals)
@@ -309,18 +503,18 @@ int main(int argc, const char** argv)
   trico_free(texcoords);
   trico_free(triangle_normals);
   trico_free(attributes);
+  trico_free(original_indices);
 
-  FILE* f = fopen(new_filename, "wb");
-  if (!f)
+  if (!trico_finalize_archive(arch))
     {
-    printf("Cannot write to file %s\n", new_filename);
+    printf("There was an error writing file %s\n", new_filename);
+    trico_close_archive(arch);
+    fclose(f);
     return -1;
     }
 
-  fwrite((const void*)trico_get_buffer_pointer(arch), trico_get_size(arch), 1, f);
-  fclose(f);
-
   trico_close_archive(arch);
+  fclose(f);
 
   return 0;
   }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "test_assert.h"
 
 #include <trico/alloc.h>
+#include <trico/context.h>
 #include <trico/transpose_aos_to_soa.h>
 #include <trico/floating_point_stream_compression.h>
 
@@ -9,7 +10,12 @@
 
 #include <lz4/lz4.h>
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
+#include <cstring>
+#include <limits>
+#include <string>
 
 #include "timer.h"
 
@@ -29,6 +35,15 @@ namespace
     double ti = g_timer.time_elapsed();
     std::cout << txt << ti << " seconds.\n";
     }
+
+  const char* instruction_set_names[] = { "scalar", "sse2", "avx2" };
+
+  const int nr_of_transpose_runs = 100;
+
+  std::string transpose_timing(const char* name, int instruction_set)
+    {
+    return std::string(name) + " time (" + instruction_set_names[instruction_set] + ", " + std::to_string(nr_of_transpose_runs) + " runs): ";
+    }
   }
 
 void transpose_xyz_aos_to_soa(const char* filename)
@@ -43,39 +58,269 @@ void transpose_xyz_aos_to_soa(const char* filename)
   float* x = (float*)trico_malloc(sizeof(float)*nr_of_vertices);
   float* y = (float*)trico_malloc(sizeof(float)*nr_of_vertices);
   float* z = (float*)trico_malloc(sizeof(float)*nr_of_vertices);
+  float* vertices_from_xyz = (float*)trico_malloc(sizeof(float)*nr_of_vertices * 3);
 
-  tic();
-  trico_transpose_xyz_aos_to_soa(&x, &y, &z, vertices, nr_of_vertices);
-  toc("transpose_xyz_aos_to_soa time: ");
-
-  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+  const int default_instruction_set = trico_get_transpose_instruction_set();
+  for (int instruction_set = TRICO_INSTRUCTION_SET_SCALAR; instruction_set <= TRICO_INSTRUCTION_SET_AVX2; ++instruction_set)
     {
-    TEST_EQ(x[i], vertices[i * 3]);
-    TEST_EQ(y[i], vertices[i * 3 + 1]);
-    TEST_EQ(z[i], vertices[i * 3 + 2]);
+    if (!trico_set_transpose_instruction_set(instruction_set))
+      continue;
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_xyz_aos_to_soa(&x, &y, &z, vertices, nr_of_vertices);
+    toc(transpose_timing("transpose_xyz_aos_to_soa", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_vertices; ++i)
+      {
+      TEST_EQ(x[i], vertices[i * 3]);
+      TEST_EQ(y[i], vertices[i * 3 + 1]);
+      TEST_EQ(z[i], vertices[i * 3 + 2]);
+      }
+
+    memset(vertices_from_xyz, 0, sizeof(float)*nr_of_vertices * 3);
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_xyz_soa_to_aos(&vertices_from_xyz, x, y, z, nr_of_vertices);
+    toc(transpose_timing("transpose_xyz_soa_to_aos", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_vertices; ++i)
+      {
+      TEST_EQ(x[i], vertices_from_xyz[i * 3]);
+      TEST_EQ(y[i], vertices_from_xyz[i * 3 + 1]);
+      TEST_EQ(z[i], vertices_from_xyz[i * 3 + 2]);
+      }
     }
+  trico_set_transpose_instruction_set(default_instruction_set);
 
-  float* vertices_from_xyz = (float*)trico_malloc(sizeof(float)*nr_of_vertices * 3);
+  trico_free(vertices_from_xyz);
+  trico_free(x);
+  trico_free(y);
+  trico_free(z);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
 
-  tic();
-  trico_transpose_xyz_soa_to_aos(&vertices_from_xyz, x, y, z, nr_of_vertices);
-  toc("transpose_xyz_soa_to_aos time: ");
+void transpose_xyz_aos_to_soa_double(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
 
-  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  double* dvertices = (double*)trico_malloc(sizeof(double)*nr_of_vertices * 3);
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    dvertices[i] = (double)vertices[i];
+
+  double* x = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
+  double* y = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
+  double* z = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
+  double* vertices_from_xyz = (double*)trico_malloc(sizeof(double)*nr_of_vertices * 3);
+
+  const int default_instruction_set = trico_get_transpose_instruction_set();
+  for (int instruction_set = TRICO_INSTRUCTION_SET_SCALAR; instruction_set <= TRICO_INSTRUCTION_SET_AVX2; ++instruction_set)
     {
-    TEST_EQ(x[i], vertices_from_xyz[i * 3]);
-    TEST_EQ(y[i], vertices_from_xyz[i * 3 + 1]);
-    TEST_EQ(z[i], vertices_from_xyz[i * 3 + 2]);
+    if (!trico_set_transpose_instruction_set(instruction_set))
+      continue;
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_xyz_aos_to_soa_double_precision(&x, &y, &z, dvertices, nr_of_vertices);
+    toc(transpose_timing("transpose_xyz_aos_to_soa_double_precision", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_vertices; ++i)
+      {
+      TEST_EQ(x[i], dvertices[i * 3]);
+      TEST_EQ(y[i], dvertices[i * 3 + 1]);
+      TEST_EQ(z[i], dvertices[i * 3 + 2]);
+      }
+
+    memset(vertices_from_xyz, 0, sizeof(double)*nr_of_vertices * 3);
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_xyz_soa_to_aos_double_precision(&vertices_from_xyz, x, y, z, nr_of_vertices);
+    toc(transpose_timing("transpose_xyz_soa_to_aos_double_precision", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+      TEST_EQ(dvertices[i], vertices_from_xyz[i]);
     }
+  trico_set_transpose_instruction_set(default_instruction_set);
 
   trico_free(vertices_from_xyz);
   trico_free(x);
   trico_free(y);
   trico_free(z);
+  trico_free(dvertices);
   trico_free(vertices);
   trico_free(triangles);
   }
 
+void transpose_uv_aos_to_soa(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  // use the coordinates as uv pairs
+  const uint32_t nr_of_uv_positions = nr_of_vertices * 3 / 2;
+  const float* uv = vertices;
+  double* duv = (double*)trico_malloc(sizeof(double)*nr_of_uv_positions * 2);
+  for (uint32_t i = 0; i < nr_of_uv_positions * 2; ++i)
+    duv[i] = (double)uv[i];
+
+  float* u = (float*)trico_malloc(sizeof(float)*nr_of_uv_positions);
+  float* v = (float*)trico_malloc(sizeof(float)*nr_of_uv_positions);
+  float* uv_from_u_v = (float*)trico_malloc(sizeof(float)*nr_of_uv_positions * 2);
+  double* du = (double*)trico_malloc(sizeof(double)*nr_of_uv_positions);
+  double* dv = (double*)trico_malloc(sizeof(double)*nr_of_uv_positions);
+  double* duv_from_u_v = (double*)trico_malloc(sizeof(double)*nr_of_uv_positions * 2);
+
+  const int default_instruction_set = trico_get_transpose_instruction_set();
+  for (int instruction_set = TRICO_INSTRUCTION_SET_SCALAR; instruction_set <= TRICO_INSTRUCTION_SET_AVX2; ++instruction_set)
+    {
+    if (!trico_set_transpose_instruction_set(instruction_set))
+      continue;
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uv_aos_to_soa(&u, &v, uv, nr_of_uv_positions);
+    toc(transpose_timing("transpose_uv_aos_to_soa", instruction_set).c_str());
+
+    memset(uv_from_u_v, 0, sizeof(float)*nr_of_uv_positions * 2);
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uv_soa_to_aos(&uv_from_u_v, u, v, nr_of_uv_positions);
+    toc(transpose_timing("transpose_uv_soa_to_aos", instruction_set).c_str());
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uv_aos_to_soa_double_precision(&du, &dv, duv, nr_of_uv_positions);
+    toc(transpose_timing("transpose_uv_aos_to_soa_double_precision", instruction_set).c_str());
+
+    memset(duv_from_u_v, 0, sizeof(double)*nr_of_uv_positions * 2);
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uv_soa_to_aos_double_precision(&duv_from_u_v, du, dv, nr_of_uv_positions);
+    toc(transpose_timing("transpose_uv_soa_to_aos_double_precision", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_uv_positions; ++i)
+      {
+      TEST_EQ(u[i], uv[i * 2]);
+      TEST_EQ(v[i], uv[i * 2 + 1]);
+      TEST_EQ(du[i], duv[i * 2]);
+      TEST_EQ(dv[i], duv[i * 2 + 1]);
+      }
+    for (uint32_t i = 0; i < nr_of_uv_positions * 2; ++i)
+      {
+      TEST_EQ(uv[i], uv_from_u_v[i]);
+      TEST_EQ(duv[i], duv_from_u_v[i]);
+      }
+    }
+  trico_set_transpose_instruction_set(default_instruction_set);
+
+  trico_free(duv_from_u_v);
+  trico_free(dv);
+  trico_free(du);
+  trico_free(uv_from_u_v);
+  trico_free(v);
+  trico_free(u);
+  trico_free(duv);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void transpose_xyz_and_uv_tails()
+  {
+  // sizes around the number of elements that the vectorized transposes handle per iteration
+  const uint32_t max_size = 41;
+  std::vector<float> aos(max_size * 3), soa(max_size * 3), aos_back(max_size * 3);
+  std::vector<double> daos(max_size * 3), dsoa(max_size * 3), daos_back(max_size * 3);
+  for (uint32_t i = 0; i < max_size * 3; ++i)
+    {
+    aos[i] = (float)i + 0.5f;
+    daos[i] = (double)i + 0.25;
+    }
+  float* x = soa.data();
+  float* y = soa.data() + max_size;
+  float* z = soa.data() + max_size * 2;
+  double* dx = dsoa.data();
+  double* dy = dsoa.data() + max_size;
+  double* dz = dsoa.data() + max_size * 2;
+  float* back = aos_back.data();
+  double* dback = daos_back.data();
+
+  const int default_instruction_set = trico_get_transpose_instruction_set();
+  for (int instruction_set = TRICO_INSTRUCTION_SET_SCALAR; instruction_set <= TRICO_INSTRUCTION_SET_AVX2; ++instruction_set)
+    {
+    if (!trico_set_transpose_instruction_set(instruction_set))
+      continue;
+    for (uint32_t n = 0; n <= max_size; ++n)
+      {
+      std::fill(soa.begin(), soa.end(), -1.f);
+      std::fill(aos_back.begin(), aos_back.end(), -1.f);
+      trico_transpose_xyz_aos_to_soa(&x, &y, &z, aos.data(), n);
+      trico_transpose_xyz_soa_to_aos(&back, x, y, z, n);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+        TEST_EQ(aos[i * 3], x[i]);
+        TEST_EQ(aos[i * 3 + 1], y[i]);
+        TEST_EQ(aos[i * 3 + 2], z[i]);
+        }
+      for (uint32_t i = 0; i < max_size * 3; ++i)
+        TEST_EQ(i < n * 3 ? aos[i] : -1.f, back[i]);
+      if (n < max_size)
+        TEST_EQ(-1.f, x[n]);
+
+      std::fill(dsoa.begin(), dsoa.end(), -1.0);
+      std::fill(daos_back.begin(), daos_back.end(), -1.0);
+      trico_transpose_xyz_aos_to_soa_double_precision(&dx, &dy, &dz, daos.data(), n);
+      trico_transpose_xyz_soa_to_aos_double_precision(&dback, dx, dy, dz, n);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+        TEST_EQ(daos[i * 3], dx[i]);
+        TEST_EQ(daos[i * 3 + 1], dy[i]);
+        TEST_EQ(daos[i * 3 + 2], dz[i]);
+        }
+      for (uint32_t i = 0; i < max_size * 3; ++i)
+        TEST_EQ(i < n * 3 ? daos[i] : -1.0, dback[i]);
+
+      std::fill(soa.begin(), soa.end(), -1.f);
+      std::fill(aos_back.begin(), aos_back.end(), -1.f);
+      trico_transpose_uv_aos_to_soa(&x, &y, aos.data(), n);
+      trico_transpose_uv_soa_to_aos(&back, x, y, n);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+        TEST_EQ(aos[i * 2], x[i]);
+        TEST_EQ(aos[i * 2 + 1], y[i]);
+        }
+      for (uint32_t i = 0; i < max_size * 3; ++i)
+        TEST_EQ(i < n * 2 ? aos[i] : -1.f, back[i]);
+
+      std::fill(dsoa.begin(), dsoa.end(), -1.0);
+      std::fill(daos_back.begin(), daos_back.end(), -1.0);
+      trico_transpose_uv_aos_to_soa_double_precision(&dx, &dy, daos.data(), n);
+      trico_transpose_uv_soa_to_aos_double_precision(&dback, dx, dy, n);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+        TEST_EQ(daos[i * 2], dx[i]);
+        TEST_EQ(daos[i * 2 + 1], dy[i]);
+        }
+      for (uint32_t i = 0; i < max_size * 3; ++i)
+        TEST_EQ(i < n * 2 ? daos[i] : -1.0, dback[i]);
+      }
+    }
+  trico_set_transpose_instruction_set(default_instruction_set);
+  }
+
 void compress_vertices_double(const char* filename)
   {
   uint32_t nr_of_vertices;
@@ -215,6 +460,15 @@ void compress_vertices(const char* filename)
     TEST_EQ(z[i], decompressed_z[i]);
 
 
+  float* decompressed_xyz = (float*)trico_malloc(sizeof(float)*nr_of_vertices * 3);
+  TEST_EQ(nr_of_vertices, trico_get_number_of_compressed_values(compressed_x));
+  trico_decompress_into(decompressed_xyz, 3, compressed_x);
+  trico_decompress_into(decompressed_xyz + 1, 3, compressed_y);
+  trico_decompress_into(decompressed_xyz + 2, 3, compressed_z);
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    TEST_EQ(vertices[i], decompressed_xyz[i]);
+  trico_free(decompressed_xyz);
+
   std::cout << "Compression ratio for x: " << ((float)nr_of_vertices*4.f) / (float)nr_of_compressed_x_bytes << "\n";
   std::cout << "Compression ratio for y: " << ((float)nr_of_vertices*4.f) / (float)nr_of_compressed_y_bytes << "\n";
   std::cout << "Compression ratio for z: " << ((float)nr_of_vertices*4.f) / (float)nr_of_compressed_z_bytes << "\n";
@@ -233,10 +487,387 @@ void compress_vertices(const char* filename)
   trico_free(triangles);
   }
 
+void compress_vertices_chunked(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  const uint32_t nr_of_floats = nr_of_vertices * 3;
+
+  uint32_t nr_of_compressed_bytes;
+  uint8_t* compressed;
+  tic();
+  trico_compress(&nr_of_compressed_bytes, &compressed, vertices, nr_of_floats, 4, 10);
+  toc("trico_compress time: ");
+  trico_free(compressed);
+
+  const uint32_t chunk_sizes[] = { 0, 1, 7, 1024, 16384, 65536 };
+  const uint32_t threads[] = { 1, 4, 0 };
+  for (uint32_t c = 0; c < sizeof(chunk_sizes) / sizeof(uint32_t); ++c)
+    {
+    for (uint32_t t = 0; t < sizeof(threads) / sizeof(uint32_t); ++t)
+      {
+      uint32_t nr_of_compressed_chunked_bytes;
+      uint8_t* compressed_chunked;
+      tic();
+      trico_compress_chunked(&nr_of_compressed_chunked_bytes, &compressed_chunked, vertices, nr_of_floats, 4, 10, chunk_sizes[c], threads[t]);
+      std::cout << "chunk size " << chunk_sizes[c] << ", threads " << threads[t] << ": ";
+      toc("trico_compress_chunked time: ");
+
+      uint32_t nr_of_decompressed_floats;
+      float* decompressed;
+      tic();
+      trico_decompress_chunked(&nr_of_decompressed_floats, &decompressed, compressed_chunked, threads[t]);
+      std::cout << "chunk size " << chunk_sizes[c] << ", threads " << threads[t] << ": ";
+      toc("trico_decompress_chunked time: ");
+
+      TEST_EQ(nr_of_floats, nr_of_decompressed_floats);
+      for (uint32_t i = 0; i < nr_of_decompressed_floats; ++i)
+        TEST_EQ(vertices[i], decompressed[i]);
+
+      if (t == 0)
+        {
+        const float ratio = ((float)nr_of_floats*4.f) / (float)nr_of_compressed_bytes;
+        const float chunked_ratio = ((float)nr_of_floats*4.f) / (float)nr_of_compressed_chunked_bytes;
+        std::cout << "Compression ratio with chunk size " << chunk_sizes[c] << ": " << chunked_ratio << " (loss: " << (ratio - chunked_ratio) / ratio * 100.f << "%)\n";
+        }
+
+      trico_free(decompressed);
+      trico_free(compressed_chunked);
+      }
+    }
+
+  double* vertices_double = (double*)trico_malloc(sizeof(double)*nr_of_floats);
+  for (uint32_t i = 0; i < nr_of_floats; ++i)
+    vertices_double[i] = (double)vertices[i];
+
+  uint32_t nr_of_compressed_double_bytes;
+  uint8_t* compressed_double;
+  trico_compress_chunked_double_precision(&nr_of_compressed_double_bytes, &compressed_double, vertices_double, nr_of_floats, 20, 20, 16383, 0);
+
+  uint32_t nr_of_doubles;
+  double* decompressed_double;
+  trico_decompress_chunked_double_precision(&nr_of_doubles, &decompressed_double, compressed_double, 0);
+
+  TEST_EQ(nr_of_floats, nr_of_doubles);
+  for (uint32_t i = 0; i < nr_of_doubles; ++i)
+    TEST_EQ(vertices_double[i], decompressed_double[i]);
+
+  trico_free(decompressed_double);
+  trico_free(compressed_double);
+  trico_free(vertices_double);
+
+  uint32_t nr_of_compressed_empty_bytes;
+  uint8_t* compressed_empty;
+  trico_compress_chunked(&nr_of_compressed_empty_bytes, &compressed_empty, vertices, 0, 4, 10, 1024, 0);
+  uint32_t nr_of_empty_floats = 1;
+  float* decompressed_empty;
+  trico_decompress_chunked(&nr_of_empty_floats, &decompressed_empty, compressed_empty, 0);
+  TEST_EQ(0, nr_of_empty_floats);
+  trico_free(decompressed_empty);
+  trico_free(compressed_empty);
+
+  // a chunk size larger than the number of values gives one chunk, and its bound does not wrap around
+  const uint32_t nr_of_values = 1000;
+  TEST_EQ(trico_compress_chunked_bound(nr_of_values, nr_of_values), trico_compress_chunked_bound(nr_of_values, 0xffffffff));
+  TEST_EQ(trico_compress_chunked_double_precision_bound(nr_of_values, nr_of_values), trico_compress_chunked_double_precision_bound(nr_of_values, 0xffffffff));
+  TEST_ASSERT(trico_compress_chunked_bound(0xffffffff, 0xffffffff) > 4 * (uint64_t)0xffffffff);
+  uint32_t nr_of_compressed_large_chunk_bytes;
+  uint8_t* compressed_large_chunk;
+  trico_compress_chunked(&nr_of_compressed_large_chunk_bytes, &compressed_large_chunk, vertices, nr_of_values, 4, 10, 0xffffffff, 0);
+  TEST_ASSERT(nr_of_compressed_large_chunk_bytes <= trico_compress_chunked_bound(nr_of_values, 0xffffffff));
+  TEST_EQ(nr_of_values, trico_get_chunk_size(compressed_large_chunk));
+  uint32_t nr_of_large_chunk_floats;
+  float* decompressed_large_chunk;
+  trico_decompress_chunked(&nr_of_large_chunk_floats, &decompressed_large_chunk, compressed_large_chunk, 0);
+  TEST_EQ(nr_of_values, nr_of_large_chunk_floats);
+  TEST_ASSERT(memcmp(vertices, decompressed_large_chunk, nr_of_values * sizeof(float)) == 0);
+  trico_free(decompressed_large_chunk);
+  trico_free(compressed_large_chunk);
+  std::vector<double> doubles(vertices, vertices + nr_of_values);
+  trico_compress_chunked_double_precision(&nr_of_compressed_large_chunk_bytes, &compressed_large_chunk, doubles.data(), nr_of_values, 20, 20, 0xffffffff, 0);
+  TEST_ASSERT(nr_of_compressed_large_chunk_bytes <= trico_compress_chunked_double_precision_bound(nr_of_values, 0xffffffff));
+  uint32_t nr_of_large_chunk_doubles;
+  double* decompressed_large_chunk_doubles;
+  trico_decompress_chunked_double_precision(&nr_of_large_chunk_doubles, &decompressed_large_chunk_doubles, compressed_large_chunk, 0);
+  TEST_EQ(nr_of_values, nr_of_large_chunk_doubles);
+  TEST_ASSERT(memcmp(doubles.data(), decompressed_large_chunk_doubles, nr_of_values * sizeof(double)) == 0);
+  trico_free(decompressed_large_chunk_doubles);
+  trico_free(compressed_large_chunk);
+
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void compress_all_codes()
+  {
+  // values with residuals of every byte length, for both predictors, and all sizes of the last (partial) group
+  std::vector<uint32_t> bits;
+  uint32_t state = 12345;
+  for (uint32_t i = 0; i < 4096; ++i)
+    {
+    state = state * 1664525 + 1013904223;
+    const uint32_t nr_of_bits = (state >> 27) + 1;
+    if (i % 5 == 0)
+      bits.push_back(bits.empty() ? 0 : bits.back());
+    else if (i % 7 == 0)
+      bits.push_back(bits.empty() ? 0 : bits.back() + (bits.size() > 1 ? bits.back() - bits[bits.size() - 2] : 0));
+    else
+      bits.push_back((bits.empty() ? 0 : bits.back()) ^ (state & (uint32_t)(((uint64_t)1 << nr_of_bits) - 1)));
+    }
+  for (uint32_t n = 0; n < 4096; n = n < 40 ? n + 1 : n * 2 + 3)
+    {
+    const float* input = (const float*)bits.data();
+    uint8_t* compressed = (uint8_t*)trico_malloc(trico_compress_bound(n));
+    const uint32_t nr_of_compressed_bytes = trico_compress_into(compressed, input, n, 4, 10);
+    TEST_ASSERT(nr_of_compressed_bytes <= trico_compress_bound(n));
+    // decompress from an exactly sized copy, so that reading past the end would be detected by memory checkers
+    uint8_t* exact = (uint8_t*)trico_malloc(nr_of_compressed_bytes);
+    memcpy(exact, compressed, nr_of_compressed_bytes);
+    std::vector<uint32_t> decompressed(n + 1, 0xdeadbeef);
+    trico_decompress_into((float*)decompressed.data(), 1, exact);
+    for (uint32_t i = 0; i < n; ++i)
+      TEST_EQ(bits[i], decompressed[i]);
+    TEST_EQ(0xdeadbeef, decompressed[n]);
+    trico_free(exact);
+    trico_free(compressed);
+    }
+  }
+
+void compress_interleaved()
+  {
+  // each stream of the interleaved encoders equals the stream of its transposed component, also over tile borders
+  const uint32_t max_n = 2048 * 2 + 5;
+  std::vector<float> values(TRICO_MAX_INTERLEAVED_COMPONENTS * max_n);
+  std::vector<double> values_double(values.size());
+  uint32_t state = 12345;
+  for (size_t i = 0; i < values.size(); ++i)
+    {
+    state = state * 1664525 + 1013904223;
+    values[i] = (float)(i / TRICO_MAX_INTERLEAVED_COMPONENTS) * 0.25f + (float)(state >> 24) / 256.f;
+    values_double[i] = (double)values[i] * 1.0000001;
+    }
+  void* context = trico_create_context();
+  const uint32_t sizes[] = { 0, 1, 7, 2048, 2049, max_n };
+  for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+    const uint32_t n = sizes[s];
+    std::vector<float> plane(n + 1);
+    std::vector<double> plane_double(n + 1);
+    const uint64_t bound = std::max(trico_compress_bound(n), trico_compress_double_precision_bound(n));
+    std::vector<uint8_t> expected(bound);
+    for (uint32_t nr_of_components = 1; nr_of_components <= TRICO_MAX_INTERLEAVED_COMPONENTS; ++nr_of_components)
+      {
+      std::vector<uint8_t> compressed[TRICO_MAX_INTERLEAVED_COMPONENTS];
+      uint8_t* out[TRICO_MAX_INTERLEAVED_COMPONENTS];
+      uint32_t nr_of_compressed_bytes[TRICO_MAX_INTERLEAVED_COMPONENTS];
+      for (uint32_t c = 0; c < nr_of_components; ++c)
+        {
+        compressed[c].resize(bound);
+        out[c] = compressed[c].data();
+        }
+      TEST_EQ(1, trico_compress_interleaved_into_with_context(context, out, nr_of_compressed_bytes, values.data(), nr_of_components, n, 4, 10));
+      for (uint32_t c = 0; c < nr_of_components; ++c)
+        {
+        for (uint32_t i = 0; i < n; ++i)
+          plane[i] = values[i * nr_of_components + c];
+        TEST_EQ(trico_compress_into(expected.data(), plane.data(), n, 4, 10), nr_of_compressed_bytes[c]);
+        TEST_ASSERT(memcmp(expected.data(), compressed[c].data(), nr_of_compressed_bytes[c]) == 0);
+        }
+      TEST_EQ(1, trico_compress_interleaved_double_precision_into_with_context(context, out, nr_of_compressed_bytes, values_double.data(), nr_of_components, n, 12, 14));
+      for (uint32_t c = 0; c < nr_of_components; ++c)
+        {
+        for (uint32_t i = 0; i < n; ++i)
+          plane_double[i] = values_double[i * nr_of_components + c];
+        TEST_EQ(trico_compress_double_precision_into(expected.data(), plane_double.data(), n, 12, 14), nr_of_compressed_bytes[c]);
+        TEST_ASSERT(memcmp(expected.data(), compressed[c].data(), nr_of_compressed_bytes[c]) == 0);
+        trico_decompress_double_precision_into(plane_double.data(), 1, compressed[c].data());
+        for (uint32_t i = 0; i < n; ++i)
+          TEST_EQ(values_double[i * nr_of_components + c], plane_double[i]);
+        }
+      }
+    }
+  uint8_t* out[TRICO_MAX_INTERLEAVED_COMPONENTS + 1];
+  uint32_t nr_of_compressed_bytes[TRICO_MAX_INTERLEAVED_COMPONENTS + 1];
+  TEST_EQ(0, trico_compress_interleaved_into_with_context(context, out, nr_of_compressed_bytes, values.data(), 0, 1, 4, 10));
+  TEST_EQ(0, trico_compress_interleaved_into_with_context(context, out, nr_of_compressed_bytes, values.data(), TRICO_MAX_INTERLEAVED_COMPONENTS + 1, 1, 4, 10));
+  trico_destroy_context(context);
+  }
+
+void decompress_chunked_range(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  const uint32_t chunk_size = 1000;
+  uint8_t* compressed = (uint8_t*)trico_malloc(trico_compress_chunked_bound(nr_of_vertices, chunk_size));
+  const uint32_t nr_of_compressed_bytes = trico_compress_chunked_into(compressed, vertices, nr_of_vertices, 4, 10, chunk_size, 1);
+  TEST_ASSERT(nr_of_compressed_bytes <= trico_compress_chunked_bound(nr_of_vertices, chunk_size));
+  TEST_EQ(nr_of_vertices, trico_get_number_of_chunked_values(compressed));
+  TEST_EQ(chunk_size, trico_get_chunk_size(compressed));
+
+  double* vertices_double = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    vertices_double[i] = (double)vertices[i];
+  uint8_t* compressed_double = (uint8_t*)trico_malloc(trico_compress_chunked_double_precision_bound(nr_of_vertices, chunk_size));
+  trico_compress_chunked_double_precision_into(compressed_double, vertices_double, nr_of_vertices, 20, 20, chunk_size, 1);
+
+  // ranges inside one chunk, over chunk borders, aligned with chunks, and up to the end
+  const uint32_t ranges[][2] = { { 0, 1 }, { 10, 20 }, { 999, 2 }, { 1000, 1000 }, { 500, 3000 }, { nr_of_vertices - 10, 10 }, { 0, nr_of_vertices } };
+  float* decompressed = (float*)trico_malloc(sizeof(float)*nr_of_vertices * 2);
+  double* decompressed_double = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
+  for (uint32_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); ++r)
+    {
+    const uint32_t first = ranges[r][0];
+    const uint32_t count = ranges[r][1];
+    trico_decompress_chunked_range_into(decompressed, 2, compressed, first, count, 4);
+    trico_decompress_chunked_double_precision_range_into(decompressed_double, 1, compressed_double, first, count, 1);
+    for (uint32_t i = 0; i < count; ++i)
+      {
+      TEST_EQ(vertices[first + i], decompressed[i * 2]);
+      TEST_EQ(vertices_double[first + i], decompressed_double[i]);
+      }
+    }
+
+  trico_free(decompressed_double);
+  trico_free(decompressed);
+  trico_free(compressed_double);
+  trico_free(vertices_double);
+  trico_free(compressed);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void compress_parallelogram(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* context = trico_create_context();
+  const uint64_t bound = trico_compress_parallelogram_bound(nr_of_vertices);
+  uint8_t* compressed = (uint8_t*)trico_malloc(bound);
+  const uint32_t nr_of_compressed_bytes = trico_compress_parallelogram_into_with_context(context, compressed, vertices, nr_of_vertices, triangles, nr_of_triangles);
+  TEST_ASSERT(nr_of_compressed_bytes > 0 && nr_of_compressed_bytes <= bound);
+  TEST_EQ(nr_of_vertices, trico_get_number_of_compressed_values(compressed));
+
+  // the parallelogram rule should beat the per-coordinate predictors on a mesh
+  uint8_t* compressed_planes = (uint8_t*)trico_malloc(trico_compress_bound(nr_of_vertices * 3));
+  TEST_ASSERT(nr_of_compressed_bytes < trico_compress_into(compressed_planes, vertices, nr_of_vertices * 3, 4, 10));
+  trico_free(compressed_planes);
+
+  std::vector<float> decompressed(nr_of_vertices * 3 + 1, -1.f);
+  TEST_EQ(1, trico_decompress_parallelogram_into_with_context(context, decompressed.data(), compressed, nr_of_compressed_bytes, triangles, nr_of_triangles));
+  TEST_ASSERT(memcmp(vertices, decompressed.data(), nr_of_vertices * 3 * sizeof(float)) == 0);
+  TEST_EQ(-1.f, decompressed[nr_of_vertices * 3]);
+
+  TEST_EQ(0, trico_decompress_parallelogram_into_with_context(context, decompressed.data(), compressed, nr_of_compressed_bytes - 1, triangles, nr_of_triangles));
+  TEST_EQ(0, trico_decompress_parallelogram_into_with_context(context, decompressed.data(), compressed, 4, triangles, nr_of_triangles));
+  triangles[5] = nr_of_vertices;
+  TEST_EQ(0, trico_compress_parallelogram_into_with_context(context, compressed, vertices, nr_of_vertices, triangles, nr_of_triangles));
+
+  // two triangles sharing an edge, a triangle on its own, an unused vertex, a degenerate triangle, and the signed zeros, NaN and infinities
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float small_vertices[] = { 0.f, 0.f, 0.f, 1.f, 0.f, -0.f, 0.f, 1.f, 0.f, 1.f, 1.f, 0.5f, 7.f, 7.f, 7.f, 8.f, 7.f, 7.f, 7.f, 8.f, 7.f, inf, -inf, nan, -0.f, 1e-40f, -3.f };
+  const uint32_t small_triangles[] = { 0, 1, 2, 2, 1, 3, 4, 5, 6, 3, 7, 7 };
+  const uint32_t small_nr_of_vertices = 9;
+  for (uint32_t t = 0; t <= 4; ++t)
+    {
+    const uint32_t small_bound = (uint32_t)trico_compress_parallelogram_bound(small_nr_of_vertices);
+    std::vector<uint8_t> small_compressed(small_bound);
+    const uint32_t small_nr_of_compressed_bytes = trico_compress_parallelogram_into_with_context(context, small_compressed.data(), small_vertices, small_nr_of_vertices, small_triangles, t);
+    TEST_ASSERT(small_nr_of_compressed_bytes > 0 && small_nr_of_compressed_bytes <= small_bound);
+    std::vector<float> small_decompressed(small_nr_of_vertices * 3);
+    TEST_EQ(1, trico_decompress_parallelogram_into_with_context(context, small_decompressed.data(), small_compressed.data(), small_nr_of_compressed_bytes, small_triangles, t));
+    TEST_ASSERT(memcmp(small_vertices, small_decompressed.data(), sizeof(small_vertices)) == 0);
+    }
+
+  trico_free(compressed);
+  trico_destroy_context(context);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void entropy_code_residuals(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* context = trico_create_context();
+  std::vector<float> x(nr_of_vertices);
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    x[i] = vertices[3 * i];
+  std::vector<uint8_t> compressed[2];
+  compressed[0].resize(trico_compress_bound(nr_of_vertices));
+  compressed[0].resize(trico_compress_into_with_context(context, compressed[0].data(), x.data(), nr_of_vertices, 4, 10));
+  compressed[1].resize(trico_compress_parallelogram_bound(nr_of_vertices));
+  compressed[1].resize(trico_compress_parallelogram_into_with_context(context, compressed[1].data(), vertices, nr_of_vertices, triangles, nr_of_triangles));
+  const uint32_t nr_of_values[2] = { nr_of_vertices, 3 * nr_of_vertices };
+
+  for (int k = 0; k < 2; ++k)
+    {
+    std::vector<uint8_t> entropy_coded(trico_entropy_code_residuals_bound(nr_of_values[k]));
+    const uint32_t nr_of_entropy_coded_bytes = trico_entropy_code_residuals_with_context(context, entropy_coded.data(), compressed[k].data(), (uint32_t)compressed[k].size(), nr_of_values[k]);
+    std::cout << (k ? "parallelogram" : "x coordinates") << ": " << compressed[k].size() << " bytes, with entropy coded residuals: " << nr_of_entropy_coded_bytes << " bytes\n";
+    TEST_ASSERT(nr_of_entropy_coded_bytes > 0 && nr_of_entropy_coded_bytes < compressed[k].size());
+    const uint8_t* restored;
+    uint32_t nr_of_restored_bytes;
+    tic();
+    TEST_EQ(1, trico_entropy_decode_residuals_with_context(context, &restored, &nr_of_restored_bytes, entropy_coded.data(), nr_of_entropy_coded_bytes, nr_of_values[k]));
+    toc("trico_entropy_decode_residuals time: ");
+    TEST_EQ(compressed[k].size(), nr_of_restored_bytes);
+    TEST_ASSERT(memcmp(compressed[k].data(), restored, nr_of_restored_bytes) == 0);
+    TEST_EQ(0, trico_entropy_decode_residuals_with_context(context, &restored, &nr_of_restored_bytes, entropy_coded.data(), nr_of_entropy_coded_bytes - 1, nr_of_values[k]));
+    TEST_EQ(0, trico_entropy_decode_residuals_with_context(context, &restored, &nr_of_restored_bytes, entropy_coded.data(), nr_of_entropy_coded_bytes, nr_of_values[k] + 8));
+    TEST_EQ(0, trico_entropy_code_residuals_with_context(context, entropy_coded.data(), compressed[k].data(), (uint32_t)compressed[k].size() - 1, nr_of_values[k]));
+    }
+
+  // a value count that is not a multiple of 8
+  std::vector<uint8_t> small_compressed(trico_compress_bound(13));
+  small_compressed.resize(trico_compress_into_with_context(context, small_compressed.data(), x.data(), 13, 4, 10));
+  std::vector<uint8_t> small_entropy_coded(trico_entropy_code_residuals_bound(13));
+  const uint32_t small_nr_of_entropy_coded_bytes = trico_entropy_code_residuals_with_context(context, small_entropy_coded.data(), small_compressed.data(), (uint32_t)small_compressed.size(), 13);
+  TEST_ASSERT(small_nr_of_entropy_coded_bytes > 0 && small_nr_of_entropy_coded_bytes <= small_entropy_coded.size());
+  const uint8_t* small_restored;
+  uint32_t small_nr_of_restored_bytes;
+  TEST_EQ(1, trico_entropy_decode_residuals_with_context(context, &small_restored, &small_nr_of_restored_bytes, small_entropy_coded.data(), small_nr_of_entropy_coded_bytes, 13));
+  std::vector<float> small_decompressed(13);
+  trico_decompress_into_with_context(context, small_decompressed.data(), 1, small_restored);
+  TEST_ASSERT(memcmp(x.data(), small_decompressed.data(), 13 * sizeof(float)) == 0);
+
+  trico_destroy_context(context);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
 
 void run_all_fps_compression_tests()
   {
   transpose_xyz_aos_to_soa("data/StanfordBunny.stl");
+  transpose_xyz_aos_to_soa_double("data/StanfordBunny.stl");
+  transpose_uv_aos_to_soa("data/StanfordBunny.stl");
+  transpose_xyz_and_uv_tails();
   compress_vertices("data/StanfordBunny.stl");
   compress_vertices_double("data/StanfordBunny.stl");
+  compress_vertices_chunked("data/StanfordBunny.stl");
+  decompress_chunked_range("data/StanfordBunny.stl");
+  compress_all_codes();
+  compress_interleaved();
+  compress_parallelogram("data/StanfordBunny.stl");
+  entropy_code_residuals("data/StanfordBunny.stl");
   }
\ No newline at end of file
@@ -2,13 +2,22 @@
 #include "test_assert.h"
 
 #include <trico/alloc.h>
+#include <trico/context.h>
+#include <trico/entropy_coding.h>
+#include <trico/lz4_compression.h>
+#include <trico/mesh_connectivity.h>
+#include <trico/triangle_compression.h>
 #include <trico/transpose_aos_to_soa.h>
 
 #include <trico_io/iostl.h>
 
 #include <lz4/lz4.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "timer.h"
 
@@ -28,6 +37,32 @@ namespace
     double ti = g_timer.time_elapsed();
     std::cout << txt << ti << " seconds.\n";
     }
+
+  const char* instruction_set_names[] = { "scalar", "sse2", "avx2" };
+
+  const int nr_of_transpose_runs = 100;
+
+  std::string transpose_timing(const char* name, int instruction_set)
+    {
+    return std::string(name) + " time (" + instruction_set_names[instruction_set] + ", " + std::to_string(nr_of_transpose_runs) + " runs): ";
+    }
+
+  // average number of cache misses per triangle of a fifo vertex cache
+  double average_cache_miss_ratio(const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t cache_size)
+    {
+    std::vector<uint32_t> cache;
+    uint32_t nr_of_misses = 0;
+    for (uint32_t c = 0; c < nr_of_triangles * 3; ++c)
+      {
+      if (std::find(cache.begin(), cache.end(), triangles[c]) != cache.end())
+        continue;
+      ++nr_of_misses;
+      cache.push_back(triangles[c]);
+      if (cache.size() > cache_size)
+        cache.erase(cache.begin());
+      }
+    return (double)nr_of_misses / (double)nr_of_triangles;
+    }
   }
 
 
@@ -45,22 +80,40 @@ void transpose_uint32_aos_to_soa(const char* filename)
   uint8_t* b3 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
   uint8_t* b4 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
 
-
-  tic();
-  trico_transpose_uint32_aos_to_soa(&b1, &b2, &b3, &b4, triangles, nr_of_triangles * 3);
-  toc("transpose_uint32_aos_to_soa time: ");
-
-
   uint32_t* triangles_from_b1b2b3b4 = (uint32_t*)trico_malloc(nr_of_triangles * 3 * sizeof(uint32_t));
 
-  tic();
-  trico_transpose_uint32_soa_to_aos(&triangles_from_b1b2b3b4, b1, b2, b3, b4, nr_of_triangles * 3);
-  toc("transpose_uint32_soa_to_aos time: ");
-
-  for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+  const int default_instruction_set = trico_get_transpose_instruction_set();
+  for (int instruction_set = TRICO_INSTRUCTION_SET_SCALAR; instruction_set <= TRICO_INSTRUCTION_SET_AVX2; ++instruction_set)
     {
-    TEST_EQ(triangles[i], triangles_from_b1b2b3b4[i]);
+    if (!trico_set_transpose_instruction_set(instruction_set))
+      continue;
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uint32_aos_to_soa(&b1, &b2, &b3, &b4, triangles, nr_of_triangles * 3);
+    toc(transpose_timing("transpose_uint32_aos_to_soa", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+      {
+      TEST_EQ(triangles[i] & 0xff, b1[i]);
+      TEST_EQ((triangles[i] >> 8) & 0xff, b2[i]);
+      TEST_EQ((triangles[i] >> 16) & 0xff, b3[i]);
+      TEST_EQ((triangles[i] >> 24) & 0xff, b4[i]);
+      }
+
+    memset(triangles_from_b1b2b3b4, 0, nr_of_triangles * 3 * sizeof(uint32_t));
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uint32_soa_to_aos(&triangles_from_b1b2b3b4, b1, b2, b3, b4, nr_of_triangles * 3);
+    toc(transpose_timing("transpose_uint32_soa_to_aos", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+      {
+      TEST_EQ(triangles[i], triangles_from_b1b2b3b4[i]);
+      }
     }
+  trico_set_transpose_instruction_set(default_instruction_set);
 
   trico_free(triangles_from_b1b2b3b4);
   trico_free(b1);
@@ -72,6 +125,130 @@ void transpose_uint32_aos_to_soa(const char* filename)
   trico_free(triangles);
   }
 
+void transpose_uint64_aos_to_soa(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  const uint32_t nr_of_indices = nr_of_triangles * 3;
+
+  // spread the indices over all 8 bytes
+  uint64_t* indices = (uint64_t*)trico_malloc(nr_of_indices * sizeof(uint64_t));
+  for (uint32_t i = 0; i < nr_of_indices; ++i)
+    indices[i] = (uint64_t)triangles[i] * 0x9E3779B97F4A7C15ull;
+
+  uint8_t* b[8];
+  for (int j = 0; j < 8; ++j)
+    b[j] = (uint8_t*)trico_malloc(nr_of_indices);
+
+  uint64_t* indices_from_b = (uint64_t*)trico_malloc(nr_of_indices * sizeof(uint64_t));
+
+  const int default_instruction_set = trico_get_transpose_instruction_set();
+  for (int instruction_set = TRICO_INSTRUCTION_SET_SCALAR; instruction_set <= TRICO_INSTRUCTION_SET_AVX2; ++instruction_set)
+    {
+    if (!trico_set_transpose_instruction_set(instruction_set))
+      continue;
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uint64_aos_to_soa(&b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7], indices, nr_of_indices);
+    toc(transpose_timing("transpose_uint64_aos_to_soa", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_indices; ++i)
+      {
+      for (int j = 0; j < 8; ++j)
+        TEST_EQ((indices[i] >> (8 * j)) & 0xff, b[j][i]);
+      }
+
+    memset(indices_from_b, 0, nr_of_indices * sizeof(uint64_t));
+
+    tic();
+    for (int run = 0; run < nr_of_transpose_runs; ++run)
+      trico_transpose_uint64_soa_to_aos(&indices_from_b, b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], nr_of_indices);
+    toc(transpose_timing("transpose_uint64_soa_to_aos", instruction_set).c_str());
+
+    for (uint32_t i = 0; i < nr_of_indices; ++i)
+      {
+      TEST_EQ(indices[i], indices_from_b[i]);
+      }
+    }
+  trico_set_transpose_instruction_set(default_instruction_set);
+
+  trico_free(indices_from_b);
+  for (int j = 0; j < 8; ++j)
+    trico_free(b[j]);
+  trico_free(indices);
+
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void transpose_uint_tails()
+  {
+  // sizes around the number of elements that the vectorized transposes handle per iteration
+  const uint32_t max_size = 67;
+  std::vector<uint16_t> indices16(max_size), indices16_back(max_size);
+  std::vector<uint32_t> indices32(max_size), indices32_back(max_size);
+  std::vector<uint64_t> indices64(max_size), indices64_back(max_size);
+  for (uint32_t i = 0; i < max_size; ++i)
+    {
+    indices64[i] = ((uint64_t)i + 1) * 0x0102030405060708ull + ((uint64_t)i << 56);
+    indices32[i] = (uint32_t)(indices64[i] >> 16);
+    indices16[i] = (uint16_t)(indices64[i] >> 24);
+    }
+  std::vector<uint8_t> planes(max_size * 8);
+  uint8_t* b[8];
+  for (int j = 0; j < 8; ++j)
+    b[j] = planes.data() + max_size * j;
+  uint16_t* back16 = indices16_back.data();
+  uint32_t* back32 = indices32_back.data();
+  uint64_t* back64 = indices64_back.data();
+
+  const int default_instruction_set = trico_get_transpose_instruction_set();
+  for (int instruction_set = TRICO_INSTRUCTION_SET_SCALAR; instruction_set <= TRICO_INSTRUCTION_SET_AVX2; ++instruction_set)
+    {
+    if (!trico_set_transpose_instruction_set(instruction_set))
+      continue;
+    for (uint32_t n = 0; n <= max_size; ++n)
+      {
+      memset(planes.data(), 0xcd, planes.size());
+      std::fill(indices16_back.begin(), indices16_back.end(), (uint16_t)0xcdcd);
+      trico_transpose_uint16_aos_to_soa(&b[0], &b[1], indices16.data(), n);
+      trico_transpose_uint16_soa_to_aos(&back16, b[0], b[1], n);
+      for (uint32_t i = 0; i < max_size; ++i)
+        {
+        TEST_EQ(i < n ? (uint16_t)(indices16[i] & 0xff) : (uint16_t)0xcd, (uint16_t)b[0][i]);
+        TEST_EQ(i < n ? indices16[i] : (uint16_t)0xcdcd, back16[i]);
+        }
+
+      memset(planes.data(), 0xcd, planes.size());
+      std::fill(indices32_back.begin(), indices32_back.end(), 0xcdcdcdcd);
+      trico_transpose_uint32_aos_to_soa(&b[0], &b[1], &b[2], &b[3], indices32.data(), n);
+      trico_transpose_uint32_soa_to_aos(&back32, b[0], b[1], b[2], b[3], n);
+      for (uint32_t i = 0; i < max_size; ++i)
+        {
+        TEST_EQ(i < n ? (indices32[i] >> 24) : 0xcd, (uint32_t)b[3][i]);
+        TEST_EQ(i < n ? indices32[i] : 0xcdcdcdcd, back32[i]);
+        }
+
+      memset(planes.data(), 0xcd, planes.size());
+      std::fill(indices64_back.begin(), indices64_back.end(), 0xcdcdcdcdcdcdcdcdull);
+      trico_transpose_uint64_aos_to_soa(&b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7], indices64.data(), n);
+      trico_transpose_uint64_soa_to_aos(&back64, b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], n);
+      for (uint32_t i = 0; i < max_size; ++i)
+        {
+        TEST_EQ(i < n ? (indices64[i] >> 56) : 0xcd, (uint64_t)b[7][i]);
+        TEST_EQ(i < n ? indices64[i] : 0xcdcdcdcdcdcdcdcdull, back64[i]);
+        }
+      }
+    }
+  trico_set_transpose_instruction_set(default_instruction_set);
+  }
+
 void compress_triangles_lz4(const char* filename)
   {
   uint32_t nr_of_vertices;
@@ -186,11 +363,287 @@ void compress_triangles_lz4_no_shuffling(const char* filename)
   trico_free(triangles);
   }
 
+void entropy_coding(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* context = trico_create_context();
+  const uint32_t nr_of_indices = nr_of_triangles * 3;
+  std::vector<uint8_t> plane(nr_of_indices);
+  std::vector<uint8_t> compressed(trico_compress_byte_plane_bound(nr_of_indices));
+  std::vector<uint8_t> lz4_compressed(LZ4_compressBound(nr_of_indices));
+  std::vector<uint8_t> decompressed(nr_of_indices + 1, 0xab);
+  for (int b = 0; b < 4; ++b)
+    {
+    for (uint32_t i = 0; i < nr_of_indices; ++i)
+      plane[i] = (uint8_t)(triangles[i] >> (8 * b));
+
+    const uint32_t nr_of_entropy_coded_bytes = trico_entropy_compress_into(compressed.data(), plane.data(), nr_of_indices);
+    TEST_ASSERT(nr_of_entropy_coded_bytes <= trico_entropy_compress_bound(nr_of_indices));
+    TEST_EQ(nr_of_indices, trico_get_number_of_entropy_coded_bytes(compressed.data()));
+    tic();
+    TEST_EQ(1, trico_entropy_decompress_into(decompressed.data(), compressed.data(), nr_of_entropy_coded_bytes));
+    toc(("rans decoding of byte plane " + std::to_string(b) + ": ").c_str());
+    TEST_ASSERT(memcmp(plane.data(), decompressed.data(), nr_of_indices) == 0);
+    TEST_EQ(0xab, decompressed[nr_of_indices]);
+    TEST_EQ(0, trico_entropy_decompress_into(decompressed.data(), compressed.data(), nr_of_entropy_coded_bytes - 1));
+
+    const int nr_of_lz4_bytes = LZ4_compress_default((const char*)plane.data(), (char*)lz4_compressed.data(), nr_of_indices, (int)lz4_compressed.size());
+    const uint32_t nr_of_compressed_bytes = trico_compress_byte_plane_into_with_context(context, compressed.data(), plane.data(), nr_of_indices, 0);
+    std::cout << "byte plane " << b << ": lz4 " << nr_of_lz4_bytes << " bytes, rans " << nr_of_entropy_coded_bytes << " bytes, best method " << (int)compressed[0] << " " << nr_of_compressed_bytes << " bytes\n";
+    TEST_ASSERT(nr_of_compressed_bytes <= 1 + (uint32_t)nr_of_lz4_bytes && nr_of_compressed_bytes <= 1 + nr_of_entropy_coded_bytes);
+    TEST_EQ(1, trico_decompress_byte_plane_into_with_context(context, decompressed.data(), nr_of_indices, compressed.data(), nr_of_compressed_bytes));
+    TEST_ASSERT(memcmp(plane.data(), decompressed.data(), nr_of_indices) == 0);
+    TEST_EQ(0, trico_decompress_byte_plane_into_with_context(context, decompressed.data(), nr_of_indices - 1, compressed.data(), nr_of_compressed_bytes));
+    }
+
+  // empty data, a single value, a run of equal bytes, and random bytes, which are stored
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < nr_of_indices; ++i)
+    {
+    seed = seed * 1664525 + 1013904223;
+    plane[i] = (uint8_t)(seed >> 24);
+    }
+  const std::vector<uint8_t> equal_bytes(1000, 7);
+  const uint8_t* inputs[] = { plane.data(), plane.data(), equal_bytes.data(), plane.data() };
+  const uint32_t sizes[] = { 0, 1, (uint32_t)equal_bytes.size(), nr_of_indices };
+  for (int k = 0; k < 4; ++k)
+    {
+    const uint32_t nr_of_entropy_coded_bytes = trico_entropy_compress_into(compressed.data(), inputs[k], sizes[k]);
+    TEST_ASSERT(nr_of_entropy_coded_bytes <= trico_entropy_compress_bound(sizes[k]));
+    TEST_EQ(1, trico_entropy_decompress_into(decompressed.data(), compressed.data(), nr_of_entropy_coded_bytes));
+    TEST_ASSERT(sizes[k] == 0 || memcmp(inputs[k], decompressed.data(), sizes[k]) == 0);
+    const uint32_t nr_of_compressed_bytes = trico_compress_byte_plane_into_with_context(context, compressed.data(), inputs[k], sizes[k], 0);
+    TEST_ASSERT(nr_of_compressed_bytes > 0 && nr_of_compressed_bytes <= trico_compress_byte_plane_bound(sizes[k]));
+    TEST_EQ(1, trico_decompress_byte_plane_into_with_context(context, decompressed.data(), sizes[k], compressed.data(), nr_of_compressed_bytes));
+    TEST_ASSERT(sizes[k] == 0 || memcmp(inputs[k], decompressed.data(), sizes[k]) == 0);
+    }
+  TEST_ASSERT(trico_entropy_compress_into(compressed.data(), equal_bytes.data(), (uint32_t)equal_bytes.size()) < 64);
+  TEST_EQ(trico_entropy_compress_bound(nr_of_indices), trico_entropy_compress_into(compressed.data(), plane.data(), nr_of_indices));
+
+  trico_destroy_context(context);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void lz4_levels(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* context = trico_create_context();
+  const uint32_t nr_of_indices = nr_of_triangles * 3;
+  std::vector<uint8_t> plane(nr_of_indices);
+  std::vector<uint8_t> compressed(LZ4_compressBound(nr_of_indices));
+  std::vector<uint8_t> decompressed(nr_of_indices);
+  const int levels[] = { -16, -1, 0, 1, 2, 4, 9, 12, 100 };
+  for (int b = 0; b < 2; ++b)
+    {
+    for (uint32_t i = 0; i < nr_of_indices; ++i)
+      plane[i] = (uint8_t)(triangles[i] >> (8 * b));
+    uint32_t sizes[sizeof(levels) / sizeof(int)];
+    for (size_t l = 0; l < sizeof(levels) / sizeof(int); ++l)
+      {
+      tic();
+      sizes[l] = trico_lz4_compress_into_with_context(context, compressed.data(), plane.data(), nr_of_indices, levels[l]);
+      toc(("lz4 level " + std::to_string(levels[l]) + " of byte plane " + std::to_string(b) + ": " + std::to_string(sizes[l]) + " bytes, ").c_str());
+      TEST_ASSERT(sizes[l] > 0 && sizes[l] <= (uint32_t)LZ4_compressBound(nr_of_indices));
+      TEST_EQ((int)nr_of_indices, LZ4_decompress_safe((const char*)compressed.data(), (char*)decompressed.data(), (int)sizes[l], (int)nr_of_indices));
+      TEST_ASSERT(memcmp(plane.data(), decompressed.data(), nr_of_indices) == 0);
+      }
+    TEST_ASSERT(sizes[0] >= sizes[2]); // acceleration 16
+    TEST_ASSERT(sizes[6] < sizes[2]); // level 9
+    TEST_ASSERT(sizes[7] < sizes[6]); // level 12 parses optimally
+    TEST_EQ(sizes[7], sizes[8]); // levels are capped at TRICO_LZ4_MAX_LEVEL
+    }
+
+  // short inputs around the minimum sizes of the lz4 block format, runs of equal bytes, and random bytes
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < nr_of_indices; ++i)
+    {
+    seed = seed * 1664525 + 1013904223;
+    plane[i] = (i % 1000 < 500) ? (uint8_t)(seed >> 24) : (uint8_t)(i % 7);
+    }
+  for (uint32_t size = 0; size < 40; ++size)
+    {
+    for (int level = 1; level <= TRICO_LZ4_MAX_LEVEL; level += 11)
+      {
+      const uint32_t nr_of_compressed_bytes = trico_lz4_compress_into_with_context(context, compressed.data(), plane.data() + 490, size, level);
+      TEST_ASSERT(nr_of_compressed_bytes > 0 && nr_of_compressed_bytes <= (uint32_t)LZ4_compressBound(size));
+      TEST_EQ((int)size, LZ4_decompress_safe((const char*)compressed.data(), (char*)decompressed.data(), (int)nr_of_compressed_bytes, (int)size));
+      TEST_ASSERT(size == 0 || memcmp(plane.data() + 490, decompressed.data(), size) == 0);
+      }
+    }
+  const uint32_t nr_of_compressed_bytes = trico_lz4_compress_into_with_context(context, compressed.data(), plane.data(), nr_of_indices, 9);
+  TEST_EQ((int)nr_of_indices, LZ4_decompress_safe((const char*)compressed.data(), (char*)decompressed.data(), (int)nr_of_compressed_bytes, (int)nr_of_indices));
+  TEST_ASSERT(memcmp(plane.data(), decompressed.data(), nr_of_indices) == 0);
+
+  trico_destroy_context(context);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void compress_triangles(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* context = trico_create_context();
+  const uint64_t bound = trico_compress_triangles_bound(nr_of_triangles);
+  uint8_t* compressed = (uint8_t*)trico_malloc(bound);
+  std::vector<uint32_t> decompressed(nr_of_triangles * 3 + 1, 0xdeadbeef);
+  // index use_connectivity + 2 * use_entropy_coding
+  uint32_t nr_of_compressed_bytes[4];
+  for (int mode = 0; mode < 4; ++mode)
+    {
+    nr_of_compressed_bytes[mode] = trico_compress_triangles_into_with_context(context, compressed, triangles, nr_of_triangles, mode & 1, mode >> 1, 0);
+    TEST_ASSERT(nr_of_compressed_bytes[mode] > 0 && nr_of_compressed_bytes[mode] <= bound);
+    TEST_EQ(nr_of_triangles, trico_get_number_of_compressed_triangles(compressed));
+    TEST_EQ(1, trico_decompress_triangles_into_with_context(context, decompressed.data(), compressed, nr_of_compressed_bytes[mode]));
+    TEST_ASSERT(memcmp(triangles, decompressed.data(), nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+    TEST_EQ(0xdeadbeef, decompressed[nr_of_triangles * 3]);
+    TEST_EQ(0, trico_decompress_triangles_into_with_context(context, decompressed.data(), compressed, nr_of_compressed_bytes[mode] - 1));
+    TEST_EQ(0, trico_decompress_triangles_into_with_context(context, decompressed.data(), compressed, 4));
+    }
+  TEST_ASSERT(nr_of_compressed_bytes[2] < nr_of_compressed_bytes[0]);
+  TEST_ASSERT(nr_of_compressed_bytes[3] < nr_of_compressed_bytes[1]);
+
+  // both should beat the byte planes of the plain indices, and the shared edges should help
+  uint8_t* compressed_planes = (uint8_t*)trico_malloc(LZ4_compressBound(nr_of_triangles * 3) * 4);
+  uint8_t* plane = (uint8_t*)trico_malloc(nr_of_triangles * 3);
+  int nr_of_plane_bytes = 0;
+  for (int b = 0; b < 4; ++b)
+    {
+    for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+      plane[i] = (uint8_t)(triangles[i] >> (8 * b));
+    nr_of_plane_bytes += LZ4_compress_default((const char*)plane, (char*)compressed_planes, nr_of_triangles * 3, LZ4_compressBound(nr_of_triangles * 3) * 4);
+    }
+  TEST_ASSERT(nr_of_compressed_bytes[0] < (uint32_t)nr_of_plane_bytes);
+  TEST_ASSERT(nr_of_compressed_bytes[1] < nr_of_compressed_bytes[0]);
+  trico_free(plane);
+  trico_free(compressed_planes);
+
+  // no triangles, a shared edge, an edge shared in the same direction, a degenerate triangle, and indices that are not in order
+  const uint32_t small_triangles[] = { 0, 1, 2, 2, 1, 3, 1, 2, 4, 5, 5, 5, 9, 3, 1, 3, 9, 7, 0, 0, 1 };
+  for (uint32_t t = 0; t <= 7; ++t)
+    {
+    for (int mode = 0; mode < 4; ++mode)
+      {
+      std::vector<uint8_t> small_compressed(trico_compress_triangles_bound(t));
+      const uint32_t small_nr_of_compressed_bytes = trico_compress_triangles_into_with_context(context, small_compressed.data(), small_triangles, t, mode & 1, mode >> 1, 0);
+      TEST_ASSERT(small_nr_of_compressed_bytes > 0 && small_nr_of_compressed_bytes <= small_compressed.size());
+      std::vector<uint32_t> small_decompressed(t * 3 + 1);
+      TEST_EQ(1, trico_decompress_triangles_into_with_context(context, small_decompressed.data(), small_compressed.data(), small_nr_of_compressed_bytes));
+      TEST_ASSERT(t == 0 || memcmp(small_triangles, small_decompressed.data(), t * 3 * sizeof(uint32_t)) == 0);
+      }
+    }
+
+  // the largest index is coded without connectivity, as the shared edges cannot be found for that many vertices
+  const uint32_t large_triangles[] = { 0, 1, 2, 2, 1, 0xffffffff };
+  std::vector<uint8_t> large_compressed(trico_compress_triangles_bound(2));
+  const uint32_t large_nr_of_compressed_bytes = trico_compress_triangles_into_with_context(context, large_compressed.data(), large_triangles, 2, 1, 0, 0);
+  TEST_ASSERT(large_nr_of_compressed_bytes > 0);
+  std::vector<uint32_t> large_decompressed(6);
+  TEST_EQ(1, trico_decompress_triangles_into_with_context(context, large_decompressed.data(), large_compressed.data(), large_nr_of_compressed_bytes));
+  TEST_ASSERT(memcmp(large_triangles, large_decompressed.data(), sizeof(large_triangles)) == 0);
+
+  trico_free(compressed);
+  trico_destroy_context(context);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void reorder_triangles(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* context = trico_create_context();
+  std::vector<uint32_t> triangle_order(nr_of_triangles);
+  tic();
+  TEST_EQ(1, trico_optimize_triangle_order(context, triangle_order.data(), triangles, nr_of_triangles, nr_of_vertices, 16));
+  toc("Triangle order optimization time: ");
+  std::vector<uint32_t> sorted_order(triangle_order);
+  std::sort(sorted_order.begin(), sorted_order.end());
+  for (uint32_t t = 0; t < nr_of_triangles; ++t)
+    TEST_EQ(t, sorted_order[t]);
+
+  std::vector<uint32_t> reordered_triangles(nr_of_triangles * 3);
+  trico_gather_elements(reordered_triangles.data(), triangles, 3 * sizeof(uint32_t), triangle_order.data(), nr_of_triangles);
+  std::vector<uint32_t> original_indices(nr_of_vertices);
+  TEST_EQ(1, trico_renumber_vertices(context, original_indices.data(), reordered_triangles.data(), nr_of_triangles, nr_of_vertices));
+  std::vector<float> reordered_vertices(nr_of_vertices * 3);
+  trico_gather_elements(reordered_vertices.data(), vertices, 3 * sizeof(float), original_indices.data(), nr_of_vertices);
+
+  // the same triangles, with the same corner order
+  for (uint32_t c = 0; c < nr_of_triangles * 3; ++c)
+    {
+    const uint32_t original_corner = triangle_order[c / 3] * 3 + c % 3;
+    TEST_ASSERT(memcmp(vertices + triangles[original_corner] * 3, reordered_vertices.data() + reordered_triangles[c] * 3, 3 * sizeof(float)) == 0);
+    }
+  std::vector<float> restored_vertices(nr_of_vertices * 3);
+  trico_scatter_elements(restored_vertices.data(), reordered_vertices.data(), 3 * sizeof(float), original_indices.data(), nr_of_vertices);
+  TEST_ASSERT(memcmp(vertices, restored_vertices.data(), nr_of_vertices * 3 * sizeof(float)) == 0);
+
+  const double original_ratio = average_cache_miss_ratio(triangles, nr_of_triangles, 16);
+  const double reordered_ratio = average_cache_miss_ratio(reordered_triangles.data(), nr_of_triangles, 16);
+  std::cout << "Average cache miss ratio: " << original_ratio << ", after reordering: " << reordered_ratio << "\n";
+  TEST_ASSERT(reordered_ratio < 0.8);
+  TEST_ASSERT(reordered_ratio < original_ratio);
+
+  std::vector<uint8_t> compressed(trico_compress_triangles_bound(nr_of_triangles));
+  const uint32_t original_size = trico_compress_triangles_into_with_context(context, compressed.data(), triangles, nr_of_triangles, 1, 0, 0);
+  const uint32_t reordered_size = trico_compress_triangles_into_with_context(context, compressed.data(), reordered_triangles.data(), nr_of_triangles, 1, 0, 0);
+  TEST_ASSERT(reordered_size < original_size);
+
+  // an unused vertex goes last, an invalid index leaves the triangles as they are
+  uint32_t small_triangles[] = { 3, 1, 2, 2, 1, 0, 0, 1, 3 };
+  uint32_t small_order[3];
+  uint32_t small_original_indices[5];
+  TEST_EQ(1, trico_optimize_triangle_order(context, small_order, small_triangles, 0, 5, 16));
+  TEST_EQ(1, trico_optimize_triangle_order(context, small_order, small_triangles, 3, 5, 16));
+  TEST_EQ(1, trico_renumber_vertices(context, small_original_indices, small_triangles, 3, 5));
+  const uint32_t expected_triangles[] = { 0, 1, 2, 2, 1, 3, 3, 1, 0 };
+  const uint32_t expected_original_indices[] = { 3, 1, 2, 0, 4 };
+  TEST_ASSERT(memcmp(small_triangles, expected_triangles, sizeof(small_triangles)) == 0);
+  TEST_ASSERT(memcmp(small_original_indices, expected_original_indices, sizeof(small_original_indices)) == 0);
+  TEST_EQ(0, trico_renumber_vertices(context, small_original_indices, small_triangles, 3, 3));
+  TEST_EQ(0, trico_optimize_triangle_order(context, small_order, small_triangles, 3, 3, 16));
+  TEST_ASSERT(memcmp(small_triangles, expected_triangles, sizeof(small_triangles)) == 0);
+
+  trico_destroy_context(context);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
 void test_int_compression(const char* filename)
   {
   transpose_uint32_aos_to_soa(filename);
+  transpose_uint64_aos_to_soa(filename);
+  transpose_uint_tails();
   compress_triangles_lz4(filename);
   compress_triangles_lz4_no_shuffling(filename);
+  entropy_coding(filename);
+  lz4_levels(filename);
+  compress_triangles(filename);
+  reorder_triangles(filename);
   }
 
 
@@ -2,14 +2,19 @@
 #include "test_assert.h"
 
 #include <trico/alloc.h>
+#include <trico/arena.h>
+#include <trico/parallel.h>
 #include <trico/trico.h>
 
+#include <trico_io/ioply.h>
 #include <trico_io/iostl.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
 #include <cstring>
+#include <vector>
 
 void test_header()
   {
@@ -107,6 +112,380 @@ void test_stl(const char* filename)
   }
 
 
+void test_stl_welding(const char* filename)
+  {
+  // welding is lossless: the welded mesh is written back to the same file
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+  float* normals;
+  uint16_t* attributes;
+  TEST_EQ(1, trico_read_stl_full(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, &normals, &attributes, filename));
+  TEST_ASSERT(nr_of_vertices < nr_of_triangles);
+  uint32_t next = 0;
+  for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+    {
+    TEST_ASSERT(triangles[i] <= next); // vertices are numbered in order of first occurrence
+    if (triangles[i] == next)
+      ++next;
+    }
+  TEST_EQ(nr_of_vertices, next);
+  TEST_EQ(1, trico_write_stl(vertices, triangles, nr_of_triangles, normals, attributes, "stlwelding.stl"));
+  std::ifstream original(filename, std::ios::binary);
+  std::ifstream written("stlwelding.stl", std::ios::binary);
+  std::vector<char> original_bytes((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>());
+  std::vector<char> written_bytes((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+  TEST_EQ(original_bytes.size(), written_bytes.size());
+  TEST_ASSERT(memcmp(original_bytes.data() + 84, written_bytes.data() + 84, original_bytes.size() - 84) == 0);
+  trico_free(vertices);
+  trico_free(triangles);
+  trico_free(normals);
+  trico_free(attributes);
+
+  // a large fan around one vertex, with sorted outer vertices, and corners that differ only in the sign of zero
+  const uint32_t fan_size = 100000;
+  std::vector<float> fan_vertices(3 * (fan_size + 2), 0.f);
+  std::vector<uint32_t> fan_triangles(3 * fan_size);
+  for (uint32_t i = 1; i < fan_size + 2; ++i)
+    fan_vertices[3 * i] = (float)i;
+  fan_vertices[3 * (fan_size + 1)] = 0.f;
+  fan_vertices[3 * (fan_size + 1) + 1] = -0.f;
+  for (uint32_t t = 0; t < fan_size; ++t)
+    {
+    fan_triangles[3 * t] = 0;
+    fan_triangles[3 * t + 1] = t + 1;
+    fan_triangles[3 * t + 2] = t + 2;
+    }
+  TEST_EQ(1, trico_write_stl(fan_vertices.data(), fan_triangles.data(), fan_size, nullptr, nullptr, "stlwelding.stl"));
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, "stlwelding.stl"));
+  TEST_EQ(fan_size, nr_of_triangles);
+  TEST_EQ(fan_size + 2, nr_of_vertices);
+  TEST_ASSERT(memcmp(fan_vertices.data(), vertices, fan_vertices.size() * sizeof(float)) == 0);
+  TEST_ASSERT(memcmp(fan_triangles.data(), triangles, fan_triangles.size() * sizeof(uint32_t)) == 0);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_stl_validation(const char* filename)
+  {
+  std::ifstream original(filename, std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(original)), std::istreambuf_iterator<char>());
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+  // a binary file with "solid" in its header is read by its size
+  memcpy(bytes.data(), "solid", 5);
+  std::ofstream("stlvalidation.stl", std::ios::binary).write(bytes.data(), bytes.size());
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, "stlvalidation.stl"));
+  TEST_EQ((bytes.size() - 84) / 50, (size_t)nr_of_triangles);
+  trico_free(vertices);
+  trico_free(triangles);
+  // a truncated file
+  std::ofstream("stlvalidation.stl", std::ios::binary).write(bytes.data(), bytes.size() - 1);
+  TEST_EQ(0, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, "stlvalidation.stl"));
+  TEST_ASSERT(vertices == nullptr);
+  TEST_ASSERT(triangles == nullptr);
+  // a header that claims more triangles than the file holds
+  const uint32_t too_many = 0xffffffff;
+  memcpy(bytes.data() + 80, &too_many, sizeof(uint32_t));
+  std::ofstream("stlvalidation.stl", std::ios::binary).write(bytes.data(), bytes.size());
+  TEST_EQ(0, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, "stlvalidation.stl"));
+  std::ofstream("stlvalidation.stl", std::ios::binary).write(bytes.data(), 40);
+  TEST_EQ(0, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, "stlvalidation.stl"));
+  TEST_EQ(0, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, "does_not_exist.stl"));
+  }
+
+static void write_ascii_facet(std::ofstream& out, const char* format, const float* normal, const float* corners)
+  {
+  char buffer[256];
+  out << "  facet normal";
+  for (int i = 0; i < 3; ++i)
+    {
+    snprintf(buffer, sizeof(buffer), format, normal[i]);
+    out << " " << buffer;
+    }
+  out << "\n    outer loop\n";
+  for (int corner = 0; corner < 3; ++corner)
+    {
+    out << "\tvertex";
+    for (int i = 0; i < 3; ++i)
+      {
+      snprintf(buffer, sizeof(buffer), format, corners[3 * corner + i]);
+      out << " " << buffer;
+      }
+    out << "\r\n";
+    }
+  out << "    endloop\n  endfacet\n";
+  }
+
+void test_ascii_stl(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+  float* normals;
+  uint16_t* attributes;
+  TEST_EQ(1, trico_read_stl_full(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, &normals, &attributes, filename));
+  // 9 significant digits print floats exactly, so the ascii file gives the same mesh, over many parallel chunks
+  {
+  std::ofstream out("asciistl.stl", std::ios::binary);
+  out << "solid bunny\n";
+  for (uint32_t t = 0; t < nr_of_triangles; ++t)
+    {
+    float corners[9];
+    for (int corner = 0; corner < 3; ++corner)
+      memcpy(corners + 3 * corner, vertices + 3 * triangles[3 * t + corner], 3 * sizeof(float));
+    write_ascii_facet(out, "%.9g", normals + 3 * t, corners);
+    }
+  out << "endsolid bunny\n";
+  }
+  uint32_t nr_of_ascii_vertices;
+  float* ascii_vertices;
+  uint32_t nr_of_ascii_triangles;
+  uint32_t* ascii_triangles;
+  float* ascii_normals;
+  uint16_t* ascii_attributes;
+  TEST_EQ(1, trico_read_stl_full(&nr_of_ascii_vertices, &ascii_vertices, &nr_of_ascii_triangles, &ascii_triangles, &ascii_normals, &ascii_attributes, "asciistl.stl"));
+  TEST_EQ(nr_of_triangles, nr_of_ascii_triangles);
+  TEST_EQ(nr_of_vertices, nr_of_ascii_vertices);
+  TEST_ASSERT(memcmp(vertices, ascii_vertices, 3 * (size_t)nr_of_vertices * sizeof(float)) == 0);
+  TEST_ASSERT(memcmp(triangles, ascii_triangles, 3 * (size_t)nr_of_triangles * sizeof(uint32_t)) == 0);
+  TEST_ASSERT(memcmp(normals, ascii_normals, 3 * (size_t)nr_of_triangles * sizeof(float)) == 0);
+  for (uint32_t t = 0; t < nr_of_triangles; ++t)
+    TEST_EQ(0, (int)ascii_attributes[t]);
+  trico_free(vertices);
+  trico_free(triangles);
+  trico_free(normals);
+  trico_free(attributes);
+  trico_free(ascii_vertices);
+  trico_free(ascii_triangles);
+  trico_free(ascii_normals);
+  trico_free(ascii_attributes);
+
+  // random floats in formats that take the fast and the slow paths of the float parser round like strtof
+  const char* formats[] = { "%.9g", "%.17g", "%.40g", "%.3e", "%.20f", "%a" };
+  std::vector<float> expected;
+  {
+  std::ofstream out("asciistl.stl", std::ios::binary);
+  out << "solid random\n";
+  uint32_t state = 0x9e3779b9;
+  const float normal[3] = { 0.f, 0.f, 1.f };
+  for (uint32_t t = 0; t < 6000; ++t)
+    {
+    float corners[9];
+    for (int i = 0; i < 9; ++i)
+      {
+      do
+        {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        memcpy(&corners[i], &state, sizeof(float));
+        } while (corners[i] != corners[i] || corners[i] - corners[i] != 0.f); // no nan or inf
+      if (t % 3 == 0)
+        corners[i] = (float)(state % 2000000) / 1000.f - 1000.f;
+      }
+    const char* format = formats[t % 6];
+    write_ascii_facet(out, format, normal, corners);
+    for (int i = 0; i < 9; ++i)
+      {
+      char buffer[256];
+      snprintf(buffer, sizeof(buffer), format, corners[i]);
+      expected.push_back(strtof(buffer, nullptr));
+      }
+    }
+  out << "endsolid random";
+  }
+  TEST_EQ(1, trico_read_stl(&nr_of_ascii_vertices, &ascii_vertices, &nr_of_ascii_triangles, &ascii_triangles, "asciistl.stl"));
+  TEST_EQ((uint32_t)expected.size() / 9, nr_of_ascii_triangles);
+  for (size_t c = 0; c < expected.size() / 3; ++c)
+    TEST_ASSERT(memcmp(ascii_vertices + 3 * ascii_triangles[c], expected.data() + 3 * c, 3 * sizeof(float)) == 0);
+  trico_free(ascii_vertices);
+  trico_free(ascii_triangles);
+
+  // syntax errors
+  std::ofstream("asciistl.stl", std::ios::binary) << "solid broken\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\nendloop\nendfacet\nendsolid broken\n";
+  TEST_EQ(0, trico_read_stl(&nr_of_ascii_vertices, &ascii_vertices, &nr_of_ascii_triangles, &ascii_triangles, "asciistl.stl"));
+  std::ofstream("asciistl.stl", std::ios::binary) << "solid broken\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\nvertex 1 1.0.0 0\nendloop\nendfacet\nendsolid broken\n";
+  TEST_EQ(0, trico_read_stl(&nr_of_ascii_vertices, &ascii_vertices, &nr_of_ascii_triangles, &ascii_triangles, "asciistl.stl"));
+  }
+
+struct ply_mesh
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  float* vertex_normals;
+  uint32_t* vertex_colors;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+  float* texcoords;
+  };
+
+static int read_ply_mesh(ply_mesh& mesh, const char* filename)
+  {
+  return trico_read_ply(&mesh.nr_of_vertices, &mesh.vertices, &mesh.vertex_normals, &mesh.vertex_colors, &mesh.nr_of_triangles, &mesh.triangles, &mesh.texcoords, filename);
+  }
+
+static void free_ply_mesh(ply_mesh& mesh)
+  {
+  trico_free(mesh.vertices);
+  trico_free(mesh.vertex_normals);
+  trico_free(mesh.vertex_colors);
+  trico_free(mesh.triangles);
+  trico_free(mesh.texcoords);
+  }
+
+template <class T>
+static void write_big_endian(std::ofstream& out, T value)
+  {
+  char bytes[sizeof(T)];
+  memcpy(bytes, &value, sizeof(T));
+  int n = 1;
+  if (*(char*)&n == 1)
+    std::reverse(bytes, bytes + sizeof(T));
+  out.write(bytes, sizeof(T));
+  }
+
+void test_ply(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+  std::vector<float> normals(3 * (size_t)nr_of_vertices);
+  std::vector<uint32_t> colors(nr_of_vertices);
+  std::vector<float> texcoords(6 * (size_t)nr_of_triangles);
+  for (uint32_t v = 0; v < nr_of_vertices; ++v)
+    {
+    for (int i = 0; i < 3; ++i)
+      normals[3 * v + i] = (float)((v + i) % 17) * 0.125f - 1.f;
+    colors[v] = v * 2654435761u;
+    }
+  for (size_t i = 0; i < texcoords.size(); ++i)
+    texcoords[i] = (float)(i % 1000) / 1024.f;
+
+  // the binary file that trico_write_ply writes is read back exactly
+  TEST_EQ(1, trico_write_ply(nr_of_vertices, vertices, normals.data(), colors.data(), nr_of_triangles, triangles, texcoords.data(), "plytest.ply"));
+  ply_mesh mesh;
+  TEST_EQ(1, read_ply_mesh(mesh, "plytest.ply"));
+  TEST_EQ(nr_of_vertices, mesh.nr_of_vertices);
+  TEST_EQ(nr_of_triangles, mesh.nr_of_triangles);
+  TEST_ASSERT(memcmp(vertices, mesh.vertices, 3 * (size_t)nr_of_vertices * sizeof(float)) == 0);
+  TEST_ASSERT(memcmp(normals.data(), mesh.vertex_normals, normals.size() * sizeof(float)) == 0);
+  TEST_ASSERT(memcmp(colors.data(), mesh.vertex_colors, colors.size() * sizeof(uint32_t)) == 0);
+  TEST_ASSERT(memcmp(triangles, mesh.triangles, 3 * (size_t)nr_of_triangles * sizeof(uint32_t)) == 0);
+  TEST_ASSERT(memcmp(texcoords.data(), mesh.texcoords, texcoords.size() * sizeof(float)) == 0);
+  free_ply_mesh(mesh);
+
+  // a big endian file with other types, extra properties and elements, and faces that are not triangles is read as rply
+  // reads the same data in ascii
+  const uint32_t nr_of_ascii_triangles = 1000;
+  {
+  std::ofstream binary("plytest.ply", std::ios::binary);
+  std::ofstream ascii("plytest_ascii.ply", std::ios::binary);
+  const char* header[2] = { "ply\nformat binary_big_endian 1.0\n", "ply\nformat ascii 1.0\n" };
+  for (int f = 0; f < 2; ++f)
+    {
+    std::ofstream& out = f ? ascii : binary;
+    out << header[f] << "comment written by test_ply\n";
+    out << "element vertex " << nr_of_vertices << "\nproperty double x\nproperty double y\nproperty double z\nproperty int flags\nproperty float nx\nproperty float ny\nproperty float nz\n";
+    out << "property uchar r\nproperty int green\nproperty uchar diffuse_blue\n";
+    out << "element edge 2\nproperty list uchar int vertex_indices\nproperty short weight\n";
+    out << "element face " << nr_of_ascii_triangles << "\nproperty uchar flags\nproperty list uint int vertex_index\nproperty list uchar float texcoord\n";
+    out << "end_header\n";
+    }
+  char buffer[256];
+  for (uint32_t v = 0; v < nr_of_vertices; ++v)
+    {
+    for (int i = 0; i < 3; ++i)
+      {
+      write_big_endian(binary, (double)vertices[3 * v + i]);
+      snprintf(buffer, sizeof(buffer), "%.17g ", (double)vertices[3 * v + i]);
+      ascii << buffer;
+      }
+    write_big_endian(binary, (int32_t)v - 5);
+    ascii << (int32_t)v - 5;
+    for (int i = 0; i < 3; ++i)
+      {
+      write_big_endian(binary, normals[3 * v + i]);
+      snprintf(buffer, sizeof(buffer), " %.9g", normals[3 * v + i]);
+      ascii << buffer;
+      }
+    write_big_endian(binary, (uint8_t)(colors[v] & 255));
+    write_big_endian(binary, (int32_t)((colors[v] >> 8) & 255));
+    write_big_endian(binary, (uint8_t)(colors[v] >> 16));
+    ascii << " " << (colors[v] & 255) << " " << ((colors[v] >> 8) & 255) << " " << ((colors[v] >> 16) & 255) << "\n";
+    }
+  for (int e = 0; e < 2; ++e)
+    {
+    write_big_endian(binary, (uint8_t)2);
+    write_big_endian(binary, (int32_t)e);
+    write_big_endian(binary, (int32_t)(e + 1));
+    write_big_endian(binary, (int16_t)-e);
+    ascii << "2 " << e << " " << e + 1 << " " << -e << "\n";
+    }
+  for (uint32_t t = 0; t < nr_of_ascii_triangles; ++t)
+    {
+    const uint32_t nr_of_indices = t % 5 == 4 ? 4 : 3;
+    const uint32_t nr_of_texcoords = t % 4 == 0 ? 6 : (t % 4 == 1 ? 4 : (t % 4 == 2 ? 8 : 0));
+    write_big_endian(binary, (uint8_t)t);
+    write_big_endian(binary, nr_of_indices);
+    ascii << (t & 255) << " " << nr_of_indices;
+    for (uint32_t i = 0; i < nr_of_indices; ++i)
+      {
+      write_big_endian(binary, (int32_t)triangles[3 * t + i % 3]);
+      ascii << " " << triangles[3 * t + i % 3];
+      }
+    write_big_endian(binary, (uint8_t)nr_of_texcoords);
+    ascii << " " << nr_of_texcoords;
+    for (uint32_t i = 0; i < nr_of_texcoords; ++i)
+      {
+      write_big_endian(binary, texcoords[6 * t + i % 6]);
+      snprintf(buffer, sizeof(buffer), " %.9g", texcoords[6 * t + i % 6]);
+      ascii << buffer;
+      }
+    ascii << "\n";
+    }
+  }
+  ply_mesh ascii_mesh;
+  TEST_EQ(1, read_ply_mesh(mesh, "plytest.ply"));
+  TEST_EQ(1, read_ply_mesh(ascii_mesh, "plytest_ascii.ply"));
+  TEST_EQ(nr_of_vertices, mesh.nr_of_vertices);
+  TEST_EQ(nr_of_ascii_triangles, mesh.nr_of_triangles);
+  TEST_EQ(ascii_mesh.nr_of_vertices, mesh.nr_of_vertices);
+  TEST_EQ(ascii_mesh.nr_of_triangles, mesh.nr_of_triangles);
+  TEST_ASSERT(memcmp(vertices, mesh.vertices, 3 * (size_t)nr_of_vertices * sizeof(float)) == 0);
+  TEST_ASSERT(memcmp(ascii_mesh.vertices, mesh.vertices, 3 * (size_t)nr_of_vertices * sizeof(float)) == 0);
+  TEST_ASSERT(memcmp(ascii_mesh.vertex_normals, mesh.vertex_normals, 3 * (size_t)nr_of_vertices * sizeof(float)) == 0);
+  TEST_ASSERT(memcmp(ascii_mesh.vertex_colors, mesh.vertex_colors, (size_t)nr_of_vertices * sizeof(uint32_t)) == 0);
+  TEST_EQ(colors[7] | 0xff000000, mesh.vertex_colors[7]);
+  TEST_ASSERT(memcmp(ascii_mesh.triangles, mesh.triangles, 3 * (size_t)nr_of_ascii_triangles * sizeof(uint32_t)) == 0);
+  TEST_ASSERT(memcmp(triangles, mesh.triangles, 3 * (size_t)nr_of_ascii_triangles * sizeof(uint32_t)) == 0);
+  TEST_ASSERT(memcmp(ascii_mesh.texcoords, mesh.texcoords, 6 * (size_t)nr_of_ascii_triangles * sizeof(float)) == 0);
+  TEST_EQ(0.f, mesh.texcoords[6 * 1 + 4]); // padded
+  for (int i = 0; i < 6; ++i)
+    {
+    TEST_EQ(0.f, mesh.texcoords[6 * 3 + i]); // an empty list is padded as well
+    TEST_EQ(texcoords[6 * 4 + i], mesh.texcoords[6 * 4 + i]);
+    }
+  free_ply_mesh(mesh);
+  free_ply_mesh(ascii_mesh);
+
+  // a truncated file
+  std::ifstream written("plytest.ply", std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+  std::ofstream("plytest.ply", std::ios::binary).write(bytes.data(), bytes.size() - 1);
+  TEST_EQ(0, read_ply_mesh(mesh, "plytest.ply"));
+  TEST_ASSERT(mesh.vertices == nullptr);
+  TEST_ASSERT(mesh.triangles == nullptr);
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
 void test_stl_double_64(const char* filename)
   {
   uint32_t nr_of_vertices;
@@ -176,10 +555,1305 @@ void test_stl_double_64(const char* filename)
   delete[] data;
   }
 
+void test_stl_multithreaded(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  uint64_t* triangles_long = new uint64_t[nr_of_triangles * 3];
+  for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+    triangles_long[i] = (uint64_t)triangles[i];
+
+  void* arch = trico_open_archive_for_writing(1024 * 1024);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_write_triangles_long(arch, triangles_long, nr_of_triangles));
+
+  uint64_t length = trico_get_size(arch);
+  char* data = new char[length];
+  memcpy(data, trico_get_buffer_pointer(arch), length);
+
+  trico_close_archive(arch);
+
+  const uint32_t threads[] = { 1, 3, 0 };
+  for (uint32_t t = 0; t < sizeof(threads) / sizeof(uint32_t); ++t)
+    {
+    arch = trico_open_archive_for_reading((const uint8_t*)data, length);
+    TEST_EQ(1, trico_get_number_of_threads(arch));
+    trico_set_number_of_threads(arch, threads[t]);
+    TEST_EQ(threads[t], trico_get_number_of_threads(arch));
+
+    float* vertices_read = new float[nr_of_vertices * 3];
+    TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+    for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+      {
+      TEST_EQ(vertices[i], vertices_read[i]);
+      }
+    delete[] vertices_read;
+
+    uint32_t* triangles_read = new uint32_t[nr_of_triangles * 3];
+    TEST_ASSERT(trico_read_triangles(arch, &triangles_read));
+    for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+      {
+      TEST_EQ(triangles[i], triangles_read[i]);
+      }
+    delete[] triangles_read;
+
+    uint64_t* triangles_long_read = new uint64_t[nr_of_triangles * 3];
+    TEST_ASSERT(trico_read_triangles_long(arch, &triangles_long_read));
+    for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+      {
+      TEST_EQ(triangles_long[i], triangles_long_read[i]);
+      }
+    delete[] triangles_long_read;
+
+    TEST_EQ(trico_empty, trico_get_next_stream_type(arch));
+    trico_close_archive(arch);
+    }
+
+  trico_free(vertices);
+  trico_free(triangles);
+
+  delete[] triangles_long;
+  delete[] data;
+  }
+void test_reserve(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* arch = trico_open_archive_for_writing(8);
+  uint64_t maximum_size = trico_get_size(arch) + trico_get_maximum_stream_size(trico_vertex_float_stream, nr_of_vertices) + trico_get_maximum_stream_size(trico_triangle_uint32_stream, nr_of_triangles);
+  TEST_ASSERT(trico_reserve(arch, maximum_size));
+  const uint8_t* buffer = trico_get_buffer_pointer(arch);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  TEST_ASSERT(buffer == trico_get_buffer_pointer(arch));
+  TEST_ASSERT(trico_get_size(arch) <= maximum_size);
+
+  void* arch2 = trico_open_archive_for_writing(8);
+  TEST_ASSERT(trico_write_vertices(arch2, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch2, triangles, nr_of_triangles));
+  TEST_EQ(trico_get_size(arch), trico_get_size(arch2));
+  TEST_EQ(0, memcmp(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch2), trico_get_size(arch)));
+  trico_close_archive(arch2);
+  trico_close_archive(arch);
+
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+namespace
+  {
+  struct sink_data
+    {
+    std::vector<uint8_t> bytes;
+    uint64_t largest_write = 0;
+    };
+
+  int write_to_vector(void* user_data, const uint8_t* data, uint64_t size)
+    {
+    sink_data* sink = (sink_data*)user_data;
+    sink->bytes.insert(sink->bytes.end(), data, data + size);
+    if (size > sink->largest_write)
+      sink->largest_write = size;
+    return 1;
+    }
+  }
+
+void test_sink(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+
+  sink_data sink;
+  void* sink_arch = trico_open_archive_for_writing_to_callback(&write_to_vector, &sink, 1024);
+  TEST_ASSERT(trico_write_vertices(sink_arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(sink_arch, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_flush_archive(sink_arch));
+  TEST_EQ(trico_get_size(arch), trico_get_size(sink_arch));
+  trico_close_archive(sink_arch);
+
+  TEST_EQ(trico_get_size(arch), (uint64_t)sink.bytes.size());
+  TEST_EQ(0, memcmp(trico_get_buffer_pointer(arch), sink.bytes.data(), sink.bytes.size()));
+  TEST_ASSERT(sink.largest_write < (uint64_t)sink.bytes.size() / 2);
+
+  FILE* f = fopen("sinktest.trc", "wb");
+  TEST_ASSERT(f != nullptr);
+  void* file_arch = trico_open_archive_for_writing_to_file(f, 0);
+  TEST_ASSERT(trico_write_vertices(file_arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(file_arch, triangles, nr_of_triangles));
+  trico_close_archive(file_arch);
+  fclose(f);
+
+  std::ifstream infile;
+  infile.open("sinktest.trc", std::ios::binary | std::ios::in);
+  infile.seekg(0, std::ios::end);
+  uint64_t length = (uint64_t)infile.tellg();
+  infile.seekg(0, std::ios::beg);
+  std::vector<char> data(length);
+  infile.read(data.data(), length);
+  infile.close();
+
+  TEST_EQ(trico_get_size(arch), length);
+  TEST_EQ(0, memcmp(trico_get_buffer_pointer(arch), data.data(), length));
+
+  trico_close_archive(arch);
+
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_random_access(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  uint16_t* attributes = new uint16_t[nr_of_triangles];
+  for (uint32_t i = 0; i < nr_of_triangles; ++i)
+    attributes[i] = (uint16_t)(i & 0xff);
+
+  FILE* f = fopen("randomaccess.trc", "wb");
+  TEST_ASSERT(f != nullptr);
+  void* arch = trico_open_archive_for_writing_to_file(f, 1024);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_write_attributes_uint16(arch, attributes, nr_of_triangles));
+  trico_close_archive(arch);
+  fclose(f);
+
+  TEST_ASSERT(trico_open_archive_for_reading_from_file("this_file_does_not_exist.trc") == nullptr);
+
+  arch = trico_open_archive_for_reading_from_file("randomaccess.trc");
+  TEST_ASSERT(arch != nullptr);
+  TEST_EQ(3, trico_get_number_of_streams(arch));
+  TEST_EQ(trico_vertex_float_stream, trico_get_stream_type(arch, 0));
+  TEST_EQ(trico_triangle_uint32_stream, trico_get_stream_type(arch, 1));
+  TEST_EQ(trico_attribute_uint16_stream, trico_get_stream_type(arch, 2));
+  TEST_EQ(trico_empty, trico_get_stream_type(arch, 3));
+  TEST_EQ(nr_of_vertices, trico_get_stream_count(arch, 0));
+  TEST_EQ(nr_of_triangles, trico_get_stream_count(arch, 1));
+  TEST_EQ(nr_of_triangles, trico_get_stream_count(arch, 2));
+  TEST_ASSERT(!trico_seek_stream(arch, 3));
+
+  TEST_ASSERT(trico_seek_stream(arch, 2));
+  uint16_t* attributes_read = new uint16_t[nr_of_triangles];
+  TEST_ASSERT(trico_read_attributes_uint16(arch, &attributes_read));
+  for (uint32_t i = 0; i < nr_of_triangles; ++i)
+    TEST_EQ(attributes[i], attributes_read[i]);
+  delete[] attributes_read;
+  TEST_EQ(trico_empty, trico_get_next_stream_type(arch));
+
+  TEST_ASSERT(trico_seek_stream(arch, 1));
+  uint32_t* triangles_read = new uint32_t[nr_of_triangles * 3];
+  TEST_ASSERT(trico_read_triangles(arch, &triangles_read));
+  for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+    TEST_EQ(triangles[i], triangles_read[i]);
+  delete[] triangles_read;
+
+  TEST_ASSERT(trico_seek_stream(arch, 0));
+  float* vertices_read = new float[nr_of_vertices * 3];
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    TEST_EQ(vertices[i], vertices_read[i]);
+  delete[] vertices_read;
+  TEST_EQ(trico_triangle_uint32_stream, trico_get_next_stream_type(arch));
+
+  trico_close_archive(arch);
+
+  delete[] attributes;
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_parallelogram(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_set_version(arch, 1));
+  trico_set_block_size(arch, 1000);
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_write_vertices_parallelogram(arch, vertices, nr_of_vertices, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_finalize_archive(arch));
+
+  void* arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+  TEST_ASSERT(trico_get_stream_size(arch_read, 1) < trico_get_stream_size(arch_read, 2));
+  TEST_ASSERT(trico_get_stream_size(arch_read, 1) <= trico_get_maximum_stream_size(trico_vertex_float_parallelogram_stream, nr_of_vertices));
+  TEST_EQ(trico_vertex_float_parallelogram_stream, trico_get_stream_type(arch_read, 1));
+  uint32_t* triangles_read = new uint32_t[nr_of_triangles * 3];
+  TEST_ASSERT(trico_read_triangles(arch_read, &triangles_read));
+  TEST_EQ(trico_vertex_float_parallelogram_stream, trico_get_next_stream_type(arch_read));
+  TEST_EQ(nr_of_vertices, trico_get_number_of_vertices(arch_read));
+  float* vertices_read = new float[nr_of_vertices * 3];
+  TEST_ASSERT(!trico_read_vertices(arch_read, &vertices_read));
+  TEST_ASSERT(trico_read_vertices_parallelogram(arch_read, &vertices_read, triangles_read, nr_of_triangles));
+  TEST_ASSERT(memcmp(vertices, vertices_read, nr_of_vertices * 3 * sizeof(float)) == 0);
+  TEST_EQ(trico_vertex_float_stream, trico_get_next_stream_type(arch_read));
+  trico_close_archive(arch_read);
+
+  trico_close_archive(arch);
+
+  // without a directory the stream is skipped by scanning it, which does not need the triangles
+  arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_write_vertices_parallelogram(arch, vertices, nr_of_vertices, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+  TEST_ASSERT(trico_skip_next_stream(arch_read));
+  TEST_ASSERT(trico_read_triangles(arch_read, &triangles_read));
+  TEST_ASSERT(trico_seek_stream(arch_read, 0));
+  TEST_ASSERT(trico_read_vertices_parallelogram(arch_read, &vertices_read, triangles_read, nr_of_triangles));
+  TEST_ASSERT(memcmp(vertices, vertices_read, nr_of_vertices * 3 * sizeof(float)) == 0);
+  trico_close_archive(arch_read);
+  trico_close_archive(arch);
+
+  delete[] vertices_read;
+  delete[] triangles_read;
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_triangle_coding(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  uint32_t* triangles_read = new uint32_t[nr_of_triangles * 3];
+  uint64_t previous_stream_size = 0xffffffffffffffff;
+  const enum trico_triangle_coding codings[] = { trico_triangle_coding_byte_planes, trico_triangle_coding_delta, trico_triangle_coding_connectivity };
+  for (const enum trico_triangle_coding coding : codings)
+    {
+    void* arch = trico_open_archive_for_writing(1024);
+    TEST_ASSERT(trico_set_version(arch, 1));
+    struct trico_encoder_options options;
+    trico_get_encoder_options(arch, &options);
+    options.triangle_coding = coding;
+    trico_set_encoder_options(arch, &options);
+    TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+    TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+    TEST_ASSERT(trico_finalize_archive(arch));
+
+    void* arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+    const enum trico_stream_type type = coding == trico_triangle_coding_byte_planes ? trico_triangle_uint32_stream : trico_triangle_uint32_delta_stream;
+    TEST_EQ(type, trico_get_stream_type(arch_read, 0));
+    TEST_ASSERT(trico_get_stream_size(arch_read, 0) < previous_stream_size);
+    TEST_ASSERT(trico_get_stream_size(arch_read, 0) <= trico_get_maximum_stream_size(type, nr_of_triangles));
+    previous_stream_size = trico_get_stream_size(arch_read, 0);
+    TEST_EQ(nr_of_triangles, trico_get_number_of_triangles(arch_read));
+    TEST_ASSERT(trico_skip_next_stream(arch_read));
+    memset(triangles_read, 0, nr_of_triangles * 3 * sizeof(uint32_t));
+    TEST_ASSERT(trico_read_triangles(arch_read, &triangles_read));
+    TEST_ASSERT(memcmp(triangles, triangles_read, nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+    TEST_EQ(trico_empty, trico_get_next_stream_type(arch_read));
+    trico_close_archive(arch_read);
+
+    // without a directory the stream is skipped by scanning it
+    trico_close_archive(arch);
+    arch = trico_open_archive_for_writing(1024);
+    trico_set_encoder_options(arch, &options);
+    TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+    TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+    arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+    TEST_ASSERT(trico_skip_next_stream(arch_read));
+    TEST_ASSERT(trico_read_triangles(arch_read, &triangles_read));
+    TEST_ASSERT(memcmp(triangles, triangles_read, nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+    trico_close_archive(arch_read);
+    trico_close_archive(arch);
+    }
+
+  delete[] triangles_read;
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_entropy_coding(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  std::vector<double> vertices_double(vertices, vertices + nr_of_vertices * 3);
+  std::vector<uint32_t> colors(nr_of_vertices);
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    colors[i] = 0xff000000 | ((uint32_t)(vertices[3 * i] * 1000.f) & 0xff);
+  std::vector<float> vertices_read(nr_of_vertices * 3);
+  std::vector<double> vertices_double_read(nr_of_vertices * 3);
+  std::vector<uint32_t> triangles_read(nr_of_triangles * 3);
+  std::vector<uint32_t> colors_read(nr_of_vertices);
+  float* p_vertices_read = vertices_read.data();
+  double* p_vertices_double_read = vertices_double_read.data();
+  uint32_t* p_triangles_read = triangles_read.data();
+  uint32_t* p_colors_read = colors_read.data();
+
+  // plain and blocked streams, with a directory and scanned without one
+  const uint32_t block_sizes[] = { 0, 1000 };
+  for (const uint32_t block_size : block_sizes)
+    {
+    for (uint32_t version = 0; version <= 1; ++version)
+      {
+      uint64_t stream_sizes[2][6];
+      for (int entropy_coded = 0; entropy_coded < 2; ++entropy_coded)
+        {
+        void* arch = trico_open_archive_for_writing(1024);
+        TEST_ASSERT(trico_set_version(arch, version));
+        trico_set_block_size(arch, block_size);
+        struct trico_encoder_options options;
+        trico_get_encoder_options(arch, &options);
+        TEST_EQ(trico_entropy_coding_none, options.entropy_coding[trico_vertex_float_stream]);
+        for (uint32_t st = 0; st < TRICO_NUMBER_OF_STREAM_TYPES; ++st)
+          options.entropy_coding[st] = entropy_coded ? trico_entropy_coding_rans : trico_entropy_coding_none;
+        trico_set_encoder_options(arch, &options);
+        uint64_t size = trico_get_size(arch);
+        TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+        stream_sizes[entropy_coded][0] = trico_get_size(arch) - size;
+        size = trico_get_size(arch);
+        TEST_ASSERT(trico_write_vertices_double(arch, vertices_double.data(), nr_of_vertices));
+        stream_sizes[entropy_coded][1] = trico_get_size(arch) - size;
+        size = trico_get_size(arch);
+        TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+        stream_sizes[entropy_coded][2] = trico_get_size(arch) - size;
+        size = trico_get_size(arch);
+        TEST_ASSERT(trico_write_vertices_parallelogram(arch, vertices, nr_of_vertices, triangles, nr_of_triangles));
+        stream_sizes[entropy_coded][3] = trico_get_size(arch) - size;
+        size = trico_get_size(arch);
+        TEST_ASSERT(trico_write_vertex_colors(arch, colors.data(), nr_of_vertices));
+        stream_sizes[entropy_coded][4] = trico_get_size(arch) - size;
+        options.triangle_coding = trico_triangle_coding_connectivity;
+        trico_set_encoder_options(arch, &options);
+        size = trico_get_size(arch);
+        TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+        stream_sizes[entropy_coded][5] = trico_get_size(arch) - size;
+        TEST_ASSERT(stream_sizes[entropy_coded][0] <= trico_get_maximum_stream_size(trico_vertex_float_stream, nr_of_vertices));
+        TEST_ASSERT(stream_sizes[entropy_coded][3] <= trico_get_maximum_stream_size(trico_vertex_float_parallelogram_stream, nr_of_vertices));
+        if (version == 1)
+          TEST_ASSERT(trico_finalize_archive(arch));
+
+        void* arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+        TEST_ASSERT(arch_read != NULL);
+        TEST_EQ(trico_vertex_float_stream, trico_get_next_stream_type(arch_read));
+        TEST_ASSERT(trico_read_vertices_range(arch_read, 100, 50, &p_vertices_read));
+        TEST_ASSERT(memcmp(vertices + 300, vertices_read.data(), 150 * sizeof(float)) == 0);
+        TEST_ASSERT(trico_seek_stream(arch_read, 0));
+        TEST_ASSERT(trico_read_vertices(arch_read, &p_vertices_read));
+        TEST_ASSERT(memcmp(vertices, vertices_read.data(), nr_of_vertices * 3 * sizeof(float)) == 0);
+        TEST_ASSERT(trico_read_vertices_double(arch_read, &p_vertices_double_read));
+        TEST_ASSERT(memcmp(vertices_double.data(), vertices_double_read.data(), nr_of_vertices * 3 * sizeof(double)) == 0);
+        TEST_ASSERT(trico_read_triangles(arch_read, &p_triangles_read));
+        TEST_ASSERT(memcmp(triangles, triangles_read.data(), nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+        memset(vertices_read.data(), 0, nr_of_vertices * 3 * sizeof(float));
+        TEST_ASSERT(trico_read_vertices_parallelogram(arch_read, &p_vertices_read, triangles, nr_of_triangles));
+        TEST_ASSERT(memcmp(vertices, vertices_read.data(), nr_of_vertices * 3 * sizeof(float)) == 0);
+        TEST_ASSERT(trico_read_vertex_colors(arch_read, &p_colors_read));
+        TEST_ASSERT(memcmp(colors.data(), colors_read.data(), nr_of_vertices * sizeof(uint32_t)) == 0);
+        memset(triangles_read.data(), 0, nr_of_triangles * 3 * sizeof(uint32_t));
+        TEST_ASSERT(trico_read_triangles(arch_read, &p_triangles_read));
+        TEST_ASSERT(memcmp(triangles, triangles_read.data(), nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+        TEST_EQ(trico_empty, trico_get_next_stream_type(arch_read));
+        TEST_ASSERT(trico_seek_stream(arch_read, 3));
+        TEST_EQ(trico_vertex_float_parallelogram_stream, trico_get_next_stream_type(arch_read));
+        trico_close_archive(arch_read);
+        trico_close_archive(arch);
+        }
+      for (int s = 0; s < 6; ++s)
+        TEST_ASSERT(stream_sizes[1][s] <= stream_sizes[0][s] + 4); // at most a method byte per plane
+      if (block_size == 0 && version == 1)
+        {
+        std::cout << "Entropy coded stream sizes (plain, entropy coded): ";
+        for (int s = 0; s < 6; ++s)
+          std::cout << "(" << stream_sizes[0][s] << ", " << stream_sizes[1][s] << ") ";
+        std::cout << "\n";
+        TEST_ASSERT(stream_sizes[1][0] < stream_sizes[0][0]);
+        TEST_ASSERT(stream_sizes[1][2] < stream_sizes[0][2]);
+        TEST_ASSERT(stream_sizes[1][3] < stream_sizes[0][3]);
+        TEST_ASSERT(stream_sizes[1][5] < stream_sizes[0][5]);
+        }
+      }
+    }
+
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_codec_selection(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  // random bits do not compress, so with the smallest codec they are stored with their codec ids as only overhead
+  const uint32_t nr_of_attribs = 10000;
+  std::vector<uint32_t> random_attribs(nr_of_attribs);
+  uint32_t state = 12345;
+  for (uint32_t i = 0; i < nr_of_attribs; ++i)
+    {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    random_attribs[i] = state;
+    }
+  std::vector<float> random_floats(nr_of_attribs);
+  memcpy(random_floats.data(), random_attribs.data(), nr_of_attribs * sizeof(float));
+  uint64_t stream_sizes[2][2];
+  for (int smallest = 0; smallest < 2; ++smallest)
+    {
+    void* arch = trico_open_archive_for_writing(1024);
+    struct trico_encoder_options options;
+    trico_get_encoder_options(arch, &options);
+    TEST_EQ(trico_codec_selection_compressed, options.codec_selection[trico_attribute_float_stream]);
+    for (uint32_t st = 0; st < TRICO_NUMBER_OF_STREAM_TYPES; ++st)
+      options.codec_selection[st] = smallest ? trico_codec_selection_smallest : trico_codec_selection_compressed;
+    trico_set_encoder_options(arch, &options);
+    uint64_t size = trico_get_size(arch);
+    TEST_ASSERT(trico_write_attributes_float(arch, random_floats.data(), nr_of_attribs));
+    stream_sizes[smallest][0] = trico_get_size(arch) - size;
+    size = trico_get_size(arch);
+    TEST_ASSERT(trico_write_attributes_uint32(arch, random_attribs.data(), nr_of_attribs));
+    stream_sizes[smallest][1] = trico_get_size(arch) - size;
+    TEST_ASSERT(trico_finalize_archive(arch));
+
+    void* arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+    std::vector<float> floats_read(nr_of_attribs);
+    std::vector<uint32_t> attribs_read(nr_of_attribs);
+    float* p_floats_read = floats_read.data();
+    uint32_t* p_attribs_read = attribs_read.data();
+    uint64_t nr_of_bytes = 0;
+    TEST_ASSERT((trico_get_stored_plane(arch_read, 0, &nr_of_bytes) != NULL) == (smallest == 1));
+    TEST_ASSERT(trico_read_attributes_float(arch_read, &p_floats_read));
+    TEST_ASSERT(memcmp(random_floats.data(), floats_read.data(), nr_of_attribs * sizeof(float)) == 0);
+    TEST_ASSERT(trico_read_attributes_uint32(arch_read, &p_attribs_read));
+    TEST_ASSERT(memcmp(random_attribs.data(), attribs_read.data(), nr_of_attribs * sizeof(uint32_t)) == 0);
+    TEST_EQ(trico_empty, trico_get_next_stream_type(arch_read));
+    trico_close_archive(arch_read);
+    trico_close_archive(arch);
+    }
+  TEST_EQ(5 + 4 + 1 + nr_of_attribs * sizeof(float), stream_sizes[1][0]);
+  TEST_EQ(5 + 4 * (4 + 1 + nr_of_attribs), stream_sizes[1][1]);
+  TEST_ASSERT(stream_sizes[1][0] < stream_sizes[0][0]);
+  TEST_ASSERT(stream_sizes[1][1] < stream_sizes[0][1]);
+
+  // with the stored codec all streams are raw copies, which can be read in place
+  std::vector<uint32_t> colors(nr_of_vertices);
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    colors[i] = 0xff000000 | i;
+  std::vector<float> vertices_read(nr_of_vertices * 3);
+  std::vector<uint32_t> triangles_read(nr_of_triangles * 3);
+  std::vector<uint32_t> colors_read(nr_of_vertices);
+  float* p_vertices_read = vertices_read.data();
+  uint32_t* p_triangles_read = triangles_read.data();
+  uint32_t* p_colors_read = colors_read.data();
+  const uint32_t block_sizes[] = { 0, 1000 };
+  for (const uint32_t block_size : block_sizes)
+    {
+    for (uint32_t version = 0; version <= 1; ++version)
+      {
+      void* arch = trico_open_archive_for_writing(1024);
+      TEST_ASSERT(trico_set_version(arch, version));
+      trico_set_block_size(arch, block_size);
+      struct trico_encoder_options options;
+      trico_get_encoder_options(arch, &options);
+      for (uint32_t st = 0; st < TRICO_NUMBER_OF_STREAM_TYPES; ++st)
+        options.codec_selection[st] = trico_codec_selection_stored;
+      trico_set_encoder_options(arch, &options);
+      TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+      TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+      TEST_ASSERT(trico_write_vertices_parallelogram(arch, vertices, nr_of_vertices, triangles, nr_of_triangles));
+      TEST_ASSERT(trico_write_vertex_colors(arch, colors.data(), nr_of_vertices));
+      options.triangle_coding = trico_triangle_coding_connectivity;
+      trico_set_encoder_options(arch, &options);
+      TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+      if (version == 1)
+        TEST_ASSERT(trico_finalize_archive(arch));
+
+      void* arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+      TEST_ASSERT(arch_read != NULL);
+      uint64_t nr_of_bytes = 0;
+      const float* y = (const float*)trico_get_stored_plane(arch_read, 1, &nr_of_bytes);
+      TEST_ASSERT(y != NULL);
+      TEST_EQ(nr_of_vertices * sizeof(float), nr_of_bytes);
+      float value;
+      memcpy(&value, y + 10, sizeof(float));
+      TEST_EQ(vertices[31], value);
+      TEST_ASSERT(trico_get_stored_plane(arch_read, 3, &nr_of_bytes) == NULL);
+      TEST_ASSERT(trico_read_vertices_range(arch_read, 100, 50, &p_vertices_read));
+      TEST_ASSERT(memcmp(vertices + 300, vertices_read.data(), 150 * sizeof(float)) == 0);
+      TEST_ASSERT(trico_read_vertices(arch_read, &p_vertices_read));
+      TEST_ASSERT(memcmp(vertices, vertices_read.data(), nr_of_vertices * 3 * sizeof(float)) == 0);
+      TEST_ASSERT(trico_get_stored_plane(arch_read, 3, &nr_of_bytes) != NULL);
+      TEST_EQ(nr_of_triangles * 3, nr_of_bytes);
+      TEST_ASSERT(trico_read_triangles(arch_read, &p_triangles_read));
+      TEST_ASSERT(memcmp(triangles, triangles_read.data(), nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+      const uint8_t* interleaved = (const uint8_t*)trico_get_stored_plane(arch_read, 0, &nr_of_bytes);
+      TEST_ASSERT(interleaved != NULL);
+      TEST_EQ(nr_of_vertices * 3 * sizeof(float), nr_of_bytes);
+      TEST_ASSERT(memcmp(vertices, interleaved, nr_of_bytes) == 0);
+      memset(vertices_read.data(), 0, nr_of_vertices * 3 * sizeof(float));
+      TEST_ASSERT(trico_read_vertices_parallelogram(arch_read, &p_vertices_read, triangles, nr_of_triangles));
+      TEST_ASSERT(memcmp(vertices, vertices_read.data(), nr_of_vertices * 3 * sizeof(float)) == 0);
+      TEST_ASSERT(trico_read_vertex_colors(arch_read, &p_colors_read));
+      TEST_ASSERT(memcmp(colors.data(), colors_read.data(), nr_of_vertices * sizeof(uint32_t)) == 0);
+      memset(triangles_read.data(), 0, nr_of_triangles * 3 * sizeof(uint32_t));
+      TEST_ASSERT(trico_read_triangles(arch_read, &p_triangles_read));
+      TEST_ASSERT(memcmp(triangles, triangles_read.data(), nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+      TEST_EQ(trico_empty, trico_get_next_stream_type(arch_read));
+      TEST_ASSERT(trico_get_stored_plane(arch_read, 0, &nr_of_bytes) == NULL);
+      TEST_EQ(5, trico_get_number_of_streams(arch_read));
+      TEST_ASSERT(trico_seek_stream(arch_read, 2));
+      TEST_EQ(trico_vertex_float_parallelogram_stream, trico_get_next_stream_type(arch_read));
+      trico_close_archive(arch_read);
+      trico_close_archive(arch);
+      }
+    }
+
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_vertex_remap()
+  {
+  const uint32_t original_indices[] = { 3, 1, 2, 0, 4 };
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_write_vertex_remap(arch, original_indices, 5));
+  TEST_ASSERT(trico_write_vertex_remap(arch, original_indices, 5));
+  void* arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+  TEST_EQ(trico_vertex_remap_stream, trico_get_next_stream_type(arch_read));
+  TEST_EQ(5, trico_get_number_of_vertices(arch_read));
+  TEST_ASSERT(trico_skip_next_stream(arch_read));
+  uint32_t original_indices_read[5];
+  uint32_t* p_original_indices_read = original_indices_read;
+  TEST_ASSERT(trico_read_vertex_remap(arch_read, &p_original_indices_read));
+  TEST_ASSERT(memcmp(original_indices, original_indices_read, sizeof(original_indices)) == 0);
+  TEST_EQ(trico_empty, trico_get_next_stream_type(arch_read));
+  trico_close_archive(arch_read);
+  trico_close_archive(arch);
+  }
+
+void test_stream_directory(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  double* attributes = new double[nr_of_vertices];
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    attributes[i] = (double)vertices[i * 3] * 0.5;
+
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_set_version(arch, 1));
+  TEST_ASSERT(!trico_set_version(arch, 2));
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(!trico_set_version(arch, 0));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_write_attributes_double(arch, attributes, nr_of_vertices));
+  TEST_ASSERT(trico_finalize_archive(arch));
+  TEST_ASSERT(!trico_write_vertices(arch, vertices, nr_of_vertices));
+
+  std::vector<uint8_t> data(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+
+  // sequential reading stops in front of the directory
+  arch = trico_open_archive_for_reading(data.data(), data.size());
+  TEST_ASSERT(arch != nullptr);
+  TEST_EQ(1, trico_get_version(arch));
+  TEST_EQ(3, trico_get_number_of_streams(arch));
+  TEST_EQ(trico_vertex_float_stream, trico_get_next_stream_type(arch));
+  TEST_ASSERT(trico_skip_next_stream(arch));
+  TEST_ASSERT(trico_skip_next_stream(arch));
+  TEST_EQ(trico_attribute_double_stream, trico_get_next_stream_type(arch));
+  double* attributes_read = new double[nr_of_vertices];
+  TEST_ASSERT(trico_read_attributes_double(arch, &attributes_read));
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    TEST_EQ(attributes[i], attributes_read[i]);
+  TEST_EQ(trico_empty, trico_get_next_stream_type(arch));
+
+  // each stream can be decoded on its own from its byte range
+  uint64_t total_stream_size = 8;
+  for (uint32_t s = 0; s < trico_get_number_of_streams(arch); ++s)
+    total_stream_size += trico_get_stream_size(arch, s);
+  TEST_EQ(trico_get_stream_offset(arch, 2) + trico_get_stream_size(arch, 2), total_stream_size);
+  void* stream = trico_open_archive_for_reading_stream(data.data() + trico_get_stream_offset(arch, 1), trico_get_stream_size(arch, 1));
+  TEST_ASSERT(stream != nullptr);
+  TEST_EQ(nr_of_triangles, trico_get_number_of_triangles(stream));
+  uint32_t* triangles_read = new uint32_t[nr_of_triangles * 3];
+  TEST_ASSERT(trico_read_triangles(stream, &triangles_read));
+  for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+    TEST_EQ(triangles[i], triangles_read[i]);
+  TEST_EQ(trico_empty, trico_get_next_stream_type(stream));
+  delete[] triangles_read;
+  trico_close_archive(stream);
+  TEST_ASSERT(trico_open_archive_for_reading_stream(data.data() + trico_get_stream_offset(arch, 1), trico_get_stream_size(arch, 1) - 1) == nullptr);
+  trico_close_archive(arch);
+
+  // a damaged directory is rejected
+  data[data.size() - 1] ^= 0xff;
+  TEST_ASSERT(trico_open_archive_for_reading(data.data(), data.size()) == nullptr);
+  data[data.size() - 1] ^= 0xff;
+
+  // a directory offset that only matches the size of the archive by wrapping around is rejected
+  const uint32_t wrapping_nr_of_streams = 0xffffffff;
+  const uint64_t wrapping_offset = (uint64_t)data.size() - 16 - (uint64_t)wrapping_nr_of_streams * 24;
+  memcpy(data.data() + data.size() - 16, &wrapping_offset, sizeof(uint64_t));
+  memcpy(data.data() + data.size() - 8, &wrapping_nr_of_streams, sizeof(uint32_t));
+  TEST_ASSERT(trico_open_archive_for_reading(data.data(), data.size()) == nullptr);
+
+  // archives that write to a sink get their directory on close, and version 0 archives have no directory
+  for (uint32_t version = 0; version < 2; ++version)
+    {
+    sink_data sink;
+    arch = trico_open_archive_for_writing_to_callback(write_to_vector, &sink, 64);
+    TEST_ASSERT(trico_set_version(arch, version));
+    TEST_ASSERT(trico_write_attributes_double(arch, attributes, nr_of_vertices));
+    TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+    uint64_t size = trico_get_size(arch);
+    trico_close_archive(arch);
+    TEST_EQ(version == 1 ? size + 2 * 24 + 16 : size, sink.bytes.size());
+    arch = trico_open_archive_for_reading(sink.bytes.data(), sink.bytes.size());
+    TEST_ASSERT(arch != nullptr);
+    TEST_EQ(version, trico_get_version(arch));
+    TEST_EQ(2, trico_get_number_of_streams(arch));
+    TEST_ASSERT(trico_seek_stream(arch, 1));
+    float* vertices_read = new float[nr_of_vertices * 3];
+    TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+    for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+      TEST_EQ(vertices[i], vertices_read[i]);
+    delete[] vertices_read;
+    TEST_EQ(trico_empty, trico_get_next_stream_type(arch));
+    trico_close_archive(arch);
+    }
+
+  delete[] attributes_read;
+  delete[] attributes;
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_blocked_streams(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  float* attributes = new float[nr_of_vertices];
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    attributes[i] = vertices[i * 3 + 1] * 2.f;
+
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_set_version(arch, 1));
+  trico_set_block_size(arch, 4096);
+  TEST_EQ(4096, trico_get_block_size(arch));
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  TEST_ASSERT(trico_write_attributes_float(arch, attributes, nr_of_vertices));
+  trico_set_block_size(arch, 0);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_finalize_archive(arch));
+
+  std::vector<uint8_t> data(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+
+  arch = trico_open_archive_for_reading(data.data(), data.size());
+  TEST_ASSERT(arch != nullptr);
+  TEST_EQ(4, trico_get_number_of_streams(arch));
+  TEST_EQ(trico_vertex_float_stream, trico_get_stream_type(arch, 0));
+  TEST_EQ(trico_vertex_float_stream, trico_get_next_stream_type(arch));
+
+  const uint32_t ranges[][2] = { { 0, 1 }, { 4000, 200 }, { 5000, 10000 }, { nr_of_vertices - 1, 1 }, { 0, nr_of_vertices } };
+  float* vertices_read = new float[nr_of_vertices * 3];
+  float* attributes_read = new float[nr_of_vertices];
+  for (uint32_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); ++r)
+    {
+    const uint32_t first = ranges[r][0];
+    const uint32_t count = ranges[r][1];
+    TEST_ASSERT(trico_read_vertices_range(arch, first, count, &vertices_read));
+    for (uint32_t i = 0; i < count * 3; ++i)
+      TEST_EQ(vertices[first * 3 + i], vertices_read[i]);
+    }
+  TEST_ASSERT(!trico_read_vertices_range(arch, nr_of_vertices, 1, &vertices_read));
+  TEST_ASSERT(!trico_read_attributes_float_range(arch, 0, 1, &attributes_read));
+  TEST_EQ(trico_vertex_float_stream, trico_get_next_stream_type(arch));
+
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    TEST_EQ(vertices[i], vertices_read[i]);
+  TEST_ASSERT(trico_skip_next_stream(arch));
+
+  TEST_ASSERT(trico_read_attributes_float_range(arch, 100, 5000, &attributes_read));
+  for (uint32_t i = 0; i < 5000; ++i)
+    TEST_EQ(attributes[100 + i], attributes_read[i]);
+  TEST_ASSERT(trico_read_attributes_float(arch, &attributes_read));
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    TEST_EQ(attributes[i], attributes_read[i]);
+
+  // streams without blocks are decoded completely, but give the same range
+  TEST_ASSERT(trico_read_vertices_range(arch, 5000, 10000, &vertices_read));
+  for (uint32_t i = 0; i < 10000 * 3; ++i)
+    TEST_EQ(vertices[5000 * 3 + i], vertices_read[i]);
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  TEST_EQ(trico_empty, trico_get_next_stream_type(arch));
+  trico_close_archive(arch);
+
+  // blocked streams are also found when the stream index is built by scanning a version 0 archive
+  arch = trico_open_archive_for_writing(1024);
+  trico_set_block_size(arch, 1000);
+  trico_set_number_of_threads(arch, 0);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_attributes_float(arch, attributes, nr_of_vertices));
+  data.assign(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+  arch = trico_open_archive_for_reading(data.data(), data.size());
+  trico_set_number_of_threads(arch, 4);
+  TEST_EQ(2, trico_get_number_of_streams(arch));
+  TEST_ASSERT(trico_seek_stream(arch, 1));
+  TEST_ASSERT(trico_read_attributes_float_range(arch, 999, 2, &attributes_read));
+  TEST_EQ(attributes[999], attributes_read[0]);
+  TEST_EQ(attributes[1000], attributes_read[1]);
+  TEST_ASSERT(trico_seek_stream(arch, 0));
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    TEST_EQ(vertices[i], vertices_read[i]);
+  trico_close_archive(arch);
+
+  delete[] attributes_read;
+  delete[] vertices_read;
+  delete[] attributes;
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_encoder_options(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  // the stream header is 9 bytes after the archive header, the first byte of the first plane holds the hash table sizes
+  const uint32_t hash_info_offset = 8 + 1 + 4 + 4;
+
+  // small double meshes get small hash tables
+  double small[30];
+  for (uint32_t i = 0; i < 30; ++i)
+    small[i] = (double)vertices[i];
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_write_vertices_double(arch, small, 10));
+  TEST_EQ(0x44, (int)trico_get_buffer_pointer(arch)[hash_info_offset]);
+  trico_close_archive(arch);
+
+  struct trico_encoder_options options;
+  trico_get_default_encoder_options(&options);
+  TEST_EQ(4, options.hash1_size_exponent[trico_vertex_float_stream]);
+  TEST_EQ(10, options.hash2_size_exponent[trico_vertex_float_stream]);
+  TEST_EQ(20, options.hash1_size_exponent[trico_vertex_double_stream]);
+  TEST_EQ(0, options.auto_tune);
+
+  options.hash1_size_exponent[trico_vertex_float_stream] = 13;
+  options.hash2_size_exponent[trico_vertex_float_stream] = 12;
+  arch = trico_open_archive_for_writing(1024);
+  trico_set_encoder_options(arch, &options);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_EQ(0x66, (int)trico_get_buffer_pointer(arch)[hash_info_offset]);
+  std::vector<uint8_t> data(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+
+  float* vertices_read = new float[nr_of_vertices * 3];
+  arch = trico_open_archive_for_reading(data.data(), data.size());
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    TEST_EQ(vertices[i], vertices_read[i]);
+  trico_close_archive(arch);
+
+  options.auto_tune = 1;
+  options.auto_tune_time_budget = 1.0;
+  arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_set_version(arch, 1));
+  trico_set_encoder_options(arch, &options);
+  struct trico_encoder_options options_read;
+  trico_get_encoder_options(arch, &options_read);
+  TEST_EQ(1, options_read.auto_tune);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_vertices(arch, vertices, 0));
+  TEST_ASSERT(trico_finalize_archive(arch));
+  data.assign(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+
+  arch = trico_open_archive_for_reading(data.data(), data.size());
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    TEST_EQ(vertices[i], vertices_read[i]);
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  TEST_EQ(trico_empty, trico_get_next_stream_type(arch));
+  trico_close_archive(arch);
+
+  // the sizes of the encoder options are candidates of the tuning, so a single plane stream that is tuned on all its values
+  // is never larger than with these sizes; both archives have the same layout, a version 1 archive with an empty stream and a directory
+  std::vector<float> x(nr_of_vertices);
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    x[i] = vertices[i * 3];
+  uint64_t attribute_size[2];
+  for (int tuned = 0; tuned < 2; ++tuned)
+    {
+    options.auto_tune = tuned;
+    options.auto_tune_time_budget = 0.0;
+    options.auto_tune_sample_size = 0;
+    arch = trico_open_archive_for_writing(1024);
+    TEST_ASSERT(trico_set_version(arch, 1));
+    trico_set_encoder_options(arch, &options);
+    TEST_ASSERT(trico_write_attributes_float(arch, x.data(), nr_of_vertices));
+    TEST_ASSERT(trico_write_attributes_float(arch, x.data(), 0));
+    TEST_ASSERT(trico_finalize_archive(arch));
+    attribute_size[tuned] = trico_get_size(arch);
+    trico_close_archive(arch);
+    }
+  std::cout << "Auto tuned attribute stream size: " << attribute_size[1] << " bytes, with default options: " << attribute_size[0] << " bytes\n";
+  TEST_ASSERT(attribute_size[1] <= attribute_size[0]);
+
+  // higher lz4 levels give smaller triangle streams, in every triangle coding, that the same decoder reads
+  trico_get_default_encoder_options(&options);
+  TEST_EQ(0, options.lz4_level[trico_triangle_uint32_stream]);
+  std::vector<uint32_t> triangles_read(nr_of_triangles * 3);
+  uint32_t* p_triangles_read = triangles_read.data();
+  const enum trico_triangle_coding triangle_codings[] = { trico_triangle_coding_byte_planes, trico_triangle_coding_delta, trico_triangle_coding_connectivity };
+  for (const enum trico_triangle_coding triangle_coding : triangle_codings)
+    {
+    uint64_t sizes[2];
+    for (int high = 0; high < 2; ++high)
+      {
+      options.triangle_coding = triangle_coding;
+      for (uint32_t st = 0; st < TRICO_NUMBER_OF_STREAM_TYPES; ++st)
+        options.lz4_level[st] = high ? 9 : 0;
+      arch = trico_open_archive_for_writing(1024);
+      trico_set_encoder_options(arch, &options);
+      TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+      sizes[high] = trico_get_size(arch);
+      void* arch_read = trico_open_archive_for_reading(trico_get_buffer_pointer(arch), trico_get_size(arch));
+      TEST_ASSERT(trico_read_triangles(arch_read, &p_triangles_read));
+      TEST_ASSERT(memcmp(triangles, triangles_read.data(), nr_of_triangles * 3 * sizeof(uint32_t)) == 0);
+      trico_close_archive(arch_read);
+      trico_close_archive(arch);
+      }
+    TEST_ASSERT(sizes[1] < sizes[0]);
+    }
+
+  delete[] vertices_read;
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+void test_context(const char* filename)
+  {
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  std::vector<uint8_t> expected(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+
+  void* context = trico_create_context();
+  TEST_ASSERT(context != nullptr);
+  TEST_EQ(0, (int)trico_get_context_memory_size(context));
+
+  uint64_t memory_size = 0;
+  float* vertices_read = new float[nr_of_vertices * 3];
+  uint32_t* triangles_read = new uint32_t[nr_of_triangles * 3];
+  for (int round = 0; round < 3; ++round)
+    {
+    arch = trico_open_archive_for_writing(1024);
+    trico_set_context(arch, context);
+    TEST_ASSERT(trico_get_context(arch) == context);
+    TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+    TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+    TEST_EQ(expected.size(), trico_get_size(arch));
+    TEST_ASSERT(memcmp(expected.data(), trico_get_buffer_pointer(arch), expected.size()) == 0);
+    trico_close_archive(arch);
+
+    arch = trico_open_archive_for_reading(expected.data(), expected.size());
+    trico_set_context(arch, context);
+    TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+    TEST_ASSERT(trico_read_triangles(arch, &triangles_read));
+    trico_close_archive(arch);
+    for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+      TEST_EQ(vertices[i], vertices_read[i]);
+    for (uint32_t i = 0; i < nr_of_triangles * 3; ++i)
+      TEST_EQ(triangles[i], triangles_read[i]);
+
+    // the memory of the context is reused, it only grows for the first mesh
+    if (round == 0)
+      memory_size = trico_get_context_memory_size(context);
+    TEST_ASSERT(memory_size > 0);
+    TEST_EQ(memory_size, trico_get_context_memory_size(context));
+    }
+
+  // planes that are read with multiple threads are decompressed with the worker contexts, which grow when a worker
+  // decodes its first plane, so which of them grow depends on the scheduling of the threads
+  arch = trico_open_archive_for_reading(expected.data(), expected.size());
+  trico_set_context(arch, context);
+  trico_set_number_of_threads(arch, 3);
+  TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+  trico_close_archive(arch);
+  for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+    TEST_EQ(vertices[i], vertices_read[i]);
+  TEST_ASSERT(trico_get_context_memory_size(context) >= memory_size);
+
+  // blocked streams compress and decompress their blocks with the worker contexts
+  arch = trico_open_archive_for_writing(1024);
+  trico_set_context(arch, context);
+  trico_set_block_size(arch, 1000);
+  trico_set_number_of_threads(arch, 2);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  std::vector<uint8_t> blocked(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+  arch = trico_open_archive_for_reading(blocked.data(), blocked.size());
+  trico_set_context(arch, context);
+  TEST_ASSERT(trico_read_vertices_range(arch, 1500, 2000, &vertices_read));
+  for (uint32_t i = 0; i < 2000 * 3; ++i)
+    TEST_EQ(vertices[1500 * 3 + i], vertices_read[i]);
+  trico_close_archive(arch);
+
+  trico_release_context_memory(context);
+  TEST_EQ(0, (int)trico_get_context_memory_size(context));
+  trico_destroy_context(context);
+
+  delete[] vertices_read;
+  delete[] triangles_read;
+  trico_free(vertices);
+  trico_free(triangles);
+  }
+
+namespace
+  {
+  struct allocation_counter
+    {
+    struct trico_allocator parent;
+    int64_t nr_of_live_allocations;
+    uint64_t nr_of_allocations;
+    };
+
+  void* counting_allocate(void* user_data, size_t size, size_t alignment)
+    {
+    allocation_counter* counter = (allocation_counter*)user_data;
+    ++counter->nr_of_live_allocations;
+    ++counter->nr_of_allocations;
+    return counter->parent.allocate(counter->parent.user_data, size, alignment);
+    }
+
+  void* counting_reallocate(void* user_data, void* ptr, size_t size, size_t alignment)
+    {
+    allocation_counter* counter = (allocation_counter*)user_data;
+    ++counter->nr_of_allocations;
+    return counter->parent.reallocate(counter->parent.user_data, ptr, size, alignment);
+    }
+
+  void counting_deallocate(void* user_data, void* ptr, size_t alignment)
+    {
+    allocation_counter* counter = (allocation_counter*)user_data;
+    --counter->nr_of_live_allocations;
+    counter->parent.deallocate(counter->parent.user_data, ptr, alignment);
+    }
+
+  void* failing_allocate(void* user_data, size_t size, size_t alignment)
+    {
+    (void)user_data;
+    (void)size;
+    (void)alignment;
+    return nullptr;
+    }
+
+  void count_task(void* user_data, uint32_t task_index, uint32_t thread_index)
+    {
+    (void)thread_index;
+    ((uint32_t*)user_data)[task_index] += 1;
+    }
+
+  void* failing_reallocate(void* user_data, void* ptr, size_t size, size_t alignment)
+    {
+    (void)user_data;
+    (void)ptr;
+    (void)size;
+    (void)alignment;
+    return nullptr;
+    }
+  }
+
+void test_allocators(const char* filename)
+  {
+  allocation_counter counter;
+  trico_get_default_allocator(&counter.parent);
+  counter.nr_of_live_allocations = 0;
+  counter.nr_of_allocations = 0;
+  struct trico_allocator allocator = { counting_allocate, counting_reallocate, counting_deallocate, &counter };
+  trico_set_allocator(&allocator);
+
+  uint32_t nr_of_vertices;
+  float* vertices;
+  uint32_t nr_of_triangles;
+  uint32_t* triangles;
+  TEST_EQ(1, trico_read_stl(&nr_of_vertices, &vertices, &nr_of_triangles, &triangles, filename));
+  TEST_EQ(2, counter.nr_of_live_allocations);
+
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+  TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+  std::vector<uint8_t> expected(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+  TEST_EQ(2, counter.nr_of_live_allocations);
+  TEST_ASSERT(counter.nr_of_allocations > 2);
+
+  void* aligned = trico_aligned_malloc(100, 4096);
+  TEST_ASSERT(aligned != nullptr);
+  TEST_EQ(0, (int)((uintptr_t)aligned % 4096));
+  trico_aligned_free(aligned, 4096);
+
+  // the stream index of an archive with more than 16 streams grows, which fails without leaking
+  arch = trico_open_archive_for_writing(1024);
+  const uint32_t attribs[4] = { 1, 2, 3, 4 };
+  for (int i = 0; i < 20; ++i)
+    TEST_ASSERT(trico_write_attributes_uint32(arch, attribs, 4));
+  std::vector<uint8_t> many_streams(trico_get_buffer_pointer(arch), trico_get_buffer_pointer(arch) + trico_get_size(arch));
+  trico_close_archive(arch);
+  struct trico_allocator failing_allocator = { counting_allocate, failing_reallocate, counting_deallocate, &counter };
+  trico_set_allocator(&failing_allocator);
+  arch = trico_open_archive_for_reading(many_streams.data(), many_streams.size());
+  TEST_EQ(0u, trico_get_number_of_streams(arch));
+  trico_close_archive(arch);
+  TEST_EQ(2, counter.nr_of_live_allocations);
+  trico_set_allocator(&allocator);
+  arch = trico_open_archive_for_reading(many_streams.data(), many_streams.size());
+  TEST_EQ(20u, trico_get_number_of_streams(arch));
+  trico_close_archive(arch);
+
+  // trico_parallel_for runs the tasks serially when it cannot allocate its threads
+  struct trico_allocator no_memory_allocator = { failing_allocate, failing_reallocate, counting_deallocate, &counter };
+  trico_set_allocator(&no_memory_allocator);
+  uint32_t task_counts[100] = { 0 };
+  trico_parallel_for(count_task, task_counts, 100, 4);
+  for (int i = 0; i < 100; ++i)
+    TEST_EQ(1u, task_counts[i]);
+  trico_set_allocator(&allocator);
+
+  trico_set_allocator(nullptr);
+
+  // a context and an archive that allocate from an arena, which is reset after each mesh
+  void* arena = trico_create_arena(0);
+  struct trico_allocator arena_allocator;
+  trico_get_arena_allocator(arena, &arena_allocator);
+  uint64_t reserved_size = 0;
+  for (int round = 0; round < 3; ++round)
+    {
+    void* context = trico_create_context_with_allocator(&arena_allocator);
+    arch = trico_open_archive_for_writing(1024);
+    trico_set_context(arch, context);
+    TEST_ASSERT(trico_write_vertices(arch, vertices, nr_of_vertices));
+    TEST_ASSERT(trico_write_triangles(arch, triangles, nr_of_triangles));
+    TEST_EQ(expected.size(), trico_get_size(arch));
+    TEST_ASSERT(memcmp(expected.data(), trico_get_buffer_pointer(arch), expected.size()) == 0);
+    trico_close_archive(arch);
+
+    arch = trico_open_archive_for_reading(expected.data(), expected.size());
+    trico_set_context(arch, context);
+    trico_set_number_of_threads(arch, 2);
+    float* vertices_read = (float*)arena_allocator.allocate(arena, nr_of_vertices * 3 * sizeof(float), 64);
+    TEST_EQ(0, (int)((uintptr_t)vertices_read % 64));
+    TEST_ASSERT(trico_read_vertices(arch, &vertices_read));
+    for (uint32_t i = 0; i < nr_of_vertices * 3; ++i)
+      TEST_EQ(vertices[i], vertices_read[i]);
+    trico_close_archive(arch);
+
+    TEST_ASSERT(trico_get_arena_used_size(arena) > 0);
+    trico_destroy_context(context);
+    trico_reset_arena(arena);
+    TEST_EQ(0, (int)trico_get_arena_used_size(arena));
+    // the blocks of the arena are reused after a reset
+    if (round == 0)
+      reserved_size = trico_get_arena_reserved_size(arena);
+    TEST_EQ(reserved_size, trico_get_arena_reserved_size(arena));
+    }
+
+  // growing the most recent allocation happens in place
+  uint8_t* grown = (uint8_t*)arena_allocator.allocate(arena, 16, 16);
+  memset(grown, 7, 16);
+  TEST_ASSERT(grown == (uint8_t*)arena_allocator.reallocate(arena, grown, 1024, 16));
+  uint8_t* moved = (uint8_t*)arena_allocator.allocate(arena, 16, 16);
+  uint8_t* copied = (uint8_t*)arena_allocator.reallocate(arena, grown, 2048, 16);
+  TEST_ASSERT(copied != grown && copied != moved);
+  for (int i = 0; i < 16; ++i)
+    TEST_EQ(7, (int)copied[i]);
+  trico_destroy_arena(arena);
+
+  trico_set_allocator(&allocator);
+  trico_free(vertices);
+  trico_free(triangles);
+  trico_set_allocator(nullptr);
+  TEST_EQ(0, counter.nr_of_live_allocations);
+  }
+
+void test_attributes()
+  {
+  const uint32_t n = 1000;
+  float* uv = new float[n * 2];
+  double* normals = new double[n * 3];
+  float* attrib_float = new float[n];
+  double* attrib_double = new double[n];
+  uint8_t* attrib_uint8 = new uint8_t[n];
+  uint16_t* attrib_uint16 = new uint16_t[n];
+  uint64_t* attrib_uint64 = new uint64_t[n];
+  for (uint32_t i = 0; i < n; ++i)
+    {
+    uv[i * 2] = (float)i / (float)n;
+    uv[i * 2 + 1] = 1.f - (float)i / (float)n;
+    normals[i * 3] = (double)(i % 7) / 7.0;
+    normals[i * 3 + 1] = (double)(i % 11) / 11.0;
+    normals[i * 3 + 2] = (double)(i % 13) / 13.0;
+    attrib_float[i] = (float)(i * i) * 0.25f;
+    attrib_double[i] = (double)i * 3.14159;
+    attrib_uint8[i] = (uint8_t)(i % 5);
+    attrib_uint16[i] = (uint16_t)(i * 7);
+    attrib_uint64[i] = (uint64_t)i * 1000000007ULL;
+    }
+
+  void* arch = trico_open_archive_for_writing(1024);
+  TEST_ASSERT(trico_write_uv_per_vertex(arch, uv, n));
+  TEST_ASSERT(trico_write_vertex_normals_double(arch, normals, n));
+  TEST_ASSERT(trico_write_attributes_float(arch, attrib_float, n));
+  TEST_ASSERT(trico_write_attributes_double(arch, attrib_double, n));
+  TEST_ASSERT(trico_write_attributes_uint8(arch, attrib_uint8, n));
+  TEST_ASSERT(trico_write_attributes_uint16(arch, attrib_uint16, n));
+  TEST_ASSERT(trico_write_attributes_uint64(arch, attrib_uint64, n));
+
+  uint64_t length = trico_get_size(arch);
+  char* data = new char[length];
+  memcpy(data, trico_get_buffer_pointer(arch), length);
+  trico_close_archive(arch);
+
+  arch = trico_open_archive_for_reading((const uint8_t*)data, length);
+  TEST_EQ(n, trico_get_number_of_uvs(arch));
+  float* uv_read = new float[n * 2];
+  TEST_ASSERT(trico_read_uv_per_vertex(arch, &uv_read));
+  for (uint32_t i = 0; i < n * 2; ++i)
+    TEST_EQ(uv[i], uv_read[i]);
+  delete[] uv_read;
+
+  TEST_EQ(n, trico_get_number_of_normals(arch));
+  double* normals_read = new double[n * 3];
+  TEST_ASSERT(trico_read_vertex_normals_double(arch, &normals_read));
+  for (uint32_t i = 0; i < n * 3; ++i)
+    TEST_EQ(normals[i], normals_read[i]);
+  delete[] normals_read;
+
+  float* attrib_float_read = new float[n];
+  TEST_ASSERT(trico_read_attributes_float(arch, &attrib_float_read));
+  for (uint32_t i = 0; i < n; ++i)
+    TEST_EQ(attrib_float[i], attrib_float_read[i]);
+  delete[] attrib_float_read;
+
+  TEST_ASSERT(trico_skip_next_stream(arch));
+
+  uint8_t* attrib_uint8_read = new uint8_t[n];
+  TEST_ASSERT(trico_read_attributes_uint8(arch, &attrib_uint8_read));
+  for (uint32_t i = 0; i < n; ++i)
+    TEST_EQ(attrib_uint8[i], attrib_uint8_read[i]);
+  delete[] attrib_uint8_read;
+
+  uint16_t* attrib_uint16_read = new uint16_t[n];
+  TEST_ASSERT(trico_read_attributes_uint16(arch, &attrib_uint16_read));
+  for (uint32_t i = 0; i < n; ++i)
+    TEST_EQ(attrib_uint16[i], attrib_uint16_read[i]);
+  delete[] attrib_uint16_read;
+
+  uint64_t* attrib_uint64_read = new uint64_t[n];
+  TEST_ASSERT(trico_read_attributes_uint64(arch, &attrib_uint64_read));
+  for (uint32_t i = 0; i < n; ++i)
+    TEST_EQ(attrib_uint64[i], attrib_uint64_read[i]);
+  delete[] attrib_uint64_read;
+
+  TEST_EQ(trico_empty, trico_get_next_stream_type(arch));
+  trico_close_archive(arch);
+
+  arch = trico_open_archive_for_reading((const uint8_t*)data, length);
+  while (trico_get_next_stream_type(arch) != trico_empty)
+    TEST_ASSERT(trico_skip_next_stream(arch));
+  trico_close_archive(arch);
+
+  delete[] data;
+  delete[] uv;
+  delete[] normals;
+  delete[] attrib_float;
+  delete[] attrib_double;
+  delete[] attrib_uint8;
+  delete[] attrib_uint16;
+  delete[] attrib_uint64;
+  }
 
 void run_all_trico_compression_tests()
   {
   test_header();
   test_stl("data/StanfordBunny.stl");
+  test_stl_welding("data/StanfordBunny.stl");
+  test_stl_validation("data/StanfordBunny.stl");
+  test_ascii_stl("data/StanfordBunny.stl");
+  test_ply("data/StanfordBunny.stl");
   test_stl_double_64("data/StanfordBunny.stl");
+  test_stl_multithreaded("data/StanfordBunny.stl");
+  test_attributes();
+  test_reserve("data/StanfordBunny.stl");
+  test_sink("data/StanfordBunny.stl");
+  test_random_access("data/StanfordBunny.stl");
+  test_stream_directory("data/StanfordBunny.stl");
+  test_parallelogram("data/StanfordBunny.stl");
+  test_triangle_coding("data/StanfordBunny.stl");
+  test_entropy_coding("data/StanfordBunny.stl");
+  test_codec_selection("data/StanfordBunny.stl");
+  test_vertex_remap();
+  test_blocked_streams("data/StanfordBunny.stl");
+  test_encoder_options("data/StanfordBunny.stl");
+  test_context("data/StanfordBunny.stl");
+  test_allocators("data/StanfordBunny.stl");
   }
\ No newline at end of file
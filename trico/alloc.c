@@ -0,0 +1,126 @@
+#include "alloc.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/*
+Memory with the default alignment comes straight from malloc, so that it can also be released with free.
+Larger alignments use the aligned allocation functions of the platform.
+*/
+static void* default_allocate(void* user_data, size_t size, size_t alignment)
+  {
+  (void)user_data;
+  if (alignment <= TRICO_DEFAULT_ALIGNMENT)
+    return malloc(size);
+#ifdef _WIN32
+  return _aligned_malloc(size, alignment);
+#else
+  void* ptr = NULL;
+  if (posix_memalign(&ptr, alignment, size) != 0)
+    return NULL;
+  return ptr;
+#endif
+  }
+
+static void default_deallocate(void* user_data, void* ptr, size_t alignment)
+  {
+  (void)user_data;
+#ifdef _WIN32
+  if (alignment > TRICO_DEFAULT_ALIGNMENT)
+    {
+    _aligned_free(ptr);
+    return;
+    }
+#else
+  (void)alignment;
+#endif
+  free(ptr);
+  }
+
+static void* default_reallocate(void* user_data, void* ptr, size_t size, size_t alignment)
+  {
+  if (alignment <= TRICO_DEFAULT_ALIGNMENT)
+    return realloc(ptr, size);
+#ifdef _WIN32
+  (void)user_data;
+  return _aligned_realloc(ptr, size, alignment);
+#else
+  // realloc keeps the contents, but not necessarily the alignment
+  void* new_ptr = realloc(ptr, size);
+  if (new_ptr == NULL || ((uintptr_t)new_ptr & (alignment - 1)) == 0)
+    return new_ptr;
+  void* aligned_ptr = default_allocate(user_data, size, alignment);
+  if (aligned_ptr)
+    memcpy(aligned_ptr, new_ptr, size);
+  free(new_ptr);
+  return aligned_ptr;
+#endif
+  }
+
+static struct trico_allocator trico_process_allocator = { default_allocate, default_reallocate, default_deallocate, NULL };
+
+void trico_get_default_allocator(struct trico_allocator* allocator)
+  {
+  allocator->allocate = default_allocate;
+  allocator->reallocate = default_reallocate;
+  allocator->deallocate = default_deallocate;
+  allocator->user_data = NULL;
+  }
+
+void trico_set_allocator(const struct trico_allocator* allocator)
+  {
+  if (allocator)
+    trico_process_allocator = *allocator;
+  else
+    trico_get_default_allocator(&trico_process_allocator);
+  }
+
+void trico_get_allocator(struct trico_allocator* allocator)
+  {
+  *allocator = trico_process_allocator;
+  }
+
+void* trico_malloc(size_t size)
+  {
+  return trico_process_allocator.allocate(trico_process_allocator.user_data, size, TRICO_DEFAULT_ALIGNMENT);
+  }
+
+void* trico_calloc(size_t num, size_t size)
+  {
+  if (size != 0 && num > (size_t)-1 / size)
+    return NULL;
+  // calloc can hand out fresh pages from the system without clearing them
+  if (trico_process_allocator.allocate == default_allocate)
+    return calloc(num, size);
+  void* ptr = trico_malloc(num * size);
+  if (ptr)
+    memset(ptr, 0, num * size);
+  return ptr;
+  }
+
+void* trico_realloc(void* ptr, size_t new_size)
+  {
+  if (ptr == NULL)
+    return trico_malloc(new_size);
+  return trico_process_allocator.reallocate(trico_process_allocator.user_data, ptr, new_size, TRICO_DEFAULT_ALIGNMENT);
+  }
+
+void trico_free(void* ptr)
+  {
+  if (ptr)
+    trico_process_allocator.deallocate(trico_process_allocator.user_data, ptr, TRICO_DEFAULT_ALIGNMENT);
+  }
+
+void* trico_aligned_malloc(size_t size, size_t alignment)
+  {
+  return trico_process_allocator.allocate(trico_process_allocator.user_data, size, alignment > TRICO_DEFAULT_ALIGNMENT ? alignment : TRICO_DEFAULT_ALIGNMENT);
+  }
+
+void trico_aligned_free(void* ptr, size_t alignment)
+  {
+  if (ptr)
+    trico_process_allocator.deallocate(trico_process_allocator.user_data, ptr, alignment > TRICO_DEFAULT_ALIGNMENT ? alignment : TRICO_DEFAULT_ALIGNMENT);
+  }
@@ -5,32 +5,50 @@ extern "C" {
 #ifndef TRICO_ALLOC_H
 #define TRICO_ALLOC_H
 
+#include "trico_api.h"
+
 #include <stdlib.h>
 #include <stdint.h>
 
+/*
+Alignment of memory returned by trico_malloc, trico_calloc and trico_realloc.
+*/
+#define TRICO_DEFAULT_ALIGNMENT 16
 
-static inline void* trico_malloc(size_t size)
-  {
-  return malloc(size);
-  }
-
-static inline void* trico_calloc(size_t num, size_t size)
-  {
-  return calloc(num, size);
-  }
-
-static inline void* trico_realloc(void* ptr, size_t new_size)
-  {
-  return realloc(ptr, new_size);
-  }
-
-static inline void trico_free(void* ptr)
+/*
+Allocator through which trico allocates all its memory. alignment is a power of two, and is at least TRICO_DEFAULT_ALIGNMENT.
+deallocate receives the same alignment as the allocation, reallocate keeps the alignment and the contents of the memory.
+*/
+struct trico_allocator
   {
-  free(ptr);
-  }
+  void* (*allocate)(void* user_data, size_t size, size_t alignment);
+  void* (*reallocate)(void* user_data, void* ptr, size_t size, size_t alignment);
+  void (*deallocate)(void* user_data, void* ptr, size_t alignment);
+  void* user_data;
+  };
+
+/*
+Installs the allocator that is used by trico_malloc and friends for the whole process, NULL restores the default allocator,
+which uses malloc, realloc and free. Install the allocator before trico allocates anything: memory must be released
+with the allocator that allocated it. Contexts keep the allocator that was installed when they were created.
+*/
+TRICO_API void trico_set_allocator(const struct trico_allocator* allocator);
+TRICO_API void trico_get_allocator(struct trico_allocator* allocator);
+TRICO_API void trico_get_default_allocator(struct trico_allocator* allocator);
+
+TRICO_API void* trico_malloc(size_t size);
+TRICO_API void* trico_calloc(size_t num, size_t size);
+TRICO_API void* trico_realloc(void* ptr, size_t new_size);
+TRICO_API void trico_free(void* ptr);
+
+/*
+Memory with a larger alignment, for instance cache lines or huge pages, is released with trico_aligned_free and the same alignment.
+*/
+TRICO_API void* trico_aligned_malloc(size_t size, size_t alignment);
+TRICO_API void trico_aligned_free(void* ptr, size_t alignment);
 
 #endif // #ifndef TRICO_ALLOC_H
 
 #if defined (__cplusplus)
   }
-#endif // #if defined (__cplusplus)
\ No newline at end of file
+#endif // #if defined (__cplusplus)
@@ -0,0 +1,225 @@
+#include "arena.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define TRICO_ARENA_DEFAULT_BLOCK_SIZE (1024 * 1024)
+
+struct trico_arena_block
+  {
+  struct trico_arena_block* next;
+  uint8_t* data;
+  uint64_t size;
+  uint64_t used;
+  };
+
+struct trico_arena
+  {
+  struct trico_allocator parent; // allocator of the blocks
+  struct trico_arena_block* first;
+  struct trico_arena_block* current;
+  uint64_t block_size;
+  uint8_t* last; // most recent allocation, and the fill level of its block before it was made
+  uint64_t used_before_last;
+  volatile long lock;
+  };
+
+static void lock_arena(struct trico_arena* arena)
+  {
+#ifdef _WIN32
+  while (InterlockedExchange(&arena->lock, 1) != 0)
+    YieldProcessor();
+#else
+  while (__atomic_exchange_n(&arena->lock, 1, __ATOMIC_ACQUIRE) != 0)
+    ;
+#endif
+  }
+
+static void unlock_arena(struct trico_arena* arena)
+  {
+#ifdef _WIN32
+  InterlockedExchange(&arena->lock, 0);
+#else
+  __atomic_store_n(&arena->lock, 0, __ATOMIC_RELEASE);
+#endif
+  }
+
+/*
+Each allocation is preceded by its size, which reallocate needs to copy the contents.
+Returns the aligned address in block for an allocation, or NULL if it does not fit.
+*/
+static uint8_t* fit_in_block(struct trico_arena_block* block, size_t size, size_t alignment)
+  {
+  const uintptr_t start = (uintptr_t)(block->data + block->used + sizeof(uint64_t));
+  const uintptr_t aligned = (start + alignment - 1) & ~((uintptr_t)alignment - 1);
+  if (aligned + size > (uintptr_t)(block->data + block->size))
+    return NULL;
+  return (uint8_t*)aligned;
+  }
+
+static void* allocate_unlocked(struct trico_arena* arena, size_t size, size_t alignment)
+  {
+  uint8_t* ptr = NULL;
+  struct trico_arena_block* block = arena->current;
+  while (block && (ptr = fit_in_block(block, size, alignment)) == NULL)
+    block = block->next;
+  if (ptr == NULL)
+    {
+    uint64_t block_size = (uint64_t)size + alignment + sizeof(uint64_t);
+    if (block_size < arena->block_size)
+      block_size = arena->block_size;
+    block = (struct trico_arena_block*)arena->parent.allocate(arena->parent.user_data, sizeof(struct trico_arena_block) + (size_t)block_size, TRICO_DEFAULT_ALIGNMENT);
+    if (block == NULL)
+      return NULL;
+    block->data = (uint8_t*)(block + 1);
+    block->size = block_size;
+    block->used = 0;
+    if (arena->current)
+      {
+      block->next = arena->current->next;
+      arena->current->next = block;
+      }
+    else
+      {
+      block->next = arena->first;
+      arena->first = block;
+      }
+    ptr = fit_in_block(block, size, alignment);
+    }
+  arena->current = block;
+  arena->last = ptr;
+  arena->used_before_last = block->used;
+  block->used = (uint64_t)(ptr - block->data) + size;
+  const uint64_t size_header = size;
+  memcpy(ptr - sizeof(uint64_t), &size_header, sizeof(uint64_t));
+  return ptr;
+  }
+
+static void* arena_allocate(void* user_data, size_t size, size_t alignment)
+  {
+  struct trico_arena* arena = (struct trico_arena*)user_data;
+  lock_arena(arena);
+  void* ptr = allocate_unlocked(arena, size, alignment);
+  unlock_arena(arena);
+  return ptr;
+  }
+
+static void arena_deallocate(void* user_data, void* ptr, size_t alignment)
+  {
+  (void)alignment;
+  struct trico_arena* arena = (struct trico_arena*)user_data;
+  lock_arena(arena);
+  if (ptr != NULL && ptr == arena->last)
+    {
+    arena->current->used = arena->used_before_last;
+    arena->last = NULL;
+    }
+  unlock_arena(arena);
+  }
+
+static void* arena_reallocate(void* user_data, void* ptr, size_t size, size_t alignment)
+  {
+  struct trico_arena* arena = (struct trico_arena*)user_data;
+  lock_arena(arena);
+  if (ptr == NULL)
+    {
+    ptr = allocate_unlocked(arena, size, alignment);
+    unlock_arena(arena);
+    return ptr;
+    }
+  uint8_t* p = (uint8_t*)ptr;
+  uint64_t old_size;
+  memcpy(&old_size, p - sizeof(uint64_t), sizeof(uint64_t));
+  struct trico_arena_block* block = arena->current;
+  if (p == arena->last && (uint64_t)(p - block->data) + size <= block->size)
+    {
+    // the most recent allocation grows or shrinks in place
+    const uint64_t size_header = size;
+    memcpy(p - sizeof(uint64_t), &size_header, sizeof(uint64_t));
+    block->used = (uint64_t)(p - block->data) + size;
+    unlock_arena(arena);
+    return ptr;
+    }
+  void* new_ptr = allocate_unlocked(arena, size, alignment);
+  if (new_ptr)
+    memcpy(new_ptr, ptr, (size_t)(old_size < size ? old_size : size));
+  unlock_arena(arena);
+  return new_ptr;
+  }
+
+void* trico_create_arena(uint64_t block_size)
+  {
+  struct trico_allocator parent;
+  trico_get_allocator(&parent);
+  struct trico_arena* arena = (struct trico_arena*)parent.allocate(parent.user_data, sizeof(struct trico_arena), TRICO_DEFAULT_ALIGNMENT);
+  if (!arena)
+    return NULL;
+  arena->parent = parent;
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->block_size = block_size ? block_size : TRICO_ARENA_DEFAULT_BLOCK_SIZE;
+  arena->last = NULL;
+  arena->used_before_last = 0;
+  arena->lock = 0;
+  return arena;
+  }
+
+void trico_destroy_arena(void* a)
+  {
+  struct trico_arena* arena = (struct trico_arena*)a;
+  if (!arena)
+    return;
+  struct trico_arena_block* block = arena->first;
+  while (block)
+    {
+    struct trico_arena_block* next = block->next;
+    arena->parent.deallocate(arena->parent.user_data, block, TRICO_DEFAULT_ALIGNMENT);
+    block = next;
+    }
+  struct trico_allocator parent = arena->parent;
+  parent.deallocate(parent.user_data, arena, TRICO_DEFAULT_ALIGNMENT);
+  }
+
+void trico_reset_arena(void* a)
+  {
+  struct trico_arena* arena = (struct trico_arena*)a;
+  lock_arena(arena);
+  for (struct trico_arena_block* block = arena->first; block; block = block->next)
+    block->used = 0;
+  arena->current = arena->first;
+  arena->last = NULL;
+  unlock_arena(arena);
+  }
+
+void trico_get_arena_allocator(void* arena, struct trico_allocator* allocator)
+  {
+  allocator->allocate = arena_allocate;
+  allocator->reallocate = arena_reallocate;
+  allocator->deallocate = arena_deallocate;
+  allocator->user_data = arena;
+  }
+
+uint64_t trico_get_arena_used_size(void* a)
+  {
+  struct trico_arena* arena = (struct trico_arena*)a;
+  uint64_t size = 0;
+  lock_arena(arena);
+  for (struct trico_arena_block* block = arena->first; block; block = block->next)
+    size += block->used;
+  unlock_arena(arena);
+  return size;
+  }
+
+uint64_t trico_get_arena_reserved_size(void* a)
+  {
+  struct trico_arena* arena = (struct trico_arena*)a;
+  uint64_t size = 0;
+  lock_arena(arena);
+  for (struct trico_arena_block* block = arena->first; block; block = block->next)
+    size += block->size;
+  unlock_arena(arena);
+  return size;
+  }
@@ -0,0 +1,44 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_ARENA_H
+#define TRICO_ARENA_H
+
+#include "trico_api.h"
+#include "alloc.h"
+
+#include <stdint.h>
+
+/*
+Bump allocator: allocations are carved out of large blocks and are not released individually, but all at once by trico_reset_arena,
+for instance after each mesh. The blocks are kept over resets, so an arena that is reused stops allocating once it has seen
+the largest mesh. The blocks come from the allocator that is installed when the arena is created.
+block_size is the minimal size of a block, 0 selects a default of 1 MB. Allocations are thread safe.
+*/
+TRICO_API void* trico_create_arena(uint64_t block_size);
+TRICO_API void trico_destroy_arena(void* arena);
+
+/*
+Makes all memory that was allocated from the arena available again. Memory that was handed out before becomes invalid,
+so contexts that use the arena should be destroyed first.
+*/
+TRICO_API void trico_reset_arena(void* arena);
+
+/*
+Returns an allocator that allocates from the arena, for trico_set_allocator or trico_create_context_with_allocator.
+Deallocating does nothing, except for the most recent allocation, which is given back so that growing buffers can reuse it.
+*/
+TRICO_API void trico_get_arena_allocator(void* arena, struct trico_allocator* allocator);
+
+/*
+Number of bytes handed out since the last reset, and the number of bytes of all blocks of the arena.
+*/
+TRICO_API uint64_t trico_get_arena_used_size(void* arena);
+TRICO_API uint64_t trico_get_arena_reserved_size(void* arena);
+
+#endif // #ifndef TRICO_ARENA_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
@@ -0,0 +1,181 @@
+#include "context.h"
+#include "alloc.h"
+
+#include <string.h>
+
+#define LZ4_STATIC_LINKING_ONLY
+#include <lz4/lz4.h>
+#include <lz4/lz4hc.h>
+
+/*
+Hash tables and buffers are aligned to cache lines.
+*/
+#define TRICO_CONTEXT_ALIGNMENT 64
+
+struct trico_context
+  {
+  struct trico_allocator allocator;
+  void* buffers[TRICO_CONTEXT_NUMBER_OF_BUFFERS];
+  uint64_t buffer_sizes[TRICO_CONTEXT_NUMBER_OF_BUFFERS];
+  void* hash_tables[TRICO_CONTEXT_NUMBER_OF_HASH_TABLES];
+  uint64_t hash_table_sizes[TRICO_CONTEXT_NUMBER_OF_HASH_TABLES];
+  void* lz4_state;
+  void* lz4hc_state;
+  struct trico_context** workers; // worker contexts 1, 2, ..., worker 0 is the context itself
+  uint32_t nr_of_workers;
+  };
+
+void* trico_create_context(void)
+  {
+  struct trico_allocator allocator;
+  trico_get_allocator(&allocator);
+  return trico_create_context_with_allocator(&allocator);
+  }
+
+void* trico_create_context_with_allocator(const struct trico_allocator* allocator)
+  {
+  struct trico_context* ctx = (struct trico_context*)allocator->allocate(allocator->user_data, sizeof(struct trico_context), TRICO_DEFAULT_ALIGNMENT);
+  if (!ctx)
+    return NULL;
+  memset(ctx, 0, sizeof(struct trico_context));
+  ctx->allocator = *allocator;
+  return ctx;
+  }
+
+static void deallocate(struct trico_context* ctx, void* ptr, size_t alignment)
+  {
+  if (ptr)
+    ctx->allocator.deallocate(ctx->allocator.user_data, ptr, alignment);
+  }
+
+void trico_release_context_memory(void* context)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  for (uint32_t i = 0; i < TRICO_CONTEXT_NUMBER_OF_BUFFERS; ++i)
+    {
+    deallocate(ctx, ctx->buffers[i], TRICO_CONTEXT_ALIGNMENT);
+    ctx->buffers[i] = NULL;
+    ctx->buffer_sizes[i] = 0;
+    }
+  for (uint32_t i = 0; i < TRICO_CONTEXT_NUMBER_OF_HASH_TABLES; ++i)
+    {
+    deallocate(ctx, ctx->hash_tables[i], TRICO_CONTEXT_ALIGNMENT);
+    ctx->hash_tables[i] = NULL;
+    ctx->hash_table_sizes[i] = 0;
+    }
+  deallocate(ctx, ctx->lz4_state, TRICO_CONTEXT_ALIGNMENT);
+  ctx->lz4_state = NULL;
+  deallocate(ctx, ctx->lz4hc_state, TRICO_CONTEXT_ALIGNMENT);
+  ctx->lz4hc_state = NULL;
+  for (uint32_t t = 1; t < ctx->nr_of_workers; ++t)
+    trico_destroy_context(ctx->workers[t - 1]);
+  deallocate(ctx, ctx->workers, TRICO_DEFAULT_ALIGNMENT);
+  ctx->workers = NULL;
+  ctx->nr_of_workers = 0;
+  }
+
+void trico_destroy_context(void* context)
+  {
+  if (!context)
+    return;
+  trico_release_context_memory(context);
+  struct trico_context* ctx = (struct trico_context*)context;
+  deallocate(ctx, ctx, TRICO_DEFAULT_ALIGNMENT);
+  }
+
+uint64_t trico_get_context_memory_size(void* context)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  uint64_t size = 0;
+  for (uint32_t i = 0; i < TRICO_CONTEXT_NUMBER_OF_HASH_TABLES; ++i)
+    size += ctx->hash_table_sizes[i];
+  for (uint32_t i = 0; i < TRICO_CONTEXT_NUMBER_OF_BUFFERS; ++i)
+    size += ctx->buffer_sizes[i];
+  if (ctx->lz4_state)
+    size += (uint64_t)LZ4_sizeofState();
+  if (ctx->lz4hc_state)
+    size += (uint64_t)LZ4_sizeofStateHC();
+  for (uint32_t t = 1; t < ctx->nr_of_workers; ++t)
+    size += trico_get_context_memory_size(ctx->workers[t - 1]);
+  return size;
+  }
+
+/*
+Grows memory to at least size bytes. The old contents are not needed, so free and malloc instead of realloc, which would copy them.
+*/
+static void* grow(struct trico_context* ctx, void** memory, uint64_t* memory_size, uint64_t size)
+  {
+  if (*memory_size >= size && *memory)
+    return *memory;
+  deallocate(ctx, *memory, TRICO_CONTEXT_ALIGNMENT);
+  *memory = ctx->allocator.allocate(ctx->allocator.user_data, (size_t)(size > 0 ? size : 1), TRICO_CONTEXT_ALIGNMENT);
+  *memory_size = *memory ? size : 0;
+  return *memory;
+  }
+
+void* trico_get_context_buffer(void* context, uint32_t index, uint64_t size)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  if (index >= TRICO_CONTEXT_NUMBER_OF_BUFFERS)
+    return NULL;
+  return grow(ctx, &(ctx->buffers[index]), &(ctx->buffer_sizes[index]), size);
+  }
+
+void* trico_get_context_hash_table(void* context, uint32_t index, uint64_t size)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  if (index >= TRICO_CONTEXT_NUMBER_OF_HASH_TABLES)
+    return NULL;
+  return grow(ctx, &(ctx->hash_tables[index]), &(ctx->hash_table_sizes[index]), size);
+  }
+
+void* trico_get_context_lz4_state(void* context)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  if (ctx->lz4_state == NULL)
+    {
+    ctx->lz4_state = ctx->allocator.allocate(ctx->allocator.user_data, (size_t)LZ4_sizeofState(), TRICO_CONTEXT_ALIGNMENT);
+    if (ctx->lz4_state)
+      LZ4_initStream(ctx->lz4_state, (size_t)LZ4_sizeofState());
+    }
+  return ctx->lz4_state;
+  }
+
+void* trico_get_context_lz4hc_state(void* context)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  if (ctx->lz4hc_state == NULL)
+    ctx->lz4hc_state = ctx->allocator.allocate(ctx->allocator.user_data, (size_t)LZ4_sizeofStateHC(), TRICO_CONTEXT_ALIGNMENT);
+  return ctx->lz4hc_state;
+  }
+
+int trico_reserve_worker_contexts(void* context, uint32_t nr_of_workers)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  if (nr_of_workers <= ctx->nr_of_workers || nr_of_workers <= 1)
+    return 1;
+  const size_t workers_size = (nr_of_workers - 1) * sizeof(struct trico_context*);
+  struct trico_context** workers = (struct trico_context**)(ctx->workers ?
+    ctx->allocator.reallocate(ctx->allocator.user_data, ctx->workers, workers_size, TRICO_DEFAULT_ALIGNMENT) :
+    ctx->allocator.allocate(ctx->allocator.user_data, workers_size, TRICO_DEFAULT_ALIGNMENT));
+  if (workers == NULL)
+    return 0;
+  ctx->workers = workers;
+  uint32_t t = ctx->nr_of_workers > 1 ? ctx->nr_of_workers : 1;
+  for (; t < nr_of_workers; ++t)
+    {
+    ctx->workers[t - 1] = (struct trico_context*)trico_create_context_with_allocator(&(ctx->allocator));
+    if (ctx->workers[t - 1] == NULL)
+      break;
+    }
+  ctx->nr_of_workers = t;
+  return t == nr_of_workers ? 1 : 0;
+  }
+
+void* trico_get_worker_context(void* context, uint32_t worker_index)
+  {
+  struct trico_context* ctx = (struct trico_context*)context;
+  if (worker_index == 0)
+    return ctx;
+  return worker_index < ctx->nr_of_workers ? ctx->workers[worker_index - 1] : NULL;
+  }
@@ -0,0 +1,87 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_CONTEXT_H
+#define TRICO_CONTEXT_H
+
+#include "trico_api.h"
+#include "alloc.h"
+
+#include <stdint.h>
+
+/*
+A context owns the memory that compression and decompression need besides their input and output:
+the hash tables of the float and double codecs, the lz4 state and scratch buffers for transposed planes.
+The memory grows on demand and is kept between calls, so that a context that is reused for many meshes
+stops allocating once it has seen the largest one. A context is not thread safe: use one context per thread.
+*/
+TRICO_API void* trico_create_context(void);
+TRICO_API void trico_destroy_context(void* context);
+
+/*
+Creates a context that takes all its memory from allocator instead of from the allocator of the process (see trico_set_allocator),
+for instance from an arena (see arena.h). The allocator must be thread safe when the context is used with multiple threads.
+*/
+TRICO_API void* trico_create_context_with_allocator(const struct trico_allocator* allocator);
+
+/*
+Releases all memory held by the context. The context remains usable and grows again on demand.
+*/
+TRICO_API void trico_release_context_memory(void* context);
+
+/*
+Returns the number of bytes currently held by the context, including its worker contexts.
+*/
+TRICO_API uint64_t trico_get_context_memory_size(void* context);
+
+/*
+Buffers of a context, each is used by only one party during a call, so that they never overlap:
+the plane buffer holds transposed planes of an archive, the scratch buffer holds trial output of the auto tuning encoder,
+the connectivity of the parallelogram codec or the byte planes of the triangle codec, and the codec buffer is used by the chunked
+codecs for their chunk tables and partially decompressed chunks, by the parallelogram codec for its vertex predictions,
+and by the triangle codec for the neighbours of the triangles. The entropy buffer holds the temporary data of the entropy coder.
+*/
+#define TRICO_CONTEXT_PLANE_BUFFER 0
+#define TRICO_CONTEXT_SCRATCH_BUFFER 1
+#define TRICO_CONTEXT_CODEC_BUFFER 2
+#define TRICO_CONTEXT_ENTROPY_BUFFER 3
+#define TRICO_CONTEXT_NUMBER_OF_BUFFERS 4
+
+/*
+Returns buffer index of the context with room for at least size bytes. The contents are not preserved when the buffer grows.
+Returns NULL if the memory is not available.
+*/
+TRICO_API void* trico_get_context_buffer(void* context, uint32_t index, uint64_t size);
+
+/*
+Returns hash table index of the context with room for at least size bytes. The table is not cleared:
+the codecs clear the part they use before each stream. Returns NULL if the memory is not available.
+The codecs use tables 0 and 1, the interleaved encoders use tables 2c and 2c + 1 for component c.
+*/
+#define TRICO_CONTEXT_NUMBER_OF_HASH_TABLES 8
+
+TRICO_API void* trico_get_context_hash_table(void* context, uint32_t index, uint64_t size);
+
+/*
+Returns an lz4 state for LZ4_compress_fast_extState_fastReset, which is initialized once when the context creates it.
+*/
+TRICO_API void* trico_get_context_lz4_state(void* context);
+
+/*
+Returns a state for LZ4_compress_HC_extStateHC, which the high lz4 levels use. The state is initialized by each compression.
+*/
+TRICO_API void* trico_get_context_lz4hc_state(void* context);
+
+/*
+Worker contexts are used by the threads of trico_parallel_for: worker 0 is the context itself, the other workers are created by
+trico_reserve_worker_contexts, which should be called before the parallel loop. Worker contexts are owned by the context.
+*/
+TRICO_API int trico_reserve_worker_contexts(void* context, uint32_t nr_of_workers);
+TRICO_API void* trico_get_worker_context(void* context, uint32_t worker_index);
+
+#endif // #ifndef TRICO_CONTEXT_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
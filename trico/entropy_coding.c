@@ -0,0 +1,371 @@
+#include "entropy_coding.h"
+#include "context.h"
+#include "lz4_compression.h"
+
+#define LZ4_STATIC_LINKING_ONLY
+#include <lz4/lz4.h>
+
+#include <string.h>
+
+/*
+Compressed format:
+  <uint8 mode><uint32 big endian number of bytes>
+  mode 0 (stored): the bytes
+  mode 1 (rans): the frequency table, 4 uint32 big endian rans states, and the renormalization bytes
+The frequency table lists the scaled frequency of each byte value in order, as 1 byte if it is below 128 and as 2 bytes
+with the top bit set otherwise. A frequency of 0 is followed by the number of further byte values with frequency 0.
+Byte i is coded by state i % 4. The encoder codes the bytes in reverse, so that the decoder reads the renormalization bytes forward.
+*/
+#define TRICO_ENTROPY_MODE_STORED 0
+#define TRICO_ENTROPY_MODE_RANS 1
+#define TRICO_ENTROPY_HEADER_SIZE 5
+#define TRICO_RANS_SCALE_BITS 12
+#define TRICO_RANS_SCALE (1u << TRICO_RANS_SCALE_BITS)
+#define TRICO_RANS_LOWER_BOUND (1u << 23)
+#define TRICO_RANS_MAX_TABLE_SIZE 512
+
+static inline uint32_t trico_entropy_read_uint32_big_endian(const uint8_t* p)
+  {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+  }
+
+static inline void trico_entropy_write_uint32_big_endian(uint8_t* p, uint32_t value)
+  {
+  p[0] = (uint8_t)(value >> 24);
+  p[1] = (uint8_t)(value >> 16);
+  p[2] = (uint8_t)(value >> 8);
+  p[3] = (uint8_t)value;
+  }
+
+/*
+Scales the counts to frequencies that sum to TRICO_RANS_SCALE, keeping a frequency of at least 1 for each byte value that occurs.
+The difference that rounding leaves is taken from or given to the most frequent byte values, which costs the least.
+*/
+static void normalize_frequencies(uint32_t* frequencies, const uint32_t* counts, uint32_t nr_of_bytes)
+  {
+  uint32_t sum = 0;
+  for (uint32_t s = 0; s < 256; ++s)
+    {
+    frequencies[s] = 0;
+    if (counts[s] == 0)
+      continue;
+    frequencies[s] = (uint32_t)(((uint64_t)counts[s] * TRICO_RANS_SCALE) / nr_of_bytes);
+    if (frequencies[s] == 0)
+      frequencies[s] = 1;
+    sum += frequencies[s];
+    }
+  while (sum != TRICO_RANS_SCALE)
+    {
+    uint32_t largest = 0;
+    for (uint32_t s = 1; s < 256; ++s)
+      {
+      if (frequencies[s] > frequencies[largest])
+        largest = s;
+      }
+    const uint32_t step = sum > TRICO_RANS_SCALE ? sum - TRICO_RANS_SCALE : TRICO_RANS_SCALE - sum;
+    const uint32_t room = sum > TRICO_RANS_SCALE ? (frequencies[largest] - 1) / 2 + 1 : step;
+    const uint32_t change = step < room ? step : room;
+    if (sum > TRICO_RANS_SCALE)
+      {
+      frequencies[largest] -= change;
+      sum -= change;
+      }
+    else
+      {
+      frequencies[largest] += change;
+      sum += change;
+      }
+    }
+  }
+
+static uint32_t write_frequency_table(uint8_t* out, const uint32_t* frequencies)
+  {
+  uint8_t* p_out = out;
+  for (uint32_t s = 0; s < 256; ++s)
+    {
+    if (frequencies[s] == 0)
+      {
+      uint32_t run = 0;
+      while (s + 1 + run < 256 && frequencies[s + 1 + run] == 0)
+        ++run;
+      *p_out++ = 0;
+      *p_out++ = (uint8_t)run;
+      s += run;
+      }
+    else if (frequencies[s] < 128)
+      *p_out++ = (uint8_t)frequencies[s];
+    else
+      {
+      *p_out++ = (uint8_t)(0x80 | (frequencies[s] >> 8));
+      *p_out++ = (uint8_t)(frequencies[s] & 0xff);
+      }
+    }
+  return (uint32_t)(p_out - out);
+  }
+
+static const uint8_t* read_frequency_table(uint32_t* frequencies, const uint8_t* p_in, const uint8_t* end)
+  {
+  uint32_t sum = 0;
+  for (uint32_t s = 0; s < 256; ++s)
+    {
+    if (p_in >= end)
+      return NULL;
+    const uint8_t b = *p_in++;
+    if (b == 0)
+      {
+      if (p_in >= end)
+        return NULL;
+      const uint32_t run = *p_in++;
+      if (s + run >= 256)
+        return NULL;
+      for (uint32_t r = 0; r <= run; ++r)
+        frequencies[s + r] = 0;
+      s += run;
+      }
+    else if (b < 128)
+      frequencies[s] = b;
+    else
+      {
+      if (p_in >= end)
+        return NULL;
+      frequencies[s] = ((uint32_t)(b & 0x7f) << 8) | *p_in++;
+      }
+    sum += frequencies[s];
+    }
+  return sum == TRICO_RANS_SCALE ? p_in : NULL;
+  }
+
+static inline void trico_rans_encode(uint32_t* state, uint8_t** p_out, uint32_t frequency, uint32_t start)
+  {
+  uint32_t x = *state;
+  const uint32_t x_max = ((TRICO_RANS_LOWER_BOUND >> TRICO_RANS_SCALE_BITS) << 8) * frequency;
+  while (x >= x_max)
+    {
+    *--(*p_out) = (uint8_t)(x & 0xff);
+    x >>= 8;
+    }
+  *state = ((x / frequency) << TRICO_RANS_SCALE_BITS) + (x % frequency) + start;
+  }
+
+uint64_t trico_entropy_compress_bound(uint32_t nr_of_bytes)
+  {
+  return TRICO_ENTROPY_HEADER_SIZE + (uint64_t)nr_of_bytes;
+  }
+
+static uint32_t store(uint8_t* out, const uint8_t* input, uint32_t nr_of_bytes)
+  {
+  out[0] = TRICO_ENTROPY_MODE_STORED;
+  trico_entropy_write_uint32_big_endian(out + 1, nr_of_bytes);
+  memcpy(out + TRICO_ENTROPY_HEADER_SIZE, input, nr_of_bytes);
+  return TRICO_ENTROPY_HEADER_SIZE + nr_of_bytes;
+  }
+
+uint32_t trico_entropy_compress_into(uint8_t* out, const uint8_t* input, uint32_t nr_of_bytes)
+  {
+  uint32_t counts[256] = { 0 };
+  for (uint32_t i = 0; i < nr_of_bytes; ++i)
+    ++counts[input[i]];
+  if (nr_of_bytes == 0)
+    return store(out, input, nr_of_bytes);
+  uint32_t frequencies[256];
+  normalize_frequencies(frequencies, counts, nr_of_bytes);
+  uint8_t table[TRICO_RANS_MAX_TABLE_SIZE];
+  const uint32_t table_size = write_frequency_table(table, frequencies);
+  // the rans data should end before the stored data would, else the bytes are stored
+  if ((uint64_t)table_size + 16 >= nr_of_bytes)
+    return store(out, input, nr_of_bytes);
+  uint32_t starts[256];
+  uint32_t start = 0;
+  for (uint32_t s = 0; s < 256; ++s)
+    {
+    starts[s] = start;
+    start += frequencies[s];
+    }
+
+  uint8_t* data = out + TRICO_ENTROPY_HEADER_SIZE + table_size + 16;
+  uint8_t* end = out + TRICO_ENTROPY_HEADER_SIZE + nr_of_bytes;
+  uint8_t* p_out = end;
+  uint32_t states[4] = { TRICO_RANS_LOWER_BOUND, TRICO_RANS_LOWER_BOUND, TRICO_RANS_LOWER_BOUND, TRICO_RANS_LOWER_BOUND };
+  for (uint32_t i = nr_of_bytes; i > 0; --i)
+    {
+    const uint8_t s = input[i - 1];
+    trico_rans_encode(&states[(i - 1) & 3], &p_out, frequencies[s], starts[s]);
+    // a renormalization writes at most 2 bytes, so this check keeps the output after data
+    if (p_out < data + 2)
+      return store(out, input, nr_of_bytes);
+    }
+  const uint32_t nr_of_data_bytes = (uint32_t)(end - p_out);
+  memmove(data, p_out, nr_of_data_bytes);
+
+  out[0] = TRICO_ENTROPY_MODE_RANS;
+  trico_entropy_write_uint32_big_endian(out + 1, nr_of_bytes);
+  memcpy(out + TRICO_ENTROPY_HEADER_SIZE, table, table_size);
+  for (uint32_t k = 0; k < 4; ++k)
+    trico_entropy_write_uint32_big_endian(out + TRICO_ENTROPY_HEADER_SIZE + table_size + 4 * k, states[k]);
+  return TRICO_ENTROPY_HEADER_SIZE + table_size + 16 + nr_of_data_bytes;
+  }
+
+uint32_t trico_get_number_of_entropy_coded_bytes(const uint8_t* compressed)
+  {
+  return trico_entropy_read_uint32_big_endian(compressed + 1);
+  }
+
+/*
+Decoding table entry of a slot: the symbol, its frequency, and the start of its slots.
+*/
+struct trico_rans_slot
+  {
+  uint16_t frequency;
+  uint16_t start;
+  uint8_t symbol;
+  };
+
+static inline int trico_rans_decode(uint32_t* state, uint8_t* out, const struct trico_rans_slot* slots, const uint8_t** p_in, const uint8_t* end)
+  {
+  uint32_t x = *state;
+  const struct trico_rans_slot* slot = &slots[x & (TRICO_RANS_SCALE - 1)];
+  *out = slot->symbol;
+  x = slot->frequency * (x >> TRICO_RANS_SCALE_BITS) + (x & (TRICO_RANS_SCALE - 1)) - slot->start;
+  while (x < TRICO_RANS_LOWER_BOUND)
+    {
+    if (*p_in >= end)
+      return 0;
+    x = (x << 8) | *(*p_in)++;
+    }
+  *state = x;
+  return 1;
+  }
+
+int trico_entropy_decompress_into(uint8_t* out, const uint8_t* compressed, uint32_t nr_of_compressed_bytes)
+  {
+  if (nr_of_compressed_bytes < TRICO_ENTROPY_HEADER_SIZE)
+    return 0;
+  const uint32_t nr_of_bytes = trico_get_number_of_entropy_coded_bytes(compressed);
+  const uint8_t* p_in = compressed + TRICO_ENTROPY_HEADER_SIZE;
+  const uint8_t* end = compressed + nr_of_compressed_bytes;
+  if (compressed[0] == TRICO_ENTROPY_MODE_STORED)
+    {
+    if ((uint64_t)(end - p_in) != nr_of_bytes)
+      return 0;
+    memcpy(out, p_in, nr_of_bytes);
+    return 1;
+    }
+  if (compressed[0] != TRICO_ENTROPY_MODE_RANS)
+    return 0;
+
+  uint32_t frequencies[256];
+  p_in = read_frequency_table(frequencies, p_in, end);
+  if (!p_in || end - p_in < 16)
+    return 0;
+  struct trico_rans_slot slots[TRICO_RANS_SCALE];
+  uint32_t start = 0;
+  for (uint32_t s = 0; s < 256; ++s)
+    {
+    for (uint32_t k = 0; k < frequencies[s]; ++k)
+      {
+      slots[start + k].frequency = (uint16_t)frequencies[s];
+      slots[start + k].start = (uint16_t)start;
+      slots[start + k].symbol = (uint8_t)s;
+      }
+    start += frequencies[s];
+    }
+  uint32_t states[4];
+  for (uint32_t k = 0; k < 4; ++k)
+    {
+    states[k] = trico_entropy_read_uint32_big_endian(p_in + 4 * k);
+    if (states[k] < TRICO_RANS_LOWER_BOUND)
+      return 0;
+    }
+  p_in += 16;
+
+  const uint32_t nr_of_quads = nr_of_bytes / 4;
+  for (uint32_t q = 0; q < nr_of_quads; ++q)
+    {
+    uint8_t* quad = out + 4 * (uint64_t)q;
+    if (!trico_rans_decode(&states[0], quad, slots, &p_in, end) ||
+      !trico_rans_decode(&states[1], quad + 1, slots, &p_in, end) ||
+      !trico_rans_decode(&states[2], quad + 2, slots, &p_in, end) ||
+      !trico_rans_decode(&states[3], quad + 3, slots, &p_in, end))
+      return 0;
+    }
+  for (uint32_t i = 4 * nr_of_quads; i < nr_of_bytes; ++i)
+    {
+    if (!trico_rans_decode(&states[i & 3], out + i, slots, &p_in, end))
+      return 0;
+    }
+  // the encoder started all states at the lower bound, so corrupt data ends elsewhere
+  return p_in == end && states[0] == TRICO_RANS_LOWER_BOUND && states[1] == TRICO_RANS_LOWER_BOUND &&
+    states[2] == TRICO_RANS_LOWER_BOUND && states[3] == TRICO_RANS_LOWER_BOUND;
+  }
+
+uint64_t trico_compress_byte_plane_bound(uint32_t nr_of_bytes)
+  {
+  return 1 + (uint64_t)LZ4_COMPRESSBOUND(nr_of_bytes);
+  }
+
+uint32_t trico_compress_byte_plane_into_with_context(void* context, uint8_t* out, const uint8_t* plane, uint32_t nr_of_bytes, int lz4_level)
+  {
+  if (nr_of_bytes > LZ4_MAX_INPUT_SIZE)
+    return 0;
+  const uint32_t nr_of_lz4_bytes = trico_lz4_compress_into_with_context(context, out + 1, plane, nr_of_bytes, lz4_level);
+  if (!nr_of_lz4_bytes)
+    return 0;
+  const uint64_t rans_bound = trico_entropy_compress_bound(nr_of_bytes);
+  uint8_t* rans = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_ENTROPY_BUFFER, rans_bound + trico_entropy_compress_bound(nr_of_lz4_bytes));
+  if (!rans)
+    return 0;
+  uint8_t* lz4_rans = rans + rans_bound;
+  const uint32_t nr_of_rans_bytes = trico_entropy_compress_into(rans, plane, nr_of_bytes);
+  const uint32_t nr_of_lz4_rans_bytes = trico_entropy_compress_into(lz4_rans, out + 1, nr_of_lz4_bytes);
+  out[0] = TRICO_ENTROPY_METHOD_NONE;
+  uint32_t size = nr_of_lz4_bytes;
+  if (nr_of_lz4_rans_bytes < size)
+    {
+    out[0] = TRICO_ENTROPY_METHOD_RANS;
+    size = nr_of_lz4_rans_bytes;
+    memcpy(out + 1, lz4_rans, size);
+    }
+  if (nr_of_rans_bytes < size)
+    {
+    out[0] = TRICO_ENTROPY_METHOD_RANS_UNCOMPRESSED;
+    size = nr_of_rans_bytes;
+    memcpy(out + 1, rans, size);
+    }
+  return 1 + size;
+  }
+
+int trico_decompress_byte_plane_into_with_context(void* context, uint8_t* plane, uint32_t nr_of_bytes, const uint8_t* compressed, uint32_t nr_of_compressed_bytes)
+  {
+  if (nr_of_compressed_bytes < 1 || nr_of_bytes > LZ4_MAX_INPUT_SIZE)
+    return 0;
+  const uint8_t* data = compressed + 1;
+  uint32_t nr_of_data_bytes = nr_of_compressed_bytes - 1;
+  switch (compressed[0])
+    {
+    case TRICO_ENTROPY_METHOD_NONE:
+      break;
+    case TRICO_ENTROPY_METHOD_RANS:
+      {
+      if (nr_of_data_bytes < TRICO_ENTROPY_HEADER_SIZE)
+        return 0;
+      const uint32_t nr_of_lz4_bytes = trico_get_number_of_entropy_coded_bytes(data);
+      if (nr_of_lz4_bytes > LZ4_COMPRESSBOUND(nr_of_bytes))
+        return 0;
+      uint8_t* lz4_data = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_ENTROPY_BUFFER, nr_of_lz4_bytes);
+      if (!lz4_data && nr_of_lz4_bytes)
+        return 0;
+      if (!trico_entropy_decompress_into(lz4_data, data, nr_of_data_bytes))
+        return 0;
+      data = lz4_data;
+      nr_of_data_bytes = nr_of_lz4_bytes;
+      break;
+      }
+    case TRICO_ENTROPY_METHOD_RANS_UNCOMPRESSED:
+      if (nr_of_data_bytes < TRICO_ENTROPY_HEADER_SIZE || trico_get_number_of_entropy_coded_bytes(data) != nr_of_bytes)
+        return 0;
+      return trico_entropy_decompress_into(plane, data, nr_of_data_bytes);
+    default:
+      return 0;
+    }
+  return LZ4_decompress_safe((const char*)data, (char*)plane, (int)nr_of_data_bytes, (int)nr_of_bytes) == (int)nr_of_bytes;
+  }
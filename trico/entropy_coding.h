@@ -0,0 +1,57 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_ENTROPY_CODING_H
+#define TRICO_ENTROPY_CODING_H
+
+#include "trico_api.h"
+
+#include <stdint.h>
+
+/*
+Order 0 entropy coding of bytes with a static rANS coder: the byte frequencies are stored in front of the data,
+scaled to 12 bits, and the bytes are coded by 4 interleaved rANS states, so that the decoder has 4 independent
+dependency chains and looks up each symbol in a single table. Data that does not get smaller is stored as it is.
+out needs room for trico_entropy_compress_bound(nr_of_bytes) bytes. Returns the number of compressed bytes.
+*/
+TRICO_API uint64_t trico_entropy_compress_bound(uint32_t nr_of_bytes);
+
+TRICO_API uint32_t trico_entropy_compress_into(uint8_t* out, const uint8_t* input, uint32_t nr_of_bytes);
+
+TRICO_API uint32_t trico_get_number_of_entropy_coded_bytes(const uint8_t* compressed);
+
+/*
+Decompresses the nr_of_compressed_bytes of compressed into out, which needs room for trico_get_number_of_entropy_coded_bytes(compressed) bytes.
+Returns 0 if the compressed data is invalid.
+*/
+TRICO_API int trico_entropy_decompress_into(uint8_t* out, const uint8_t* compressed, uint32_t nr_of_compressed_bytes);
+
+/*
+Entropy coding methods of a byte plane, stored in its first byte: lz4 alone, rans coding of the lz4 data, or rans coding of the
+plane itself. lz4 removes repeated sequences and rans skewed byte statistics, so which is best depends on the plane.
+*/
+#define TRICO_ENTROPY_METHOD_NONE 0
+#define TRICO_ENTROPY_METHOD_RANS 1
+#define TRICO_ENTROPY_METHOD_RANS_UNCOMPRESSED 2
+
+/*
+Compresses a byte plane with the method that gives the smallest output, as <uint8 method><data>, with lz4 at lz4_level (see lz4_compression.h).
+The context provides the lz4 state and its entropy buffer. out needs room for trico_compress_byte_plane_bound(nr_of_bytes) bytes. Returns the number of compressed bytes,
+or 0 if the memory is not available or the plane is too large for lz4.
+*/
+TRICO_API uint64_t trico_compress_byte_plane_bound(uint32_t nr_of_bytes);
+
+TRICO_API uint32_t trico_compress_byte_plane_into_with_context(void* context, uint8_t* out, const uint8_t* plane, uint32_t nr_of_bytes, int lz4_level);
+
+/*
+Decompresses the nr_of_compressed_bytes of compressed into the nr_of_bytes of plane. Returns 0 if the compressed data is invalid,
+does not hold nr_of_bytes bytes, or the memory is not available.
+*/
+TRICO_API int trico_decompress_byte_plane_into_with_context(void* context, uint8_t* plane, uint32_t nr_of_bytes, const uint8_t* compressed, uint32_t nr_of_compressed_bytes);
+
+#endif // #ifndef TRICO_ENTROPY_CODING_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
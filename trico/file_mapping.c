@@ -0,0 +1,119 @@
+#include "file_mapping.h"
+#include "alloc.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct trico_mapped_file
+  {
+  const uint8_t* data;
+  uint64_t size;
+#ifdef _WIN32
+  HANDLE file;
+  HANDLE mapping;
+#endif
+  };
+
+void* trico_map_file(const char* filename)
+  {
+  struct trico_mapped_file* mf = (struct trico_mapped_file*)trico_malloc(sizeof(struct trico_mapped_file));
+  if (!mf)
+    return NULL;
+  mf->data = NULL;
+  mf->size = 0;
+#ifdef _WIN32
+  mf->mapping = NULL;
+  mf->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (mf->file == INVALID_HANDLE_VALUE)
+    {
+    trico_free(mf);
+    return NULL;
+    }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(mf->file, &file_size))
+    {
+    CloseHandle(mf->file);
+    trico_free(mf);
+    return NULL;
+    }
+  mf->size = (uint64_t)file_size.QuadPart;
+  if (mf->size > 0) // empty files cannot be mapped
+    {
+    mf->mapping = CreateFileMappingA(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mf->mapping)
+      mf->data = (const uint8_t*)MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mf->data)
+      {
+      if (mf->mapping)
+        CloseHandle(mf->mapping);
+      CloseHandle(mf->file);
+      trico_free(mf);
+      return NULL;
+      }
+    }
+#else
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    {
+    trico_free(mf);
+    return NULL;
+    }
+  struct stat st;
+  if (fstat(fd, &st) != 0)
+    {
+    close(fd);
+    trico_free(mf);
+    return NULL;
+    }
+  mf->size = (uint64_t)st.st_size;
+  if (mf->size > 0) // empty files cannot be mapped
+    {
+    void* data = mmap(NULL, (size_t)mf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+      {
+      close(fd);
+      trico_free(mf);
+      return NULL;
+      }
+    mf->data = (const uint8_t*)data;
+    }
+  close(fd); // the mapping stays valid after closing the file
+#endif
+  return mf;
+  }
+
+const uint8_t* trico_get_mapped_data(void* mapped_file)
+  {
+  struct trico_mapped_file* mf = (struct trico_mapped_file*)mapped_file;
+  return mf->data;
+  }
+
+uint64_t trico_get_mapped_size(void* mapped_file)
+  {
+  struct trico_mapped_file* mf = (struct trico_mapped_file*)mapped_file;
+  return mf->size;
+  }
+
+void trico_unmap_file(void* mapped_file)
+  {
+  struct trico_mapped_file* mf = (struct trico_mapped_file*)mapped_file;
+  if (!mf)
+    return;
+#ifdef _WIN32
+  if (mf->data)
+    UnmapViewOfFile(mf->data);
+  if (mf->mapping)
+    CloseHandle(mf->mapping);
+  CloseHandle(mf->file);
+#else
+  if (mf->data)
+    munmap((void*)mf->data, (size_t)mf->size);
+#endif
+  trico_free(mf);
+  }
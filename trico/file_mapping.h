@@ -0,0 +1,24 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_FILE_MAPPING_H
+#define TRICO_FILE_MAPPING_H
+
+#include "trico_api.h"
+#include <stdint.h>
+
+/*
+Maps a file read-only into memory, so that only the pages that are actually accessed are read from disk.
+Returns NULL if the file cannot be opened or mapped.
+*/
+TRICO_API void* trico_map_file(const char* filename);
+TRICO_API const uint8_t* trico_get_mapped_data(void* mapped_file);
+TRICO_API uint64_t trico_get_mapped_size(void* mapped_file);
+TRICO_API void trico_unmap_file(void* mapped_file);
+
+#endif // #ifndef TRICO_FILE_MAPPING_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
@@ -1,6 +1,12 @@
 #include "floating_point_stream_compression.h"
 
 #include "alloc.h"
+#include "context.h"
+#include "entropy_coding.h"
+#include "mesh_connectivity.h"
+#include "parallel.h"
+
+#include <string.h>
 
 /*
 High Throughput Compression of Double-Precision Floating-Point Data.
@@ -9,68 +15,59 @@ Martin Burtscher and Paruj Ratanaworabhan.
 Adapted to 32-bit floating point values.
 */
 
+/*
+Number of residual bytes that is stored for each 3-bit code.
+Codes 1 to 4 store the residual of the fcm predictor, codes 5 to 7 the residual of the dfcm predictor.
+*/
+static const uint32_t trico_code_length[8] = { 0, 1, 2, 3, 4, 1, 2, 3 };
+
+/*
+Returns the number of bytes needed for x, i.e. the number of leading zero bytes is 4 minus the result.
+*/
+static inline uint32_t trico_get_number_of_significant_bytes(uint32_t x)
+  {
+  return (uint32_t)(x > 0) + (uint32_t)(x > 0xff) + (uint32_t)(x > 0xffff) + (uint32_t)(x > 0xffffff);
+  }
+
+/*
+Selects the code of a value from the residuals of both predictors. The dfcm residual is only used if it needs fewer bytes,
+and a residual of 0 bytes is only stored for the fcm predictor.
+*/
+static inline uint32_t trico_get_code(uint32_t xor1, uint32_t xor2)
+  {
+  const uint32_t length1 = trico_get_number_of_significant_bytes(xor1);
+  uint32_t length2 = trico_get_number_of_significant_bytes(xor2);
+  length2 += (uint32_t)(length2 == 0);
+  return length2 < length1 ? 4 + length2 : length1;
+  }
+
+/*
+Writes the 24-bit code of a group of 8 values, followed by the residual bytes of the values (big endian).
+The residuals are written branchless: each residual is shifted to the top of a 4-byte big endian store,
+and the output pointer only advances by the length of the code. The store can thus write up to 3 bytes
+past the last residual, which trico_compress_max_size accounts for.
+*/
 static inline void trico_fill_code(uint8_t** out, uint32_t* xor1, uint32_t* xor2, uint32_t* bcode)
   {
   uint32_t bc = (bcode[7] << 21) | (bcode[6] << 18) | (bcode[5] << 15) | (bcode[4] << 12) | (bcode[3] << 9) | (bcode[2] << 6) | (bcode[1] << 3) | bcode[0];
 
-  *(*out)++ = (uint8_t)(bc >> 16);
-  *(*out)++ = (uint8_t)((bc >> 8) & 0xff);
-  *(*out)++ = (uint8_t)(bc & 0xff);
+  uint8_t* p_out = *out;
+  *p_out++ = (uint8_t)(bc >> 16);
+  *p_out++ = (uint8_t)((bc >> 8) & 0xff);
+  *p_out++ = (uint8_t)(bc & 0xff);
 
   for (uint32_t k = 0; k < 8; ++k)
     {
-    switch (bcode[k])
-      {
-      case 0:
-      {
-      break;
-      }
-      case 1:
-      {
-      *(*out)++ = (uint8_t)(xor1[k]);
-      break;
-      }
-      case 2:
-      {
-      *(*out)++ = (uint8_t)((xor1[k] >> 8) & 0xff);
-      *(*out)++ = (uint8_t)((xor1[k]) & 0xff);
-      break;
-      }
-      case 3:
-      {
-      *(*out)++ = (uint8_t)((xor1[k] >> 16));
-      *(*out)++ = (uint8_t)((xor1[k] >> 8) & 0xff);
-      *(*out)++ = (uint8_t)((xor1[k]) & 0xff);
-      break;
-      }
-      case 4:
-      {
-      *(*out)++ = (uint8_t)((xor1[k] >> 24));
-      *(*out)++ = (uint8_t)((xor1[k] >> 16) & 0xff);
-      *(*out)++ = (uint8_t)((xor1[k] >> 8) & 0xff);
-      *(*out)++ = (uint8_t)((xor1[k]) & 0xff);
-      break;
-      }
-      case 5:
-      {
-      *(*out)++ = (uint8_t)(xor2[k]);
-      break;
-      }
-      case 6:
-      {
-      *(*out)++ = (uint8_t)((xor2[k] >> 8) & 0xff);
-      *(*out)++ = (uint8_t)((xor2[k]) & 0xff);
-      break;
-      }
-      case 7:
-      {
-      *(*out)++ = (uint8_t)((xor2[k] >> 16));
-      *(*out)++ = (uint8_t)((xor2[k] >> 8) & 0xff);
-      *(*out)++ = (uint8_t)((xor2[k]) & 0xff);
-      break;
-      }
-      }
+    const uint32_t length = trico_code_length[bcode[k]];
+    const uint32_t residual = bcode[k] > 4 ? xor2[k] : xor1[k];
+    const uint32_t aligned = (uint32_t)((uint64_t)residual << (32 - 8 * length));
+    p_out[0] = (uint8_t)(aligned >> 24);
+    p_out[1] = (uint8_t)((aligned >> 16) & 0xff);
+    p_out[2] = (uint8_t)((aligned >> 8) & 0xff);
+    p_out[3] = (uint8_t)(aligned & 0xff);
+    p_out += length;
     }
+  *out = p_out;
   }
 
 static inline uint32_t trico_compute_hash1_32(uint32_t hash, uint32_t value, uint32_t hash_size_exponent, uint32_t hash_mask)
@@ -83,40 +80,89 @@ static inline uint32_t trico_compute_hash2_32(uint32_t hash, uint32_t value, uin
   return ((hash << (hash_size_exponent / 2)) ^ (value >> (32 - hash_size_exponent))) & hash_mask;
   }
 
-void trico_compress(uint32_t* nr_of_compressed_bytes, uint8_t** out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent)
+static inline uint32_t trico_normalize_hash_size_exponent(uint32_t hash_size_exponent)
   {
-  hash1_size_exponent = (hash1_size_exponent >> 1) << 1;
-  hash2_size_exponent = (hash2_size_exponent >> 1) << 1;
-  if (hash1_size_exponent > 30)
-    hash1_size_exponent = 30;
-  if (hash2_size_exponent > 30)
-    hash2_size_exponent = 30;
+  hash_size_exponent = (hash_size_exponent >> 1) << 1;
+  return hash_size_exponent > 30 ? 30 : hash_size_exponent;
+  }
 
-  uint32_t max_size = (number_of_floats) * sizeof(float) + 3 * (number_of_floats + 7) / 8 + (number_of_floats & 7); // theoretical maximum
-  *out = (uint8_t*)trico_malloc(max_size);
+/*
+Returns hash table index of the context, cleared for a table of 2^hash_size_exponent entries.
+*/
+static void* trico_get_cleared_hash_table(void* context, uint32_t index, uint32_t hash_size_exponent, size_t entry_size)
+  {
+  const size_t size = ((size_t)1 << hash_size_exponent) * entry_size;
+  void* hash_table = trico_get_context_hash_table(context, index, size);
+  if (hash_table)
+    memset(hash_table, 0, size);
+  return hash_table;
+  }
 
+static inline uint32_t trico_read_uint32_big_endian(const uint8_t* p)
+  {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | ((uint32_t)p[3]);
+  }
 
-  const uint32_t hash1_size = 1 << hash1_size_exponent;
-  const uint32_t hash2_size = 1 << hash2_size_exponent;
-  const uint32_t hash1_mask = hash1_size - 1;
-  const uint32_t hash2_mask = hash2_size - 1;
+static inline void trico_write_uint32_big_endian(uint8_t* p, uint32_t value)
+  {
+  p[0] = (uint8_t)(value >> 24);
+  p[1] = (uint8_t)((value >> 16) & 0xff);
+  p[2] = (uint8_t)((value >> 8) & 0xff);
+  p[3] = (uint8_t)(value & 0xff);
+  }
 
-  uint32_t* hash_table_1 = (uint32_t*)trico_calloc(hash1_size, 4);
-  uint32_t* hash_table_2 = (uint32_t*)trico_calloc(hash2_size, 4);
+static inline uint64_t trico_compress_max_size(uint32_t number_of_floats)
+  {
+  // header + a 3 byte code per group of 8 values + 4 bytes per value + at most 7 padding bytes in the last group
+  // + 3 bytes for the last store of trico_fill_code
+  return 5 + 3 * (((uint64_t)number_of_floats + 7) / 8) + (uint64_t)number_of_floats * sizeof(float) + 7 + 3;
+  }
 
-  uint32_t value;
-  uint32_t stride;
-  uint32_t last_value = 0;
-  uint32_t hash1 = 0;
-  uint32_t hash2 = 0;
-  uint32_t prediction1 = 0;
-  uint32_t prediction2 = 0;
+/*
+Reads a residual of length bytes (big endian). This always reads 4 bytes, so up to 3 bytes past the residual.
+*/
+static inline uint32_t trico_read_residual(const uint8_t* p, uint32_t length)
+  {
+  return (uint32_t)((uint64_t)trico_read_uint32_big_endian(p) >> (32 - 8 * length));
+  }
+
+/*
+State of the float encoder between calls of trico_encode_floats, so that a stream can be encoded in pieces,
+for instance a tile of one component of an interleaved array at a time.
+*/
+struct trico_float_encoder
+  {
+  uint32_t* hash_table_1;
+  uint32_t* hash_table_2;
+  uint32_t hash1_size_exponent;
+  uint32_t hash2_size_exponent;
+  uint32_t last_value;
+  uint32_t hash1;
+  uint32_t hash2;
+  uint32_t prediction1;
+  uint32_t prediction2;
   uint32_t xor1[8];
   uint32_t xor2[8];
   uint32_t bcode[8];
-  uint32_t j = 0;
-  uint8_t* p_out = *out;
+  uint32_t j; // number of values in the current group of 8
+  uint8_t* out;
+  uint8_t* p_out;
+  };
 
+/*
+Starts a stream of number_of_floats values in out, which should be able to contain trico_compress_max_size(number_of_floats) bytes.
+The hash tables should be zero-initialized and sized according to the (normalized) exponents.
+*/
+static void trico_begin_float_encoder(struct trico_float_encoder* encoder, uint8_t* out, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t* hash_table_1, uint32_t* hash_table_2)
+  {
+  memset(encoder, 0, sizeof(struct trico_float_encoder));
+  encoder->hash_table_1 = hash_table_1;
+  encoder->hash_table_2 = hash_table_2;
+  encoder->hash1_size_exponent = hash1_size_exponent;
+  encoder->hash2_size_exponent = hash2_size_exponent;
+  encoder->out = out;
+
+  uint8_t* p_out = out;
   uint8_t hash_info = (uint8_t)(((hash1_size_exponent >> 1) << 4) | (hash2_size_exponent >> 1));
   *p_out++ = hash_info;
 
@@ -124,11 +170,39 @@ void trico_compress(uint32_t* nr_of_compressed_bytes, uint8_t** out, const float
   *p_out++ = (uint8_t)((number_of_floats >> 16) & 0xff);
   *p_out++ = (uint8_t)((number_of_floats >> 8) & 0xff);
   *p_out++ = (uint8_t)((number_of_floats) & 0xff);
+  encoder->p_out = p_out;
+  }
+
+/*
+Encodes the next count values of the stream, value i is read from input[i * input_stride].
+The state is kept in locals during the loop, so that the compiler can keep it in registers.
+*/
+static void trico_encode_floats(struct trico_float_encoder* encoder, const float* input, uint32_t input_stride, uint32_t count)
+  {
+  const uint32_t hash1_size_exponent = encoder->hash1_size_exponent;
+  const uint32_t hash2_size_exponent = encoder->hash2_size_exponent;
+  const uint32_t hash1_mask = (1 << hash1_size_exponent) - 1;
+  const uint32_t hash2_mask = (1 << hash2_size_exponent) - 1;
+  uint32_t* hash_table_1 = encoder->hash_table_1;
+  uint32_t* hash_table_2 = encoder->hash_table_2;
 
-  for (uint32_t i = 0; i < number_of_floats; ++i)
+  uint32_t value;
+  uint32_t stride;
+  uint32_t last_value = encoder->last_value;
+  uint32_t hash1 = encoder->hash1;
+  uint32_t hash2 = encoder->hash2;
+  uint32_t prediction1 = encoder->prediction1;
+  uint32_t prediction2 = encoder->prediction2;
+  uint32_t* xor1 = encoder->xor1;
+  uint32_t* xor2 = encoder->xor2;
+  uint32_t* bcode = encoder->bcode;
+  uint32_t j = encoder->j;
+  uint8_t* p_out = encoder->p_out;
+
+  for (uint32_t i = 0; i < count; ++i)
     {
-    j = i & 7;
-    value = *(const uint32_t*)(input++);
+    value = *(const uint32_t*)(input);
+    input += input_stride;
 
     xor1[j] = value ^ prediction1;
     hash_table_1[hash1] = value;
@@ -143,73 +217,135 @@ void trico_compress(uint32_t* nr_of_compressed_bytes, uint8_t** out, const float
     prediction2 = hash_table_2[hash2];
 
 
-    bcode[j] = 4; // 4 bytes
-    if (0 == xor1[j])
-      {
-      bcode[j] = 0; // 0 bytes
-      }
-    else if (0 == (xor1[j] >> 8))
-      {
-      bcode[j] = 1; // 1 byte
-      }
-    else if (0 == (xor1[j] >> 16))
-      {
-      bcode[j] = 2; // 2 bytes
-      if (0 == (xor2[j] >> 8))
-        {
-        bcode[j] = 5; // 1 byte
-        }
-      }
-    else if (0 == (xor1[j] >> 24))
-      {
-      bcode[j] = 3; // 3 bytes
-      if (0 == (xor2[j] >> 8))
-        {
-        bcode[j] = 5; // 1 byte
-        }
-      else if (0 == (xor2[j] >> 16))
-        {
-        bcode[j] = 6; // 2 bytes
-        }
-      }
-    else // 4 bytes
+    bcode[j] = trico_get_code(xor1[j], xor2[j]);
+
+    if (++j == 8)
       {
-      if (0 == (xor2[j] >> 8))
-        {
-        bcode[j] = 5; // 1 byte
-        }
-      else if (0 == (xor2[j] >> 16))
-        {
-        bcode[j] = 6; // 2 bytes
-        }
-      else if (0 == (xor2[j] >> 24))
-        {
-        bcode[j] = 7; // 3 bytes
-        }
+      trico_fill_code(&p_out, xor1, xor2, bcode);
+      j = 0;
       }
+    }
 
-    if (j == 7)
+  encoder->last_value = last_value;
+  encoder->hash1 = hash1;
+  encoder->hash2 = hash2;
+  encoder->prediction1 = prediction1;
+  encoder->prediction2 = prediction2;
+  encoder->j = j;
+  encoder->p_out = p_out;
+  }
+
+/*
+Writes the last incomplete group of the stream. Returns the number of compressed bytes.
+*/
+static uint32_t trico_end_float_encoder(struct trico_float_encoder* encoder)
+  {
+  if (encoder->j)
+    {
+    for (uint32_t l = encoder->j; l < 8; ++l)
       {
-      trico_fill_code(&p_out, xor1, xor2, bcode);
+      encoder->bcode[l] = 1;
+      encoder->xor1[l] = 0;
       }
+    trico_fill_code(&(encoder->p_out), encoder->xor1, encoder->xor2, encoder->bcode);
     }
-  for (uint32_t l = j + 1; l < 8; ++l)
+  return (uint32_t)(encoder->p_out - encoder->out);
+  }
+
+/*
+Compresses number_of_floats values to out, which should be able to contain trico_compress_max_size(number_of_floats) bytes.
+The hash tables should be zero-initialized and sized according to the (normalized) exponents.
+Returns the number of compressed bytes.
+*/
+static uint32_t trico_compress_core(uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t* hash_table_1, uint32_t* hash_table_2)
+  {
+  struct trico_float_encoder encoder;
+  trico_begin_float_encoder(&encoder, out, number_of_floats, hash1_size_exponent, hash2_size_exponent, hash_table_1, hash_table_2);
+  trico_encode_floats(&encoder, input, 1, number_of_floats);
+  return trico_end_float_encoder(&encoder);
+  }
+
+uint64_t trico_compress_bound(uint32_t number_of_floats)
+  {
+  return 5 + 3 * (((uint64_t)number_of_floats + 7) / 8) + 4 * (uint64_t)number_of_floats + 7 + 3;
+  }
+
+uint32_t trico_compress_into(uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent)
+  {
+  hash1_size_exponent = trico_normalize_hash_size_exponent(hash1_size_exponent);
+  hash2_size_exponent = trico_normalize_hash_size_exponent(hash2_size_exponent);
+
+  uint32_t* hash_table_1 = (uint32_t*)trico_calloc((size_t)1 << hash1_size_exponent, 4);
+  uint32_t* hash_table_2 = (uint32_t*)trico_calloc((size_t)1 << hash2_size_exponent, 4);
+
+  uint32_t nr_of_compressed_bytes = trico_compress_core(out, input, number_of_floats, hash1_size_exponent, hash2_size_exponent, hash_table_1, hash_table_2);
+
+  trico_free(hash_table_1);
+  trico_free(hash_table_2);
+  return nr_of_compressed_bytes;
+  }
+
+uint32_t trico_compress_into_with_context(void* context, uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent)
+  {
+  hash1_size_exponent = trico_normalize_hash_size_exponent(hash1_size_exponent);
+  hash2_size_exponent = trico_normalize_hash_size_exponent(hash2_size_exponent);
+
+  uint32_t* hash_table_1 = (uint32_t*)trico_get_cleared_hash_table(context, 0, hash1_size_exponent, 4);
+  uint32_t* hash_table_2 = (uint32_t*)trico_get_cleared_hash_table(context, 1, hash2_size_exponent, 4);
+  if (!hash_table_1 || !hash_table_2)
+    return 0;
+
+  return trico_compress_core(out, input, number_of_floats, hash1_size_exponent, hash2_size_exponent, hash_table_1, hash_table_2);
+  }
+
+/*
+Number of values per component that the interleaved encoders take from the input at a time. A tile of 2048 vertices
+of 3 floats or doubles stays in cache, so it is loaded from memory only once for the encoders of all components.
+*/
+#define TRICO_INTERLEAVED_TILE_SIZE 2048
+
+int trico_compress_interleaved_into_with_context(void* context, uint8_t** out, uint32_t* nr_of_compressed_bytes, const float* input, uint32_t nr_of_components, const uint32_t number_of_values, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent)
+  {
+  if (nr_of_components == 0 || nr_of_components > TRICO_MAX_INTERLEAVED_COMPONENTS)
+    return 0;
+  hash1_size_exponent = trico_normalize_hash_size_exponent(hash1_size_exponent);
+  hash2_size_exponent = trico_normalize_hash_size_exponent(hash2_size_exponent);
+
+  struct trico_float_encoder encoders[TRICO_MAX_INTERLEAVED_COMPONENTS];
+  for (uint32_t c = 0; c < nr_of_components; ++c)
     {
-    bcode[l] = 1;
-    xor1[l] = 0;
+    uint32_t* hash_table_1 = (uint32_t*)trico_get_cleared_hash_table(context, 2 * c, hash1_size_exponent, 4);
+    uint32_t* hash_table_2 = (uint32_t*)trico_get_cleared_hash_table(context, 2 * c + 1, hash2_size_exponent, 4);
+    if (!hash_table_1 || !hash_table_2)
+      return 0;
+    trico_begin_float_encoder(&encoders[c], out[c], number_of_values, hash1_size_exponent, hash2_size_exponent, hash_table_1, hash_table_2);
     }
-  if (j != 7)
+
+  for (uint32_t first = 0; first < number_of_values; first += TRICO_INTERLEAVED_TILE_SIZE)
     {
-    trico_fill_code(&p_out, xor1, xor2, bcode);
+    const uint32_t count = number_of_values - first < TRICO_INTERLEAVED_TILE_SIZE ? number_of_values - first : TRICO_INTERLEAVED_TILE_SIZE;
+    const float* tile = input + (uint64_t)first * nr_of_components;
+    for (uint32_t c = 0; c < nr_of_components; ++c)
+      trico_encode_floats(&encoders[c], tile + c, nr_of_components, count);
     }
 
-  *nr_of_compressed_bytes = (uint32_t)(p_out - *out);
-  trico_free(hash_table_1);
-  trico_free(hash_table_2);
+  for (uint32_t c = 0; c < nr_of_components; ++c)
+    nr_of_compressed_bytes[c] = trico_end_float_encoder(&encoders[c]);
+  return 1;
+  }
+
+void trico_compress(uint32_t* nr_of_compressed_bytes, uint8_t** out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent)
+  {
+  *out = (uint8_t*)trico_malloc(trico_compress_bound(number_of_floats));
+  *nr_of_compressed_bytes = trico_compress_into(*out, input, number_of_floats, hash1_size_exponent, hash2_size_exponent);
   *out = (uint8_t*)trico_realloc(*out, *nr_of_compressed_bytes);
   }
 
-void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* compressed)
+/*
+Decompresses the values in compressed to out, value i is written to out[i * out_stride].
+The hash tables should be zero-initialized and large enough for the exponents stored in the first byte of compressed.
+*/
+static void trico_decompress_core(float* out, uint32_t out_stride, const uint8_t* compressed, uint32_t* hash_table_1, uint32_t* hash_table_2)
   {
   uint8_t hash_info = *compressed++;
 
@@ -221,14 +357,8 @@ void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* co
   const uint32_t hash1_mask = hash1_size - 1;
   const uint32_t hash2_mask = hash2_size - 1;
 
-  uint32_t* hash_table_1 = (uint32_t*)trico_calloc(hash1_size, 4);
-  uint32_t* hash_table_2 = (uint32_t*)trico_calloc(hash2_size, 4);
-
-  *number_of_floats = ((uint32_t)(*compressed++)) << 24;
-  *number_of_floats |= ((uint32_t)(*compressed++)) << 16;
-  *number_of_floats |= ((uint32_t)(*compressed++)) << 8;
-  *number_of_floats |= ((uint32_t)(*compressed++));
-  *out = (float*)trico_malloc(*number_of_floats * sizeof(float));
+  const uint32_t number_of_floats = trico_read_uint32_big_endian(compressed);
+  compressed += 4;
 
   uint32_t bc;
   uint32_t bcode[8];
@@ -240,15 +370,29 @@ void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* co
   uint32_t prediction2 = 0;
   uint32_t stride;
   uint32_t last_value = 0;
-  uint32_t* p_out = (uint32_t*)(*out);
+  uint32_t* p_out = (uint32_t*)out;
 
-  const uint32_t cnt = *number_of_floats / 8;
+  const uint32_t cnt = number_of_floats / 8;
+  // The residuals of a group are gathered with 4-byte loads, that read up to 3 bytes past the group. This is safe as long as
+  // another group follows, so only the last group is decoded byte by byte, when there is no partial group after it.
+  const uint32_t cnt_gather = (number_of_floats & 7) || cnt == 0 ? cnt : cnt - 1;
   for (uint32_t q = 0; q < cnt; ++q)
     {
     bc = ((uint32_t)(*compressed++)) << 16;
     bc |= ((uint32_t)(*compressed++)) << 8;
     bc |= (*compressed++);
-    for (int j = 0; j < 8; ++j)
+    if (q < cnt_gather)
+      {
+      for (int j = 0; j < 8; ++j)
+        {
+        const uint32_t b = (bc >> (j * 3)) & 7;
+        const uint32_t length = trico_code_length[b];
+        bcode[j] = b;
+        xor[j] = trico_read_residual(compressed, length);
+        compressed += length;
+        }
+      }
+    else for (int j = 0; j < 8; ++j)
       {
       uint8_t b = (bc >> (j * 3)) & 7;
       bcode[j] = b;
@@ -307,8 +451,7 @@ void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* co
       }
     for (int j = 0; j < 8; ++j)
       {
-      if (bcode[j] > 4)
-        prediction1 = prediction2;
+      prediction1 = bcode[j] > 4 ? prediction2 : prediction1;
 
       value = xor[j] ^ prediction1;
 
@@ -322,11 +465,12 @@ void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* co
       prediction2 = value + hash_table_2[hash2];
       last_value = value;
 
-      *p_out++ = value;
+      *p_out = value;
+      p_out += out_stride;
       }
     }
 
-  if (*number_of_floats & 7)
+  if (number_of_floats & 7)
     {
     bc = ((uint32_t)(*compressed++)) << 16;
     bc |= ((uint32_t)(*compressed++)) << 8;
@@ -393,8 +537,7 @@ void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* co
       }
     for (int j = 0; j < max_j; ++j)
       {
-      if (bcode[j] > 4)
-        prediction1 = prediction2;
+      prediction1 = bcode[j] > 4 ? prediction2 : prediction1;
 
       value = xor[j] ^ prediction1;
 
@@ -408,14 +551,55 @@ void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* co
       prediction2 = value + hash_table_2[hash2];
       last_value = value;
 
-      *p_out++ = value;
+      *p_out = value;
+      p_out += out_stride;
       }
     }
+  }
+
+void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* compressed)
+  {
+  const uint8_t hash_info = compressed[0];
+  uint32_t* hash_table_1 = (uint32_t*)trico_calloc((size_t)1 << ((hash_info >> 4) << 1), 4);
+  uint32_t* hash_table_2 = (uint32_t*)trico_calloc((size_t)1 << ((hash_info & 15) << 1), 4);
+
+  *number_of_floats = trico_read_uint32_big_endian(compressed + 1);
+  *out = (float*)trico_malloc(*number_of_floats * sizeof(float));
+
+  trico_decompress_core(*out, 1, compressed, hash_table_1, hash_table_2);
+
+  trico_free(hash_table_1);
+  trico_free(hash_table_2);
+  }
+
+void trico_decompress_into(float* out, uint32_t out_stride, const uint8_t* compressed)
+  {
+  const uint8_t hash_info = compressed[0];
+  uint32_t* hash_table_1 = (uint32_t*)trico_calloc((size_t)1 << ((hash_info >> 4) << 1), 4);
+  uint32_t* hash_table_2 = (uint32_t*)trico_calloc((size_t)1 << ((hash_info & 15) << 1), 4);
+
+  trico_decompress_core(out, out_stride, compressed, hash_table_1, hash_table_2);
 
   trico_free(hash_table_1);
   trico_free(hash_table_2);
   }
 
+void trico_decompress_into_with_context(void* context, float* out, uint32_t out_stride, const uint8_t* compressed)
+  {
+  const uint8_t hash_info = compressed[0];
+  uint32_t* hash_table_1 = (uint32_t*)trico_get_cleared_hash_table(context, 0, (uint32_t)(hash_info >> 4) << 1, 4);
+  uint32_t* hash_table_2 = (uint32_t*)trico_get_cleared_hash_table(context, 1, (uint32_t)(hash_info & 15) << 1, 4);
+  if (!hash_table_1 || !hash_table_2)
+    return;
+
+  trico_decompress_core(out, out_stride, compressed, hash_table_1, hash_table_2);
+  }
+
+uint32_t trico_get_number_of_compressed_values(const uint8_t* compressed)
+  {
+  return trico_read_uint32_big_endian(compressed + 1);
+  }
+
 
 
 static inline void trico_fill_code_double(uint8_t** out, uint64_t* xor1, uint64_t* xor2, uint64_t* bcode)
@@ -573,39 +757,44 @@ static inline uint64_t trico_compute_hash2_64(uint64_t hash, uint64_t value, uin
   }
 
 
-void trico_compress_double_precision(uint32_t* nr_of_compressed_bytes, uint8_t** out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent)
+static inline uint64_t trico_compress_double_precision_max_size(uint32_t number_of_doubles)
   {
-  hash1_size_exponent = (hash1_size_exponent >> 1) << 1;
-  hash2_size_exponent = (hash2_size_exponent >> 1) << 1;
-  if (hash1_size_exponent > 30)
-    hash1_size_exponent = 30;
-  if (hash2_size_exponent > 30)
-    hash2_size_exponent = 30;
-
-  uint32_t max_size = (number_of_doubles) * sizeof(double) + (number_of_doubles) / 2 + (number_of_doubles & 1); // theoretical maximum
-  *out = (uint8_t*)trico_malloc(max_size);
-
-  const uint64_t hash1_size = (uint64_t)1 << hash1_size_exponent;
-  const uint64_t hash2_size = (uint64_t)1 << hash2_size_exponent;
-  const uint64_t hash1_mask = hash1_size - 1;
-  const uint64_t hash2_mask = hash2_size - 1;
-
-  uint64_t* hash_table_1 = (uint64_t*)trico_calloc(hash1_size, 8);
-  uint64_t* hash_table_2 = (uint64_t*)trico_calloc(hash2_size, 8);
+  // header + a 1 byte code per pair of values + 8 bytes per value + at most 1 padding byte in the last pair
+  return 5 + ((uint64_t)number_of_doubles + 1) / 2 + (uint64_t)number_of_doubles * sizeof(double) + 1;
+  }
 
-  uint64_t value;
-  uint64_t stride;
-  uint64_t last_value = 0;
-  uint64_t hash1 = 0;
-  uint64_t hash2 = 0;
-  uint64_t prediction1 = 0;
-  uint64_t prediction2 = 0;
+/*
+Double precision counterpart of struct trico_float_encoder.
+*/
+struct trico_double_encoder
+  {
+  uint64_t* hash_table_1;
+  uint64_t* hash_table_2;
+  uint64_t hash1_size_exponent;
+  uint64_t hash2_size_exponent;
+  uint64_t last_value;
+  uint64_t hash1;
+  uint64_t hash2;
+  uint64_t prediction1;
+  uint64_t prediction2;
   uint64_t xor1[2];
   uint64_t xor2[2];
   uint64_t bcode[2];
-  uint32_t j = 0;
-  uint8_t* p_out = *out;
+  uint32_t j; // number of values in the current pair
+  uint8_t* out;
+  uint8_t* p_out;
+  };
 
+static void trico_begin_double_encoder(struct trico_double_encoder* encoder, uint8_t* out, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint64_t* hash_table_1, uint64_t* hash_table_2)
+  {
+  memset(encoder, 0, sizeof(struct trico_double_encoder));
+  encoder->hash_table_1 = hash_table_1;
+  encoder->hash_table_2 = hash_table_2;
+  encoder->hash1_size_exponent = hash1_size_exponent;
+  encoder->hash2_size_exponent = hash2_size_exponent;
+  encoder->out = out;
+
+  uint8_t* p_out = out;
   uint8_t hash_info = (uint8_t)(((hash1_size_exponent >> 1) << 4) | (hash2_size_exponent >> 1));
   *p_out++ = hash_info;
 
@@ -613,11 +802,35 @@ void trico_compress_double_precision(uint32_t* nr_of_compressed_bytes, uint8_t**
   *p_out++ = (uint8_t)((number_of_doubles >> 16) & 0xff);
   *p_out++ = (uint8_t)((number_of_doubles >> 8) & 0xff);
   *p_out++ = (uint8_t)((number_of_doubles) & 0xff);
+  encoder->p_out = p_out;
+  }
+
+static void trico_encode_doubles(struct trico_double_encoder* encoder, const double* input, uint32_t input_stride, uint32_t count)
+  {
+  const uint64_t hash1_size_exponent = encoder->hash1_size_exponent;
+  const uint64_t hash2_size_exponent = encoder->hash2_size_exponent;
+  const uint64_t hash1_mask = ((uint64_t)1 << hash1_size_exponent) - 1;
+  const uint64_t hash2_mask = ((uint64_t)1 << hash2_size_exponent) - 1;
+  uint64_t* hash_table_1 = encoder->hash_table_1;
+  uint64_t* hash_table_2 = encoder->hash_table_2;
 
-  for (uint32_t i = 0; i < number_of_doubles; ++i)
+  uint64_t value;
+  uint64_t stride;
+  uint64_t last_value = encoder->last_value;
+  uint64_t hash1 = encoder->hash1;
+  uint64_t hash2 = encoder->hash2;
+  uint64_t prediction1 = encoder->prediction1;
+  uint64_t prediction2 = encoder->prediction2;
+  uint64_t* xor1 = encoder->xor1;
+  uint64_t* xor2 = encoder->xor2;
+  uint64_t* bcode = encoder->bcode;
+  uint32_t j = encoder->j;
+  uint8_t* p_out = encoder->p_out;
+
+  for (uint32_t i = 0; i < count; ++i)
     {
-    j = i & 1;
-    value = *(const uint64_t*)(input++);
+    value = *(const uint64_t*)(input);
+    input += input_stride;
 
     xor1[j] = value ^ prediction1;
     hash_table_1[hash1] = value;
@@ -781,26 +994,119 @@ void trico_compress_double_precision(uint32_t* nr_of_compressed_bytes, uint8_t**
         }
       }
 
-    if (j == 1)
+    if (++j == 2)
       {
       trico_fill_code_double(&p_out, xor1, xor2, bcode);
+      j = 0;
       }
     }
-  if (j == 0)
-    {
-    bcode[1] = 1;
-    xor1[1] = 0;
-    trico_fill_code_double(&p_out, xor1, xor2, bcode);
-    }
 
-  *nr_of_compressed_bytes = (uint32_t)(p_out - *out);
-  trico_free(hash_table_1);
-  trico_free(hash_table_2);
-  *out = (uint8_t*)trico_realloc(*out, *nr_of_compressed_bytes);
+  encoder->last_value = last_value;
+  encoder->hash1 = hash1;
+  encoder->hash2 = hash2;
+  encoder->prediction1 = prediction1;
+  encoder->prediction2 = prediction2;
+  encoder->j = j;
+  encoder->p_out = p_out;
   }
 
+static uint32_t trico_end_double_encoder(struct trico_double_encoder* encoder)
+  {
+  if (encoder->j)
+    {
+    encoder->bcode[1] = 1;
+    encoder->xor1[1] = 0;
+    trico_fill_code_double(&(encoder->p_out), encoder->xor1, encoder->xor2, encoder->bcode);
+    }
+  return (uint32_t)(encoder->p_out - encoder->out);
+  }
 
-void trico_decompress_double_precision(uint32_t* number_of_doubles, double** out, const uint8_t* compressed)
+/*
+Double precision counterpart of trico_compress_core.
+*/
+static uint32_t trico_compress_double_precision_core(uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint64_t* hash_table_1, uint64_t* hash_table_2)
+  {
+  struct trico_double_encoder encoder;
+  trico_begin_double_encoder(&encoder, out, number_of_doubles, hash1_size_exponent, hash2_size_exponent, hash_table_1, hash_table_2);
+  trico_encode_doubles(&encoder, input, 1, number_of_doubles);
+  return trico_end_double_encoder(&encoder);
+  }
+
+uint64_t trico_compress_double_precision_bound(uint32_t number_of_doubles)
+  {
+  return 5 + ((uint64_t)number_of_doubles + 1) / 2 + 8 * (uint64_t)number_of_doubles + 1;
+  }
+
+uint32_t trico_compress_double_precision_into(uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent)
+  {
+  uint32_t hash1_exponent = trico_normalize_hash_size_exponent((uint32_t)(hash1_size_exponent > 30 ? 30 : hash1_size_exponent));
+  uint32_t hash2_exponent = trico_normalize_hash_size_exponent((uint32_t)(hash2_size_exponent > 30 ? 30 : hash2_size_exponent));
+
+  uint64_t* hash_table_1 = (uint64_t*)trico_calloc((size_t)1 << hash1_exponent, 8);
+  uint64_t* hash_table_2 = (uint64_t*)trico_calloc((size_t)1 << hash2_exponent, 8);
+
+  uint32_t nr_of_compressed_bytes = trico_compress_double_precision_core(out, input, number_of_doubles, hash1_exponent, hash2_exponent, hash_table_1, hash_table_2);
+
+  trico_free(hash_table_1);
+  trico_free(hash_table_2);
+  return nr_of_compressed_bytes;
+  }
+
+uint32_t trico_compress_double_precision_into_with_context(void* context, uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent)
+  {
+  uint32_t hash1_exponent = trico_normalize_hash_size_exponent((uint32_t)(hash1_size_exponent > 30 ? 30 : hash1_size_exponent));
+  uint32_t hash2_exponent = trico_normalize_hash_size_exponent((uint32_t)(hash2_size_exponent > 30 ? 30 : hash2_size_exponent));
+
+  uint64_t* hash_table_1 = (uint64_t*)trico_get_cleared_hash_table(context, 0, hash1_exponent, 8);
+  uint64_t* hash_table_2 = (uint64_t*)trico_get_cleared_hash_table(context, 1, hash2_exponent, 8);
+  if (!hash_table_1 || !hash_table_2)
+    return 0;
+
+  return trico_compress_double_precision_core(out, input, number_of_doubles, hash1_exponent, hash2_exponent, hash_table_1, hash_table_2);
+  }
+
+int trico_compress_interleaved_double_precision_into_with_context(void* context, uint8_t** out, uint32_t* nr_of_compressed_bytes, const double* input, uint32_t nr_of_components, const uint32_t number_of_values, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent)
+  {
+  if (nr_of_components == 0 || nr_of_components > TRICO_MAX_INTERLEAVED_COMPONENTS)
+    return 0;
+  uint32_t hash1_exponent = trico_normalize_hash_size_exponent((uint32_t)(hash1_size_exponent > 30 ? 30 : hash1_size_exponent));
+  uint32_t hash2_exponent = trico_normalize_hash_size_exponent((uint32_t)(hash2_size_exponent > 30 ? 30 : hash2_size_exponent));
+
+  struct trico_double_encoder encoders[TRICO_MAX_INTERLEAVED_COMPONENTS];
+  for (uint32_t c = 0; c < nr_of_components; ++c)
+    {
+    uint64_t* hash_table_1 = (uint64_t*)trico_get_cleared_hash_table(context, 2 * c, hash1_exponent, 8);
+    uint64_t* hash_table_2 = (uint64_t*)trico_get_cleared_hash_table(context, 2 * c + 1, hash2_exponent, 8);
+    if (!hash_table_1 || !hash_table_2)
+      return 0;
+    trico_begin_double_encoder(&encoders[c], out[c], number_of_values, hash1_exponent, hash2_exponent, hash_table_1, hash_table_2);
+    }
+
+  for (uint32_t first = 0; first < number_of_values; first += TRICO_INTERLEAVED_TILE_SIZE)
+    {
+    const uint32_t count = number_of_values - first < TRICO_INTERLEAVED_TILE_SIZE ? number_of_values - first : TRICO_INTERLEAVED_TILE_SIZE;
+    const double* tile = input + (uint64_t)first * nr_of_components;
+    for (uint32_t c = 0; c < nr_of_components; ++c)
+      trico_encode_doubles(&encoders[c], tile + c, nr_of_components, count);
+    }
+
+  for (uint32_t c = 0; c < nr_of_components; ++c)
+    nr_of_compressed_bytes[c] = trico_end_double_encoder(&encoders[c]);
+  return 1;
+  }
+
+void trico_compress_double_precision(uint32_t* nr_of_compressed_bytes, uint8_t** out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent)
+  {
+  *out = (uint8_t*)trico_malloc(trico_compress_double_precision_bound(number_of_doubles));
+  *nr_of_compressed_bytes = trico_compress_double_precision_into(*out, input, number_of_doubles, hash1_size_exponent, hash2_size_exponent);
+  *out = (uint8_t*)trico_realloc(*out, *nr_of_compressed_bytes);
+  }
+
+
+/*
+Double precision counterpart of trico_decompress_core.
+*/
+static void trico_decompress_double_precision_core(double* out, uint32_t out_stride, const uint8_t* compressed, uint64_t* hash_table_1, uint64_t* hash_table_2)
   {
   uint8_t hash_info = *compressed++;
 
@@ -812,14 +1118,8 @@ void trico_decompress_double_precision(uint32_t* number_of_doubles, double** out
   const uint64_t hash1_mask = hash1_size - 1;
   const uint64_t hash2_mask = hash2_size - 1;
 
-  uint64_t* hash_table_1 = (uint64_t*)trico_calloc(hash1_size, 8);
-  uint64_t* hash_table_2 = (uint64_t*)trico_calloc(hash2_size, 8);
-
-  *number_of_doubles = ((uint32_t)(*compressed++)) << 24;
-  *number_of_doubles |= ((uint32_t)(*compressed++)) << 16;
-  *number_of_doubles |= ((uint32_t)(*compressed++)) << 8;
-  *number_of_doubles |= ((uint32_t)(*compressed++));
-  *out = (double*)trico_malloc(*number_of_doubles * sizeof(double));
+  const uint32_t number_of_doubles = trico_read_uint32_big_endian(compressed);
+  compressed += 4;
 
   uint64_t bc;
   uint64_t bcode[2];
@@ -831,9 +1131,9 @@ void trico_decompress_double_precision(uint32_t* number_of_doubles, double** out
   uint64_t prediction2 = 0;
   uint64_t stride;
   uint64_t last_value = 0;
-  uint64_t* p_out = (uint64_t*)(*out);
+  uint64_t* p_out = (uint64_t*)out;
 
-  const uint32_t cnt = *number_of_doubles / 2;
+  const uint32_t cnt = number_of_doubles / 2;
   for (uint32_t q = 0; q < cnt; ++q)
     {
     bc = ((uint32_t)(*compressed++));
@@ -991,11 +1291,12 @@ void trico_decompress_double_precision(uint32_t* number_of_doubles, double** out
       prediction2 = value + hash_table_2[hash2];
       last_value = value;
 
-      *p_out++ = value;
+      *p_out = value;
+      p_out += out_stride;
       }
     }
 
-  if (*number_of_doubles & 1)
+  if (number_of_doubles & 1)
     {
     bc = ((uint32_t)(*compressed++));
     int max_j = 2;
@@ -1155,11 +1456,747 @@ void trico_decompress_double_precision(uint32_t* number_of_doubles, double** out
       prediction2 = value + hash_table_2[hash2];
       last_value = value;
 
-      *p_out++ = value;
+      *p_out = value;
+      p_out += out_stride;
       }
     }
 
+  }
+
+void trico_decompress_double_precision(uint32_t* number_of_doubles, double** out, const uint8_t* compressed)
+  {
+  const uint8_t hash_info = compressed[0];
+  uint64_t* hash_table_1 = (uint64_t*)trico_calloc((size_t)1 << ((hash_info >> 4) << 1), 8);
+  uint64_t* hash_table_2 = (uint64_t*)trico_calloc((size_t)1 << ((hash_info & 15) << 1), 8);
+
+  *number_of_doubles = trico_read_uint32_big_endian(compressed + 1);
+  *out = (double*)trico_malloc(*number_of_doubles * sizeof(double));
+
+  trico_decompress_double_precision_core(*out, 1, compressed, hash_table_1, hash_table_2);
+
+  trico_free(hash_table_1);
+  trico_free(hash_table_2);
+  }
+
+void trico_decompress_double_precision_into(double* out, uint32_t out_stride, const uint8_t* compressed)
+  {
+  const uint8_t hash_info = compressed[0];
+  uint64_t* hash_table_1 = (uint64_t*)trico_calloc((size_t)1 << ((hash_info >> 4) << 1), 8);
+  uint64_t* hash_table_2 = (uint64_t*)trico_calloc((size_t)1 << ((hash_info & 15) << 1), 8);
+
+  trico_decompress_double_precision_core(out, out_stride, compressed, hash_table_1, hash_table_2);
+
   trico_free(hash_table_1);
   trico_free(hash_table_2);
   }
-  
\ No newline at end of file
+
+void trico_decompress_double_precision_into_with_context(void* context, double* out, uint32_t out_stride, const uint8_t* compressed)
+  {
+  const uint8_t hash_info = compressed[0];
+  uint64_t* hash_table_1 = (uint64_t*)trico_get_cleared_hash_table(context, 0, (uint32_t)(hash_info >> 4) << 1, 8);
+  uint64_t* hash_table_2 = (uint64_t*)trico_get_cleared_hash_table(context, 1, (uint32_t)(hash_info & 15) << 1, 8);
+  if (!hash_table_1 || !hash_table_2)
+    return;
+
+  trico_decompress_double_precision_core(out, out_stride, compressed, hash_table_1, hash_table_2);
+  }
+
+
+
+/*
+Chunked streams have the following layout (all integers big endian):
+
+  uint32_t number of values
+  uint32_t chunk size (number of values per chunk, the last chunk can be smaller)
+  uint32_t offsets[number of chunks + 1] (offset of each chunk relative to the end of the offset table, the last offset equals the total chunk data size)
+  chunk data, where each chunk is a regular trico_compress stream
+*/
+
+static inline uint32_t trico_get_number_of_chunks(uint32_t number_of_values, uint32_t chunk_size)
+  {
+  return (uint32_t)(((uint64_t)number_of_values + chunk_size - 1) / chunk_size);
+  }
+
+/*
+A chunk size of 0, or larger than the number of values, gives a single chunk of all values.
+*/
+static inline uint32_t trico_clamp_chunk_size(uint32_t number_of_values, uint32_t chunk_size)
+  {
+  if (chunk_size == 0 || chunk_size > number_of_values)
+    return number_of_values > 0 ? number_of_values : 1;
+  return chunk_size;
+  }
+
+static inline uint32_t trico_get_chunked_header_size(uint32_t nr_of_chunks)
+  {
+  return 8 + 4 * (nr_of_chunks + 1);
+  }
+
+static void trico_write_chunked_header(uint8_t* out, uint32_t number_of_values, uint32_t chunk_size, uint32_t nr_of_chunks, const uint32_t* chunk_sizes)
+  {
+  trico_write_uint32_big_endian(out, number_of_values);
+  trico_write_uint32_big_endian(out + 4, chunk_size);
+  uint32_t offset = 0;
+  for (uint32_t c = 0; c < nr_of_chunks; ++c)
+    {
+    trico_write_uint32_big_endian(out + 8 + 4 * c, offset);
+    offset += chunk_sizes[c];
+    }
+  trico_write_uint32_big_endian(out + 8 + 4 * nr_of_chunks, offset);
+  }
+
+/*
+Compacts the chunks, that were compressed at a fixed stride of chunk_max_size bytes after the header, and fills in the header.
+Returns the total number of bytes.
+*/
+static uint32_t trico_finalize_chunked(uint8_t* out, uint32_t number_of_values, uint32_t chunk_size, uint32_t nr_of_chunks, const uint32_t* chunk_sizes, uint64_t chunk_max_size)
+  {
+  const uint32_t header_size = trico_get_chunked_header_size(nr_of_chunks);
+  uint8_t* p_out = out + header_size;
+  for (uint32_t c = 0; c < nr_of_chunks; ++c)
+    {
+    memmove(p_out, out + header_size + (uint64_t)c * chunk_max_size, chunk_sizes[c]);
+    p_out += chunk_sizes[c];
+    }
+  trico_write_chunked_header(out, number_of_values, chunk_size, nr_of_chunks, chunk_sizes);
+  return (uint32_t)(p_out - out);
+  }
+
+struct trico_compress_chunked_data
+  {
+  const void* input;
+  uint8_t* out;
+  uint32_t* chunk_sizes;
+  void* context; // provides the hash tables of each thread through its worker contexts
+  uint32_t number_of_values;
+  uint32_t chunk_size;
+  uint64_t chunk_max_size;
+  uint32_t header_size;
+  uint32_t hash1_size_exponent;
+  uint32_t hash2_size_exponent;
+  };
+
+static void trico_compress_chunk(void* user_data, uint32_t chunk, uint32_t thread_index)
+  {
+  struct trico_compress_chunked_data* data = (struct trico_compress_chunked_data*)user_data;
+  const uint32_t first = chunk * data->chunk_size;
+  const uint32_t last = data->number_of_values - first < data->chunk_size ? data->number_of_values : first + data->chunk_size;
+  void* context = trico_get_worker_context(data->context, thread_index);
+  uint32_t* hash_table_1 = (uint32_t*)trico_get_cleared_hash_table(context, 0, data->hash1_size_exponent, 4);
+  uint32_t* hash_table_2 = (uint32_t*)trico_get_cleared_hash_table(context, 1, data->hash2_size_exponent, 4);
+  uint8_t* p_out = data->out + data->header_size + (uint64_t)chunk * data->chunk_max_size;
+  data->chunk_sizes[chunk] = trico_compress_core(p_out, (const float*)data->input + first, last - first, data->hash1_size_exponent, data->hash2_size_exponent, hash_table_1, hash_table_2);
+  }
+
+static void trico_compress_chunk_double_precision(void* user_data, uint32_t chunk, uint32_t thread_index)
+  {
+  struct trico_compress_chunked_data* data = (struct trico_compress_chunked_data*)user_data;
+  const uint32_t first = chunk * data->chunk_size;
+  const uint32_t last = data->number_of_values - first < data->chunk_size ? data->number_of_values : first + data->chunk_size;
+  void* context = trico_get_worker_context(data->context, thread_index);
+  uint64_t* hash_table_1 = (uint64_t*)trico_get_cleared_hash_table(context, 0, data->hash1_size_exponent, 8);
+  uint64_t* hash_table_2 = (uint64_t*)trico_get_cleared_hash_table(context, 1, data->hash2_size_exponent, 8);
+  uint8_t* p_out = data->out + data->header_size + (uint64_t)chunk * data->chunk_max_size;
+  data->chunk_sizes[chunk] = trico_compress_double_precision_core(p_out, (const double*)data->input + first, last - first, data->hash1_size_exponent, data->hash2_size_exponent, hash_table_1, hash_table_2);
+  }
+
+static uint64_t trico_get_chunk_max_size(uint32_t chunk_size, int double_precision)
+  {
+  return double_precision ? trico_compress_double_precision_max_size(chunk_size) : trico_compress_max_size(chunk_size);
+  }
+
+static uint64_t trico_compress_chunked_bound_generic(uint32_t number_of_values, uint32_t chunk_size, int double_precision)
+  {
+  chunk_size = trico_clamp_chunk_size(number_of_values, chunk_size);
+  const uint32_t nr_of_chunks = trico_get_number_of_chunks(number_of_values, chunk_size);
+  return trico_get_chunked_header_size(nr_of_chunks) + (uint64_t)nr_of_chunks * trico_get_chunk_max_size(chunk_size, double_precision);
+  }
+
+uint64_t trico_compress_chunked_bound(uint32_t number_of_floats, uint32_t chunk_size)
+  {
+  return trico_compress_chunked_bound_generic(number_of_floats, chunk_size, 0);
+  }
+
+uint64_t trico_compress_chunked_double_precision_bound(uint32_t number_of_doubles, uint32_t chunk_size)
+  {
+  return trico_compress_chunked_bound_generic(number_of_doubles, chunk_size, 1);
+  }
+
+/*
+Makes sure that the worker contexts exist and that their hash tables are allocated, so that the tasks of trico_parallel_for
+only look up memory that is already there. Returns the context itself, or a new context that the caller should destroy if context is NULL.
+*/
+static void* trico_prepare_worker_contexts(void* context, uint32_t nr_of_workers, uint64_t hash_table_1_size, uint64_t hash_table_2_size)
+  {
+  void* ctx = context ? context : trico_create_context();
+  if (!ctx)
+    return NULL;
+  int ok = trico_reserve_worker_contexts(ctx, nr_of_workers);
+  for (uint32_t t = 0; ok && t < nr_of_workers; ++t)
+    {
+    void* worker = trico_get_worker_context(ctx, t);
+    ok = trico_get_context_hash_table(worker, 0, hash_table_1_size) && trico_get_context_hash_table(worker, 1, hash_table_2_size);
+    }
+  if (!ok)
+    {
+    if (ctx != context)
+      trico_destroy_context(ctx);
+    return NULL;
+    }
+  return ctx;
+  }
+
+static uint32_t trico_compress_chunked_into_generic(void* context, uint8_t* out, const void* input, const uint32_t number_of_values, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads, int double_precision)
+  {
+  chunk_size = trico_clamp_chunk_size(number_of_values, chunk_size);
+
+  struct trico_compress_chunked_data data;
+  const uint32_t nr_of_chunks = trico_get_number_of_chunks(number_of_values, chunk_size);
+  const size_t hash_entry_size = double_precision ? 8 : 4;
+  data.input = input;
+  data.out = out;
+  data.number_of_values = number_of_values;
+  data.chunk_size = chunk_size;
+  data.chunk_max_size = trico_get_chunk_max_size(chunk_size, double_precision);
+  data.header_size = trico_get_chunked_header_size(nr_of_chunks);
+  data.hash1_size_exponent = trico_normalize_hash_size_exponent(hash1_size_exponent);
+  data.hash2_size_exponent = trico_normalize_hash_size_exponent(hash2_size_exponent);
+
+  const uint32_t nr_of_workers = trico_get_number_of_workers(nr_of_chunks, nr_of_threads);
+  data.context = trico_prepare_worker_contexts(context, nr_of_workers, ((size_t)1 << data.hash1_size_exponent) * hash_entry_size, ((size_t)1 << data.hash2_size_exponent) * hash_entry_size);
+  if (!data.context)
+    return 0;
+  data.chunk_sizes = (uint32_t*)trico_get_context_buffer(data.context, TRICO_CONTEXT_CODEC_BUFFER, (nr_of_chunks + 1) * sizeof(uint32_t));
+  if (!data.chunk_sizes)
+    {
+    if (data.context != context)
+      trico_destroy_context(data.context);
+    return 0;
+    }
+
+  trico_parallel_for(double_precision ? trico_compress_chunk_double_precision : trico_compress_chunk, &data, nr_of_chunks, nr_of_workers);
+
+  const uint32_t nr_of_compressed_bytes = trico_finalize_chunked(data.out, number_of_values, chunk_size, nr_of_chunks, data.chunk_sizes, data.chunk_max_size);
+  if (data.context != context)
+    trico_destroy_context(data.context);
+  return nr_of_compressed_bytes;
+  }
+
+uint32_t trico_compress_chunked_into(uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads)
+  {
+  return trico_compress_chunked_into_generic(NULL, out, input, number_of_floats, hash1_size_exponent, hash2_size_exponent, chunk_size, nr_of_threads, 0);
+  }
+
+uint32_t trico_compress_chunked_into_with_context(void* context, uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads)
+  {
+  return trico_compress_chunked_into_generic(context, out, input, number_of_floats, hash1_size_exponent, hash2_size_exponent, chunk_size, nr_of_threads, 0);
+  }
+
+uint32_t trico_compress_chunked_double_precision_into(uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads)
+  {
+  return trico_compress_chunked_into_generic(NULL, out, input, number_of_doubles, (uint32_t)(hash1_size_exponent > 30 ? 30 : hash1_size_exponent), (uint32_t)(hash2_size_exponent > 30 ? 30 : hash2_size_exponent), chunk_size, nr_of_threads, 1);
+  }
+
+uint32_t trico_compress_chunked_double_precision_into_with_context(void* context, uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads)
+  {
+  return trico_compress_chunked_into_generic(context, out, input, number_of_doubles, (uint32_t)(hash1_size_exponent > 30 ? 30 : hash1_size_exponent), (uint32_t)(hash2_size_exponent > 30 ? 30 : hash2_size_exponent), chunk_size, nr_of_threads, 1);
+  }
+
+void trico_compress_chunked(uint32_t* nr_of_compressed_bytes, uint8_t** out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads)
+  {
+  *out = (uint8_t*)trico_malloc(trico_compress_chunked_bound(number_of_floats, chunk_size));
+  *nr_of_compressed_bytes = trico_compress_chunked_into(*out, input, number_of_floats, hash1_size_exponent, hash2_size_exponent, chunk_size, nr_of_threads);
+  *out = (uint8_t*)trico_realloc(*out, *nr_of_compressed_bytes);
+  }
+
+void trico_compress_chunked_double_precision(uint32_t* nr_of_compressed_bytes, uint8_t** out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads)
+  {
+  *out = (uint8_t*)trico_malloc(trico_compress_chunked_double_precision_bound(number_of_doubles, chunk_size));
+  *nr_of_compressed_bytes = trico_compress_chunked_double_precision_into(*out, input, number_of_doubles, hash1_size_exponent, hash2_size_exponent, chunk_size, nr_of_threads);
+  *out = (uint8_t*)trico_realloc(*out, *nr_of_compressed_bytes);
+  }
+
+uint32_t trico_get_number_of_chunked_values(const uint8_t* compressed)
+  {
+  return trico_read_uint32_big_endian(compressed);
+  }
+
+uint32_t trico_get_chunk_size(const uint8_t* compressed)
+  {
+  return trico_read_uint32_big_endian(compressed + 4);
+  }
+
+struct trico_decompress_chunked_data
+  {
+  uint8_t* out;
+  const uint8_t* chunk_data;
+  const uint8_t* offsets;
+  void* context; // provides the hash tables of each thread, and a chunk buffer for chunks that are only partially inside the requested range
+  uint32_t number_of_values;
+  uint32_t chunk_size;
+  uint32_t first_chunk;
+  uint32_t first; // requested range of values
+  uint32_t count;
+  uint32_t out_stride;
+  uint32_t hash1_size_exponent;
+  uint32_t hash2_size_exponent;
+  };
+
+/*
+Determines which values of the chunk are requested. Returns 1 if the chunk is completely inside the requested range,
+so that it can be decompressed directly into the output.
+*/
+static int trico_get_chunk_range(uint32_t* range_first, uint32_t* range_last, const struct trico_decompress_chunked_data* data, uint32_t chunk)
+  {
+  const uint32_t chunk_first = chunk * data->chunk_size;
+  const uint32_t chunk_last = data->number_of_values - chunk_first < data->chunk_size ? data->number_of_values : chunk_first + data->chunk_size;
+  *range_first = data->first > chunk_first ? data->first : chunk_first;
+  *range_last = data->first + data->count < chunk_last ? data->first + data->count : chunk_last;
+  return (*range_first == chunk_first && *range_last == chunk_last) ? 1 : 0;
+  }
+
+static void trico_decompress_chunk(void* user_data, uint32_t task, uint32_t thread_index)
+  {
+  struct trico_decompress_chunked_data* data = (struct trico_decompress_chunked_data*)user_data;
+  const uint32_t chunk = data->first_chunk + task;
+  void* context = trico_get_worker_context(data->context, thread_index);
+  uint32_t* hash_table_1 = (uint32_t*)trico_get_cleared_hash_table(context, 0, data->hash1_size_exponent, 4);
+  uint32_t* hash_table_2 = (uint32_t*)trico_get_cleared_hash_table(context, 1, data->hash2_size_exponent, 4);
+  const uint8_t* compressed = data->chunk_data + trico_read_uint32_big_endian(data->offsets + 4 * chunk);
+  uint32_t range_first, range_last;
+  float* out = (float*)data->out;
+  if (trico_get_chunk_range(&range_first, &range_last, data, chunk))
+    {
+    trico_decompress_core(out + (uint64_t)(range_first - data->first) * data->out_stride, data->out_stride, compressed, hash_table_1, hash_table_2);
+    return;
+    }
+  float* chunk_buffer = (float*)trico_get_context_buffer(context, TRICO_CONTEXT_CODEC_BUFFER, (uint64_t)data->chunk_size * sizeof(float));
+  trico_decompress_core(chunk_buffer, 1, compressed, hash_table_1, hash_table_2);
+  const uint32_t chunk_first = chunk * data->chunk_size;
+  for (uint32_t i = range_first; i < range_last; ++i)
+    out[(uint64_t)(i - data->first) * data->out_stride] = chunk_buffer[i - chunk_first];
+  }
+
+static void trico_decompress_chunk_double_precision(void* user_data, uint32_t task, uint32_t thread_index)
+  {
+  struct trico_decompress_chunked_data* data = (struct trico_decompress_chunked_data*)user_data;
+  const uint32_t chunk = data->first_chunk + task;
+  void* context = trico_get_worker_context(data->context, thread_index);
+  uint64_t* hash_table_1 = (uint64_t*)trico_get_cleared_hash_table(context, 0, data->hash1_size_exponent, 8);
+  uint64_t* hash_table_2 = (uint64_t*)trico_get_cleared_hash_table(context, 1, data->hash2_size_exponent, 8);
+  const uint8_t* compressed = data->chunk_data + trico_read_uint32_big_endian(data->offsets + 4 * chunk);
+  uint32_t range_first, range_last;
+  double* out = (double*)data->out;
+  if (trico_get_chunk_range(&range_first, &range_last, data, chunk))
+    {
+    trico_decompress_double_precision_core(out + (uint64_t)(range_first - data->first) * data->out_stride, data->out_stride, compressed, hash_table_1, hash_table_2);
+    return;
+    }
+  double* chunk_buffer = (double*)trico_get_context_buffer(context, TRICO_CONTEXT_CODEC_BUFFER, (uint64_t)data->chunk_size * sizeof(double));
+  trico_decompress_double_precision_core(chunk_buffer, 1, compressed, hash_table_1, hash_table_2);
+  const uint32_t chunk_first = chunk * data->chunk_size;
+  for (uint32_t i = range_first; i < range_last; ++i)
+    out[(uint64_t)(i - data->first) * data->out_stride] = chunk_buffer[i - chunk_first];
+  }
+
+static void trico_decompress_chunked_range_into_generic(void* context, void* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads, int double_precision)
+  {
+  struct trico_decompress_chunked_data data;
+  const size_t value_size = double_precision ? 8 : 4;
+  data.number_of_values = trico_read_uint32_big_endian(compressed);
+  data.chunk_size = trico_read_uint32_big_endian(compressed + 4);
+  if (data.chunk_size == 0 || first >= data.number_of_values || count == 0)
+    return;
+  data.chunk_size = trico_clamp_chunk_size(data.number_of_values, data.chunk_size);
+  if (count > data.number_of_values - first)
+    count = data.number_of_values - first;
+  const uint32_t nr_of_chunks = trico_get_number_of_chunks(data.number_of_values, data.chunk_size);
+  data.out = (uint8_t*)out;
+  data.out_stride = out_stride;
+  data.first = first;
+  data.count = count;
+  data.first_chunk = first / data.chunk_size;
+  const uint32_t nr_of_tasks = (first + count - 1) / data.chunk_size - data.first_chunk + 1;
+  data.offsets = compressed + 8;
+  data.chunk_data = compressed + trico_get_chunked_header_size(nr_of_chunks);
+
+  // every chunk stores its own hash table sizes, so allocate for the largest
+  data.hash1_size_exponent = 0;
+  data.hash2_size_exponent = 0;
+  for (uint32_t c = data.first_chunk; c < data.first_chunk + nr_of_tasks; ++c)
+    {
+    const uint8_t hash_info = *(data.chunk_data + trico_read_uint32_big_endian(data.offsets + 4 * c));
+    if (((uint32_t)(hash_info >> 4) << 1) > data.hash1_size_exponent)
+      data.hash1_size_exponent = (uint32_t)(hash_info >> 4) << 1;
+    if (((uint32_t)(hash_info & 15) << 1) > data.hash2_size_exponent)
+      data.hash2_size_exponent = (uint32_t)(hash_info & 15) << 1;
+    }
+
+  // only the first and the last chunk can be partially inside the range
+  const int partial_chunks = (first % data.chunk_size) != 0 || ((first + count) % data.chunk_size != 0 && first + count != data.number_of_values);
+
+  const uint32_t nr_of_workers = trico_get_number_of_workers(nr_of_tasks, nr_of_threads);
+  data.context = trico_prepare_worker_contexts(context, nr_of_workers, ((size_t)1 << data.hash1_size_exponent) * value_size, ((size_t)1 << data.hash2_size_exponent) * value_size);
+  if (!data.context)
+    return;
+  for (uint32_t t = 0; partial_chunks && t < nr_of_workers; ++t)
+    {
+    if (!trico_get_context_buffer(trico_get_worker_context(data.context, t), TRICO_CONTEXT_CODEC_BUFFER, (uint64_t)data.chunk_size * value_size))
+      {
+      if (data.context != context)
+        trico_destroy_context(data.context);
+      return;
+      }
+    }
+
+  trico_parallel_for(double_precision ? trico_decompress_chunk_double_precision : trico_decompress_chunk, &data, nr_of_tasks, nr_of_workers);
+
+  if (data.context != context)
+    trico_destroy_context(data.context);
+  }
+
+void trico_decompress_chunked_range_into(float* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads)
+  {
+  trico_decompress_chunked_range_into_generic(NULL, out, out_stride, compressed, first, count, nr_of_threads, 0);
+  }
+
+void trico_decompress_chunked_range_into_with_context(void* context, float* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads)
+  {
+  trico_decompress_chunked_range_into_generic(context, out, out_stride, compressed, first, count, nr_of_threads, 0);
+  }
+
+void trico_decompress_chunked_double_precision_range_into(double* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads)
+  {
+  trico_decompress_chunked_range_into_generic(NULL, out, out_stride, compressed, first, count, nr_of_threads, 1);
+  }
+
+void trico_decompress_chunked_double_precision_range_into_with_context(void* context, double* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads)
+  {
+  trico_decompress_chunked_range_into_generic(context, out, out_stride, compressed, first, count, nr_of_threads, 1);
+  }
+
+void trico_decompress_chunked(uint32_t* number_of_floats, float** out, const uint8_t* compressed, uint32_t nr_of_threads)
+  {
+  *number_of_floats = trico_get_number_of_chunked_values(compressed);
+  *out = (float*)trico_malloc((size_t)(*number_of_floats) * sizeof(float));
+  trico_decompress_chunked_range_into(*out, 1, compressed, 0, *number_of_floats, nr_of_threads);
+  }
+
+void trico_decompress_chunked_double_precision(uint32_t* number_of_doubles, double** out, const uint8_t* compressed, uint32_t nr_of_threads)
+  {
+  *number_of_doubles = trico_get_number_of_chunked_values(compressed);
+  *out = (double*)trico_malloc((size_t)(*number_of_doubles) * sizeof(double));
+  trico_decompress_chunked_double_precision_range_into(*out, 1, compressed, 0, *number_of_doubles, nr_of_threads);
+  }
+
+/*
+Vertices of a triangle mesh are coded in the traversal order of trico_compute_vertex_predictions, three coordinates per vertex,
+with the codes of trico_compress: predictor 1 is the parallelogram (or the midpoint of an edge), predictor 2 the nearest known vertex.
+*/
+static inline uint32_t trico_float_bits(float value)
+  {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(uint32_t));
+  return bits;
+  }
+
+/*
+The parallelogram rule predicts close values rather than equal bits, so the residual is the difference of the floats as ordered integers
+instead of the xor of their bits: a prediction that is a few ulps off, possibly on the other side of a power of two or of zero, leaves a small residual.
+The difference is zigzag coded, so that small negative differences have small codes as well.
+*/
+static inline uint32_t trico_float_bits_to_ordered(uint32_t bits)
+  {
+  return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+  }
+
+static inline uint32_t trico_ordered_to_float_bits(uint32_t ordered)
+  {
+  return (ordered & 0x80000000) ? (ordered & 0x7fffffff) : ~ordered;
+  }
+
+static inline uint32_t trico_ordered_residual(uint32_t value, uint32_t prediction)
+  {
+  const uint32_t difference = trico_float_bits_to_ordered(value) - trico_float_bits_to_ordered(prediction);
+  return (difference << 1) ^ (0u - (difference >> 31));
+  }
+
+static inline uint32_t trico_add_ordered_residual(uint32_t prediction, uint32_t residual)
+  {
+  const uint32_t difference = (residual >> 1) ^ (0u - (residual & 1));
+  return trico_ordered_to_float_bits(trico_float_bits_to_ordered(prediction) + difference);
+  }
+
+/*
+Encoder and decoder compute the predictions with the same float operations on the same values, so they find the same bits.
+A prediction that is not a number is replaced by a, as the bits of a NaN result are not the same on all platforms.
+*/
+static inline void trico_predict_vertex(uint32_t* prediction1, uint32_t* prediction2, const float* vertices, const struct trico_vertex_prediction* p)
+  {
+  for (uint32_t k = 0; k < 3; ++k)
+    {
+    if (p->a == TRICO_NO_VERTEX)
+      {
+      prediction1[k] = 0;
+      prediction2[k] = 0;
+      continue;
+      }
+    const float a = vertices[3 * (uint64_t)p->a + k];
+    float prediction = a;
+    if (p->b != TRICO_NO_VERTEX)
+      {
+      const float b = vertices[3 * (uint64_t)p->b + k];
+      prediction = p->c != TRICO_NO_VERTEX ? (a + b) - vertices[3 * (uint64_t)p->c + k] : (a + b) * 0.5f;
+      if (prediction != prediction)
+        prediction = a;
+      }
+    prediction1[k] = trico_float_bits(prediction);
+    prediction2[k] = trico_float_bits(a);
+    }
+  }
+
+/*
+Reads the code and the residuals of a group of 8 values from [*in, end). Returns 0 if the group does not fit.
+*/
+static inline int trico_read_group_checked(const uint8_t** in, const uint8_t* end, uint32_t* xor, uint32_t* bcode)
+  {
+  const uint8_t* p = *in;
+  if (end - p < 3)
+    return 0;
+  const uint32_t bc = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | (uint32_t)p[2];
+  p += 3;
+  // a group has at most 32 residual bytes, and the 4-byte loads of trico_read_residual read at most 3 bytes past them
+  const int gather = end - p >= 35;
+  for (uint32_t j = 0; j < 8; ++j)
+    {
+    bcode[j] = (bc >> (j * 3)) & 7;
+    const uint32_t length = trico_code_length[bcode[j]];
+    if (gather)
+      xor[j] = trico_read_residual(p, length);
+    else
+      {
+      if ((uint64_t)(end - p) < length)
+        return 0;
+      xor[j] = 0;
+      for (uint32_t l = 0; l < length; ++l)
+        xor[j] = (xor[j] << 8) | (uint32_t)p[l];
+      }
+    p += length;
+    }
+  *in = p;
+  return 1;
+  }
+
+uint64_t trico_compress_parallelogram_bound(uint32_t nr_of_vertices)
+  {
+  const uint64_t number_of_floats = 3 * (uint64_t)nr_of_vertices;
+  return 5 + 3 * ((number_of_floats + 7) / 8) + 4 * number_of_floats + 7 + 3;
+  }
+
+uint32_t trico_compress_parallelogram_into_with_context(void* context, uint8_t* out, const float* vertices, uint32_t nr_of_vertices, const uint32_t* triangles, uint32_t nr_of_triangles)
+  {
+  struct trico_vertex_prediction* predictions = (struct trico_vertex_prediction*)trico_get_context_buffer(context, TRICO_CONTEXT_CODEC_BUFFER, (uint64_t)nr_of_vertices * sizeof(struct trico_vertex_prediction));
+  if (!predictions || !trico_compute_vertex_predictions(context, predictions, triangles, nr_of_triangles, nr_of_vertices))
+    return 0;
+
+  uint8_t* p_out = out;
+  *p_out++ = 0; // no hash tables
+  trico_write_uint32_big_endian(p_out, nr_of_vertices);
+  p_out += 4;
+
+  uint32_t prediction1[3];
+  uint32_t prediction2[3];
+  uint32_t xor1[8];
+  uint32_t xor2[8];
+  uint32_t bcode[8];
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    {
+    const struct trico_vertex_prediction* p = &predictions[i];
+    trico_predict_vertex(prediction1, prediction2, vertices, p);
+    for (uint32_t k = 0; k < 3; ++k)
+      {
+      const uint32_t value = trico_float_bits(vertices[3 * (uint64_t)p->vertex + k]);
+      xor1[j] = trico_ordered_residual(value, prediction1[k]);
+      xor2[j] = trico_ordered_residual(value, prediction2[k]);
+      bcode[j] = trico_get_code(xor1[j], xor2[j]);
+      if (++j == 8)
+        {
+        trico_fill_code(&p_out, xor1, xor2, bcode);
+        j = 0;
+        }
+      }
+    }
+  if (j)
+    {
+    for (uint32_t l = j; l < 8; ++l)
+      {
+      bcode[l] = 1;
+      xor1[l] = 0;
+      }
+    trico_fill_code(&p_out, xor1, xor2, bcode);
+    }
+  return (uint32_t)(p_out - out);
+  }
+
+int trico_decompress_parallelogram_into_with_context(void* context, float* vertices, const uint8_t* compressed, uint32_t nr_of_compressed_bytes, const uint32_t* triangles, uint32_t nr_of_triangles)
+  {
+  if (nr_of_compressed_bytes < 5)
+    return 0;
+  const uint32_t nr_of_vertices = trico_read_uint32_big_endian(compressed + 1);
+  struct trico_vertex_prediction* predictions = (struct trico_vertex_prediction*)trico_get_context_buffer(context, TRICO_CONTEXT_CODEC_BUFFER, (uint64_t)nr_of_vertices * sizeof(struct trico_vertex_prediction));
+  if (!predictions || !trico_compute_vertex_predictions(context, predictions, triangles, nr_of_triangles, nr_of_vertices))
+    return 0;
+
+  const uint8_t* p_in = compressed + 5;
+  const uint8_t* end = compressed + nr_of_compressed_bytes;
+  uint32_t prediction1[3];
+  uint32_t prediction2[3];
+  uint32_t xor[8];
+  uint32_t bcode[8];
+  uint32_t j = 8;
+  for (uint32_t i = 0; i < nr_of_vertices; ++i)
+    {
+    const struct trico_vertex_prediction* p = &predictions[i];
+    trico_predict_vertex(prediction1, prediction2, vertices, p);
+    for (uint32_t k = 0; k < 3; ++k)
+      {
+      if (j == 8)
+        {
+        if (!trico_read_group_checked(&p_in, end, xor, bcode))
+          return 0;
+        j = 0;
+        }
+      const uint32_t value = trico_add_ordered_residual(bcode[j] > 4 ? prediction2[k] : prediction1[k], xor[j]);
+      ++j;
+      memcpy(&vertices[3 * (uint64_t)p->vertex + k], &value, sizeof(uint32_t));
+      }
+    }
+  return 1;
+  }
+
+/*
+Entropy coded residuals:
+  <the 5 byte header of the compressed data>
+  5 planes, each as <uint32 big endian size><trico_entropy_compress_into data>:
+  the codes of all groups, one per byte, and for k = 0..3 the k-th byte of each residual with more than k bytes
+The codes of a group are strongly skewed towards the common residual lengths, and the leading byte of a residual
+differs in its statistics from its trailing bytes, which are close to random.
+*/
+#define TRICO_RESIDUAL_PLANES 5
+
+uint64_t trico_entropy_code_residuals_bound(uint32_t number_of_values)
+  {
+  const uint64_t nr_of_codes = 8 * (((uint64_t)number_of_values + 7) / 8);
+  return 5 + TRICO_RESIDUAL_PLANES * (4 + trico_entropy_compress_bound((uint32_t)nr_of_codes));
+  }
+
+uint32_t trico_entropy_code_residuals_with_context(void* context, uint8_t* out, const uint8_t* compressed, uint32_t nr_of_compressed_bytes, uint32_t number_of_values)
+  {
+  const uint64_t nr_of_codes = 8 * (((uint64_t)number_of_values + 7) / 8);
+  if (nr_of_compressed_bytes < 5 || nr_of_codes > 0xffffffff)
+    return 0;
+  uint8_t* planes = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_ENTROPY_BUFFER, TRICO_RESIDUAL_PLANES * nr_of_codes + 1);
+  if (!planes)
+    return 0;
+  uint32_t sizes[TRICO_RESIDUAL_PLANES] = { (uint32_t)nr_of_codes, 0, 0, 0, 0 };
+  const uint8_t* p_in = compressed + 5;
+  const uint8_t* end = compressed + nr_of_compressed_bytes;
+  for (uint64_t group = 0; group < nr_of_codes; group += 8)
+    {
+    if (end - p_in < 3)
+      return 0;
+    const uint32_t bc = ((uint32_t)p_in[0] << 16) | ((uint32_t)p_in[1] << 8) | (uint32_t)p_in[2];
+    p_in += 3;
+    for (uint32_t j = 0; j < 8; ++j)
+      {
+      const uint32_t code = (bc >> (j * 3)) & 7;
+      const uint32_t length = trico_code_length[code];
+      if ((uint64_t)(end - p_in) < length)
+        return 0;
+      planes[group + j] = (uint8_t)code;
+      for (uint32_t k = 0; k < length; ++k)
+        planes[(k + 1) * nr_of_codes + sizes[k + 1]++] = *p_in++;
+      }
+    }
+  if (p_in != end)
+    return 0;
+  memcpy(out, compressed, 5);
+  uint8_t* p_out = out + 5;
+  for (uint32_t k = 0; k < TRICO_RESIDUAL_PLANES; ++k)
+    {
+    const uint32_t size = trico_entropy_compress_into(p_out + 4, planes + k * nr_of_codes, sizes[k]);
+    trico_write_uint32_big_endian(p_out, size);
+    p_out += 4 + size;
+    }
+  return (uint32_t)(p_out - out);
+  }
+
+int trico_entropy_decode_residuals_with_context(void* context, const uint8_t** compressed, uint32_t* nr_of_compressed_bytes, const uint8_t* entropy_coded, uint32_t nr_of_entropy_coded_bytes, uint32_t number_of_values)
+  {
+  const uint64_t nr_of_groups = ((uint64_t)number_of_values + 7) / 8;
+  const uint64_t nr_of_codes = 8 * nr_of_groups;
+  // a group takes at most 3 + 32 bytes, and the decoder reads up to 3 bytes past the last residual
+  const uint64_t max_compressed_size = 5 + 35 * nr_of_groups;
+  if (nr_of_entropy_coded_bytes < 5 || max_compressed_size > 0xffffffff)
+    return 0;
+  uint8_t* planes = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_ENTROPY_BUFFER, TRICO_RESIDUAL_PLANES * nr_of_codes + max_compressed_size + 3);
+  if (!planes)
+    return 0;
+  uint8_t* out = planes + TRICO_RESIDUAL_PLANES * nr_of_codes;
+  const uint8_t* p_in = entropy_coded + 5;
+  const uint8_t* end = entropy_coded + nr_of_entropy_coded_bytes;
+  uint32_t sizes[TRICO_RESIDUAL_PLANES];
+  for (uint32_t k = 0; k < TRICO_RESIDUAL_PLANES; ++k)
+    {
+    if (end - p_in < 4 + 5)
+      return 0;
+    const uint32_t size = trico_read_uint32_big_endian(p_in);
+    if ((uint64_t)(end - p_in - 4) < size || size < 5)
+      return 0;
+    sizes[k] = trico_get_number_of_entropy_coded_bytes(p_in + 4);
+    if (sizes[k] > nr_of_codes || (k == 0 && sizes[k] != nr_of_codes))
+      return 0;
+    if (!trico_entropy_decompress_into(planes + k * nr_of_codes, p_in + 4, size))
+      return 0;
+    p_in += 4 + size;
+    }
+  if (p_in != end)
+    return 0;
+
+  memcpy(out, entropy_coded, 5);
+  uint8_t* p_out = out + 5;
+  uint32_t positions[TRICO_RESIDUAL_PLANES] = { 0 };
+  for (uint64_t group = 0; group < nr_of_codes; group += 8)
+    {
+    uint32_t bc = 0;
+    for (uint32_t j = 0; j < 8; ++j)
+      {
+      if (planes[group + j] > 7)
+        return 0;
+      bc |= (uint32_t)planes[group + j] << (j * 3);
+      }
+    *p_out++ = (uint8_t)(bc >> 16);
+    *p_out++ = (uint8_t)((bc >> 8) & 0xff);
+    *p_out++ = (uint8_t)(bc & 0xff);
+    for (uint32_t j = 0; j < 8; ++j)
+      {
+      const uint32_t length = trico_code_length[planes[group + j]];
+      for (uint32_t k = 0; k < length; ++k)
+        {
+        if (positions[k + 1] == sizes[k + 1])
+          return 0;
+        *p_out++ = planes[(k + 1) * nr_of_codes + positions[k + 1]++];
+        }
+      }
+    }
+  for (uint32_t k = 1; k < TRICO_RESIDUAL_PLANES; ++k)
+    {
+    if (positions[k] != sizes[k])
+      return 0;
+    }
+  memset(p_out, 0, 3);
+  *compressed = out;
+  *nr_of_compressed_bytes = (uint32_t)(p_out - out);
+  return 1;
+  }
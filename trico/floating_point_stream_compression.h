@@ -8,6 +8,21 @@ extern "C" {
 #include "trico_api.h"
 #include <stdint.h>
 
+/*
+Worst-case number of bytes produced by trico_compress for the given number of values.
+*/
+TRICO_API uint64_t trico_compress_bound(uint32_t number_of_floats);
+
+TRICO_API uint64_t trico_compress_double_precision_bound(uint32_t number_of_doubles);
+
+/*
+Compress into memory provided by the caller, out needs room for trico_compress_bound(number_of_floats) bytes.
+Returns the number of compressed bytes.
+*/
+TRICO_API uint32_t trico_compress_into(uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent);
+
+TRICO_API uint32_t trico_compress_double_precision_into(uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent);
+
 TRICO_API void trico_compress(uint32_t* nr_of_compressed_bytes, uint8_t** out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent); // 4, 10
 
 TRICO_API void trico_decompress(uint32_t* number_of_floats, float** out, const uint8_t* compressed);
@@ -16,6 +31,128 @@ TRICO_API void trico_compress_double_precision(uint32_t* nr_of_compressed_bytes,
 
 TRICO_API void trico_decompress_double_precision(uint32_t* number_of_doubles, double** out, const uint8_t* compressed);
 
+/*
+Returns the number of values in a stream compressed with trico_compress or trico_compress_double_precision.
+*/
+TRICO_API uint32_t trico_get_number_of_compressed_values(const uint8_t* compressed);
+
+/*
+Decompress into memory provided by the caller: value i is written to out[i * out_stride], so that for instance the
+x, y and z planes of a vec3 stream can be decompressed directly into an interleaved array with out_stride 3.
+out needs room for (trico_get_number_of_compressed_values(compressed) - 1) * out_stride + 1 values.
+*/
+TRICO_API void trico_decompress_into(float* out, uint32_t out_stride, const uint8_t* compressed);
+
+TRICO_API void trico_decompress_double_precision_into(double* out, uint32_t out_stride, const uint8_t* compressed);
+
+/*
+Chunked variants: the input is split in chunks of chunk_size values that are compressed independently,
+so that chunks can be encoded and decoded on multiple threads. Smaller chunks give more parallelism but
+a slightly worse compression ratio, as the hash tables start empty for each chunk.
+A chunk_size of 0, or larger than the number of values, means one chunk, a value of 0 for nr_of_threads means: use all hardware threads.
+The output of the chunked variants can only be decompressed with the chunked variants.
+*/
+TRICO_API void trico_compress_chunked(uint32_t* nr_of_compressed_bytes, uint8_t** out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads);
+
+TRICO_API void trico_decompress_chunked(uint32_t* number_of_floats, float** out, const uint8_t* compressed, uint32_t nr_of_threads);
+
+TRICO_API void trico_compress_chunked_double_precision(uint32_t* nr_of_compressed_bytes, uint8_t** out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads);
+
+TRICO_API void trico_decompress_chunked_double_precision(uint32_t* number_of_doubles, double** out, const uint8_t* compressed, uint32_t nr_of_threads);
+
+/*
+Worst-case number of bytes produced by the chunked variants, and variants that compress into memory provided by the caller,
+which needs room for trico_compress_chunked_bound(number_of_floats, chunk_size) bytes. Return the number of compressed bytes.
+*/
+TRICO_API uint64_t trico_compress_chunked_bound(uint32_t number_of_floats, uint32_t chunk_size);
+
+TRICO_API uint64_t trico_compress_chunked_double_precision_bound(uint32_t number_of_doubles, uint32_t chunk_size);
+
+TRICO_API uint32_t trico_compress_chunked_into(uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads);
+
+TRICO_API uint32_t trico_compress_chunked_double_precision_into(uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads);
+
+/*
+Returns the number of values and the number of values per chunk of a chunked stream.
+*/
+TRICO_API uint32_t trico_get_number_of_chunked_values(const uint8_t* compressed);
+
+TRICO_API uint32_t trico_get_chunk_size(const uint8_t* compressed);
+
+/*
+Decompresses the values [first, first + count) of a chunked stream: value first + i is written to out[i * out_stride].
+Only the chunks that overlap with the range are decompressed.
+*/
+TRICO_API void trico_decompress_chunked_range_into(float* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads);
+
+TRICO_API void trico_decompress_chunked_double_precision_range_into(double* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads);
+
+/*
+Variants that take their hash tables and scratch memory from a context (see context.h) instead of allocating them on each call.
+The chunked variants use the worker contexts of context for their threads.
+*/
+TRICO_API uint32_t trico_compress_into_with_context(void* context, uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent);
+
+TRICO_API uint32_t trico_compress_double_precision_into_with_context(void* context, uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent);
+
+TRICO_API void trico_decompress_into_with_context(void* context, float* out, uint32_t out_stride, const uint8_t* compressed);
+
+TRICO_API void trico_decompress_double_precision_into_with_context(void* context, double* out, uint32_t out_stride, const uint8_t* compressed);
+
+TRICO_API uint32_t trico_compress_chunked_into_with_context(void* context, uint8_t* out, const float* input, const uint32_t number_of_floats, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads);
+
+TRICO_API uint32_t trico_compress_chunked_double_precision_into_with_context(void* context, uint8_t* out, const double* input, const uint32_t number_of_doubles, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent, uint32_t chunk_size, uint32_t nr_of_threads);
+
+TRICO_API void trico_decompress_chunked_range_into_with_context(void* context, float* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads);
+
+TRICO_API void trico_decompress_chunked_double_precision_range_into_with_context(void* context, double* out, uint32_t out_stride, const uint8_t* compressed, uint32_t first, uint32_t count, uint32_t nr_of_threads);
+
+/*
+Compresses the nr_of_components interleaved components of number_of_values values each (e.g. the x, y and z of vertices) into one stream per component.
+Stream c is identical to compressing component c after transposing it, but the input is not transposed: the encoders of all components advance
+together over tiles of the input that stay in cache. out[c] should be able to contain trico_compress_bound(number_of_values) bytes,
+and nr_of_compressed_bytes[c] receives the size of stream c. The hash tables of component c are tables 2c and 2c + 1 of the context.
+Returns 0 if nr_of_components is 0 or larger than TRICO_MAX_INTERLEAVED_COMPONENTS, or if the hash tables are not available.
+*/
+#define TRICO_MAX_INTERLEAVED_COMPONENTS 4
+
+TRICO_API int trico_compress_interleaved_into_with_context(void* context, uint8_t** out, uint32_t* nr_of_compressed_bytes, const float* input, uint32_t nr_of_components, const uint32_t number_of_values, uint32_t hash1_size_exponent, uint32_t hash2_size_exponent);
+
+TRICO_API int trico_compress_interleaved_double_precision_into_with_context(void* context, uint8_t** out, uint32_t* nr_of_compressed_bytes, const double* input, uint32_t nr_of_components, const uint32_t number_of_values, uint64_t hash1_size_exponent, uint64_t hash2_size_exponent);
+
+/*
+Compresses the vertices (x, y, z interleaved) of a triangle mesh with parallelogram prediction: the triangles are traversed
+over shared edges (see mesh_connectivity.h), and each vertex is predicted from the adjacent triangle that was visited before it.
+The residuals are the differences of the floats as ordered integers, coded with the codes of trico_compress, so that the vertices are restored bit-exact. The triangles are not stored,
+the decoder needs the same triangles. out needs room for trico_compress_parallelogram_bound(nr_of_vertices) bytes.
+Returns the number of compressed bytes, or 0 if a triangle refers to a vertex index >= nr_of_vertices or the memory is not available.
+*/
+TRICO_API uint64_t trico_compress_parallelogram_bound(uint32_t nr_of_vertices);
+
+TRICO_API uint32_t trico_compress_parallelogram_into_with_context(void* context, uint8_t* out, const float* vertices, uint32_t nr_of_vertices, const uint32_t* triangles, uint32_t nr_of_triangles);
+
+/*
+Decompresses the nr_of_compressed_bytes of compressed into vertices, which needs room for 3 * trico_get_number_of_compressed_values(compressed) floats.
+Returns 0 if the compressed data is truncated, if a triangle refers to a vertex index >= the number of vertices, or if the memory is not available.
+*/
+TRICO_API int trico_decompress_parallelogram_into_with_context(void* context, float* vertices, const uint8_t* compressed, uint32_t nr_of_compressed_bytes, const uint32_t* triangles, uint32_t nr_of_triangles);
+
+/*
+Entropy codes the output of trico_compress or trico_compress_parallelogram for number_of_values floats: the 3-bit codes are
+unpacked to one byte each and the residual bytes are split by their position in the residual, and each of these 5 planes is
+coded with trico_entropy_compress_into. out needs room for trico_entropy_code_residuals_bound(number_of_values) bytes.
+Returns the number of entropy coded bytes, or 0 if compressed does not hold number_of_values values or the memory is not available.
+*/
+TRICO_API uint64_t trico_entropy_code_residuals_bound(uint32_t number_of_values);
+
+TRICO_API uint32_t trico_entropy_code_residuals_with_context(void* context, uint8_t* out, const uint8_t* compressed, uint32_t nr_of_compressed_bytes, uint32_t number_of_values);
+
+/*
+Restores the compressed data of number_of_values floats from the nr_of_entropy_coded_bytes of entropy_coded in the entropy buffer
+of context, and sets *compressed and *nr_of_compressed_bytes to it. Returns 0 if the entropy coded data is invalid or the memory is not available.
+*/
+TRICO_API int trico_entropy_decode_residuals_with_context(void* context, const uint8_t** compressed, uint32_t* nr_of_compressed_bytes, const uint8_t* entropy_coded, uint32_t nr_of_entropy_coded_bytes, uint32_t number_of_values);
+
 #endif // #ifndef TRICO_FLOATING_POINT_STREAM_COMPRESSION_H
 
 #if defined (__cplusplus)
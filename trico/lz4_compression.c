@@ -0,0 +1,26 @@
+#include "lz4_compression.h"
+#include "context.h"
+
+#define LZ4_STATIC_LINKING_ONLY
+#include <lz4/lz4.h>
+#include <lz4/lz4hc.h>
+
+#define TRICO_LZ4_MAX_ACCELERATION 65537
+
+uint32_t trico_lz4_compress_into_with_context(void* context, uint8_t* out, const uint8_t* input, uint32_t nr_of_bytes, int level)
+  {
+  if (nr_of_bytes > LZ4_MAX_INPUT_SIZE)
+    return 0;
+  if (level > 0)
+    {
+    void* lz4hc_state = trico_get_context_lz4hc_state(context);
+    if (!lz4hc_state)
+      return 0;
+    return (uint32_t)LZ4_compress_HC_extStateHC(lz4hc_state, (const char*)input, (char*)out, (int)nr_of_bytes, LZ4_COMPRESSBOUND(nr_of_bytes), level < TRICO_LZ4_MAX_LEVEL ? level : TRICO_LZ4_MAX_LEVEL);
+    }
+  void* lz4_state = trico_get_context_lz4_state(context);
+  if (!lz4_state)
+    return 0;
+  const int acceleration = level >= -TRICO_LZ4_MAX_ACCELERATION ? (level < 0 ? -level : 1) : TRICO_LZ4_MAX_ACCELERATION;
+  return (uint32_t)LZ4_compress_fast_extState_fastReset(lz4_state, (const char*)input, (char*)out, (int)nr_of_bytes, LZ4_COMPRESSBOUND(nr_of_bytes), acceleration);
+  }
@@ -0,0 +1,31 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_LZ4_COMPRESSION_H
+#define TRICO_LZ4_COMPRESSION_H
+
+#include "trico_api.h"
+
+#include <stdint.h>
+
+/*
+Compression levels of lz4: level 0 is LZ4_compress_fast with acceleration 1, the lz4 default. Negative levels compress faster
+and worse with acceleration -level. Levels 1 up to TRICO_LZ4_MAX_LEVEL are the levels of LZ4-HC (see lz4hc.h): levels up to 9
+search hash chains, and levels 10 up to 12 parse the input optimally. Higher levels are capped at TRICO_LZ4_MAX_LEVEL.
+All levels write the lz4 block format, so the output is decompressed with LZ4_decompress_safe, equally fast for all levels.
+*/
+#define TRICO_LZ4_MAX_LEVEL 12
+
+/*
+Compresses nr_of_bytes of input into out with the given level. The higher levels use the lz4hc state of the context.
+out needs room for LZ4_COMPRESSBOUND(nr_of_bytes) bytes. Returns the number of compressed bytes, or 0 if the memory is not available
+or the input is too large for lz4.
+*/
+TRICO_API uint32_t trico_lz4_compress_into_with_context(void* context, uint8_t* out, const uint8_t* input, uint32_t nr_of_bytes, int level);
+
+#endif // #ifndef TRICO_LZ4_COMPRESSION_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
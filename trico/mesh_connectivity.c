@@ -0,0 +1,367 @@
+#include "mesh_connectivity.h"
+#include "context.h"
+
+#include <string.h>
+
+#define TRICO_NO_CORNER 0xfffffffe
+#define TRICO_UNKNOWN_CORNER 0xffffffff
+
+/*
+Corner k of triangle t is corner 3t + k, the edge opposite to a corner joins the other two corners of its triangle.
+*/
+static inline uint32_t next_corner(uint32_t corner)
+  {
+  return corner % 3 == 2 ? corner - 2 : corner + 1;
+  }
+
+static inline uint32_t previous_corner(uint32_t corner)
+  {
+  return corner % 3 == 0 ? corner + 2 : corner - 1;
+  }
+
+/*
+A corner of a vertex, with the other two vertices of its triangle, so that neighbours are found without visiting the triangles.
+*/
+struct trico_corner
+  {
+  uint32_t corner;
+  uint32_t next_vertex;
+  uint32_t previous_vertex;
+  };
+
+/*
+The corners around each vertex in compressed row format: the corners of vertex v are corners[first[v]] up to corners[first[v + 1]].
+*/
+struct trico_vertex_corners
+  {
+  uint32_t* first;
+  struct trico_corner* corners;
+  };
+
+static void build_vertex_corners(struct trico_vertex_corners* vc, const uint32_t* triangles, uint32_t nr_of_corners, uint32_t nr_of_vertices)
+  {
+  memset(vc->first, 0, ((uint64_t)nr_of_vertices + 1) * sizeof(uint32_t));
+  for (uint32_t c = 0; c < nr_of_corners; ++c)
+    ++vc->first[triangles[c] + 1];
+  for (uint32_t v = 0; v < nr_of_vertices; ++v)
+    vc->first[v + 1] += vc->first[v];
+  // fill with first[v] as cursor, which moves first[v] to the start of vertex v + 1, and shift back afterwards
+  for (uint32_t c = 0; c < nr_of_corners; c += 3)
+    {
+    const uint32_t v0 = triangles[c];
+    const uint32_t v1 = triangles[c + 1];
+    const uint32_t v2 = triangles[c + 2];
+    struct trico_corner* entry = &vc->corners[vc->first[v0]++];
+    entry->corner = c;
+    entry->next_vertex = v1;
+    entry->previous_vertex = v2;
+    entry = &vc->corners[vc->first[v1]++];
+    entry->corner = c + 1;
+    entry->next_vertex = v2;
+    entry->previous_vertex = v0;
+    entry = &vc->corners[vc->first[v2]++];
+    entry->corner = c + 2;
+    entry->next_vertex = v0;
+    entry->previous_vertex = v1;
+    }
+  for (uint32_t v = nr_of_vertices; v > 0; --v)
+    vc->first[v] = vc->first[v - 1];
+  vc->first[0] = 0;
+  }
+
+/*
+Returns the corner opposite to the edge of corner in the first other triangle that shares this edge, or TRICO_NO_CORNER on a border.
+The neighbour is found among the corners of one of the endpoints of the edge, so the cost is proportional to its valence.
+*/
+static uint32_t find_opposite_corner(const struct trico_vertex_corners* vc, const uint32_t* triangles, uint32_t corner)
+  {
+  const uint32_t u = triangles[next_corner(corner)];
+  const uint32_t w = triangles[previous_corner(corner)];
+  if (u == w)
+    return TRICO_NO_CORNER;
+  const uint32_t triangle = corner / 3;
+  for (uint32_t i = vc->first[u]; i < vc->first[u + 1]; ++i)
+    {
+    const struct trico_corner* entry = &vc->corners[i];
+    if (entry->next_vertex == w && entry->corner / 3 != triangle)
+      return previous_corner(entry->corner);
+    if (entry->previous_vertex == w && entry->corner / 3 != triangle)
+      return next_corner(entry->corner);
+    }
+  return TRICO_NO_CORNER;
+  }
+
+/*
+Checks the vertex indices, and takes room for the corners around each vertex followed by extra_bytes from the scratch buffer of context.
+Returns a pointer to the extra bytes, or NULL.
+*/
+static uint8_t* get_vertex_corners(struct trico_vertex_corners* vc, void* context, const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices, uint64_t extra_bytes)
+  {
+  const uint64_t nr_of_corners = (uint64_t)nr_of_triangles * 3;
+  if (nr_of_corners > 0xffffffff)
+    return NULL;
+  for (uint64_t c = 0; c < nr_of_corners; ++c)
+    {
+    if (triangles[c] >= nr_of_vertices)
+      return NULL;
+    }
+  const uint64_t corners_size = nr_of_corners * sizeof(struct trico_corner) + ((uint64_t)nr_of_vertices + 1) * sizeof(uint32_t);
+  uint8_t* scratch = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_SCRATCH_BUFFER, corners_size + extra_bytes);
+  if (!scratch)
+    return NULL;
+  vc->corners = (struct trico_corner*)scratch;
+  vc->first = (uint32_t*)(vc->corners + nr_of_corners);
+  build_vertex_corners(vc, triangles, (uint32_t)nr_of_corners, nr_of_vertices);
+  return scratch + corners_size;
+  }
+
+int trico_find_previous_neighbours(void* context, uint32_t* neighbours, const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices)
+  {
+  struct trico_vertex_corners vc;
+  if (!get_vertex_corners(&vc, context, triangles, nr_of_triangles, nr_of_vertices, 0))
+    return 0;
+  const uint32_t nr_of_corners = nr_of_triangles * 3;
+  for (uint32_t c = 0; c < nr_of_corners; ++c)
+    {
+    // the neighbour has the edge w -> u where this triangle has u -> w, it is found among the corners of u,
+    // which are in triangle order, so the last one before this triangle is the last match before the corners of this triangle
+    const uint32_t u = triangles[next_corner(c)];
+    const uint32_t w = triangles[previous_corner(c)];
+    const uint32_t first_corner_of_triangle = c - c % 3;
+    neighbours[c] = TRICO_NO_NEIGHBOUR;
+    for (uint32_t i = vc.first[u]; i < vc.first[u + 1] && vc.corners[i].corner < first_corner_of_triangle; ++i)
+      {
+      if (vc.corners[i].previous_vertex == w)
+        neighbours[c] = next_corner(vc.corners[i].corner);
+      }
+    }
+  return 1;
+  }
+
+int trico_compute_vertex_predictions(void* context, struct trico_vertex_prediction* predictions, const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices)
+  {
+  const uint64_t nr_of_corners = (uint64_t)nr_of_triangles * 3;
+  struct trico_vertex_corners vc;
+  uint32_t* opposite = (uint32_t*)get_vertex_corners(&vc, context, triangles, nr_of_triangles, nr_of_vertices, (nr_of_corners + nr_of_triangles) * sizeof(uint32_t) + nr_of_triangles + nr_of_vertices);
+  if (!opposite)
+    return 0;
+  uint32_t* queue = opposite + nr_of_corners;
+  uint8_t* visited = (uint8_t*)(queue + nr_of_triangles);
+  uint8_t* known = visited + nr_of_triangles;
+  memset(visited, 0, nr_of_triangles);
+  memset(known, 0, nr_of_vertices);
+  // in the order of the triangles, which is usually more local than the traversal order,
+  // and an edge that is shared by two triangles is searched only once
+  memset(opposite, 0xff, nr_of_corners * sizeof(uint32_t));
+  for (uint32_t c = 0; c < nr_of_corners; ++c)
+    {
+    if (opposite[c] != TRICO_UNKNOWN_CORNER)
+      continue;
+    opposite[c] = find_opposite_corner(&vc, triangles, c);
+    if (opposite[c] != TRICO_NO_CORNER && opposite[opposite[c]] == TRICO_UNKNOWN_CORNER)
+      opposite[opposite[c]] = c;
+    }
+
+  uint32_t nr_of_predictions = 0;
+  uint32_t previous = TRICO_NO_VERTEX;
+  for (uint32_t seed = 0; seed < nr_of_triangles; ++seed)
+    {
+    if (visited[seed])
+      continue;
+    visited[seed] = 1;
+    queue[0] = seed;
+    uint32_t head = 0;
+    uint32_t tail = 1;
+    while (head < tail)
+      {
+      const uint32_t t = queue[head++];
+      for (uint32_t k = 0; k < 3; ++k)
+        {
+        const uint32_t c = 3 * t + k;
+        const uint32_t v = triangles[c];
+        if (known[v])
+          continue;
+        const uint32_t a = triangles[next_corner(c)];
+        const uint32_t b = triangles[previous_corner(c)];
+        struct trico_vertex_prediction* p = &predictions[nr_of_predictions++];
+        p->vertex = v;
+        p->b = TRICO_NO_VERTEX;
+        p->c = TRICO_NO_VERTEX;
+        if (known[a] && known[b])
+          {
+          p->a = a;
+          p->b = b;
+          // the opposite vertex only predicts if the decoder knows it at this point as well
+          if (opposite[c] != TRICO_NO_CORNER && known[triangles[opposite[c]]])
+            p->c = triangles[opposite[c]];
+          }
+        else if (known[a])
+          p->a = a;
+        else if (known[b])
+          p->a = b;
+        else
+          p->a = previous;
+        known[v] = 1;
+        previous = v;
+        }
+      for (uint32_t c = 3 * t; c < 3 * t + 3; ++c)
+        {
+        if (opposite[c] != TRICO_NO_CORNER && !visited[opposite[c] / 3])
+          {
+          visited[opposite[c] / 3] = 1;
+          queue[tail++] = opposite[c] / 3;
+          }
+        }
+      }
+    }
+  for (uint32_t v = 0; v < nr_of_vertices; ++v)
+    {
+    if (known[v])
+      continue;
+    struct trico_vertex_prediction* p = &predictions[nr_of_predictions++];
+    p->vertex = v;
+    p->a = previous;
+    p->b = TRICO_NO_VERTEX;
+    p->c = TRICO_NO_VERTEX;
+    previous = v;
+    }
+  return 1;
+  }
+
+/*
+Returns the next fanning vertex: the candidate with live triangles that entered the cache longest ago, but will still be in the cache
+after its live triangles are emitted, else the most recent dead end with live triangles, else the next vertex in index order with
+live triangles, else TRICO_NO_VERTEX.
+*/
+static uint32_t get_next_fanning_vertex(const uint32_t* candidates, uint32_t nr_of_candidates, const uint32_t* live, const uint32_t* time_stamps, uint32_t time,
+  uint32_t cache_size, const uint32_t* dead_ends, uint32_t* nr_of_dead_ends, uint32_t* cursor, uint32_t nr_of_vertices)
+  {
+  uint32_t best = TRICO_NO_VERTEX;
+  int64_t best_priority = -1;
+  for (uint32_t i = 0; i < nr_of_candidates; ++i)
+    {
+    const uint32_t v = candidates[i];
+    if (live[v] == 0)
+      continue;
+    int64_t priority = 0;
+    if ((int64_t)time - time_stamps[v] + 2 * (int64_t)live[v] <= cache_size)
+      priority = (int64_t)time - time_stamps[v];
+    if (priority > best_priority)
+      {
+      best_priority = priority;
+      best = v;
+      }
+    }
+  if (best != TRICO_NO_VERTEX)
+    return best;
+  while (*nr_of_dead_ends > 0)
+    {
+    const uint32_t v = dead_ends[--(*nr_of_dead_ends)];
+    if (live[v] > 0)
+      return v;
+    }
+  while (*cursor < nr_of_vertices)
+    {
+    if (live[*cursor] > 0)
+      return *cursor;
+    ++(*cursor);
+    }
+  return TRICO_NO_VERTEX;
+  }
+
+int trico_optimize_triangle_order(void* context, uint32_t* triangle_order, const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices, uint32_t cache_size)
+  {
+  if (nr_of_triangles == 0)
+    return 1;
+  const uint64_t nr_of_corners = (uint64_t)nr_of_triangles * 3;
+  struct trico_vertex_corners vc;
+  uint32_t* live = (uint32_t*)get_vertex_corners(&vc, context, triangles, nr_of_triangles, nr_of_vertices,
+    (2 * (uint64_t)nr_of_vertices + 2 * nr_of_corners) * sizeof(uint32_t) + nr_of_triangles);
+  if (!live)
+    return 0;
+  uint32_t* time_stamps = live + nr_of_vertices;
+  uint32_t* dead_ends = time_stamps + nr_of_vertices;
+  uint32_t* candidates = dead_ends + nr_of_corners;
+  uint8_t* emitted = (uint8_t*)(candidates + nr_of_corners);
+  for (uint32_t v = 0; v < nr_of_vertices; ++v)
+    live[v] = vc.first[v + 1] - vc.first[v];
+  memset(time_stamps, 0, (uint64_t)nr_of_vertices * sizeof(uint32_t));
+  memset(emitted, 0, nr_of_triangles);
+
+  uint32_t nr_of_dead_ends = 0;
+  uint32_t cursor = 0;
+  uint32_t nr_of_emitted_triangles = 0;
+  // time starts after the cache size, so that a vertex with time stamp 0 is not in the cache
+  uint32_t time = cache_size + 1;
+  uint32_t fanning_vertex = triangles[0];
+  while (fanning_vertex != TRICO_NO_VERTEX)
+    {
+    uint32_t nr_of_candidates = 0;
+    for (uint32_t i = vc.first[fanning_vertex]; i < vc.first[fanning_vertex + 1]; ++i)
+      {
+      const uint32_t t = vc.corners[i].corner / 3;
+      if (emitted[t])
+        continue;
+      emitted[t] = 1;
+      triangle_order[nr_of_emitted_triangles++] = t;
+      for (uint32_t c = 3 * t; c < 3 * t + 3; ++c)
+        {
+        const uint32_t v = triangles[c];
+        dead_ends[nr_of_dead_ends++] = v;
+        candidates[nr_of_candidates++] = v;
+        --live[v];
+        if (time - time_stamps[v] > cache_size)
+          time_stamps[v] = time++;
+        }
+      }
+    fanning_vertex = get_next_fanning_vertex(candidates, nr_of_candidates, live, time_stamps, time, cache_size, dead_ends, &nr_of_dead_ends, &cursor, nr_of_vertices);
+    }
+  return 1;
+  }
+
+int trico_renumber_vertices(void* context, uint32_t* original_indices, uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices)
+  {
+  const uint64_t nr_of_corners = (uint64_t)nr_of_triangles * 3;
+  for (uint64_t c = 0; c < nr_of_corners; ++c)
+    {
+    if (triangles[c] >= nr_of_vertices)
+      return 0;
+    }
+  uint32_t* new_indices = (uint32_t*)trico_get_context_buffer(context, TRICO_CONTEXT_SCRATCH_BUFFER, (uint64_t)nr_of_vertices * sizeof(uint32_t));
+  if (!new_indices && nr_of_vertices > 0)
+    return 0;
+  memset(new_indices, 0xff, (uint64_t)nr_of_vertices * sizeof(uint32_t));
+  uint32_t nr_of_used_vertices = 0;
+  for (uint64_t c = 0; c < nr_of_corners; ++c)
+    {
+    const uint32_t v = triangles[c];
+    if (new_indices[v] == TRICO_NO_VERTEX)
+      {
+      new_indices[v] = nr_of_used_vertices;
+      original_indices[nr_of_used_vertices++] = v;
+      }
+    triangles[c] = new_indices[v];
+    }
+  for (uint32_t v = 0; v < nr_of_vertices; ++v)
+    {
+    if (new_indices[v] == TRICO_NO_VERTEX)
+      original_indices[nr_of_used_vertices++] = v;
+    }
+  return 1;
+  }
+
+void trico_gather_elements(void* destination, const void* source, uint32_t element_size, const uint32_t* indices, uint32_t count)
+  {
+  uint8_t* d = (uint8_t*)destination;
+  const uint8_t* s = (const uint8_t*)source;
+  for (uint32_t i = 0; i < count; ++i)
+    memcpy(d + (uint64_t)i * element_size, s + (uint64_t)indices[i] * element_size, element_size);
+  }
+
+void trico_scatter_elements(void* destination, const void* source, uint32_t element_size, const uint32_t* indices, uint32_t count)
+  {
+  uint8_t* d = (uint8_t*)destination;
+  const uint8_t* s = (const uint8_t*)source;
+  for (uint32_t i = 0; i < count; ++i)
+    memcpy(d + (uint64_t)indices[i] * element_size, s + (uint64_t)i * element_size, element_size);
+  }
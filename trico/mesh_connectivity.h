@@ -0,0 +1,78 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_MESH_CONNECTIVITY_H
+#define TRICO_MESH_CONNECTIVITY_H
+
+#include "trico_api.h"
+
+#include <stdint.h>
+
+#define TRICO_NO_VERTEX 0xffffffff
+
+/*
+Prediction of a vertex from vertices that precede it in the traversal order:
+a + b - c (parallelogram rule) if a, b and c are given, the midpoint of a and b if c is TRICO_NO_VERTEX,
+a if only a is given (the previous vertex, for the first vertex of a connected component), and 0 if nothing is given.
+*/
+struct trico_vertex_prediction
+  {
+  uint32_t vertex;
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+  };
+
+/*
+Traverses the triangles breadth first over shared edges, starting a new traversal at the first unvisited triangle
+for each connected component. A vertex that is reached through a triangle of which the other two vertices are known
+is predicted by the parallelogram it forms with the triangle on the other side of their edge, if that triangle was visited.
+predictions[i] receives the prediction of the i-th vertex in traversal order. Vertices that are not used by any triangle
+follow in index order. The traversal only depends on the triangles, so that a decoder with the same triangles finds the same
+predictions. Temporary memory is taken from the scratch buffer of context.
+Returns 0 if a triangle refers to a vertex index >= nr_of_vertices, or if the memory is not available.
+*/
+TRICO_API int trico_compute_vertex_predictions(void* context, struct trico_vertex_prediction* predictions, const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices);
+
+#define TRICO_NO_NEIGHBOUR 0xffffffff
+
+/*
+For each corner c of triangle t, neighbours[c] receives the corner opposite to the edge of c in the last triangle before t
+that contains this edge in the opposite direction (so a consistently oriented neighbour), or TRICO_NO_NEIGHBOUR if there is none.
+Temporary memory is taken from the scratch buffer of context.
+Returns 0 if a triangle refers to a vertex index >= nr_of_vertices, or if the memory is not available.
+*/
+TRICO_API int trico_find_previous_neighbours(void* context, uint32_t* neighbours, const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices);
+
+/*
+Computes an order of the triangles with good locality for a vertex cache of cache_size entries (Tipsify, Sander et al. 2007),
+which also helps the compression of the triangles and of the vertices that are renumbered in this order.
+The triangles are emitted in fans around vertices that are still in the cache, and the order of the corners of a triangle is kept.
+triangle_order[i] receives the index of the triangle that comes at position i, apply it with trico_gather_elements.
+Temporary memory is taken from the scratch buffer of context.
+Returns 0 if a triangle refers to a vertex index >= nr_of_vertices, or if the memory is not available.
+*/
+TRICO_API int trico_optimize_triangle_order(void* context, uint32_t* triangle_order, const uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices, uint32_t cache_size);
+
+/*
+Renumbers the vertices in the order in which the triangles first use them, followed by the unused vertices in their original order.
+The triangles are renumbered in place, and original_indices[i] receives the original index of vertex i, so the vertex data
+is renumbered with trico_gather_elements, and restored with trico_scatter_elements.
+Temporary memory is taken from the scratch buffer of context.
+Returns 0, without changing the triangles, if a triangle refers to a vertex index >= nr_of_vertices, or if the memory is not available.
+*/
+TRICO_API int trico_renumber_vertices(void* context, uint32_t* original_indices, uint32_t* triangles, uint32_t nr_of_triangles, uint32_t nr_of_vertices);
+
+/*
+Element i of destination receives element indices[i] of source (gather), or element i of source is written to element indices[i]
+of destination (scatter), for count elements of element_size bytes. Source and destination should not overlap.
+*/
+TRICO_API void trico_gather_elements(void* destination, const void* source, uint32_t element_size, const uint32_t* indices, uint32_t count);
+TRICO_API void trico_scatter_elements(void* destination, const void* source, uint32_t element_size, const uint32_t* indices, uint32_t count);
+
+#endif // #ifndef TRICO_MESH_CONNECTIVITY_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
@@ -0,0 +1,148 @@
+#include "parallel.h"
+#include "alloc.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+struct trico_parallel_for_data
+  {
+  trico_parallel_task task;
+  void* user_data;
+  uint32_t nr_of_tasks;
+  volatile long next_task;
+  };
+
+struct trico_parallel_for_worker
+  {
+  struct trico_parallel_for_data* data;
+  uint32_t thread_index;
+  };
+
+static uint32_t trico_fetch_next_task(struct trico_parallel_for_data* data)
+  {
+#ifdef _WIN32
+  return (uint32_t)(InterlockedIncrement(&data->next_task) - 1);
+#else
+  return (uint32_t)__atomic_fetch_add(&data->next_task, 1, __ATOMIC_RELAXED);
+#endif
+  }
+
+static void trico_parallel_for_run(struct trico_parallel_for_worker* worker)
+  {
+  struct trico_parallel_for_data* data = worker->data;
+  uint32_t task_index = trico_fetch_next_task(data);
+  while (task_index < data->nr_of_tasks)
+    {
+    data->task(data->user_data, task_index, worker->thread_index);
+    task_index = trico_fetch_next_task(data);
+    }
+  }
+
+#ifdef _WIN32
+static DWORD WINAPI trico_parallel_for_thread(LPVOID param)
+  {
+  trico_parallel_for_run((struct trico_parallel_for_worker*)param);
+  return 0;
+  }
+#else
+static void* trico_parallel_for_thread(void* param)
+  {
+  trico_parallel_for_run((struct trico_parallel_for_worker*)param);
+  return NULL;
+  }
+#endif
+
+uint32_t trico_get_number_of_hardware_threads(void)
+  {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+#else
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (uint32_t)n : 1;
+#endif
+  }
+
+uint32_t trico_get_number_of_workers(uint32_t nr_of_tasks, uint32_t nr_of_threads)
+  {
+  if (nr_of_threads == 0)
+    nr_of_threads = trico_get_number_of_hardware_threads();
+  if (nr_of_threads > nr_of_tasks)
+    nr_of_threads = nr_of_tasks;
+  return nr_of_threads > 0 ? nr_of_threads : 1;
+  }
+
+void trico_parallel_for(trico_parallel_task task, void* user_data, uint32_t nr_of_tasks, uint32_t nr_of_threads)
+  {
+  nr_of_threads = trico_get_number_of_workers(nr_of_tasks, nr_of_threads);
+
+  if (nr_of_threads == 1)
+    {
+    for (uint32_t i = 0; i < nr_of_tasks; ++i)
+      task(user_data, i, 0);
+    return;
+    }
+
+  struct trico_parallel_for_data data;
+  data.task = task;
+  data.user_data = user_data;
+  data.nr_of_tasks = nr_of_tasks;
+  data.next_task = 0;
+
+  struct trico_parallel_for_worker* workers = (struct trico_parallel_for_worker*)trico_malloc(nr_of_threads * sizeof(struct trico_parallel_for_worker));
+#ifdef _WIN32
+  HANDLE* threads = (HANDLE*)trico_malloc(nr_of_threads * sizeof(HANDLE));
+#else
+  pthread_t* threads = (pthread_t*)trico_malloc(nr_of_threads * sizeof(pthread_t));
+#endif
+  int* started = (int*)trico_calloc(nr_of_threads, sizeof(int));
+  if (!workers || !threads || !started)
+    {
+    trico_free(started);
+    trico_free(threads);
+    trico_free(workers);
+    for (uint32_t i = 0; i < nr_of_tasks; ++i)
+      task(user_data, i, 0);
+    return;
+    }
+
+  for (uint32_t t = 0; t < nr_of_threads; ++t)
+    {
+    workers[t].data = &data;
+    workers[t].thread_index = t;
+    }
+
+  // worker 0 is the calling thread, if a thread cannot be started the remaining workers simply take over its tasks
+  for (uint32_t t = 1; t < nr_of_threads; ++t)
+    {
+#ifdef _WIN32
+    threads[t] = CreateThread(NULL, 0, trico_parallel_for_thread, &workers[t], 0, NULL);
+    started[t] = threads[t] != NULL ? 1 : 0;
+#else
+    started[t] = pthread_create(&threads[t], NULL, trico_parallel_for_thread, &workers[t]) == 0 ? 1 : 0;
+#endif
+    }
+
+  trico_parallel_for_run(&workers[0]);
+
+  for (uint32_t t = 1; t < nr_of_threads; ++t)
+    {
+    if (!started[t])
+      continue;
+#ifdef _WIN32
+    WaitForSingleObject(threads[t], INFINITE);
+    CloseHandle(threads[t]);
+#else
+    pthread_join(threads[t], NULL);
+#endif
+    }
+
+  trico_free(started);
+  trico_free(threads);
+  trico_free(workers);
+  }
@@ -0,0 +1,38 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_PARALLEL_H
+#define TRICO_PARALLEL_H
+
+#include "trico_api.h"
+
+#include <stdint.h>
+
+/*
+Task callback for trico_parallel_for.
+task_index runs over [0, nr_of_tasks), thread_index over [0, nr_of_threads) and identifies
+the worker that executes the task, so that callers can keep per-thread scratch memory.
+*/
+typedef void (*trico_parallel_task)(void* user_data, uint32_t task_index, uint32_t thread_index);
+
+TRICO_API uint32_t trico_get_number_of_hardware_threads(void);
+
+/*
+Returns the number of workers trico_parallel_for will use for the given arguments.
+A value of 0 for nr_of_threads means: use all hardware threads.
+*/
+TRICO_API uint32_t trico_get_number_of_workers(uint32_t nr_of_tasks, uint32_t nr_of_threads);
+
+/*
+Runs task(user_data, i, thread_index) for all i in [0, nr_of_tasks).
+The calling thread takes part in the work, so nr_of_threads == 1 runs everything serially without spawning threads.
+Returns when all tasks are finished.
+*/
+TRICO_API void trico_parallel_for(trico_parallel_task task, void* user_data, uint32_t nr_of_tasks, uint32_t nr_of_threads);
+
+#endif // #ifndef TRICO_PARALLEL_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
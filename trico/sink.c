@@ -0,0 +1,37 @@
+#include "sink.h"
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+int trico_write_to_file(void* file, const uint8_t* data, uint64_t size)
+  {
+  return fwrite(data, 1, (size_t)size, (FILE*)file) == (size_t)size ? 1 : 0;
+  }
+
+int trico_write_to_file_descriptor(void* fd, const uint8_t* data, uint64_t size)
+  {
+  const int file_descriptor = (int)(intptr_t)fd;
+  while (size > 0)
+    {
+    // stay well below the 2GB limit of a single write call on some platforms
+    const uint64_t chunk = size > 0x40000000 ? 0x40000000 : size;
+#ifdef _WIN32
+    int bytes_written = _write(file_descriptor, data, (unsigned int)chunk);
+#else
+    ssize_t bytes_written = write(file_descriptor, data, (size_t)chunk);
+    if (bytes_written < 0 && errno == EINTR)
+      continue;
+#endif
+    if (bytes_written <= 0)
+      return 0;
+    data += bytes_written;
+    size -= (uint64_t)bytes_written;
+    }
+  return 1;
+  }
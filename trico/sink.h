@@ -0,0 +1,32 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_SINK_H
+#define TRICO_SINK_H
+
+#include "trico_api.h"
+#include <stdint.h>
+
+/*
+Callback that receives the bytes of an archive opened with trico_open_archive_for_writing_to_callback.
+Returns 1 on success, 0 on failure.
+*/
+typedef int (*trico_write_callback)(void* user_data, const uint8_t* data, uint64_t size);
+
+/*
+Write callback for a FILE*, passed as user_data.
+*/
+TRICO_API int trico_write_to_file(void* file, const uint8_t* data, uint64_t size);
+
+/*
+Write callback for a file descriptor, passed as user_data by casting it with (void*)(intptr_t)fd.
+Partial writes are continued until all bytes are written.
+*/
+TRICO_API int trico_write_to_file_descriptor(void* fd, const uint8_t* data, uint64_t size);
+
+#endif // #ifndef TRICO_SINK_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
@@ -4,145 +4,950 @@
 #include <stdlib.h>
 #include <stdint.h>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRICO_HAS_SSE2
+#include <emmintrin.h>
+#endif
 
-void trico_transpose_xyz_aos_to_soa(float** x, float** y, float** z, const float* vertices, uint32_t nr_of_vertices)
+#if defined(TRICO_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER))
+#define TRICO_HAS_AVX2
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TRICO_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#include <intrin.h>
+#define TRICO_TARGET_AVX2
+#endif
+#endif
+
+/*
+Scalar reference versions, which also handle the tails of the vectorized versions.
+*/
+
+static void xyz_aos_to_soa_scalar(float* x, float* y, float* z, const float* vertices, uint32_t nr_of_vertices)
   {
   for (uint32_t i = 0; i < nr_of_vertices; ++i)
     {
-    (*x)[i] = *vertices++;
-    (*y)[i] = *vertices++;
-    (*z)[i] = *vertices++;
+    x[i] = *vertices++;
+    y[i] = *vertices++;
+    z[i] = *vertices++;
     }
   }
 
-void trico_transpose_xyz_soa_to_aos(float** vertices, const float* x, const float* y, const float* z, uint32_t nr_of_vertices)
+static void xyz_soa_to_aos_scalar(float* vertices, const float* x, const float* y, const float* z, uint32_t nr_of_vertices)
   {
   for (uint32_t i = 0; i < nr_of_vertices; ++i)
     {
-    (*vertices)[i * 3] = *x++;
-    (*vertices)[i * 3 + 1] = *y++;
-    (*vertices)[i * 3 + 2] = *z++;
+    *vertices++ = x[i];
+    *vertices++ = y[i];
+    *vertices++ = z[i];
     }
   }
 
-void trico_transpose_xyz_aos_to_soa_double_precision(double** x, double** y, double** z, const double* vertices, uint32_t nr_of_vertices)
+static void xyz_aos_to_soa_double_scalar(double* x, double* y, double* z, const double* vertices, uint32_t nr_of_vertices)
   {
   for (uint32_t i = 0; i < nr_of_vertices; ++i)
     {
-    (*x)[i] = *vertices++;
-    (*y)[i] = *vertices++;
-    (*z)[i] = *vertices++;
+    x[i] = *vertices++;
+    y[i] = *vertices++;
+    z[i] = *vertices++;
     }
   }
 
-void trico_transpose_xyz_soa_to_aos_double_precision(double** vertices, const double* x, const double* y, const double* z, uint32_t nr_of_vertices)
+static void xyz_soa_to_aos_double_scalar(double* vertices, const double* x, const double* y, const double* z, uint32_t nr_of_vertices)
   {
   for (uint32_t i = 0; i < nr_of_vertices; ++i)
     {
-    (*vertices)[i * 3] = *x++;
-    (*vertices)[i * 3 + 1] = *y++;
-    (*vertices)[i * 3 + 2] = *z++;
+    *vertices++ = x[i];
+    *vertices++ = y[i];
+    *vertices++ = z[i];
     }
   }
 
-void trico_transpose_uv_aos_to_soa(float** u, float** v, const float* uv, uint32_t nr_of_uv_positions)
+static void uv_aos_to_soa_scalar(float* u, float* v, const float* uv, uint32_t nr_of_uv_positions)
   {
   for (uint32_t i = 0; i < nr_of_uv_positions; ++i)
     {
-    (*u)[i] = *uv++;
-    (*v)[i] = *uv++;
+    u[i] = *uv++;
+    v[i] = *uv++;
     }
   }
 
-void trico_transpose_uv_soa_to_aos(float** uv, const float* u, const float* v, uint32_t nr_of_uv_positions)
+static void uv_soa_to_aos_scalar(float* uv, const float* u, const float* v, uint32_t nr_of_uv_positions)
   {
   for (uint32_t i = 0; i < nr_of_uv_positions; ++i)
     {
-    (*uv)[i * 2] = *u++;
-    (*uv)[i * 2 + 1] = *v++;
+    *uv++ = u[i];
+    *uv++ = v[i];
     }
   }
 
-void trico_transpose_uv_aos_to_soa_double_precision(double** u, double** v, const double* uv, uint32_t nr_of_uv_positions)
+static void uv_aos_to_soa_double_scalar(double* u, double* v, const double* uv, uint32_t nr_of_uv_positions)
   {
   for (uint32_t i = 0; i < nr_of_uv_positions; ++i)
     {
-    (*u)[i] = *uv++;
-    (*v)[i] = *uv++;
+    u[i] = *uv++;
+    v[i] = *uv++;
     }
   }
 
-void trico_transpose_uv_soa_to_aos_double_precision(double** uv, const double* u, const double* v, uint32_t nr_of_uv_positions)
+static void uv_soa_to_aos_double_scalar(double* uv, const double* u, const double* v, uint32_t nr_of_uv_positions)
   {
   for (uint32_t i = 0; i < nr_of_uv_positions; ++i)
     {
-    (*uv)[i * 2] = *u++;
-    (*uv)[i * 2 + 1] = *v++;
+    *uv++ = u[i];
+    *uv++ = v[i];
     }
   }
 
-void trico_transpose_uint16_aos_to_soa(uint8_t** b1, uint8_t** b2, const uint16_t* indices, uint32_t nr_of_indices)
+static void uint16_aos_to_soa_scalar(uint8_t* const* b, const uint16_t* indices, uint32_t nr_of_indices)
   {
+  uint8_t* b1 = b[0];
+  uint8_t* b2 = b[1];
   for (uint32_t i = 0; i < nr_of_indices; ++i)
     {
-    const uint16_t index = *indices++;
-    (*b1)[i] = index & 0xff;
-    (*b2)[i] = (index >> 8) & 0xff;
+    const uint16_t index = indices[i];
+    b1[i] = index & 0xff;
+    b2[i] = (index >> 8) & 0xff;
     }
   }
 
-void trico_transpose_uint16_soa_to_aos(uint16_t** indices, const uint8_t* b1, const uint8_t* b2, uint32_t nr_of_indices)
+static void uint16_soa_to_aos_scalar(uint16_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
+  {
+  const uint8_t* b1 = b[0];
+  const uint8_t* b2 = b[1];
+  for (uint32_t i = 0; i < nr_of_indices; ++i)
+    indices[i] = (uint16_t)((uint32_t)b1[i] | (uint32_t)b2[i] << 8);
+  }
+
+static void uint32_aos_to_soa_scalar(uint8_t* const* b, const uint32_t* indices, uint32_t nr_of_indices)
   {
+  uint8_t* b1 = b[0];
+  uint8_t* b2 = b[1];
+  uint8_t* b3 = b[2];
+  uint8_t* b4 = b[3];
   for (uint32_t i = 0; i < nr_of_indices; ++i)
     {
-    const uint16_t index = (uint32_t)(*b1++) | (uint32_t)(*b2++) << 8;
-    (*indices)[i] = index;
+    const uint32_t index = indices[i];
+    b1[i] = index & 0xff;
+    b2[i] = (index >> 8) & 0xff;
+    b3[i] = (index >> 16) & 0xff;
+    b4[i] = (index >> 24) & 0xff;
     }
   }
 
-void trico_transpose_uint32_aos_to_soa(uint8_t** b1, uint8_t** b2, uint8_t** b3, uint8_t** b4, const uint32_t* indices, uint32_t nr_of_indices)
+static void uint32_soa_to_aos_scalar(uint32_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
   {
+  const uint8_t* b1 = b[0];
+  const uint8_t* b2 = b[1];
+  const uint8_t* b3 = b[2];
+  const uint8_t* b4 = b[3];
+  for (uint32_t i = 0; i < nr_of_indices; ++i)
+    indices[i] = (uint32_t)b1[i] | (uint32_t)b2[i] << 8 | (uint32_t)b3[i] << 16 | (uint32_t)b4[i] << 24;
+  }
+
+static void uint64_aos_to_soa_scalar(uint8_t* const* b, const uint64_t* indices, uint32_t nr_of_indices)
+  {
+  uint8_t* b1 = b[0];
+  uint8_t* b2 = b[1];
+  uint8_t* b3 = b[2];
+  uint8_t* b4 = b[3];
+  uint8_t* b5 = b[4];
+  uint8_t* b6 = b[5];
+  uint8_t* b7 = b[6];
+  uint8_t* b8 = b[7];
   for (uint32_t i = 0; i < nr_of_indices; ++i)
     {
-    const uint32_t index = *indices++;
-    (*b1)[i] = index & 0xff;
-    (*b2)[i] = (index >> 8) & 0xff;
-    (*b3)[i] = (index >> 16) & 0xff;
-    (*b4)[i] = (index >> 24) & 0xff;
+    const uint64_t index = indices[i];
+    b1[i] = index & 0xff;
+    b2[i] = (index >> 8) & 0xff;
+    b3[i] = (index >> 16) & 0xff;
+    b4[i] = (index >> 24) & 0xff;
+    b5[i] = (index >> 32) & 0xff;
+    b6[i] = (index >> 40) & 0xff;
+    b7[i] = (index >> 48) & 0xff;
+    b8[i] = (index >> 56) & 0xff;
     }
   }
 
-void trico_transpose_uint32_soa_to_aos(uint32_t** indices, const uint8_t* b1, const uint8_t* b2, const uint8_t* b3, const uint8_t* b4, uint32_t nr_of_indices)
+static void uint64_soa_to_aos_scalar(uint64_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
   {
+  const uint8_t* b1 = b[0];
+  const uint8_t* b2 = b[1];
+  const uint8_t* b3 = b[2];
+  const uint8_t* b4 = b[3];
+  const uint8_t* b5 = b[4];
+  const uint8_t* b6 = b[5];
+  const uint8_t* b7 = b[6];
+  const uint8_t* b8 = b[7];
   for (uint32_t i = 0; i < nr_of_indices; ++i)
+    indices[i] = (uint64_t)b1[i] | (uint64_t)b2[i] << 8 | (uint64_t)b3[i] << 16 | (uint64_t)b4[i] << 24 | (uint64_t)b5[i] << 32 | (uint64_t)b6[i] << 40 | (uint64_t)b7[i] << 48 | (uint64_t)b8[i] << 56;
+  }
+
+/*
+Moves the byte plane pointers b forward by offset elements, for passing the tail to the scalar version.
+*/
+static void offset_planes(uint8_t** dst, uint8_t* const* b, int nr_of_planes, uint32_t offset)
+  {
+  for (int j = 0; j < nr_of_planes; ++j)
+    dst[j] = b[j] + offset;
+  }
+
+static void offset_const_planes(const uint8_t** dst, const uint8_t* const* b, int nr_of_planes, uint32_t offset)
+  {
+  for (int j = 0; j < nr_of_planes; ++j)
+    dst[j] = b[j] + offset;
+  }
+
+#ifdef TRICO_HAS_SSE2
+
+/*
+SSE2 versions: 4 floats, 2 doubles or 16 bytes per register. Loads and stores are unaligned.
+*/
+
+static void xyz_aos_to_soa_sse2(float* x, float* y, float* z, const float* vertices, uint32_t nr_of_vertices)
+  {
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_vertices; i += 4, vertices += 12)
     {
-    const uint32_t index = (uint32_t)(*b1++) | (uint32_t)(*b2++) << 8 | (uint32_t)(*b3++) << 16 | (uint32_t)(*b4++) << 24;
-    (*indices)[i] = index;
+    const __m128 a = _mm_loadu_ps(vertices); // x0 y0 z0 x1
+    const __m128 b = _mm_loadu_ps(vertices + 4); // y1 z1 x2 y2
+    const __m128 c = _mm_loadu_ps(vertices + 8); // z2 x3 y3 z3
+    const __m128 x2y2x3y3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    const __m128 y0z0y1z1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    _mm_storeu_ps(x + i, _mm_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0)));
+    _mm_storeu_ps(y + i, _mm_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_ps(z + i, _mm_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1)));
     }
+  xyz_aos_to_soa_scalar(x + i, y + i, z + i, vertices, nr_of_vertices - i);
   }
 
-void trico_transpose_uint64_aos_to_soa(uint8_t** b1, uint8_t** b2, uint8_t** b3, uint8_t** b4, uint8_t** b5, uint8_t** b6, uint8_t** b7, uint8_t** b8, const uint64_t* indices, uint32_t nr_of_indices)
+static void xyz_soa_to_aos_sse2(float* vertices, const float* x, const float* y, const float* z, uint32_t nr_of_vertices)
   {
-  for (uint32_t i = 0; i < nr_of_indices; ++i)
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_vertices; i += 4, vertices += 12)
     {
-    const uint64_t index = *indices++;
-    (*b1)[i] = index & 0xff;
-    (*b2)[i] = (index >> 8) & 0xff;
-    (*b3)[i] = (index >> 16) & 0xff;
-    (*b4)[i] = (index >> 24) & 0xff;
-    (*b5)[i] = (index >> 32) & 0xff;
-    (*b6)[i] = (index >> 40) & 0xff;
-    (*b7)[i] = (index >> 48) & 0xff;
-    (*b8)[i] = (index >> 56) & 0xff;
+    const __m128 xv = _mm_loadu_ps(x + i);
+    const __m128 yv = _mm_loadu_ps(y + i);
+    const __m128 zv = _mm_loadu_ps(z + i);
+    const __m128 x0y0x1y1 = _mm_unpacklo_ps(xv, yv);
+    const __m128 x2y2x3y3 = _mm_unpackhi_ps(xv, yv);
+    const __m128 z0z0x1x1 = _mm_shuffle_ps(zv, xv, _MM_SHUFFLE(1, 1, 0, 0));
+    const __m128 y1y1z1z1 = _mm_shuffle_ps(yv, zv, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 z2z3x3y3 = _mm_shuffle_ps(zv, x2y2x3y3, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm_storeu_ps(vertices, _mm_shuffle_ps(x0y0x1y1, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0)));
+    _mm_storeu_ps(vertices + 4, _mm_shuffle_ps(y1y1z1z1, x2y2x3y3, _MM_SHUFFLE(1, 0, 2, 0)));
+    _mm_storeu_ps(vertices + 8, _mm_shuffle_ps(z2z3x3y3, z2z3x3y3, _MM_SHUFFLE(1, 3, 2, 0)));
     }
+  xyz_soa_to_aos_scalar(vertices, x + i, y + i, z + i, nr_of_vertices - i);
   }
 
-void trico_transpose_uint64_soa_to_aos(uint64_t** indices, const uint8_t* b1, const uint8_t* b2, const uint8_t* b3, const uint8_t* b4, const uint8_t* b5, const uint8_t* b6, const uint8_t* b7, const uint8_t* b8, uint32_t nr_of_indices)
+static void xyz_aos_to_soa_double_sse2(double* x, double* y, double* z, const double* vertices, uint32_t nr_of_vertices)
   {
-  for (uint32_t i = 0; i < nr_of_indices; ++i)
+  uint32_t i = 0;
+  for (; i + 2 <= nr_of_vertices; i += 2, vertices += 6)
+    {
+    const __m128d a = _mm_loadu_pd(vertices); // x0 y0
+    const __m128d b = _mm_loadu_pd(vertices + 2); // z0 x1
+    const __m128d c = _mm_loadu_pd(vertices + 4); // y1 z1
+    _mm_storeu_pd(x + i, _mm_shuffle_pd(a, b, 2));
+    _mm_storeu_pd(y + i, _mm_shuffle_pd(a, c, 1));
+    _mm_storeu_pd(z + i, _mm_shuffle_pd(b, c, 2));
+    }
+  xyz_aos_to_soa_double_scalar(x + i, y + i, z + i, vertices, nr_of_vertices - i);
+  }
+
+static void xyz_soa_to_aos_double_sse2(double* vertices, const double* x, const double* y, const double* z, uint32_t nr_of_vertices)
+  {
+  uint32_t i = 0;
+  for (; i + 2 <= nr_of_vertices; i += 2, vertices += 6)
     {
-    const uint64_t index = (uint64_t)(*b1++) | (uint64_t)(*b2++) << 8 | (uint64_t)(*b3++) << 16 | (uint64_t)(*b4++) << 24 | (uint64_t)(*b5++) << 32 | (uint64_t)(*b6++) << 40 | (uint64_t)(*b7++) << 48 | (uint64_t)(*b8++) << 56;
-    (*indices)[i] = index;
+    const __m128d xv = _mm_loadu_pd(x + i);
+    const __m128d yv = _mm_loadu_pd(y + i);
+    const __m128d zv = _mm_loadu_pd(z + i);
+    _mm_storeu_pd(vertices, _mm_shuffle_pd(xv, yv, 0));
+    _mm_storeu_pd(vertices + 2, _mm_shuffle_pd(zv, xv, 2));
+    _mm_storeu_pd(vertices + 4, _mm_shuffle_pd(yv, zv, 3));
     }
+  xyz_soa_to_aos_double_scalar(vertices, x + i, y + i, z + i, nr_of_vertices - i);
   }
 
+static void uv_aos_to_soa_sse2(float* u, float* v, const float* uv, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_uv_positions; i += 4, uv += 8)
+    {
+    const __m128 a = _mm_loadu_ps(uv); // u0 v0 u1 v1
+    const __m128 b = _mm_loadu_ps(uv + 4); // u2 v2 u3 v3
+    _mm_storeu_ps(u + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(v + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+  uv_aos_to_soa_scalar(u + i, v + i, uv, nr_of_uv_positions - i);
+  }
+
+static void uv_soa_to_aos_sse2(float* uv, const float* u, const float* v, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_uv_positions; i += 4, uv += 8)
+    {
+    const __m128 uu = _mm_loadu_ps(u + i);
+    const __m128 vv = _mm_loadu_ps(v + i);
+    _mm_storeu_ps(uv, _mm_unpacklo_ps(uu, vv));
+    _mm_storeu_ps(uv + 4, _mm_unpackhi_ps(uu, vv));
+    }
+  uv_soa_to_aos_scalar(uv, u + i, v + i, nr_of_uv_positions - i);
+  }
+
+static void uv_aos_to_soa_double_sse2(double* u, double* v, const double* uv, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 2 <= nr_of_uv_positions; i += 2, uv += 4)
+    {
+    const __m128d a = _mm_loadu_pd(uv); // u0 v0
+    const __m128d b = _mm_loadu_pd(uv + 2); // u1 v1
+    _mm_storeu_pd(u + i, _mm_unpacklo_pd(a, b));
+    _mm_storeu_pd(v + i, _mm_unpackhi_pd(a, b));
+    }
+  uv_aos_to_soa_double_scalar(u + i, v + i, uv, nr_of_uv_positions - i);
+  }
+
+static void uv_soa_to_aos_double_sse2(double* uv, const double* u, const double* v, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 2 <= nr_of_uv_positions; i += 2, uv += 4)
+    {
+    const __m128d uu = _mm_loadu_pd(u + i);
+    const __m128d vv = _mm_loadu_pd(v + i);
+    _mm_storeu_pd(uv, _mm_unpacklo_pd(uu, vv));
+    _mm_storeu_pd(uv + 2, _mm_unpackhi_pd(uu, vv));
+    }
+  uv_soa_to_aos_double_scalar(uv, u + i, v + i, nr_of_uv_positions - i);
+  }
+
+static void uint16_aos_to_soa_sse2(uint8_t* const* b, const uint16_t* indices, uint32_t nr_of_indices)
+  {
+  const __m128i low_byte = _mm_set1_epi16(0xff);
+  uint32_t i = 0;
+  for (; i + 16 <= nr_of_indices; i += 16)
+    {
+    const __m128i r0 = _mm_loadu_si128((const __m128i*)(indices + i));
+    const __m128i r1 = _mm_loadu_si128((const __m128i*)(indices + i + 8));
+    _mm_storeu_si128((__m128i*)(b[0] + i), _mm_packus_epi16(_mm_and_si128(r0, low_byte), _mm_and_si128(r1, low_byte)));
+    _mm_storeu_si128((__m128i*)(b[1] + i), _mm_packus_epi16(_mm_srli_epi16(r0, 8), _mm_srli_epi16(r1, 8)));
+    }
+  uint8_t* tail[2];
+  offset_planes(tail, b, 2, i);
+  uint16_aos_to_soa_scalar(tail, indices + i, nr_of_indices - i);
+  }
+
+static void uint16_soa_to_aos_sse2(uint16_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 16 <= nr_of_indices; i += 16)
+    {
+    const __m128i b1 = _mm_loadu_si128((const __m128i*)(b[0] + i));
+    const __m128i b2 = _mm_loadu_si128((const __m128i*)(b[1] + i));
+    _mm_storeu_si128((__m128i*)(indices + i), _mm_unpacklo_epi8(b1, b2));
+    _mm_storeu_si128((__m128i*)(indices + i + 8), _mm_unpackhi_epi8(b1, b2));
+    }
+  const uint8_t* tail[2];
+  offset_const_planes(tail, b, 2, i);
+  uint16_soa_to_aos_scalar(indices + i, tail, nr_of_indices - i);
+  }
+
+/*
+Splits 16 uint32 values in r into 4 byte planes of 16 bytes. The bytes of a plane are isolated in 32 bit lanes
+and then packed with saturation, which does not change them as they are smaller than 256.
+*/
+static void split_uint32_sse2(uint8_t* const* b, uint32_t offset, const __m128i* r)
+  {
+  const __m128i low_byte = _mm_set1_epi32(0xff);
+  for (int j = 0; j < 4; ++j)
+    {
+    const int shift = 8 * j;
+    const __m128i r0 = _mm_and_si128(_mm_srli_epi32(r[0], shift), low_byte);
+    const __m128i r1 = _mm_and_si128(_mm_srli_epi32(r[1], shift), low_byte);
+    const __m128i r2 = _mm_and_si128(_mm_srli_epi32(r[2], shift), low_byte);
+    const __m128i r3 = _mm_and_si128(_mm_srli_epi32(r[3], shift), low_byte);
+    _mm_storeu_si128((__m128i*)(b[j] + offset), _mm_packus_epi16(_mm_packs_epi32(r0, r1), _mm_packs_epi32(r2, r3)));
+    }
+  }
+
+/*
+Merges 4 byte planes of 16 bytes into 16 uint32 values in r.
+*/
+static void merge_uint32_sse2(__m128i* r, const uint8_t* const* b, uint32_t offset)
+  {
+  const __m128i b1 = _mm_loadu_si128((const __m128i*)(b[0] + offset));
+  const __m128i b2 = _mm_loadu_si128((const __m128i*)(b[1] + offset));
+  const __m128i b3 = _mm_loadu_si128((const __m128i*)(b[2] + offset));
+  const __m128i b4 = _mm_loadu_si128((const __m128i*)(b[3] + offset));
+  const __m128i lo12 = _mm_unpacklo_epi8(b1, b2);
+  const __m128i hi12 = _mm_unpackhi_epi8(b1, b2);
+  const __m128i lo34 = _mm_unpacklo_epi8(b3, b4);
+  const __m128i hi34 = _mm_unpackhi_epi8(b3, b4);
+  r[0] = _mm_unpacklo_epi16(lo12, lo34);
+  r[1] = _mm_unpackhi_epi16(lo12, lo34);
+  r[2] = _mm_unpacklo_epi16(hi12, hi34);
+  r[3] = _mm_unpackhi_epi16(hi12, hi34);
+  }
+
+static void uint32_aos_to_soa_sse2(uint8_t* const* b, const uint32_t* indices, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 16 <= nr_of_indices; i += 16)
+    {
+    __m128i r[4];
+    for (int j = 0; j < 4; ++j)
+      r[j] = _mm_loadu_si128((const __m128i*)(indices + i + 4 * j));
+    split_uint32_sse2(b, i, r);
+    }
+  uint8_t* tail[4];
+  offset_planes(tail, b, 4, i);
+  uint32_aos_to_soa_scalar(tail, indices + i, nr_of_indices - i);
+  }
+
+static void uint32_soa_to_aos_sse2(uint32_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 16 <= nr_of_indices; i += 16)
+    {
+    __m128i r[4];
+    merge_uint32_sse2(r, b, i);
+    for (int j = 0; j < 4; ++j)
+      _mm_storeu_si128((__m128i*)(indices + i + 4 * j), r[j]);
+    }
+  const uint8_t* tail[4];
+  offset_const_planes(tail, b, 4, i);
+  uint32_soa_to_aos_scalar(indices + i, tail, nr_of_indices - i);
+  }
+
+/*
+The uint64 versions split the values in their low and high 32 bits, and reuse the uint32 versions for both halves.
+*/
+static void uint64_aos_to_soa_sse2(uint8_t* const* b, const uint64_t* indices, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 16 <= nr_of_indices; i += 16)
+    {
+    __m128i lo[4], hi[4];
+    for (int j = 0; j < 4; ++j)
+      {
+      const __m128i r0 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(indices + i + 4 * j)), _MM_SHUFFLE(3, 1, 2, 0));
+      const __m128i r1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(indices + i + 4 * j + 2)), _MM_SHUFFLE(3, 1, 2, 0));
+      lo[j] = _mm_unpacklo_epi64(r0, r1);
+      hi[j] = _mm_unpackhi_epi64(r0, r1);
+      }
+    split_uint32_sse2(b, i, lo);
+    split_uint32_sse2(b + 4, i, hi);
+    }
+  uint8_t* tail[8];
+  offset_planes(tail, b, 8, i);
+  uint64_aos_to_soa_scalar(tail, indices + i, nr_of_indices - i);
+  }
+
+static void uint64_soa_to_aos_sse2(uint64_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 16 <= nr_of_indices; i += 16)
+    {
+    __m128i lo[4], hi[4];
+    merge_uint32_sse2(lo, b, i);
+    merge_uint32_sse2(hi, b + 4, i);
+    for (int j = 0; j < 4; ++j)
+      {
+      _mm_storeu_si128((__m128i*)(indices + i + 4 * j), _mm_unpacklo_epi32(lo[j], hi[j]));
+      _mm_storeu_si128((__m128i*)(indices + i + 4 * j + 2), _mm_unpackhi_epi32(lo[j], hi[j]));
+      }
+    }
+  const uint8_t* tail[8];
+  offset_const_planes(tail, b, 8, i);
+  uint64_soa_to_aos_scalar(indices + i, tail, nr_of_indices - i);
+  }
+
+#endif // #ifdef TRICO_HAS_SSE2
+
+#ifdef TRICO_HAS_AVX2
+
+/*
+AVX2 versions: the shuffles of the SSE2 versions work within 128 bit lanes, so the xyz versions first gather
+vertices 0-3 in the low lanes and vertices 4-7 in the high lanes, after which the SSE2 shuffles apply unchanged.
+*/
+
+TRICO_TARGET_AVX2 static void xyz_aos_to_soa_avx2(float* x, float* y, float* z, const float* vertices, uint32_t nr_of_vertices)
+  {
+  uint32_t i = 0;
+  for (; i + 8 <= nr_of_vertices; i += 8, vertices += 24)
+    {
+    const __m256 m0 = _mm256_loadu_ps(vertices);
+    const __m256 m1 = _mm256_loadu_ps(vertices + 8);
+    const __m256 m2 = _mm256_loadu_ps(vertices + 16);
+    const __m256 a = _mm256_permute2f128_ps(m0, m1, 0x30);
+    const __m256 b = _mm256_permute2f128_ps(m0, m2, 0x21);
+    const __m256 c = _mm256_permute2f128_ps(m1, m2, 0x30);
+    const __m256 x2y2x3y3 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    const __m256 y0z0y1z1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    _mm256_storeu_ps(x + i, _mm256_shuffle_ps(a, x2y2x3y3, _MM_SHUFFLE(2, 0, 3, 0)));
+    _mm256_storeu_ps(y + i, _mm256_shuffle_ps(y0z0y1z1, x2y2x3y3, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm256_storeu_ps(z + i, _mm256_shuffle_ps(y0z0y1z1, c, _MM_SHUFFLE(3, 0, 3, 1)));
+    }
+  xyz_aos_to_soa_sse2(x + i, y + i, z + i, vertices, nr_of_vertices - i);
+  }
+
+TRICO_TARGET_AVX2 static void xyz_soa_to_aos_avx2(float* vertices, const float* x, const float* y, const float* z, uint32_t nr_of_vertices)
+  {
+  uint32_t i = 0;
+  for (; i + 8 <= nr_of_vertices; i += 8, vertices += 24)
+    {
+    const __m256 xv = _mm256_loadu_ps(x + i);
+    const __m256 yv = _mm256_loadu_ps(y + i);
+    const __m256 zv = _mm256_loadu_ps(z + i);
+    const __m256 x0y0x1y1 = _mm256_unpacklo_ps(xv, yv);
+    const __m256 x2y2x3y3 = _mm256_unpackhi_ps(xv, yv);
+    const __m256 z0z0x1x1 = _mm256_shuffle_ps(zv, xv, _MM_SHUFFLE(1, 1, 0, 0));
+    const __m256 y1y1z1z1 = _mm256_shuffle_ps(yv, zv, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m256 z2z3x3y3 = _mm256_shuffle_ps(zv, x2y2x3y3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 a = _mm256_shuffle_ps(x0y0x1y1, z0z0x1x1, _MM_SHUFFLE(2, 0, 1, 0));
+    const __m256 b = _mm256_shuffle_ps(y1y1z1z1, x2y2x3y3, _MM_SHUFFLE(1, 0, 2, 0));
+    const __m256 c = _mm256_shuffle_ps(z2z3x3y3, z2z3x3y3, _MM_SHUFFLE(1, 3, 2, 0));
+    _mm256_storeu_ps(vertices, _mm256_permute2f128_ps(a, b, 0x20));
+    _mm256_storeu_ps(vertices + 8, _mm256_permute2f128_ps(c, a, 0x30));
+    _mm256_storeu_ps(vertices + 16, _mm256_permute2f128_ps(b, c, 0x31));
+    }
+  xyz_soa_to_aos_sse2(vertices, x + i, y + i, z + i, nr_of_vertices - i);
+  }
+
+TRICO_TARGET_AVX2 static void xyz_aos_to_soa_double_avx2(double* x, double* y, double* z, const double* vertices, uint32_t nr_of_vertices)
+  {
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_vertices; i += 4, vertices += 12)
+    {
+    const __m256d m0 = _mm256_loadu_pd(vertices);
+    const __m256d m1 = _mm256_loadu_pd(vertices + 4);
+    const __m256d m2 = _mm256_loadu_pd(vertices + 8);
+    const __m256d a = _mm256_permute2f128_pd(m0, m1, 0x30);
+    const __m256d b = _mm256_permute2f128_pd(m0, m2, 0x21);
+    const __m256d c = _mm256_permute2f128_pd(m1, m2, 0x30);
+    _mm256_storeu_pd(x + i, _mm256_shuffle_pd(a, b, 10));
+    _mm256_storeu_pd(y + i, _mm256_shuffle_pd(a, c, 5));
+    _mm256_storeu_pd(z + i, _mm256_shuffle_pd(b, c, 10));
+    }
+  xyz_aos_to_soa_double_sse2(x + i, y + i, z + i, vertices, nr_of_vertices - i);
+  }
+
+TRICO_TARGET_AVX2 static void xyz_soa_to_aos_double_avx2(double* vertices, const double* x, const double* y, const double* z, uint32_t nr_of_vertices)
+  {
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_vertices; i += 4, vertices += 12)
+    {
+    const __m256d xv = _mm256_loadu_pd(x + i);
+    const __m256d yv = _mm256_loadu_pd(y + i);
+    const __m256d zv = _mm256_loadu_pd(z + i);
+    const __m256d a = _mm256_shuffle_pd(xv, yv, 0);
+    const __m256d b = _mm256_shuffle_pd(zv, xv, 10);
+    const __m256d c = _mm256_shuffle_pd(yv, zv, 15);
+    _mm256_storeu_pd(vertices, _mm256_permute2f128_pd(a, b, 0x20));
+    _mm256_storeu_pd(vertices + 4, _mm256_permute2f128_pd(c, a, 0x30));
+    _mm256_storeu_pd(vertices + 8, _mm256_permute2f128_pd(b, c, 0x31));
+    }
+  xyz_soa_to_aos_double_sse2(vertices, x + i, y + i, z + i, nr_of_vertices - i);
+  }
+
+/*
+The uv versions shuffle within lanes and then put the 64 bit groups in order across the lanes.
+*/
+TRICO_TARGET_AVX2 static void uv_aos_to_soa_avx2(float* u, float* v, const float* uv, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 8 <= nr_of_uv_positions; i += 8, uv += 16)
+    {
+    const __m256 a = _mm256_loadu_ps(uv);
+    const __m256 b = _mm256_loadu_ps(uv + 8);
+    const __m256d uu = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    const __m256d vv = _mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    _mm256_storeu_ps(u + i, _mm256_castpd_ps(_mm256_permute4x64_pd(uu, _MM_SHUFFLE(3, 1, 2, 0))));
+    _mm256_storeu_ps(v + i, _mm256_castpd_ps(_mm256_permute4x64_pd(vv, _MM_SHUFFLE(3, 1, 2, 0))));
+    }
+  uv_aos_to_soa_sse2(u + i, v + i, uv, nr_of_uv_positions - i);
+  }
+
+TRICO_TARGET_AVX2 static void uv_soa_to_aos_avx2(float* uv, const float* u, const float* v, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 8 <= nr_of_uv_positions; i += 8, uv += 16)
+    {
+    const __m256 uu = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_loadu_ps(u + i)), _MM_SHUFFLE(3, 1, 2, 0)));
+    const __m256 vv = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_loadu_ps(v + i)), _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm256_storeu_ps(uv, _mm256_unpacklo_ps(uu, vv));
+    _mm256_storeu_ps(uv + 8, _mm256_unpackhi_ps(uu, vv));
+    }
+  uv_soa_to_aos_sse2(uv, u + i, v + i, nr_of_uv_positions - i);
+  }
+
+TRICO_TARGET_AVX2 static void uv_aos_to_soa_double_avx2(double* u, double* v, const double* uv, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_uv_positions; i += 4, uv += 8)
+    {
+    const __m256d a = _mm256_loadu_pd(uv);
+    const __m256d b = _mm256_loadu_pd(uv + 4);
+    _mm256_storeu_pd(u + i, _mm256_permute4x64_pd(_mm256_unpacklo_pd(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm256_storeu_pd(v + i, _mm256_permute4x64_pd(_mm256_unpackhi_pd(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+  uv_aos_to_soa_double_sse2(u + i, v + i, uv, nr_of_uv_positions - i);
+  }
+
+TRICO_TARGET_AVX2 static void uv_soa_to_aos_double_avx2(double* uv, const double* u, const double* v, uint32_t nr_of_uv_positions)
+  {
+  uint32_t i = 0;
+  for (; i + 4 <= nr_of_uv_positions; i += 4, uv += 8)
+    {
+    const __m256d uu = _mm256_permute4x64_pd(_mm256_loadu_pd(u + i), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256d vv = _mm256_permute4x64_pd(_mm256_loadu_pd(v + i), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_pd(uv, _mm256_unpacklo_pd(uu, vv));
+    _mm256_storeu_pd(uv + 4, _mm256_unpackhi_pd(uu, vv));
+    }
+  uv_soa_to_aos_double_sse2(uv, u + i, v + i, nr_of_uv_positions - i);
+  }
+
+/*
+The byte plane versions group the bytes of each plane within a lane with a byte shuffle, and then transpose the groups across lanes and registers.
+*/
+TRICO_TARGET_AVX2 static void uint16_aos_to_soa_avx2(uint8_t* const* b, const uint16_t* indices, uint32_t nr_of_indices)
+  {
+  const __m256i bytes = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+  uint32_t i = 0;
+  for (; i + 32 <= nr_of_indices; i += 32)
+    {
+    const __m256i r0 = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(indices + i)), bytes), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256i r1 = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)(indices + i + 16)), bytes), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256((__m256i*)(b[0] + i), _mm256_permute2x128_si256(r0, r1, 0x20));
+    _mm256_storeu_si256((__m256i*)(b[1] + i), _mm256_permute2x128_si256(r0, r1, 0x31));
+    }
+  uint8_t* tail[2];
+  offset_planes(tail, b, 2, i);
+  uint16_aos_to_soa_sse2(tail, indices + i, nr_of_indices - i);
+  }
+
+TRICO_TARGET_AVX2 static void uint16_soa_to_aos_avx2(uint16_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 32 <= nr_of_indices; i += 32)
+    {
+    const __m256i b1 = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(b[0] + i)), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m256i b2 = _mm256_permute4x64_epi64(_mm256_loadu_si256((const __m256i*)(b[1] + i)), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256((__m256i*)(indices + i), _mm256_unpacklo_epi8(b1, b2));
+    _mm256_storeu_si256((__m256i*)(indices + i + 16), _mm256_unpackhi_epi8(b1, b2));
+    }
+  const uint8_t* tail[2];
+  offset_const_planes(tail, b, 2, i);
+  uint16_soa_to_aos_sse2(indices + i, tail, nr_of_indices - i);
+  }
+
+/*
+Splits 32 uint32 values in r into 4 byte planes of 32 bytes. After the byte shuffle and the permutation each register
+holds 8 bytes of plane 1, 2, 3 and 4 in its 64 bit groups, which are then transposed over the 4 registers.
+*/
+TRICO_TARGET_AVX2 static void split_uint32_avx2(uint8_t* const* b, uint32_t offset, const __m256i* r)
+  {
+  const __m256i bytes = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+  const __m256i dwords = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  const __m256i s0 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(r[0], bytes), dwords);
+  const __m256i s1 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(r[1], bytes), dwords);
+  const __m256i s2 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(r[2], bytes), dwords);
+  const __m256i s3 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(r[3], bytes), dwords);
+  const __m256i t0 = _mm256_unpacklo_epi64(s0, s1);
+  const __m256i t1 = _mm256_unpacklo_epi64(s2, s3);
+  const __m256i t2 = _mm256_unpackhi_epi64(s0, s1);
+  const __m256i t3 = _mm256_unpackhi_epi64(s2, s3);
+  _mm256_storeu_si256((__m256i*)(b[0] + offset), _mm256_permute2x128_si256(t0, t1, 0x20));
+  _mm256_storeu_si256((__m256i*)(b[1] + offset), _mm256_permute2x128_si256(t2, t3, 0x20));
+  _mm256_storeu_si256((__m256i*)(b[2] + offset), _mm256_permute2x128_si256(t0, t1, 0x31));
+  _mm256_storeu_si256((__m256i*)(b[3] + offset), _mm256_permute2x128_si256(t2, t3, 0x31));
+  }
+
+/*
+Merges 4 byte planes of 32 bytes into 32 uint32 values in r, by reversing the steps of split_uint32_avx2.
+*/
+TRICO_TARGET_AVX2 static void merge_uint32_avx2(__m256i* r, const uint8_t* const* b, uint32_t offset)
+  {
+  const __m256i bytes = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+  const __m256i dwords = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  const __m256i b1 = _mm256_loadu_si256((const __m256i*)(b[0] + offset));
+  const __m256i b2 = _mm256_loadu_si256((const __m256i*)(b[1] + offset));
+  const __m256i b3 = _mm256_loadu_si256((const __m256i*)(b[2] + offset));
+  const __m256i b4 = _mm256_loadu_si256((const __m256i*)(b[3] + offset));
+  const __m256i t0 = _mm256_permute2x128_si256(b1, b3, 0x20);
+  const __m256i t1 = _mm256_permute2x128_si256(b1, b3, 0x31);
+  const __m256i t2 = _mm256_permute2x128_si256(b2, b4, 0x20);
+  const __m256i t3 = _mm256_permute2x128_si256(b2, b4, 0x31);
+  r[0] = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(t0, t2), dwords), bytes);
+  r[1] = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(t0, t2), dwords), bytes);
+  r[2] = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpacklo_epi64(t1, t3), dwords), bytes);
+  r[3] = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(_mm256_unpackhi_epi64(t1, t3), dwords), bytes);
+  }
+
+TRICO_TARGET_AVX2 static void uint32_aos_to_soa_avx2(uint8_t* const* b, const uint32_t* indices, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 32 <= nr_of_indices; i += 32)
+    {
+    __m256i r[4];
+    for (int j = 0; j < 4; ++j)
+      r[j] = _mm256_loadu_si256((const __m256i*)(indices + i + 8 * j));
+    split_uint32_avx2(b, i, r);
+    }
+  uint8_t* tail[4];
+  offset_planes(tail, b, 4, i);
+  uint32_aos_to_soa_sse2(tail, indices + i, nr_of_indices - i);
+  }
+
+TRICO_TARGET_AVX2 static void uint32_soa_to_aos_avx2(uint32_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 32 <= nr_of_indices; i += 32)
+    {
+    __m256i r[4];
+    merge_uint32_avx2(r, b, i);
+    for (int j = 0; j < 4; ++j)
+      _mm256_storeu_si256((__m256i*)(indices + i + 8 * j), r[j]);
+    }
+  const uint8_t* tail[4];
+  offset_const_planes(tail, b, 4, i);
+  uint32_soa_to_aos_sse2(indices + i, tail, nr_of_indices - i);
+  }
+
+TRICO_TARGET_AVX2 static void uint64_aos_to_soa_avx2(uint8_t* const* b, const uint64_t* indices, uint32_t nr_of_indices)
+  {
+  const __m256i halves = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  uint32_t i = 0;
+  for (; i + 32 <= nr_of_indices; i += 32)
+    {
+    __m256i lo[4], hi[4];
+    for (int j = 0; j < 4; ++j)
+      {
+      const __m256i r0 = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(indices + i + 8 * j)), halves);
+      const __m256i r1 = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(indices + i + 8 * j + 4)), halves);
+      lo[j] = _mm256_permute2x128_si256(r0, r1, 0x20);
+      hi[j] = _mm256_permute2x128_si256(r0, r1, 0x31);
+      }
+    split_uint32_avx2(b, i, lo);
+    split_uint32_avx2(b + 4, i, hi);
+    }
+  uint8_t* tail[8];
+  offset_planes(tail, b, 8, i);
+  uint64_aos_to_soa_sse2(tail, indices + i, nr_of_indices - i);
+  }
+
+TRICO_TARGET_AVX2 static void uint64_soa_to_aos_avx2(uint64_t* indices, const uint8_t* const* b, uint32_t nr_of_indices)
+  {
+  uint32_t i = 0;
+  for (; i + 32 <= nr_of_indices; i += 32)
+    {
+    __m256i lo[4], hi[4];
+    merge_uint32_avx2(lo, b, i);
+    merge_uint32_avx2(hi, b + 4, i);
+    for (int j = 0; j < 4; ++j)
+      {
+      const __m256i r0 = _mm256_unpacklo_epi32(lo[j], hi[j]);
+      const __m256i r1 = _mm256_unpackhi_epi32(lo[j], hi[j]);
+      _mm256_storeu_si256((__m256i*)(indices + i + 8 * j), _mm256_permute2x128_si256(r0, r1, 0x20));
+      _mm256_storeu_si256((__m256i*)(indices + i + 8 * j + 4), _mm256_permute2x128_si256(r0, r1, 0x31));
+      }
+    }
+  const uint8_t* tail[8];
+  offset_const_planes(tail, b, 8, i);
+  uint64_soa_to_aos_sse2(indices + i, tail, nr_of_indices - i);
+  }
+
+static int cpu_supports_avx2(void)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? 1 : 0;
+#else
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return 0;
+  __cpuid(info, 1);
+  const int osxsave_and_avx = (1 << 27) | (1 << 28);
+  if ((info[2] & osxsave_and_avx) != osxsave_and_avx)
+    return 0;
+  if ((_xgetbv(0) & 6) != 6) // the os saves the xmm and ymm registers
+    return 0;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) ? 1 : 0;
+#endif
+  }
+
+#endif // #ifdef TRICO_HAS_AVX2
+
+struct transpose_functions
+  {
+  void (*xyz_aos_to_soa)(float*, float*, float*, const float*, uint32_t);
+  void (*xyz_soa_to_aos)(float*, const float*, const float*, const float*, uint32_t);
+  void (*xyz_aos_to_soa_double)(double*, double*, double*, const double*, uint32_t);
+  void (*xyz_soa_to_aos_double)(double*, const double*, const double*, const double*, uint32_t);
+  void (*uv_aos_to_soa)(float*, float*, const float*, uint32_t);
+  void (*uv_soa_to_aos)(float*, const float*, const float*, uint32_t);
+  void (*uv_aos_to_soa_double)(double*, double*, const double*, uint32_t);
+  void (*uv_soa_to_aos_double)(double*, const double*, const double*, uint32_t);
+  void (*uint16_aos_to_soa)(uint8_t* const*, const uint16_t*, uint32_t);
+  void (*uint16_soa_to_aos)(uint16_t*, const uint8_t* const*, uint32_t);
+  void (*uint32_aos_to_soa)(uint8_t* const*, const uint32_t*, uint32_t);
+  void (*uint32_soa_to_aos)(uint32_t*, const uint8_t* const*, uint32_t);
+  void (*uint64_aos_to_soa)(uint8_t* const*, const uint64_t*, uint32_t);
+  void (*uint64_soa_to_aos)(uint64_t*, const uint8_t* const*, uint32_t);
+  };
+
+static const struct transpose_functions scalar_functions =
+  {
+  xyz_aos_to_soa_scalar, xyz_soa_to_aos_scalar, xyz_aos_to_soa_double_scalar, xyz_soa_to_aos_double_scalar,
+  uv_aos_to_soa_scalar, uv_soa_to_aos_scalar, uv_aos_to_soa_double_scalar, uv_soa_to_aos_double_scalar,
+  uint16_aos_to_soa_scalar, uint16_soa_to_aos_scalar, uint32_aos_to_soa_scalar, uint32_soa_to_aos_scalar,
+  uint64_aos_to_soa_scalar, uint64_soa_to_aos_scalar
+  };
+
+#ifdef TRICO_HAS_SSE2
+static const struct transpose_functions sse2_functions =
+  {
+  xyz_aos_to_soa_sse2, xyz_soa_to_aos_sse2, xyz_aos_to_soa_double_sse2, xyz_soa_to_aos_double_sse2,
+  uv_aos_to_soa_sse2, uv_soa_to_aos_sse2, uv_aos_to_soa_double_sse2, uv_soa_to_aos_double_sse2,
+  uint16_aos_to_soa_sse2, uint16_soa_to_aos_sse2, uint32_aos_to_soa_sse2, uint32_soa_to_aos_sse2,
+  uint64_aos_to_soa_sse2, uint64_soa_to_aos_sse2
+  };
+#endif
+
+#ifdef TRICO_HAS_AVX2
+static const struct transpose_functions avx2_functions =
+  {
+  xyz_aos_to_soa_avx2, xyz_soa_to_aos_avx2, xyz_aos_to_soa_double_avx2, xyz_soa_to_aos_double_avx2,
+  uv_aos_to_soa_avx2, uv_soa_to_aos_avx2, uv_aos_to_soa_double_avx2, uv_soa_to_aos_double_avx2,
+  uint16_aos_to_soa_avx2, uint16_soa_to_aos_avx2, uint32_aos_to_soa_avx2, uint32_soa_to_aos_avx2,
+  uint64_aos_to_soa_avx2, uint64_soa_to_aos_avx2
+  };
+#endif
+
+/*
+-1 until the first transpose selects the best supported instruction set. Threads that race on the first call all select the same one.
+*/
+static volatile int selected_instruction_set = -1;
+
+static int get_supported_instruction_set(void)
+  {
+#ifdef TRICO_HAS_AVX2
+  if (cpu_supports_avx2())
+    return TRICO_INSTRUCTION_SET_AVX2;
+#endif
+#ifdef TRICO_HAS_SSE2
+  return TRICO_INSTRUCTION_SET_SSE2;
+#else
+  return TRICO_INSTRUCTION_SET_SCALAR;
+#endif
+  }
+
+int trico_get_transpose_instruction_set(void)
+  {
+  if (selected_instruction_set < 0)
+    selected_instruction_set = get_supported_instruction_set();
+  return selected_instruction_set;
+  }
+
+int trico_set_transpose_instruction_set(int instruction_set)
+  {
+  if (instruction_set < TRICO_INSTRUCTION_SET_SCALAR || instruction_set > get_supported_instruction_set())
+    return 0;
+  selected_instruction_set = instruction_set;
+  return 1;
+  }
+
+static const struct transpose_functions* get_functions(void)
+  {
+  switch (trico_get_transpose_instruction_set())
+    {
+#ifdef TRICO_HAS_AVX2
+    case TRICO_INSTRUCTION_SET_AVX2: return &avx2_functions;
+#endif
+#ifdef TRICO_HAS_SSE2
+    case TRICO_INSTRUCTION_SET_SSE2: return &sse2_functions;
+#endif
+    default: return &scalar_functions;
+    }
+  }
+
+void trico_transpose_xyz_aos_to_soa(float** x, float** y, float** z, const float* vertices, uint32_t nr_of_vertices)
+  {
+  get_functions()->xyz_aos_to_soa(*x, *y, *z, vertices, nr_of_vertices);
+  }
+
+void trico_transpose_xyz_soa_to_aos(float** vertices, const float* x, const float* y, const float* z, uint32_t nr_of_vertices)
+  {
+  get_functions()->xyz_soa_to_aos(*vertices, x, y, z, nr_of_vertices);
+  }
+
+void trico_transpose_xyz_aos_to_soa_double_precision(double** x, double** y, double** z, const double* vertices, uint32_t nr_of_vertices)
+  {
+  get_functions()->xyz_aos_to_soa_double(*x, *y, *z, vertices, nr_of_vertices);
+  }
+
+void trico_transpose_xyz_soa_to_aos_double_precision(double** vertices, const double* x, const double* y, const double* z, uint32_t nr_of_vertices)
+  {
+  get_functions()->xyz_soa_to_aos_double(*vertices, x, y, z, nr_of_vertices);
+  }
+
+void trico_transpose_uv_aos_to_soa(float** u, float** v, const float* uv, uint32_t nr_of_uv_positions)
+  {
+  get_functions()->uv_aos_to_soa(*u, *v, uv, nr_of_uv_positions);
+  }
+
+void trico_transpose_uv_soa_to_aos(float** uv, const float* u, const float* v, uint32_t nr_of_uv_positions)
+  {
+  get_functions()->uv_soa_to_aos(*uv, u, v, nr_of_uv_positions);
+  }
+
+void trico_transpose_uv_aos_to_soa_double_precision(double** u, double** v, const double* uv, uint32_t nr_of_uv_positions)
+  {
+  get_functions()->uv_aos_to_soa_double(*u, *v, uv, nr_of_uv_positions);
+  }
+
+void trico_transpose_uv_soa_to_aos_double_precision(double** uv, const double* u, const double* v, uint32_t nr_of_uv_positions)
+  {
+  get_functions()->uv_soa_to_aos_double(*uv, u, v, nr_of_uv_positions);
+  }
+
+void trico_transpose_uint16_aos_to_soa(uint8_t** b1, uint8_t** b2, const uint16_t* indices, uint32_t nr_of_indices)
+  {
+  uint8_t* b[2] = { *b1, *b2 };
+  get_functions()->uint16_aos_to_soa(b, indices, nr_of_indices);
+  }
+
+void trico_transpose_uint16_soa_to_aos(uint16_t** indices, const uint8_t* b1, const uint8_t* b2, uint32_t nr_of_indices)
+  {
+  const uint8_t* b[2] = { b1, b2 };
+  get_functions()->uint16_soa_to_aos(*indices, b, nr_of_indices);
+  }
+
+void trico_transpose_uint32_aos_to_soa(uint8_t** b1, uint8_t** b2, uint8_t** b3, uint8_t** b4, const uint32_t* indices, uint32_t nr_of_indices)
+  {
+  uint8_t* b[4] = { *b1, *b2, *b3, *b4 };
+  get_functions()->uint32_aos_to_soa(b, indices, nr_of_indices);
+  }
+
+void trico_transpose_uint32_soa_to_aos(uint32_t** indices, const uint8_t* b1, const uint8_t* b2, const uint8_t* b3, const uint8_t* b4, uint32_t nr_of_indices)
+  {
+  const uint8_t* b[4] = { b1, b2, b3, b4 };
+  get_functions()->uint32_soa_to_aos(*indices, b, nr_of_indices);
+  }
+
+void trico_transpose_uint64_aos_to_soa(uint8_t** b1, uint8_t** b2, uint8_t** b3, uint8_t** b4, uint8_t** b5, uint8_t** b6, uint8_t** b7, uint8_t** b8, const uint64_t* indices, uint32_t nr_of_indices)
+  {
+  uint8_t* b[8] = { *b1, *b2, *b3, *b4, *b5, *b6, *b7, *b8 };
+  get_functions()->uint64_aos_to_soa(b, indices, nr_of_indices);
+  }
+
+void trico_transpose_uint64_soa_to_aos(uint64_t** indices, const uint8_t* b1, const uint8_t* b2, const uint8_t* b3, const uint8_t* b4, const uint8_t* b5, const uint8_t* b6, const uint8_t* b7, const uint8_t* b8, uint32_t nr_of_indices)
+  {
+  const uint8_t* b[8] = { b1, b2, b3, b4, b5, b6, b7, b8 };
+  get_functions()->uint64_soa_to_aos(*indices, b, nr_of_indices);
+  }
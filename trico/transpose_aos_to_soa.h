@@ -9,6 +9,20 @@ extern "C" {
 
 #include <stdint.h>
 
+/*
+The transposes use SSE2 or AVX2 when available. By default the best instruction set that the processor supports is selected at the first call.
+*/
+#define TRICO_INSTRUCTION_SET_SCALAR 0
+#define TRICO_INSTRUCTION_SET_SSE2 1
+#define TRICO_INSTRUCTION_SET_AVX2 2
+
+TRICO_API int trico_get_transpose_instruction_set(void);
+
+/*
+Selects the instruction set of all transposes, for instance to compare them. Returns 0 if the build or the processor does not support it.
+*/
+TRICO_API int trico_set_transpose_instruction_set(int instruction_set);
+
 TRICO_API void trico_transpose_xyz_aos_to_soa(float** x, float** y, float** z, const float* vertices, uint32_t nr_of_vertices);
 
 TRICO_API void trico_transpose_xyz_soa_to_aos(float** vertices, const float* x, const float* y, const float* z, uint32_t nr_of_vertices);
@@ -0,0 +1,332 @@
+#include "triangle_compression.h"
+
+#include "context.h"
+#include "entropy_coding.h"
+#include "lz4_compression.h"
+#include "mesh_connectivity.h"
+
+#include <lz4/lz4.h>
+
+#include <string.h>
+
+/*
+Compressed format:
+  <uint8 mode><uint32 big endian number of triangles>
+  mode 0 (delta): 4 byte planes of the 3n index codes
+  mode 1 (connectivity): a plane with a 4-bit symbol per triangle, 4 byte planes of the distances to the triangles with a shared edge,
+                         and 4 byte planes of the index codes
+  each plane is stored as <uint32 big endian compressed size><lz4 data>, or with the entropy coded flag in the mode as
+  <uint32 big endian compressed size><byte plane data of trico_compress_byte_plane_into_with_context>
+The symbol of a triangle is 0 if it is coded without shared edge, and else 1 + 3k + s, where k is the corner of the triangle
+opposite to the shared edge, and s the corner of the earlier triangle opposite to the same edge.
+*/
+#define TRICO_TRIANGLE_MODE_DELTA 0
+#define TRICO_TRIANGLE_MODE_CONNECTIVITY 1
+#define TRICO_TRIANGLE_ENTROPY_CODED_FLAG 0x80
+#define TRICO_TRIANGLE_MAX_SYMBOL 9
+
+static inline uint32_t trico_triangle_read_uint32_big_endian(const uint8_t* p)
+  {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+  }
+
+static inline void trico_triangle_write_uint32_big_endian(uint8_t* p, uint32_t value)
+  {
+  p[0] = (uint8_t)(value >> 24);
+  p[1] = (uint8_t)(value >> 16);
+  p[2] = (uint8_t)(value >> 8);
+  p[3] = (uint8_t)value;
+  }
+
+static inline uint32_t next_corner_of(uint32_t k)
+  {
+  return k == 2 ? 0 : k + 1;
+  }
+
+static inline uint32_t previous_corner_of(uint32_t k)
+  {
+  return k == 0 ? 2 : k - 1;
+  }
+
+static inline uint32_t zigzag(uint32_t difference)
+  {
+  return (difference << 1) ^ (0u - (difference >> 31));
+  }
+
+static inline uint32_t unzigzag(uint32_t z)
+  {
+  return (z >> 1) ^ (0u - (z & 1));
+  }
+
+/*
+Code 0 is the next new vertex, the other indices are ranked by their zigzag coded difference with reference,
+skipping the rank of the next new vertex, so that every index has exactly one code.
+*/
+static inline uint32_t encode_index(uint32_t index, uint32_t reference, uint32_t next)
+  {
+  if (index == next)
+    return 0;
+  const uint32_t z = zigzag(index - reference);
+  return z < zigzag(next - reference) ? z + 1 : z;
+  }
+
+static inline uint32_t decode_index(uint32_t code, uint32_t reference, uint32_t next)
+  {
+  if (code == 0)
+    return next;
+  const uint32_t z = code - 1 < zigzag(next - reference) ? code - 1 : code;
+  return reference + unzigzag(z);
+  }
+
+static inline uint32_t update_next(uint32_t index, uint32_t next)
+  {
+  return index >= next ? index + 1 : next;
+  }
+
+/*
+Values are stored in 4 byte planes of capacity bytes each, least significant byte first.
+*/
+static inline void put_value(uint8_t* planes, uint32_t capacity, uint32_t i, uint32_t value)
+  {
+  planes[i] = (uint8_t)value;
+  planes[(uint64_t)capacity + i] = (uint8_t)(value >> 8);
+  planes[2 * (uint64_t)capacity + i] = (uint8_t)(value >> 16);
+  planes[3 * (uint64_t)capacity + i] = (uint8_t)(value >> 24);
+  }
+
+static inline uint32_t get_value(const uint8_t* planes, uint32_t capacity, uint32_t i)
+  {
+  return (uint32_t)planes[i] | ((uint32_t)planes[(uint64_t)capacity + i] << 8) |
+    ((uint32_t)planes[2 * (uint64_t)capacity + i] << 16) | ((uint32_t)planes[3 * (uint64_t)capacity + i] << 24);
+  }
+
+static uint64_t lz4_bound(uint64_t size)
+  {
+  return size + size / 255 + 16;
+  }
+
+/*
+Returns the end of the compressed plane, or NULL if the memory is not available.
+*/
+static uint8_t* compress_plane(void* context, uint8_t* out, const uint8_t* plane, uint32_t size, int use_entropy_coding, int lz4_level)
+  {
+  const uint32_t nr_of_compressed_bytes = use_entropy_coding ?
+    trico_compress_byte_plane_into_with_context(context, out + 4, plane, size, lz4_level) :
+    trico_lz4_compress_into_with_context(context, out + 4, plane, size, lz4_level);
+  if (!nr_of_compressed_bytes)
+    return NULL;
+  trico_triangle_write_uint32_big_endian(out, nr_of_compressed_bytes);
+  return out + 4 + nr_of_compressed_bytes;
+  }
+
+static uint8_t* compress_planes(void* context, uint8_t* out, const uint8_t* planes, uint32_t capacity, uint32_t size, int use_entropy_coding, int lz4_level)
+  {
+  for (uint32_t p = 0; p < 4 && out; ++p)
+    out = compress_plane(context, out, planes + p * (uint64_t)capacity, size, use_entropy_coding, lz4_level);
+  return out;
+  }
+
+static int decompress_plane(void* context, const uint8_t** in, const uint8_t* end, uint8_t* plane, uint32_t size, int use_entropy_coding)
+  {
+  if (end - *in < 4)
+    return 0;
+  const uint32_t nr_of_compressed_bytes = trico_triangle_read_uint32_big_endian(*in);
+  if (nr_of_compressed_bytes > trico_compress_byte_plane_bound(LZ4_MAX_INPUT_SIZE) || (uint64_t)(end - *in - 4) < nr_of_compressed_bytes)
+    return 0;
+  if (use_entropy_coding)
+    {
+    if (!trico_decompress_byte_plane_into_with_context(context, plane, size, *in + 4, nr_of_compressed_bytes))
+      return 0;
+    }
+  else if (LZ4_decompress_safe((const char*)(*in + 4), (char*)plane, (int)nr_of_compressed_bytes, (int)size) != (int)size)
+    return 0;
+  *in += 4 + nr_of_compressed_bytes;
+  return 1;
+  }
+
+static int decompress_planes(void* context, const uint8_t** in, const uint8_t* end, uint8_t* planes, uint32_t capacity, uint32_t size, int use_entropy_coding)
+  {
+  for (uint32_t p = 0; p < 4; ++p)
+    {
+    if (!decompress_plane(context, in, end, planes + p * (uint64_t)capacity, size, use_entropy_coding))
+      return 0;
+    }
+  return 1;
+  }
+
+uint64_t trico_compress_triangles_bound(uint32_t nr_of_triangles)
+  {
+  return 5 + 9 * 5 + lz4_bound(((uint64_t)nr_of_triangles + 1) / 2) + 4 * lz4_bound(nr_of_triangles) + 4 * lz4_bound(3 * (uint64_t)nr_of_triangles);
+  }
+
+uint32_t trico_get_number_of_compressed_triangles(const uint8_t* compressed)
+  {
+  return trico_triangle_read_uint32_big_endian(compressed + 1);
+  }
+
+/*
+Returns the corners of the earlier triangles that share an edge with each corner, in the codec buffer of context,
+or NULL if the connectivity is not used for these triangles.
+*/
+static const uint32_t* find_neighbours(void* context, const uint32_t* triangles, uint32_t nr_of_triangles, int* error)
+  {
+  const uint64_t nr_of_indices = 3 * (uint64_t)nr_of_triangles;
+  uint32_t max_index = 0;
+  for (uint64_t i = 0; i < nr_of_indices; ++i)
+    max_index = triangles[i] > max_index ? triangles[i] : max_index;
+  if (max_index == 0xffffffff || (uint64_t)max_index > 4 * nr_of_indices + 1024)
+    return NULL;
+  uint32_t* neighbours = (uint32_t*)trico_get_context_buffer(context, TRICO_CONTEXT_CODEC_BUFFER, nr_of_indices * sizeof(uint32_t));
+  if (!neighbours || !trico_find_previous_neighbours(context, neighbours, triangles, nr_of_triangles, max_index + 1))
+    {
+    *error = 1;
+    return NULL;
+    }
+  return neighbours;
+  }
+
+uint32_t trico_compress_triangles_into_with_context(void* context, uint8_t* out, const uint32_t* triangles, uint32_t nr_of_triangles, int use_connectivity, int use_entropy_coding, int lz4_level)
+  {
+  const uint32_t nr_of_indices = nr_of_triangles * 3;
+  if (3 * (uint64_t)nr_of_triangles > LZ4_MAX_INPUT_SIZE)
+    return 0;
+  int error = 0;
+  const uint32_t* neighbours = use_connectivity ? find_neighbours(context, triangles, nr_of_triangles, &error) : NULL;
+  if (error)
+    return 0;
+
+  const uint32_t nr_of_symbol_bytes = neighbours ? (nr_of_triangles + 1) / 2 : 0;
+  const uint32_t distance_capacity = neighbours ? nr_of_triangles : 0;
+  uint8_t* symbols = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_SCRATCH_BUFFER, nr_of_symbol_bytes + 4 * ((uint64_t)distance_capacity + nr_of_indices));
+  if (!symbols)
+    return 0;
+  uint8_t* distances = symbols + nr_of_symbol_bytes;
+  uint8_t* codes = distances + 4 * (uint64_t)distance_capacity;
+
+  uint32_t nr_of_distances = 0;
+  uint32_t nr_of_codes = 0;
+  uint32_t next = 0;
+  for (uint32_t t = 0; t < nr_of_triangles; ++t)
+    {
+    const uint32_t* triangle = triangles + 3 * (uint64_t)t;
+    uint32_t symbol = 0;
+    if (neighbours)
+      {
+      uint32_t neighbour = TRICO_NO_NEIGHBOUR;
+      uint32_t k = 0;
+      for (uint32_t j = 0; j < 3; ++j)
+        {
+        const uint32_t candidate = neighbours[3 * (uint64_t)t + j];
+        if (candidate != TRICO_NO_NEIGHBOUR && (neighbour == TRICO_NO_NEIGHBOUR || candidate / 3 > neighbour / 3))
+          {
+          neighbour = candidate;
+          k = j;
+          }
+        }
+      if (neighbour != TRICO_NO_NEIGHBOUR)
+        {
+        symbol = 1 + 3 * k + neighbour % 3;
+        put_value(distances, distance_capacity, nr_of_distances++, t - neighbour / 3 - 1);
+        put_value(codes, nr_of_indices, nr_of_codes++, encode_index(triangle[k], triangle[next_corner_of(k)], next));
+        next = update_next(triangle[k], next);
+        }
+      symbols[t / 2] = (uint8_t)((t & 1) ? (symbols[t / 2] | (symbol << 4)) : symbol);
+      }
+    if (symbol == 0)
+      {
+      for (uint32_t k = 0; k < 3; ++k)
+        {
+        const uint32_t reference = t + k > 0 ? triangle[(int)k - 1] : 0;
+        put_value(codes, nr_of_indices, nr_of_codes++, encode_index(triangle[k], reference, next));
+        next = update_next(triangle[k], next);
+        }
+      }
+    }
+
+  uint8_t* p_out = out;
+  *p_out++ = (uint8_t)((neighbours ? TRICO_TRIANGLE_MODE_CONNECTIVITY : TRICO_TRIANGLE_MODE_DELTA) | (use_entropy_coding ? TRICO_TRIANGLE_ENTROPY_CODED_FLAG : 0));
+  trico_triangle_write_uint32_big_endian(p_out, nr_of_triangles);
+  p_out += 4;
+  if (neighbours)
+    {
+    p_out = compress_plane(context, p_out, symbols, nr_of_symbol_bytes, use_entropy_coding, lz4_level);
+    if (p_out)
+      p_out = compress_planes(context, p_out, distances, distance_capacity, nr_of_distances, use_entropy_coding, lz4_level);
+    }
+  if (p_out)
+    p_out = compress_planes(context, p_out, codes, nr_of_indices, nr_of_codes, use_entropy_coding, lz4_level);
+  return p_out ? (uint32_t)(p_out - out) : 0;
+  }
+
+int trico_decompress_triangles_into_with_context(void* context, uint32_t* triangles, const uint8_t* compressed, uint32_t nr_of_compressed_bytes)
+  {
+  if (nr_of_compressed_bytes < 5)
+    return 0;
+  const uint8_t mode = compressed[0] & ~TRICO_TRIANGLE_ENTROPY_CODED_FLAG;
+  const int use_entropy_coding = (compressed[0] & TRICO_TRIANGLE_ENTROPY_CODED_FLAG) != 0;
+  const uint32_t nr_of_triangles = trico_get_number_of_compressed_triangles(compressed);
+  if (mode > TRICO_TRIANGLE_MODE_CONNECTIVITY || 3 * (uint64_t)nr_of_triangles > LZ4_MAX_INPUT_SIZE)
+    return 0;
+  const uint8_t* p_in = compressed + 5;
+  const uint8_t* end = compressed + nr_of_compressed_bytes;
+
+  const uint32_t nr_of_indices = nr_of_triangles * 3;
+  const uint32_t nr_of_symbol_bytes = mode == TRICO_TRIANGLE_MODE_CONNECTIVITY ? (nr_of_triangles + 1) / 2 : 0;
+  const uint32_t distance_capacity = mode == TRICO_TRIANGLE_MODE_CONNECTIVITY ? nr_of_triangles : 0;
+  uint8_t* symbols = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_SCRATCH_BUFFER, nr_of_symbol_bytes + 4 * ((uint64_t)distance_capacity + nr_of_indices));
+  if (!symbols)
+    return 0;
+  uint8_t* distances = symbols + nr_of_symbol_bytes;
+  uint8_t* codes = distances + 4 * (uint64_t)distance_capacity;
+
+  uint32_t nr_of_distances = 0;
+  if (mode == TRICO_TRIANGLE_MODE_CONNECTIVITY)
+    {
+    if (!decompress_plane(context, &p_in, end, symbols, nr_of_symbol_bytes, use_entropy_coding))
+      return 0;
+    for (uint32_t t = 0; t < nr_of_triangles; ++t)
+      {
+      const uint32_t symbol = (symbols[t / 2] >> ((t & 1) * 4)) & 15;
+      if (symbol > TRICO_TRIANGLE_MAX_SYMBOL)
+        return 0;
+      nr_of_distances += symbol ? 1 : 0;
+      }
+    if (!decompress_planes(context, &p_in, end, distances, distance_capacity, nr_of_distances, use_entropy_coding))
+      return 0;
+    }
+  const uint32_t nr_of_codes = nr_of_indices - 2 * nr_of_distances;
+  if (!decompress_planes(context, &p_in, end, codes, nr_of_indices, nr_of_codes, use_entropy_coding))
+    return 0;
+
+  uint32_t distance_index = 0;
+  uint32_t code_index = 0;
+  uint32_t next = 0;
+  for (uint32_t t = 0; t < nr_of_triangles; ++t)
+    {
+    uint32_t* triangle = triangles + 3 * (uint64_t)t;
+    const uint32_t symbol = mode == TRICO_TRIANGLE_MODE_CONNECTIVITY ? (symbols[t / 2] >> ((t & 1) * 4)) & 15 : 0;
+    if (symbol)
+      {
+      const uint32_t distance = get_value(distances, distance_capacity, distance_index++);
+      if (distance >= t)
+        return 0;
+      const uint32_t k = (symbol - 1) / 3;
+      const uint32_t s = (symbol - 1) % 3;
+      const uint32_t* neighbour = triangle - 3 * ((uint64_t)distance + 1);
+      triangle[next_corner_of(k)] = neighbour[previous_corner_of(s)];
+      triangle[previous_corner_of(k)] = neighbour[next_corner_of(s)];
+      triangle[k] = decode_index(get_value(codes, nr_of_indices, code_index++), triangle[next_corner_of(k)], next);
+      next = update_next(triangle[k], next);
+      }
+    else
+      {
+      for (uint32_t k = 0; k < 3; ++k)
+        {
+        const uint32_t reference = t + k > 0 ? triangle[(int)k - 1] : 0;
+        triangle[k] = decode_index(get_value(codes, nr_of_indices, code_index++), reference, next);
+        next = update_next(triangle[k], next);
+        }
+      }
+    }
+  return 1;
+  }
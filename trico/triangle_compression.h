@@ -0,0 +1,41 @@
+#if defined (__cplusplus)
+extern "C" {
+#endif // #if defined (__cplusplus)
+
+#ifndef TRICO_TRIANGLE_COMPRESSION_H
+#define TRICO_TRIANGLE_COMPRESSION_H
+
+#include "trico_api.h"
+
+#include <stdint.h>
+
+/*
+Compresses triangles (3 vertex indices each) losslessly, in their original order and with their original corner order.
+Each index is coded relative to a reference index: a code 0 for the next new vertex (one more than the largest index so far,
+which is the common case for vertices that are numbered in order of first use), and else the zigzag coded difference.
+Without connectivity the reference is the previous index. With use_connectivity, a triangle that shares an edge with an earlier
+triangle (in the opposite direction, as in a consistently oriented mesh) is coded as the distance to the last such triangle,
+which edge is shared, and only its third vertex, which is referenced to the shared edge.
+The codes are split in byte planes that are compressed with lz4 at lz4_level (see lz4_compression.h), or with use_entropy_coding
+with the best method of trico_compress_byte_plane_into_with_context. Meshes with far more vertices than corners are coded without
+connectivity, as finding the shared edges takes memory proportional to the number of vertices.
+out needs room for trico_compress_triangles_bound(nr_of_triangles) bytes. Returns the number of compressed bytes, or 0 if
+the memory is not available or there are too many triangles for lz4.
+*/
+TRICO_API uint64_t trico_compress_triangles_bound(uint32_t nr_of_triangles);
+
+TRICO_API uint32_t trico_compress_triangles_into_with_context(void* context, uint8_t* out, const uint32_t* triangles, uint32_t nr_of_triangles, int use_connectivity, int use_entropy_coding, int lz4_level);
+
+TRICO_API uint32_t trico_get_number_of_compressed_triangles(const uint8_t* compressed);
+
+/*
+Decompresses the nr_of_compressed_bytes of compressed into triangles, which needs room for 3 * trico_get_number_of_compressed_triangles(compressed) indices.
+Returns 0 if the compressed data is invalid or the memory is not available.
+*/
+TRICO_API int trico_decompress_triangles_into_with_context(void* context, uint32_t* triangles, const uint8_t* compressed, uint32_t nr_of_compressed_bytes);
+
+#endif // #ifndef TRICO_TRIANGLE_COMPRESSION_H
+
+#if defined (__cplusplus)
+  }
+#endif // #if defined (__cplusplus)
@@ -1,13 +1,71 @@
 #include "trico.h"
+#include "context.h"
 #include "transpose_aos_to_soa.h"
 #include "floating_point_stream_compression.h"
+#include "triangle_compression.h"
+#include "entropy_coding.h"
+#include "lz4_compression.h"
+#include "parallel.h"
+#include "sink.h"
+#include "file_mapping.h"
 #include "alloc.h"
 
+#define LZ4_STATIC_LINKING_ONLY
 #include <lz4/lz4.h>
 
 #include <string.h>
 #include <assert.h>
-
+#include <time.h>
+
+
+#define TRICO_LATEST_VERSION 1
+
+/*
+Version 1 archives end with a directory of all streams, followed by a trailer:
+  for each stream: <uint64 offset><uint64 size><uint32 count><uint8 type><uint8 hash1 exponent><uint8 hash2 exponent><uint8 flags>
+  trailer: <uint64 directory offset><uint32 number of streams><uint32 'TrcD'>
+Offsets are relative to the start of the archive. The streams themselves are laid out exactly as in version 0.
+*/
+#define TRICO_DIRECTORY_MAGIC 0x44637254
+#define TRICO_DIRECTORY_ENTRY_SIZE 24
+#define TRICO_DIRECTORY_TRAILER_SIZE 16
+
+/*
+Float and double planes of a blocked stream are compressed in independent blocks (see trico_compress_chunked),
+which is marked by this flag in the stream type byte, and by TRICO_STREAM_FLAG_BLOCKED in the directory.
+*/
+#define TRICO_BLOCKED_STREAM_TYPE_FLAG 0x80
+#define TRICO_STREAM_FLAG_BLOCKED 1
+
+/*
+Each plane of an entropy coded stream (see trico_entropy_coding), or of a stream with a codec selection other than
+trico_codec_selection_compressed, starts with the byte of its codec id, which is marked by this flag in the stream type byte,
+and by TRICO_STREAM_FLAG_CODEC_IDS in the directory. Byte planes use the methods of trico_compress_byte_plane_into_with_context,
+the other planes are stored as their codec wrote them, rans coded as a whole, or with the residuals of the float codecs split
+and rans coded (see trico_entropy_code_residuals_with_context). Any plane can be stored with its raw values instead.
+*/
+#define TRICO_CODEC_ID_STREAM_TYPE_FLAG 0x40
+#define TRICO_STREAM_FLAG_CODEC_IDS 2
+#define TRICO_STREAM_TYPE_FLAGS (TRICO_BLOCKED_STREAM_TYPE_FLAG | TRICO_CODEC_ID_STREAM_TYPE_FLAG)
+#define TRICO_ENTROPY_METHOD_RESIDUALS 3
+#define TRICO_CODEC_ID_STORED 4
+
+#define TRICO_FLOAT_HASH1_SIZE_EXPONENT 4
+#define TRICO_FLOAT_HASH2_SIZE_EXPONENT 10
+#define TRICO_DOUBLE_HASH1_SIZE_EXPONENT 20
+#define TRICO_DOUBLE_HASH2_SIZE_EXPONENT 20
+#define TRICO_AUTO_TUNE_SAMPLE_SIZE 16384
+
+struct trico_stream_entry
+  {
+  uint64_t offset; // position of the stream type byte in the archive data
+  uint64_t size; // number of bytes of the stream, including the type byte and count
+  uint32_t count;
+  enum trico_stream_type type;
+  uint8_t hash1_size_exponent; // codec parameters of float and double planes, 0 for lz4 planes
+  uint8_t hash2_size_exponent;
+  uint8_t flags;
+  };
 
 struct trico_archive
   {
@@ -17,9 +75,32 @@ struct trico_archive
   const uint8_t* data_pointer;
   uint32_t version;
   enum trico_stream_type next_stream_type;
+  int next_stream_blocked;
+  int next_stream_codec_ids;
   uint64_t buffer_size;
   uint64_t data_size;
   uint64_t size_available;
+  void* context; // hash tables, lz4 state and scratch memory, see trico_set_context
+  int owns_context;
+  trico_write_callback sink;
+  void* sink_user_data;
+  uint64_t bytes_flushed;
+  void* mapped_file;
+  struct trico_stream_entry* streams;
+  uint32_t nr_of_streams;
+  uint32_t streams_capacity;
+  int streams_indexed;
+  uint32_t nr_of_threads;
+  uint32_t block_size;
+  struct trico_encoder_options options;
+  uint32_t hash1_size_exponent; // hash table sizes of the stream that is being written
+  uint32_t hash2_size_exponent;
+  int auto_tune_pending; // the hash table sizes of the stream that is being written still need to be tuned on its first plane
+  int entropy_coded; // the planes of the stream that is being written are entropy coded
+  int codec_ids; // the planes of the stream that is being written start with their codec id
+  int stored; // the planes of the stream that is being written are stored with their raw values
+  int lz4_level; // lz4 level of the byte planes of the stream that is being written
+  int finalized;
   int writable;
   };
 
@@ -34,14 +115,19 @@ static int buffer_ready_for_writing(struct trico_archive* arch, uint64_t bytes_n
     return 0;
   if (sufficient_buffer_available(arch, bytes_needed) == 0)
     {
-    uint64_t extra_size = bytes_needed - arch->size_available;
+    // grow geometrically, so that a sequence of writes only reallocates a logarithmic number of times
+    uint64_t new_size = arch->buffer_size * 2;
+    uint64_t minimal_size = arch->buffer_size + bytes_needed - arch->size_available;
+    if (new_size < minimal_size)
+      new_size = minimal_size;
     uint64_t buff_diff = arch->buffer_pointer - arch->buffer;
-    arch->buffer = (uint8_t*)trico_realloc(arch->buffer, arch->buffer_size + extra_size);
-    if (arch->buffer == NULL)
+    uint8_t* new_buffer = (uint8_t*)trico_realloc(arch->buffer, new_size);
+    if (new_buffer == NULL)
       return 0;
+    arch->buffer = new_buffer;
     arch->buffer_pointer = arch->buffer + buff_diff;
-    arch->buffer_size += extra_size;
-    arch->size_available += extra_size;
+    arch->size_available += new_size - arch->buffer_size;
+    arch->buffer_size = new_size;
     }
   return 1;
   }
@@ -54,11 +140,27 @@ static void write_unsafe(const void* buf, uint64_t element_size, uint64_t elemen
   arch->size_available -= sz;
   }
 
-static int write(const void* buf, uint64_t element_size, uint64_t element_count, struct trico_archive* arch)
+static void advance_unsafe(uint64_t sz, struct trico_archive* arch)
+  {
+  arch->buffer_pointer += sz;
+  arch->size_available -= sz;
+  }
+
+/*
+Hands all buffered bytes to the sink of the archive, if it has one.
+*/
+static int flush_to_sink(struct trico_archive* arch)
   {
-  if (!buffer_ready_for_writing(arch, element_size * element_count))
+  if (arch->sink == NULL)
+    return 1;
+  uint64_t sz = arch->buffer_pointer - arch->buffer;
+  if (sz == 0)
+    return 1;
+  if (!arch->sink(arch->sink_user_data, arch->buffer, sz))
     return 0;
-  write_unsafe(buf, element_size, element_count, arch);
+  arch->bytes_flushed += sz;
+  arch->buffer_pointer = arch->buffer;
+  arch->size_available = arch->buffer_size;
   return 1;
   }
 
@@ -87,6 +189,823 @@ static int read_inplace(void* buf, uint64_t element_size, uint64_t element_count
   return 1;
   }
 
+static int read_pointer(const uint8_t** buf, uint64_t size, struct trico_archive* arch)
+  {
+  if (arch->writable)
+    return 0;
+  uint64_t data_read = arch->data_pointer - arch->data;
+  if ((data_read + size) > arch->data_size)
+    return 0;
+  *buf = arch->data_pointer;
+  arch->data_pointer += size;
+  return 1;
+  }
+
+#define TRICO_MAX_NUMBER_OF_PLANES 8
+
+enum trico_plane_codec
+  {
+  trico_plane_float,
+  trico_plane_double,
+  trico_plane_lz4,
+  trico_plane_parallelogram,
+  trico_plane_triangles
+  };
+
+/*
+The planes of a stream (x/y/z, u/v or the byte planes of integer data) are compressed independently,
+so they can be decompressed in parallel. The compressed planes are not copied, they point into the archive data,
+and the planes are decompressed straight into the destination memory, which is not owned by this struct.
+*/
+struct trico_planes
+  {
+  const uint8_t* compressed[TRICO_MAX_NUMBER_OF_PLANES];
+  uint32_t nr_of_compressed_bytes[TRICO_MAX_NUMBER_OF_PLANES];
+  void* decompressed[TRICO_MAX_NUMBER_OF_PLANES];
+  int decompressed_ok[TRICO_MAX_NUMBER_OF_PLANES];
+  enum trico_plane_codec codec;
+  uint32_t nr_of_planes;
+  uint32_t plane_size; // number of values in each plane
+  uint32_t stride; // distance between consecutive values of a float or double plane in the destination
+  int blocked; // float or double planes that are compressed in independent blocks
+  int codec_ids; // each plane starts with its codec id
+  uint32_t range_first; // range of values of blocked planes that is decompressed
+  uint32_t range_count;
+  void* context; // each worker decompresses with its own worker context
+  const uint32_t* triangles; // connectivity that parallelogram planes are predicted with
+  uint32_t nr_of_triangles;
+  };
+
+static int read_planes(struct trico_planes* planes, enum trico_plane_codec codec, uint32_t nr_of_planes, uint32_t plane_size, struct trico_archive* arch)
+  {
+  assert(nr_of_planes <= TRICO_MAX_NUMBER_OF_PLANES);
+  planes->codec = codec;
+  planes->nr_of_planes = nr_of_planes;
+  planes->plane_size = plane_size;
+  planes->stride = 1;
+  planes->blocked = arch->next_stream_blocked;
+  planes->codec_ids = arch->next_stream_codec_ids;
+  planes->range_first = 0;
+  planes->range_count = plane_size;
+  planes->context = NULL;
+  planes->triangles = NULL;
+  planes->nr_of_triangles = 0;
+  for (uint32_t p = 0; p < nr_of_planes; ++p)
+    {
+    if (!read(&(planes->nr_of_compressed_bytes[p]), sizeof(uint32_t), 1, arch))
+      return 0;
+    if (!read_pointer(&(planes->compressed[p]), planes->nr_of_compressed_bytes[p], arch))
+      return 0;
+    planes->decompressed[p] = NULL;
+    planes->decompressed_ok[p] = 0;
+    }
+  return 1;
+  }
+
+static uint64_t get_maximum_plane_size(enum trico_plane_codec codec, uint64_t plane_size, uint32_t block_size);
+
+static int blocked_plane_is_valid(const struct trico_planes* planes, const uint8_t* compressed, uint32_t nr_of_compressed_bytes)
+  {
+  if (nr_of_compressed_bytes < 8)
+    return 0;
+  const uint32_t block_size = trico_get_chunk_size(compressed);
+  if (block_size == 0 || trico_get_number_of_chunked_values(compressed) != planes->plane_size)
+    return 0;
+  const uint64_t nr_of_blocks = ((uint64_t)planes->plane_size + block_size - 1) / block_size;
+  return 8 + 4 * (nr_of_blocks + 1) <= nr_of_compressed_bytes;
+  }
+
+/*
+Undoes the entropy coding of a plane that is not a byte plane: *compressed and *nr_of_compressed_bytes are moved to the output of the codec,
+which is behind the codec id, or restored in the entropy buffer of context.
+*/
+static int entropy_decode_plane(void* context, const uint8_t** compressed, uint32_t* nr_of_compressed_bytes, const struct trico_planes* planes)
+  {
+  if (*nr_of_compressed_bytes == 0)
+    return 0;
+  const uint8_t method = **compressed;
+  const uint8_t* data = *compressed + 1;
+  const uint32_t nr_of_data_bytes = *nr_of_compressed_bytes - 1;
+  *compressed = data;
+  *nr_of_compressed_bytes = nr_of_data_bytes;
+  switch (method)
+    {
+    case TRICO_ENTROPY_METHOD_NONE:
+      return 1;
+    case TRICO_ENTROPY_METHOD_RANS:
+    {
+    if ((planes->codec != trico_plane_float && planes->codec != trico_plane_double) || nr_of_data_bytes < 5)
+      return 0;
+    // rans can code a run of equal bytes in almost no bits, so the decoded size is checked against the largest plane of the codec,
+    // and a few zero bytes are appended for the codecs, which can read past the end of their input
+    const uint32_t nr_of_bytes = trico_get_number_of_entropy_coded_bytes(data);
+    if (nr_of_bytes > get_maximum_plane_size(planes->codec, planes->plane_size, planes->blocked ? 1 : 0))
+      return 0;
+    uint8_t* decoded = (uint8_t*)trico_get_context_buffer(context, TRICO_CONTEXT_ENTROPY_BUFFER, (uint64_t)nr_of_bytes + 8);
+    if (!decoded || !trico_entropy_decompress_into(decoded, data, nr_of_data_bytes))
+      return 0;
+    memset(decoded + nr_of_bytes, 0, 8);
+    *compressed = decoded;
+    *nr_of_compressed_bytes = nr_of_bytes;
+    return 1;
+    }
+    case TRICO_ENTROPY_METHOD_RESIDUALS:
+    {
+    if ((planes->codec != trico_plane_float || planes->blocked) && planes->codec != trico_plane_parallelogram)
+      return 0;
+    const uint64_t nr_of_values = planes->codec == trico_plane_parallelogram ? 3 * (uint64_t)planes->plane_size : planes->plane_size;
+    if (nr_of_values > 0xffffffff)
+      return 0;
+    return trico_entropy_decode_residuals_with_context(context, compressed, nr_of_compressed_bytes, data, nr_of_data_bytes, (uint32_t)nr_of_values);
+    }
+    }
+  return 0;
+  }
+
+static uint32_t get_stored_value_size(enum trico_plane_codec codec)
+  {
+  switch (codec)
+    {
+    case trico_plane_float: return sizeof(float);
+    case trico_plane_double: return sizeof(double);
+    case trico_plane_lz4: return 1;
+    case trico_plane_parallelogram: return 3 * sizeof(float);
+    case trico_plane_triangles: return 3 * sizeof(uint32_t);
+    }
+  return 0;
+  }
+
+static int plane_is_stored(const struct trico_planes* planes, uint32_t p)
+  {
+  return planes->codec_ids && planes->nr_of_compressed_bytes[p] > 0 && planes->compressed[p][0] == TRICO_CODEC_ID_STORED;
+  }
+
+/*
+Copies the raw values of a stored plane, with the stride and range of float and double planes.
+*/
+static int copy_stored_plane(const struct trico_planes* planes, uint32_t p)
+  {
+  const uint8_t* values = planes->compressed[p] + 1;
+  const uint32_t value_size = get_stored_value_size(planes->codec);
+  if ((uint64_t)planes->nr_of_compressed_bytes[p] - 1 != (uint64_t)planes->plane_size * value_size)
+    return 0;
+  if (planes->codec != trico_plane_float && planes->codec != trico_plane_double)
+    {
+    memcpy(planes->decompressed[p], values, (size_t)planes->plane_size * value_size);
+    return 1;
+    }
+  uint8_t* out = (uint8_t*)planes->decompressed[p];
+  values += (uint64_t)planes->range_first * value_size;
+  if (planes->stride == 1)
+    {
+    memcpy(out, values, (size_t)planes->range_count * value_size);
+    return 1;
+    }
+  for (uint32_t i = 0; i < planes->range_count; ++i)
+    memcpy(out + (uint64_t)i * planes->stride * value_size, values + (uint64_t)i * value_size, value_size);
+  return 1;
+  }
+
+static void decompress_plane(void* user_data, uint32_t p, uint32_t thread_index)
+  {
+  struct trico_planes* planes = (struct trico_planes*)user_data;
+  void* context = trico_get_worker_context(planes->context, thread_index);
+  const uint8_t* compressed = planes->compressed[p];
+  uint32_t nr_of_compressed_bytes = planes->nr_of_compressed_bytes[p];
+  if (plane_is_stored(planes, p))
+    {
+    planes->decompressed_ok[p] = copy_stored_plane(planes, p);
+    return;
+    }
+  if (planes->codec_ids && planes->codec != trico_plane_lz4 && !entropy_decode_plane(context, &compressed, &nr_of_compressed_bytes, planes))
+    return;
+  switch (planes->codec)
+    {
+    case trico_plane_float:
+    {
+    if (planes->blocked)
+      {
+      if (!blocked_plane_is_valid(planes, compressed, nr_of_compressed_bytes))
+        return;
+      trico_decompress_chunked_range_into_with_context(context, (float*)planes->decompressed[p], planes->stride, compressed, planes->range_first, planes->range_count, 1);
+      planes->decompressed_ok[p] = 1;
+      break;
+      }
+    if (nr_of_compressed_bytes < 5 || trico_get_number_of_compressed_values(compressed) != planes->plane_size)
+      return;
+    trico_decompress_into_with_context(context, (float*)planes->decompressed[p], planes->stride, compressed);
+    planes->decompressed_ok[p] = 1;
+    break;
+    }
+    case trico_plane_double:
+    {
+    if (planes->blocked)
+      {
+      if (!blocked_plane_is_valid(planes, compressed, nr_of_compressed_bytes))
+        return;
+      trico_decompress_chunked_double_precision_range_into_with_context(context, (double*)planes->decompressed[p], planes->stride, compressed, planes->range_first, planes->range_count, 1);
+      planes->decompressed_ok[p] = 1;
+      break;
+      }
+    if (nr_of_compressed_bytes < 5 || trico_get_number_of_compressed_values(compressed) != planes->plane_size)
+      return;
+    trico_decompress_double_precision_into_with_context(context, (double*)planes->decompressed[p], planes->stride, compressed);
+    planes->decompressed_ok[p] = 1;
+    break;
+    }
+    case trico_plane_lz4:
+    {
+    if (planes->codec_ids)
+      {
+      planes->decompressed_ok[p] = trico_decompress_byte_plane_into_with_context(context, (uint8_t*)planes->decompressed[p], planes->plane_size, compressed, nr_of_compressed_bytes);
+      break;
+      }
+    int bytes_decompressed = LZ4_decompress_safe((const char*)compressed, (char*)planes->decompressed[p], (int)nr_of_compressed_bytes, (int)planes->plane_size);
+    planes->decompressed_ok[p] = bytes_decompressed == (int)planes->plane_size ? 1 : 0;
+    break;
+    }
+    case trico_plane_parallelogram:
+    {
+    if (planes->blocked || nr_of_compressed_bytes < 5 || trico_get_number_of_compressed_values(compressed) != planes->plane_size)
+      return;
+    planes->decompressed_ok[p] = trico_decompress_parallelogram_into_with_context(context, (float*)planes->decompressed[p], compressed, nr_of_compressed_bytes, planes->triangles, planes->nr_of_triangles);
+    break;
+    }
+    case trico_plane_triangles:
+    {
+    if (planes->blocked || nr_of_compressed_bytes < 5 || trico_get_number_of_compressed_triangles(compressed) != planes->plane_size)
+      return;
+    planes->decompressed_ok[p] = trico_decompress_triangles_into_with_context(context, (uint32_t*)planes->decompressed[p], compressed, nr_of_compressed_bytes);
+    break;
+    }
+    }
+  }
+
+/*
+Returns the context of the archive, the archive creates its own context on first use if none was set with trico_set_context.
+*/
+static void* get_context(struct trico_archive* arch)
+  {
+  if (arch->context == NULL)
+    {
+    arch->context = trico_create_context();
+    arch->owns_context = arch->context ? 1 : 0;
+    }
+  return arch->context;
+  }
+
+static void* get_buffer(struct trico_archive* arch, uint32_t index, uint64_t size)
+  {
+  void* context = get_context(arch);
+  return context ? trico_get_context_buffer(context, index, size) : NULL;
+  }
+
+static int decompress_planes(struct trico_planes* planes, struct trico_archive* arch)
+  {
+  const uint32_t nr_of_workers = trico_get_number_of_workers(planes->nr_of_planes, arch->nr_of_threads);
+  planes->context = get_context(arch);
+  if (!planes->context || !trico_reserve_worker_contexts(planes->context, nr_of_workers))
+    return 0;
+  trico_parallel_for(decompress_plane, planes, planes->nr_of_planes, nr_of_workers);
+  for (uint32_t p = 0; p < planes->nr_of_planes; ++p)
+    {
+    if (!planes->decompressed_ok[p])
+      return 0;
+    }
+  return 1;
+  }
+
+/*
+Points planes at nr_of_planes consecutive planes of plane_bytes each in the plane buffer of the context,
+which holds the transposed input of a stream that is written, or the decompressed planes of a stream that is read.
+*/
+static int get_planes(void** planes, uint32_t nr_of_planes, uint64_t plane_bytes, struct trico_archive* arch)
+  {
+  uint8_t* buffer = (uint8_t*)get_buffer(arch, TRICO_CONTEXT_PLANE_BUFFER, plane_bytes * nr_of_planes);
+  if (!buffer)
+    return 0;
+  for (uint32_t p = 0; p < nr_of_planes; ++p)
+    planes[p] = buffer + p * plane_bytes;
+  return 1;
+  }
+
+/*
+Decompresses the planes one after the other into the plane buffer of the context, that is reused over all reads.
+*/
+static int decompress_planes_to_scratch(struct trico_planes* planes, uint32_t value_size, struct trico_archive* arch)
+  {
+  if (!get_planes(planes->decompressed, planes->nr_of_planes, (uint64_t)planes->plane_size * value_size, arch))
+    return 0;
+  planes->stride = 1;
+  return decompress_planes(planes, arch);
+  }
+
+/*
+Decompresses float or double planes into the interleaved (AoS) array out.
+With a single worker the planes are decoded directly into out. Multiple workers would write to the same cache lines
+when decoding into an interleaved array, so then the planes are decoded into the scratch arena and transposed afterwards.
+*/
+static int decompress_planes_interleaved(struct trico_planes* planes, void* out, struct trico_archive* arch)
+  {
+  const uint32_t value_size = planes->codec == trico_plane_float ? sizeof(float) : sizeof(double);
+  if (trico_get_number_of_workers(planes->nr_of_planes, arch->nr_of_threads) == 1)
+    {
+    for (uint32_t p = 0; p < planes->nr_of_planes; ++p)
+      planes->decompressed[p] = (uint8_t*)out + p * value_size;
+    planes->stride = planes->nr_of_planes;
+    return decompress_planes(planes, arch);
+    }
+  if (!decompress_planes_to_scratch(planes, value_size, arch))
+    return 0;
+  if (planes->codec == trico_plane_float)
+    {
+    float* aos = (float*)out;
+    if (planes->nr_of_planes == 3)
+      trico_transpose_xyz_soa_to_aos(&aos, planes->decompressed[0], planes->decompressed[1], planes->decompressed[2], planes->plane_size);
+    else
+      trico_transpose_uv_soa_to_aos(&aos, planes->decompressed[0], planes->decompressed[1], planes->plane_size);
+    }
+  else
+    {
+    double* aos = (double*)out;
+    if (planes->nr_of_planes == 3)
+      trico_transpose_xyz_soa_to_aos_double_precision(&aos, planes->decompressed[0], planes->decompressed[1], planes->decompressed[2], planes->plane_size);
+    else
+      trico_transpose_uv_soa_to_aos_double_precision(&aos, planes->decompressed[0], planes->decompressed[1], planes->plane_size);
+    }
+  return 1;
+  }
+
+/*
+Decompresses the values [first, first + count) of float or double planes into the interleaved array out.
+Blocked planes only decompress the blocks that overlap with the range, and stored planes only copy the range.
+Other planes have to be decompressed completely, as their predictor runs from the first value.
+*/
+static int decompress_planes_range(struct trico_planes* planes, uint32_t first, uint32_t count, void* out, struct trico_archive* arch)
+  {
+  const uint32_t value_size = planes->codec == trico_plane_float ? sizeof(float) : sizeof(double);
+  int stored = 1;
+  for (uint32_t p = 0; p < planes->nr_of_planes; ++p)
+    stored = stored && plane_is_stored(planes, p);
+  if (!planes->blocked && !stored)
+    {
+    if (!decompress_planes_to_scratch(planes, value_size, arch))
+      return 0;
+    for (uint32_t p = 0; p < planes->nr_of_planes; ++p)
+      {
+      const uint8_t* src = (const uint8_t*)planes->decompressed[p] + (uint64_t)first * value_size;
+      uint8_t* dst = (uint8_t*)out + p * value_size;
+      for (uint32_t i = 0; i < count; ++i)
+        memcpy(dst + (uint64_t)i * planes->nr_of_planes * value_size, src + (uint64_t)i * value_size, value_size);
+      }
+    return 1;
+    }
+  for (uint32_t p = 0; p < planes->nr_of_planes; ++p)
+    planes->decompressed[p] = (uint8_t*)out + p * value_size;
+  planes->stride = planes->nr_of_planes;
+  planes->range_first = first;
+  planes->range_count = count;
+  return decompress_planes(planes, arch);
+  }
+
+/*
+The worst-case size of a compressed plane, including its size and the codec id of streams with codec ids.
+*/
+static uint64_t get_maximum_plane_size(enum trico_plane_codec codec, uint64_t plane_size, uint32_t block_size)
+  {
+  const uint64_t header_size = sizeof(uint32_t) + 1;
+  switch (codec)
+    {
+    case trico_plane_float: return header_size + (block_size ? trico_compress_chunked_bound((uint32_t)plane_size, block_size) : trico_compress_bound((uint32_t)plane_size));
+    case trico_plane_double: return header_size + (block_size ? trico_compress_chunked_double_precision_bound((uint32_t)plane_size, block_size) : trico_compress_double_precision_bound((uint32_t)plane_size));
+    case trico_plane_lz4: return header_size + LZ4_COMPRESSBOUND(plane_size);
+    case trico_plane_parallelogram: return header_size + trico_compress_parallelogram_bound((uint32_t)plane_size);
+    case trico_plane_triangles: return header_size + trico_compress_triangles_bound((uint32_t)plane_size);
+    }
+  return 0;
+  }
+
+static uint64_t get_maximum_stream_size(enum trico_plane_codec codec, uint32_t nr_of_planes, uint64_t plane_size, uint32_t block_size)
+  {
+  return 1 + sizeof(uint32_t) + nr_of_planes * get_maximum_plane_size(codec, plane_size, block_size);
+  }
+
+/*
+Only float and double planes are written in blocks, the byte planes of integer streams are compressed with lz4 as a whole,
+and parallelogram planes depend on the connectivity of the complete mesh.
+*/
+static uint32_t get_block_size(enum trico_plane_codec codec, struct trico_archive* arch)
+  {
+  return (codec == trico_plane_float || codec == trico_plane_double) ? arch->block_size : 0;
+  }
+
+/*
+A hash table with many more entries than there are values does not give better predictions,
+but it does cost a calloc of up to 8 MB per plane, so the tables are limited to 16 entries per value.
+*/
+static uint32_t limit_hash_size_exponent(uint32_t hash_size_exponent, uint64_t nr_of_values)
+  {
+  uint32_t limit = 2;
+  while (limit < 30 && ((uint64_t)1 << limit) < 16 * nr_of_values)
+    limit += 2;
+  hash_size_exponent = hash_size_exponent > 30 ? 30 : (hash_size_exponent >> 1) << 1;
+  return hash_size_exponent < limit ? hash_size_exponent : limit;
+  }
+
+static void select_hash_size_exponents(enum trico_stream_type st, enum trico_plane_codec codec, uint64_t plane_size, struct trico_archive* arch)
+  {
+  if (codec != trico_plane_float && codec != trico_plane_double)
+    {
+    arch->hash1_size_exponent = 0;
+    arch->hash2_size_exponent = 0;
+    arch->auto_tune_pending = 0;
+    return;
+    }
+  arch->hash1_size_exponent = limit_hash_size_exponent(arch->options.hash1_size_exponent[st], plane_size);
+  arch->hash2_size_exponent = limit_hash_size_exponent(arch->options.hash2_size_exponent[st], plane_size);
+  arch->auto_tune_pending = arch->options.auto_tune && plane_size > 0;
+  }
+
+/*
+Version 1 archives keep track of the streams that are written, for the directory that trico_finalize_archive appends.
+The size of a stream follows from the offset of the next stream, or from the offset of the directory for the last one.
+*/
+static int add_stream_entry(enum trico_stream_type st, uint32_t count, enum trico_plane_codec codec, struct trico_archive* arch)
+  {
+  if (arch->nr_of_streams == arch->streams_capacity)
+    {
+    uint32_t new_capacity = arch->streams_capacity ? arch->streams_capacity * 2 : 16;
+    struct trico_stream_entry* new_streams = (struct trico_stream_entry*)trico_realloc(arch->streams, new_capacity * sizeof(struct trico_stream_entry));
+    if (new_streams == NULL)
+      return 0;
+    arch->streams = new_streams;
+    arch->streams_capacity = new_capacity;
+    }
+  struct trico_stream_entry* entry = &(arch->streams[arch->nr_of_streams++]);
+  entry->offset = trico_get_size(arch);
+  entry->size = 0;
+  entry->count = count;
+  entry->type = st;
+  entry->hash1_size_exponent = (uint8_t)arch->hash1_size_exponent;
+  entry->hash2_size_exponent = (uint8_t)arch->hash2_size_exponent;
+  entry->flags = (uint8_t)((get_block_size(codec, arch) ? TRICO_STREAM_FLAG_BLOCKED : 0) | (arch->codec_ids ? TRICO_STREAM_FLAG_CODEC_IDS : 0));
+  return 1;
+  }
+
+/*
+Writes the stream type and count, after reserving the worst-case size of the complete stream,
+so that the planes can be encoded in place with the plane writers below.
+Archives that write to a sink only reserve the header here: each plane reserves its own worst-case size
+and is flushed right after encoding, so the buffer never has to hold more than one plane.
+*/
+static int write_stream_header(enum trico_stream_type st, uint32_t count, enum trico_plane_codec codec, uint32_t nr_of_planes, uint64_t plane_size, struct trico_archive* arch)
+  {
+  if (arch->finalized || plane_size > 0xffffffff || (codec == trico_plane_lz4 && plane_size > LZ4_MAX_INPUT_SIZE))
+    return 0;
+  if (!buffer_ready_for_writing(arch, arch->sink ? 1 + sizeof(uint32_t) : get_maximum_stream_size(codec, nr_of_planes, plane_size, get_block_size(codec, arch))))
+    return 0;
+  select_hash_size_exponents(st, codec, plane_size, arch);
+  arch->entropy_coded = arch->options.entropy_coding[st] == trico_entropy_coding_rans;
+  arch->stored = arch->options.codec_selection[st] == trico_codec_selection_stored;
+  arch->lz4_level = arch->options.lz4_level[st];
+  arch->codec_ids = arch->entropy_coded || arch->options.codec_selection[st] != trico_codec_selection_compressed;
+  if (arch->version >= 1 && !add_stream_entry(st, count, codec, arch))
+    return 0;
+  uint8_t header = (uint8_t)st;
+  if (get_block_size(codec, arch))
+    header |= TRICO_BLOCKED_STREAM_TYPE_FLAG;
+  if (arch->codec_ids)
+    header |= TRICO_CODEC_ID_STREAM_TYPE_FLAG;
+  write_unsafe(&header, 1, 1, arch);
+  write_unsafe(&count, sizeof(uint32_t), 1, arch);
+  return 1;
+  }
+
+static uint32_t get_auto_tune_sample_size(uint32_t nr_of_values, struct trico_archive* arch)
+  {
+  return nr_of_values < arch->options.auto_tune_sample_size || arch->options.auto_tune_sample_size == 0 ? nr_of_values : arch->options.auto_tune_sample_size;
+  }
+
+/*
+Seconds of wall clock time, for the time budget of auto_tune_hash_size_exponents. clock() would count the cpu time of all threads.
+*/
+static double get_wall_time(void)
+  {
+  struct timespec ts;
+  if (timespec_get(&ts, TIME_UTC) != TIME_UTC)
+    return 0.0;
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+  }
+
+/*
+Picks the hash table sizes of the current stream by compressing a prefix of its first plane with a grid of sizes.
+The sizes of the encoder options are tried first, and no size that compresses the prefix worse than these is taken.
+Within that, the smallest output wins, but sizes that are within 1% of it and compress faster are preferred.
+The grid is traversed from small to large tables, and tuning stops when the time budget is used up.
+*/
+static void auto_tune_hash_size_exponents(const void* plane, uint32_t nr_of_values, enum trico_plane_codec codec, struct trico_archive* arch)
+  {
+  static const uint32_t grid[] = { 2, 4, 6, 8, 10, 12, 16, 20, 24 };
+  const uint32_t grid_size = sizeof(grid) / sizeof(uint32_t);
+  const uint32_t sample_size = get_auto_tune_sample_size(nr_of_values, arch);
+  arch->auto_tune_pending = 0;
+  uint8_t* scratch = (uint8_t*)get_buffer(arch, TRICO_CONTEXT_SCRATCH_BUFFER, codec == trico_plane_float ? trico_compress_bound(sample_size) : trico_compress_double_precision_bound(sample_size));
+  if (!scratch)
+    return;
+  const double start = get_wall_time();
+  const double budget = arch->options.auto_tune_time_budget;
+  const uint32_t default_size = codec == trico_plane_float ?
+    trico_compress_into_with_context(arch->context, scratch, (const float*)plane, sample_size, arch->hash1_size_exponent, arch->hash2_size_exponent) :
+    trico_compress_double_precision_into_with_context(arch->context, scratch, (const double*)plane, sample_size, arch->hash1_size_exponent, arch->hash2_size_exponent);
+  uint32_t best_size = default_size;
+  double best_time = get_wall_time() - start;
+  for (uint32_t i = 0; i < grid_size; ++i)
+    {
+    for (uint32_t j = 0; j < grid_size; ++j)
+      {
+      const uint32_t hash1_size_exponent = limit_hash_size_exponent(grid[i], sample_size);
+      const uint32_t hash2_size_exponent = limit_hash_size_exponent(grid[j], sample_size);
+      if (hash1_size_exponent != grid[i] || hash2_size_exponent != grid[j])
+        continue;
+      if (budget > 0.0 && get_wall_time() - start > budget)
+        break;
+      const double trial_start = get_wall_time();
+      const uint32_t size = codec == trico_plane_float ?
+        trico_compress_into_with_context(arch->context, scratch, (const float*)plane, sample_size, hash1_size_exponent, hash2_size_exponent) :
+        trico_compress_double_precision_into_with_context(arch->context, scratch, (const double*)plane, sample_size, hash1_size_exponent, hash2_size_exponent);
+      const double time = get_wall_time() - trial_start;
+      const int better_ratio = (double)size < 0.99 * (double)best_size;
+      const int comparable_ratio = (double)size <= 1.01 * (double)best_size && size <= default_size;
+      if (better_ratio || (comparable_ratio && time < best_time))
+        {
+        best_size = size < best_size ? size : best_size;
+        best_time = time;
+        arch->hash1_size_exponent = hash1_size_exponent;
+        arch->hash2_size_exponent = hash2_size_exponent;
+        }
+      }
+    }
+  if (arch->version >= 1 && arch->nr_of_streams > 0)
+    {
+    arch->streams[arch->nr_of_streams - 1].hash1_size_exponent = (uint8_t)arch->hash1_size_exponent;
+    arch->streams[arch->nr_of_streams - 1].hash2_size_exponent = (uint8_t)arch->hash2_size_exponent;
+    }
+  }
+
+/*
+The plane writers compress in place into the archive buffer, right after the 4 bytes that hold the compressed size,
+and the codec id of streams with codec ids.
+*/
+static uint8_t* get_plane_output(struct trico_archive* arch)
+  {
+  return arch->buffer_pointer + sizeof(uint32_t) + (arch->codec_ids ? 1 : 0);
+  }
+
+/*
+Stores the nr_of_value_bytes of values as they are, behind the codec id. The worst-case size of every codec exceeds the raw size,
+so the stored plane always fits in the room that was reserved for the plane. Returns the size of the plane including the codec id.
+*/
+static uint32_t store_plane(const void* values, uint64_t nr_of_value_bytes, struct trico_archive* arch)
+  {
+  if (nr_of_value_bytes >= 0xffffffff)
+    return 0;
+  uint8_t* plane = arch->buffer_pointer + sizeof(uint32_t);
+  plane[0] = TRICO_CODEC_ID_STORED;
+  memcpy(plane + 1, values, (size_t)nr_of_value_bytes);
+  return (uint32_t)nr_of_value_bytes + 1;
+  }
+
+/*
+Replaces the compressed plane of nr_of_compressed_bytes by the raw values if the compression did not pay off.
+*/
+static uint32_t store_if_smaller(uint32_t nr_of_compressed_bytes, const void* values, uint64_t nr_of_value_bytes, struct trico_archive* arch)
+  {
+  if (!arch->codec_ids || nr_of_compressed_bytes == 0 || nr_of_value_bytes + 1 >= nr_of_compressed_bytes)
+    return nr_of_compressed_bytes;
+  return store_plane(values, nr_of_value_bytes, arch);
+  }
+
+/*
+Writes the size of the plane of nr_of_compressed_bytes in front of it, and moves the archive past it.
+*/
+static int finish_plane(uint32_t nr_of_compressed_bytes, struct trico_archive* arch)
+  {
+  if (nr_of_compressed_bytes == 0)
+    return 0;
+  write_unsafe(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch);
+  advance_unsafe(nr_of_compressed_bytes, arch);
+  return 1;
+  }
+
+/*
+Entropy codes the nr_of_compressed_bytes that a codec wrote at get_plane_output, if the stream is entropy coded, and keeps the smallest of the coded and the plain plane.
+The residuals of the float codecs are split from their codes (see trico_entropy_code_residuals_with_context), the output of the other float and double codecs is rans coded as a whole.
+Returns the size of the plane including the codec id, or 0 if nr_of_compressed_bytes is 0 or the memory is not available.
+*/
+static uint32_t entropy_code_plane(uint32_t nr_of_compressed_bytes, enum trico_plane_codec codec, uint64_t nr_of_values, struct trico_archive* arch)
+  {
+  if (!arch->codec_ids || nr_of_compressed_bytes == 0)
+    return nr_of_compressed_bytes;
+  if (!arch->entropy_coded)
+    {
+    get_plane_output(arch)[-1] = TRICO_ENTROPY_METHOD_NONE;
+    return nr_of_compressed_bytes + 1;
+    }
+  uint8_t* plane = get_plane_output(arch);
+  uint8_t method = TRICO_ENTROPY_METHOD_NONE;
+  uint32_t size = nr_of_compressed_bytes;
+  if ((codec == trico_plane_float && !arch->block_size) || codec == trico_plane_parallelogram)
+    {
+    uint8_t* coded = (uint8_t*)get_buffer(arch, TRICO_CONTEXT_SCRATCH_BUFFER, trico_entropy_code_residuals_bound((uint32_t)nr_of_values));
+    const uint32_t nr_of_coded_bytes = coded ? trico_entropy_code_residuals_with_context(arch->context, coded, plane, nr_of_compressed_bytes, (uint32_t)nr_of_values) : 0;
+    if (nr_of_coded_bytes == 0)
+      return 0;
+    if (nr_of_coded_bytes < size)
+      {
+      method = TRICO_ENTROPY_METHOD_RESIDUALS;
+      size = nr_of_coded_bytes;
+      memcpy(plane, coded, size);
+      }
+    }
+  else if (codec == trico_plane_float || codec == trico_plane_double)
+    {
+    uint8_t* coded = (uint8_t*)get_buffer(arch, TRICO_CONTEXT_SCRATCH_BUFFER, trico_entropy_compress_bound(nr_of_compressed_bytes));
+    if (!coded)
+      return 0;
+    const uint32_t nr_of_coded_bytes = trico_entropy_compress_into(coded, plane, nr_of_compressed_bytes);
+    if (nr_of_coded_bytes < size)
+      {
+      method = TRICO_ENTROPY_METHOD_RANS;
+      size = nr_of_coded_bytes;
+      memcpy(plane, coded, size);
+      }
+    }
+  plane[-1] = method;
+  return size + 1;
+  }
+
+static int write_float_plane(const float* plane, uint32_t nr_of_floats, struct trico_archive* arch)
+  {
+  if (arch->sink && !buffer_ready_for_writing(arch, get_maximum_plane_size(trico_plane_float, nr_of_floats, arch->block_size)))
+    return 0;
+  if (arch->stored)
+    return finish_plane(store_plane(plane, nr_of_floats * (uint64_t)sizeof(float), arch), arch) && flush_to_sink(arch);
+  if (arch->auto_tune_pending)
+    auto_tune_hash_size_exponents(plane, nr_of_floats, trico_plane_float, arch);
+  void* context = get_context(arch);
+  if (!context)
+    return 0;
+  uint32_t nr_of_compressed_bytes = arch->block_size ?
+    trico_compress_chunked_into_with_context(context, get_plane_output(arch), plane, nr_of_floats, arch->hash1_size_exponent, arch->hash2_size_exponent, arch->block_size, arch->nr_of_threads) :
+    trico_compress_into_with_context(context, get_plane_output(arch), plane, nr_of_floats, arch->hash1_size_exponent, arch->hash2_size_exponent);
+  nr_of_compressed_bytes = entropy_code_plane(nr_of_compressed_bytes, trico_plane_float, nr_of_floats, arch);
+  nr_of_compressed_bytes = store_if_smaller(nr_of_compressed_bytes, plane, nr_of_floats * (uint64_t)sizeof(float), arch);
+  return finish_plane(nr_of_compressed_bytes, arch) && flush_to_sink(arch);
+  }
+
+static int write_double_plane(const double* plane, uint32_t nr_of_doubles, struct trico_archive* arch)
+  {
+  if (arch->sink && !buffer_ready_for_writing(arch, get_maximum_plane_size(trico_plane_double, nr_of_doubles, arch->block_size)))
+    return 0;
+  if (arch->stored)
+    return finish_plane(store_plane(plane, nr_of_doubles * (uint64_t)sizeof(double), arch), arch) && flush_to_sink(arch);
+  if (arch->auto_tune_pending)
+    auto_tune_hash_size_exponents(plane, nr_of_doubles, trico_plane_double, arch);
+  void* context = get_context(arch);
+  if (!context)
+    return 0;
+  uint32_t nr_of_compressed_bytes = arch->block_size ?
+    trico_compress_chunked_double_precision_into_with_context(context, get_plane_output(arch), plane, nr_of_doubles, arch->hash1_size_exponent, arch->hash2_size_exponent, arch->block_size, arch->nr_of_threads) :
+    trico_compress_double_precision_into_with_context(context, get_plane_output(arch), plane, nr_of_doubles, arch->hash1_size_exponent, arch->hash2_size_exponent);
+  nr_of_compressed_bytes = entropy_code_plane(nr_of_compressed_bytes, trico_plane_double, nr_of_doubles, arch);
+  nr_of_compressed_bytes = store_if_smaller(nr_of_compressed_bytes, plane, nr_of_doubles * (uint64_t)sizeof(double), arch);
+  return finish_plane(nr_of_compressed_bytes, arch) && flush_to_sink(arch);
+  }
+
+/*
+Tunes the hash table sizes of an interleaved stream on a prefix of its first component, which is gathered into the plane buffer.
+*/
+static int auto_tune_interleaved(const void* values, uint32_t nr_of_planes, uint32_t nr_of_values, enum trico_plane_codec codec, struct trico_archive* arch)
+  {
+  if (!arch->auto_tune_pending)
+    return 1;
+  const uint32_t sample_size = get_auto_tune_sample_size(nr_of_values, arch);
+  const uint64_t value_size = codec == trico_plane_float ? sizeof(float) : sizeof(double);
+  void* sample;
+  if (!get_planes(&sample, 1, sample_size * value_size, arch))
+    return 0;
+  for (uint32_t i = 0; i < sample_size; ++i)
+    memcpy((uint8_t*)sample + i * value_size, (const uint8_t*)values + i * nr_of_planes * value_size, value_size);
+  auto_tune_hash_size_exponents(sample, sample_size, codec, arch);
+  return 1;
+  }
+
+/*
+The interleaved encoder needs the hash tables of all planes at the same time. It is used when these extra tables take less memory
+than the transposed planes that it saves, which excludes the large default tables of double planes unless the mesh is large.
+Blocked planes are transposed, so that their blocks can be compressed in parallel, and so are the planes of streams with codec ids,
+which can be stored with their raw values.
+*/
+static int use_interleaved_encoder(enum trico_plane_codec codec, uint32_t nr_of_planes, uint32_t nr_of_values, struct trico_archive* arch)
+  {
+  if (arch->block_size || arch->codec_ids)
+    return 0;
+  const uint64_t value_size = codec == trico_plane_float ? sizeof(float) : sizeof(double);
+  const uint64_t hash_tables_size = value_size * (((uint64_t)1 << arch->hash1_size_exponent) + ((uint64_t)1 << arch->hash2_size_exponent));
+  return (nr_of_planes - 1) * hash_tables_size <= nr_of_planes * value_size * nr_of_values;
+  }
+
+/*
+Writes the float or double planes of the interleaved array values without transposing it first (see trico_compress_interleaved_into_with_context).
+The planes are compressed at their worst-case positions in the archive buffer, and then moved behind their sizes one by one, each flushed on its own.
+*/
+static int write_interleaved_planes(const void* values, uint32_t nr_of_planes, uint32_t nr_of_values, enum trico_plane_codec codec, struct trico_archive* arch)
+  {
+  const uint64_t maximum_plane_size = get_maximum_plane_size(codec, nr_of_values, 0);
+  if (arch->sink && !buffer_ready_for_writing(arch, nr_of_planes * maximum_plane_size))
+    return 0;
+  void* context = get_context(arch);
+  if (!context)
+    return 0;
+  uint8_t* out[TRICO_MAX_INTERLEAVED_COMPONENTS];
+  uint32_t nr_of_compressed_bytes[TRICO_MAX_INTERLEAVED_COMPONENTS];
+  for (uint32_t p = 0; p < nr_of_planes; ++p)
+    out[p] = get_plane_output(arch) + p * maximum_plane_size;
+  int result = codec == trico_plane_float ?
+    trico_compress_interleaved_into_with_context(context, out, nr_of_compressed_bytes, (const float*)values, nr_of_planes, nr_of_values, arch->hash1_size_exponent, arch->hash2_size_exponent) :
+    trico_compress_interleaved_double_precision_into_with_context(context, out, nr_of_compressed_bytes, (const double*)values, nr_of_planes, nr_of_values, arch->hash1_size_exponent, arch->hash2_size_exponent);
+  if (!result)
+    return 0;
+  for (uint32_t p = 0; p < nr_of_planes; ++p)
+    {
+    memmove(get_plane_output(arch), out[p], nr_of_compressed_bytes[p]);
+    // flushing moves the archive back to the start of the buffer, which is before the planes that are still to be moved
+    if (!finish_plane(entropy_code_plane(nr_of_compressed_bytes[p], codec, nr_of_values, arch), arch) || !flush_to_sink(arch))
+      return 0;
+    }
+  return 1;
+  }
+
+/*
+The vertices are compressed as a whole (x, y, z interleaved), as each vertex is predicted from its neighbours in the mesh.
+*/
+static int write_parallelogram_plane(const float* vertices, uint32_t nr_of_vertices, const uint32_t* triangles, uint32_t nr_of_triangles, struct trico_archive* arch)
+  {
+  const uint64_t maximum_plane_size = get_maximum_plane_size(trico_plane_parallelogram, nr_of_vertices, 0);
+  if (maximum_plane_size > 0xffffffff || (arch->sink && !buffer_ready_for_writing(arch, maximum_plane_size)))
+    return 0;
+  const uint64_t nr_of_value_bytes = 3 * (uint64_t)nr_of_vertices * sizeof(float);
+  if (arch->stored)
+    return finish_plane(store_plane(vertices, nr_of_value_bytes, arch), arch) && flush_to_sink(arch);
+  void* context = get_context(arch);
+  if (!context)
+    return 0;
+  uint32_t nr_of_compressed_bytes = trico_compress_parallelogram_into_with_context(context, get_plane_output(arch), vertices, nr_of_vertices, triangles, nr_of_triangles);
+  nr_of_compressed_bytes = entropy_code_plane(nr_of_compressed_bytes, trico_plane_parallelogram, 3 * (uint64_t)nr_of_vertices, arch);
+  nr_of_compressed_bytes = store_if_smaller(nr_of_compressed_bytes, vertices, nr_of_value_bytes, arch);
+  return finish_plane(nr_of_compressed_bytes, arch) && flush_to_sink(arch);
+  }
+
+/*
+The triangles are compressed as a whole, as they are coded relative to the triangles before them.
+*/
+static int write_triangle_plane(const uint32_t* triangles, uint32_t nr_of_triangles, struct trico_archive* arch)
+  {
+  const uint64_t maximum_plane_size = get_maximum_plane_size(trico_plane_triangles, nr_of_triangles, 0);
+  if (maximum_plane_size > 0xffffffff || (arch->sink && !buffer_ready_for_writing(arch, maximum_plane_size)))
+    return 0;
+  const uint64_t nr_of_value_bytes = 3 * (uint64_t)nr_of_triangles * sizeof(uint32_t);
+  if (arch->stored)
+    return finish_plane(store_plane(triangles, nr_of_value_bytes, arch), arch) && flush_to_sink(arch);
+  void* context = get_context(arch);
+  if (!context)
+    return 0;
+  // the triangle codec entropy codes its own byte planes
+  uint32_t nr_of_compressed_bytes = trico_compress_triangles_into_with_context(context, get_plane_output(arch), triangles, nr_of_triangles, arch->options.triangle_coding == trico_triangle_coding_connectivity, arch->entropy_coded, arch->lz4_level);
+  nr_of_compressed_bytes = entropy_code_plane(nr_of_compressed_bytes, trico_plane_triangles, nr_of_triangles, arch);
+  nr_of_compressed_bytes = store_if_smaller(nr_of_compressed_bytes, triangles, nr_of_value_bytes, arch);
+  return finish_plane(nr_of_compressed_bytes, arch) && flush_to_sink(arch);
+  }
+
+static int write_lz4_plane(const uint8_t* plane, uint32_t nr_of_bytes, struct trico_archive* arch)
+  {
+  if (arch->sink && !buffer_ready_for_writing(arch, get_maximum_plane_size(trico_plane_lz4, nr_of_bytes, 0)))
+    return 0;
+  if (arch->stored)
+    return finish_plane(store_plane(plane, nr_of_bytes, arch), arch) && flush_to_sink(arch);
+  void* context = get_context(arch);
+  if (!context)
+    return 0;
+  // the codec id of an entropy coded byte plane is written by trico_compress_byte_plane_into_with_context
+  uint32_t nr_of_compressed_bytes = arch->entropy_coded ?
+    trico_compress_byte_plane_into_with_context(context, arch->buffer_pointer + sizeof(uint32_t), plane, nr_of_bytes, arch->lz4_level) :
+    trico_lz4_compress_into_with_context(context, get_plane_output(arch), plane, nr_of_bytes, arch->lz4_level);
+  if (!arch->entropy_coded)
+    nr_of_compressed_bytes = entropy_code_plane(nr_of_compressed_bytes, trico_plane_lz4, nr_of_bytes, arch);
+  nr_of_compressed_bytes = store_if_smaller(nr_of_compressed_bytes, plane, nr_of_bytes, arch);
+  return finish_plane(nr_of_compressed_bytes, arch) && flush_to_sink(arch);
+  }
+
 static int write_header(struct trico_archive* arch)
   {
   if (buffer_ready_for_writing(arch, 8) == 0)
@@ -100,12 +1019,196 @@ static int write_header(struct trico_archive* arch)
 static void read_next_stream_type(struct trico_archive* arch)
   {
   assert(!arch->writable);
+  uint8_t header = 0;
   if ((uint64_t)(arch->data_pointer - arch->data) < arch->data_size)
     {
-    read(&(arch->next_stream_type), 1, 1, arch);
+    read(&header, 1, 1, arch);
     }
-  else
-    arch->next_stream_type = trico_empty;
+  arch->next_stream_type = (enum trico_stream_type)(header & ~TRICO_STREAM_TYPE_FLAGS);
+  arch->next_stream_blocked = (header & TRICO_BLOCKED_STREAM_TYPE_FLAG) ? 1 : 0;
+  arch->next_stream_codec_ids = (header & TRICO_CODEC_ID_STREAM_TYPE_FLAG) ? 1 : 0;
+  }
+
+static uint64_t read_uint64_unsafe(const uint8_t* data)
+  {
+  uint64_t value;
+  memcpy(&value, data, sizeof(uint64_t));
+  return value;
+  }
+
+static uint32_t read_uint32_unsafe(const uint8_t* data)
+  {
+  uint32_t value;
+  memcpy(&value, data, sizeof(uint32_t));
+  return value;
+  }
+
+static uint32_t get_number_of_planes(enum trico_stream_type st)
+  {
+  switch (st)
+    {
+    case trico_empty: return 0;
+    case trico_vertex_float_stream: return 3;
+    case trico_vertex_double_stream: return 3;
+    case trico_triangle_uint32_stream: return 4;
+    case trico_triangle_uint64_stream: return 8;
+    case trico_uv_per_vertex_float_stream: return 2;
+    case trico_uv_per_vertex_double_stream: return 2;
+    case trico_uv_per_triangle_float_stream: return 2;
+    case trico_uv_per_triangle_double_stream: return 2;
+    case trico_vertex_normal_float_stream: return 3;
+    case trico_vertex_normal_double_stream: return 3;
+    case trico_triangle_normal_float_stream: return 3;
+    case trico_triangle_normal_double_stream: return 3;
+    case trico_vertex_color_stream: return 4;
+    case trico_triangle_color_stream: return 4;
+    case trico_attribute_float_stream: return 1;
+    case trico_attribute_double_stream: return 1;
+    case trico_attribute_uint8_stream: return 1;
+    case trico_attribute_uint16_stream: return 2;
+    case trico_attribute_uint32_stream: return 4;
+    case trico_attribute_uint64_stream: return 8;
+    case trico_vertex_float_parallelogram_stream: return 1;
+    case trico_triangle_uint32_delta_stream: return 1;
+    case trico_vertex_remap_stream: return 4;
+    }
+  return 0;
+  }
+
+static enum trico_plane_codec get_plane_codec(enum trico_stream_type st)
+  {
+  switch (st)
+    {
+    case trico_vertex_float_stream:
+    case trico_uv_per_vertex_float_stream:
+    case trico_uv_per_triangle_float_stream:
+    case trico_vertex_normal_float_stream:
+    case trico_triangle_normal_float_stream:
+    case trico_attribute_float_stream:
+      return trico_plane_float;
+    case trico_vertex_double_stream:
+    case trico_uv_per_vertex_double_stream:
+    case trico_uv_per_triangle_double_stream:
+    case trico_vertex_normal_double_stream:
+    case trico_triangle_normal_double_stream:
+    case trico_attribute_double_stream:
+      return trico_plane_double;
+    case trico_vertex_float_parallelogram_stream:
+      return trico_plane_parallelogram;
+    case trico_triangle_uint32_delta_stream:
+      return trico_plane_triangles;
+    default:
+      return trico_plane_lz4;
+    }
+  }
+
+/*
+Reads the header of the stream at position and moves position past the stream: only the type, count and
+compressed plane sizes are read, the planes themselves are skipped.
+*/
+static int scan_stream(struct trico_stream_entry* entry, uint64_t* position, struct trico_archive* arch)
+  {
+  uint64_t pos = *position;
+  entry->offset = pos;
+  entry->type = (enum trico_stream_type)(arch->data[pos] & ~TRICO_STREAM_TYPE_FLAGS);
+  entry->flags = (uint8_t)(((arch->data[pos] & TRICO_BLOCKED_STREAM_TYPE_FLAG) ? TRICO_STREAM_FLAG_BLOCKED : 0) |
+    ((arch->data[pos] & TRICO_CODEC_ID_STREAM_TYPE_FLAG) ? TRICO_STREAM_FLAG_CODEC_IDS : 0));
+  const uint32_t nr_of_planes = get_number_of_planes(entry->type);
+  if (nr_of_planes == 0 || pos + 1 + sizeof(uint32_t) > arch->data_size)
+    return 0;
+  memcpy(&(entry->count), arch->data + pos + 1, sizeof(uint32_t));
+  pos += 1 + sizeof(uint32_t);
+  for (uint32_t p = 0; p < nr_of_planes; ++p)
+    {
+    uint32_t nr_of_compressed_bytes;
+    if (pos + sizeof(uint32_t) > arch->data_size)
+      return 0;
+    memcpy(&nr_of_compressed_bytes, arch->data + pos, sizeof(uint32_t));
+    pos += sizeof(uint32_t) + nr_of_compressed_bytes;
+    }
+  if (pos > arch->data_size)
+    return 0;
+  entry->size = pos - *position;
+  entry->hash1_size_exponent = 0;
+  entry->hash2_size_exponent = 0;
+  const uint8_t* first_plane = arch->data + *position + 1 + 2 * sizeof(uint32_t);
+  uint32_t first_plane_size = read_uint32_unsafe(first_plane - sizeof(uint32_t));
+  if ((entry->flags & TRICO_STREAM_FLAG_CODEC_IDS) && first_plane_size > 0)
+    {
+    // the codec output follows the codec id, unless it was rans coded as a whole or the plane is stored
+    const uint8_t method = *first_plane;
+    first_plane += 1;
+    first_plane_size = (method == TRICO_ENTROPY_METHOD_NONE || method == TRICO_ENTROPY_METHOD_RESIDUALS) ? first_plane_size - 1 : 0;
+    }
+  if ((entry->flags & TRICO_STREAM_FLAG_BLOCKED) && first_plane_size >= 8 && trico_get_chunk_size(first_plane) > 0 && trico_get_number_of_chunked_values(first_plane) > 0)
+    {
+    // the hash table sizes are stored at the start of each block, take them from the first block
+    const uint64_t nr_of_blocks = ((uint64_t)trico_get_number_of_chunked_values(first_plane) + trico_get_chunk_size(first_plane) - 1) / trico_get_chunk_size(first_plane);
+    const uint64_t header_size = 8 + 4 * (nr_of_blocks + 1);
+    if (header_size < first_plane_size)
+      {
+      first_plane += header_size;
+      first_plane_size -= (uint32_t)header_size;
+      }
+    else
+      first_plane_size = 0;
+    }
+  const enum trico_plane_codec codec = get_plane_codec(entry->type);
+  if ((codec == trico_plane_float || codec == trico_plane_double) && first_plane_size > 0)
+    {
+    // the first byte of a float or double plane holds its hash table sizes, see trico_compress
+    entry->hash1_size_exponent = (uint8_t)(((*first_plane) >> 4) << 1);
+    entry->hash2_size_exponent = (uint8_t)(((*first_plane) & 15) << 1);
+    }
+  *position = pos;
+  return 1;
+  }
+
+/*
+Reads the directory of a version 1 archive into the stream index, and shrinks data_size to the end of the last stream,
+so that sequential reading stops in front of the directory.
+*/
+static int read_directory(struct trico_archive* arch)
+  {
+  if (arch->data_size < 2 * sizeof(uint32_t) + TRICO_DIRECTORY_TRAILER_SIZE)
+    return 0;
+  const uint8_t* trailer = arch->data + arch->data_size - TRICO_DIRECTORY_TRAILER_SIZE;
+  const uint64_t directory_offset = read_uint64_unsafe(trailer);
+  const uint32_t nr_of_streams = read_uint32_unsafe(trailer + sizeof(uint64_t));
+  if (read_uint32_unsafe(trailer + sizeof(uint64_t) + sizeof(uint32_t)) != TRICO_DIRECTORY_MAGIC)
+    return 0;
+  // checked without sums that could wrap around, so that a crafted offset cannot point outside the data
+  const uint64_t directory_end = arch->data_size - TRICO_DIRECTORY_TRAILER_SIZE;
+  if (directory_offset < 2 * sizeof(uint32_t) || directory_offset > directory_end || nr_of_streams > (directory_end - directory_offset) / TRICO_DIRECTORY_ENTRY_SIZE)
+    return 0;
+  if (directory_offset + (uint64_t)nr_of_streams * TRICO_DIRECTORY_ENTRY_SIZE != directory_end)
+    return 0;
+  struct trico_stream_entry* streams = (struct trico_stream_entry*)trico_malloc((nr_of_streams ? nr_of_streams : 1) * sizeof(struct trico_stream_entry));
+  if (streams == NULL)
+    return 0;
+  const uint8_t* directory = arch->data + directory_offset;
+  for (uint32_t i = 0; i < nr_of_streams; ++i)
+    {
+    const uint8_t* e = directory + (uint64_t)i * TRICO_DIRECTORY_ENTRY_SIZE;
+    streams[i].offset = read_uint64_unsafe(e);
+    streams[i].size = read_uint64_unsafe(e + 8);
+    streams[i].count = read_uint32_unsafe(e + 16);
+    streams[i].type = (enum trico_stream_type)e[20];
+    streams[i].hash1_size_exponent = e[21];
+    streams[i].hash2_size_exponent = e[22];
+    streams[i].flags = e[23];
+    if (streams[i].offset < 2 * sizeof(uint32_t) || streams[i].size > directory_offset || streams[i].offset > directory_offset - streams[i].size)
+      {
+      trico_free(streams);
+      return 0;
+      }
+    }
+  arch->streams = streams;
+  arch->nr_of_streams = nr_of_streams;
+  arch->streams_capacity = nr_of_streams;
+  arch->streams_indexed = 1;
+  arch->data_size = directory_offset;
+  return 1;
   }
 
 static int read_header(struct trico_archive* arch)
@@ -119,23 +1222,60 @@ static int read_header(struct trico_archive* arch)
     }
   if (!read(&(arch->version), sizeof(uint32_t), 1, arch))
     return 0;
+  if (arch->version > TRICO_LATEST_VERSION)
+    return 0;
+  if (arch->version >= 1 && !read_directory(arch))
+    return 0;
   read_next_stream_type(arch);
   return 1;
   }
 
-void* trico_open_archive_for_writing(uint64_t initial_buffer_size)
+static struct trico_archive* create_archive(void)
   {
   struct trico_archive* arch = (struct trico_archive*)trico_malloc(sizeof(struct trico_archive));
+  if (!arch)
+    return NULL;
   arch->buffer = NULL;
   arch->buffer_pointer = NULL;
   arch->data = NULL;
   arch->data_pointer = NULL;
   arch->version = 0;
   arch->next_stream_type = trico_empty;
+  arch->next_stream_blocked = 0;
+  arch->next_stream_codec_ids = 0;
   arch->buffer_size = 0;
   arch->data_size = 0;
   arch->size_available = 0;
+  arch->context = NULL;
+  arch->owns_context = 0;
+  arch->sink = NULL;
+  arch->sink_user_data = NULL;
+  arch->bytes_flushed = 0;
+  arch->mapped_file = NULL;
+  arch->streams = NULL;
+  arch->nr_of_streams = 0;
+  arch->streams_capacity = 0;
+  arch->streams_indexed = 0;
+  arch->nr_of_threads = 1;
+  arch->block_size = 0;
+  trico_get_default_encoder_options(&(arch->options));
+  arch->hash1_size_exponent = 0;
+  arch->hash2_size_exponent = 0;
+  arch->auto_tune_pending = 0;
+  arch->entropy_coded = 0;
+  arch->codec_ids = 0;
+  arch->stored = 0;
+  arch->lz4_level = 0;
+  arch->finalized = 0;
   arch->writable = 0;
+  return arch;
+  }
+
+void* trico_open_archive_for_writing(uint64_t initial_buffer_size)
+  {
+  struct trico_archive* arch = create_archive();
+  if (!arch)
+    return NULL;
 
   arch->buffer = (uint8_t*)trico_malloc(initial_buffer_size);
   if (!arch->buffer)
@@ -155,36 +1295,147 @@ void* trico_open_archive_for_writing(uint64_t initial_buffer_size)
   return arch;
   }
 
+void* trico_open_archive_for_reading_from_file(const char* filename)
+  {
+  void* mapped_file = trico_map_file(filename);
+  if (!mapped_file)
+    return NULL;
+  struct trico_archive* arch = (struct trico_archive*)trico_open_archive_for_reading(trico_get_mapped_data(mapped_file), trico_get_mapped_size(mapped_file));
+  if (!arch)
+    {
+    trico_unmap_file(mapped_file);
+    return NULL;
+    }
+  arch->mapped_file = mapped_file;
+  return arch;
+  }
+
+void* trico_open_archive_for_writing_to_callback(trico_write_callback write_callback, void* user_data, uint64_t buffer_size)
+  {
+  struct trico_archive* arch = (struct trico_archive*)trico_open_archive_for_writing(buffer_size);
+  if (!arch)
+    return NULL;
+  arch->sink = write_callback;
+  arch->sink_user_data = user_data;
+  return arch;
+  }
+
+void* trico_open_archive_for_writing_to_file(FILE* file, uint64_t buffer_size)
+  {
+  return trico_open_archive_for_writing_to_callback(trico_write_to_file, file, buffer_size);
+  }
+
+void* trico_open_archive_for_writing_to_file_descriptor(int fd, uint64_t buffer_size)
+  {
+  return trico_open_archive_for_writing_to_callback(trico_write_to_file_descriptor, (void*)(intptr_t)fd, buffer_size);
+  }
+
 void* trico_open_archive_for_reading(const uint8_t* data, uint64_t data_size)
   {
-  struct trico_archive* arch = (struct trico_archive*)trico_malloc(sizeof(struct trico_archive));
-  arch->buffer = NULL;
-  arch->buffer_pointer = NULL;
-  arch->data = NULL;
-  arch->data_pointer = NULL;
-  arch->version = 0;
-  arch->next_stream_type = trico_empty;
-  arch->buffer_size = 0;
-  arch->data_size = 0;
-  arch->size_available = 0;
-  arch->writable = 0;
+  struct trico_archive* arch = create_archive();
+  if (!arch)
+    return NULL;
+
+  arch->data = data;
+  arch->data_pointer = arch->data;
+  arch->data_size = data_size;
+  if (!read_header(arch))
+    {
+    trico_free(arch);
+    return NULL;
+    }
+  return arch;
+  }
+
+void* trico_open_archive_for_reading_stream(const uint8_t* stream_data, uint64_t stream_size)
+  {
+  struct trico_archive* arch = create_archive();
+  if (!arch)
+    return NULL;
+  arch->data = stream_data;
+  arch->data_pointer = arch->data;
+  arch->data_size = stream_size;
+  arch->streams = (struct trico_stream_entry*)trico_malloc(sizeof(struct trico_stream_entry));
+  uint64_t position = 0;
+  if (!arch->streams || stream_size == 0 || !scan_stream(arch->streams, &position, arch) || position != stream_size)
+    {
+    trico_free(arch->streams);
+    trico_free(arch);
+    return NULL;
+    }
+  arch->nr_of_streams = 1;
+  arch->streams_capacity = 1;
+  arch->streams_indexed = 1;
+  read_next_stream_type(arch);
+  return arch;
+  }
+
+int trico_flush_archive(void* a)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  return flush_to_sink(arch);
+  }
 
-  arch->data = data;
-  arch->data_pointer = arch->data;
-  arch->data_size = data_size;
-  if (!read_header(arch))
+static void write_uint64_unsafe(uint64_t value, struct trico_archive* arch)
+  {
+  write_unsafe(&value, sizeof(uint64_t), 1, arch);
+  }
+
+int trico_finalize_archive(void* a)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!arch->writable)
+    return 0;
+  if (arch->finalized)
+    return flush_to_sink(arch);
+  if (arch->version >= 1)
     {
-    trico_free(arch);
-    return NULL;
+    const uint64_t directory_offset = trico_get_size(arch);
+    if (!buffer_ready_for_writing(arch, (uint64_t)arch->nr_of_streams * TRICO_DIRECTORY_ENTRY_SIZE + TRICO_DIRECTORY_TRAILER_SIZE))
+      return 0;
+    for (uint32_t i = 0; i < arch->nr_of_streams; ++i)
+      {
+      struct trico_stream_entry* entry = &(arch->streams[i]);
+      const uint64_t end = i + 1 < arch->nr_of_streams ? arch->streams[i + 1].offset : directory_offset;
+      entry->size = end - entry->offset;
+      uint8_t info[4] = { (uint8_t)entry->type, entry->hash1_size_exponent, entry->hash2_size_exponent, entry->flags };
+      write_uint64_unsafe(entry->offset, arch);
+      write_uint64_unsafe(entry->size, arch);
+      write_unsafe(&(entry->count), sizeof(uint32_t), 1, arch);
+      write_unsafe(info, 1, 4, arch);
+      }
+    uint32_t directory_magic = TRICO_DIRECTORY_MAGIC;
+    write_uint64_unsafe(directory_offset, arch);
+    write_unsafe(&(arch->nr_of_streams), sizeof(uint32_t), 1, arch);
+    write_unsafe(&directory_magic, sizeof(uint32_t), 1, arch);
     }
-  return arch;
+  arch->finalized = 1;
+  return flush_to_sink(arch);
+  }
+
+int trico_set_version(void* a, uint32_t version)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  // the header is still in the buffer as long as no stream was written
+  if (!arch->writable || arch->finalized || version > TRICO_LATEST_VERSION || trico_get_size(arch) != 2 * sizeof(uint32_t) || arch->bytes_flushed != 0)
+    return 0;
+  arch->version = version;
+  memcpy(arch->buffer + sizeof(uint32_t), &version, sizeof(uint32_t));
+  return 1;
   }
 
 void trico_close_archive(void* a)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
+  if (arch->sink)
+    trico_finalize_archive(arch);
   if (arch->buffer)
     trico_free(arch->buffer);
+  if (arch->owns_context)
+    trico_destroy_context(arch->context);
+  trico_free(arch->streams);
+  if (arch->mapped_file)
+    trico_unmap_file(arch->mapped_file);
   trico_free(arch);
   }
 
@@ -197,7 +1448,45 @@ uint8_t* trico_get_buffer_pointer(void* a)
 uint64_t trico_get_size(void* a)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  return arch->buffer_size - arch->size_available;
+  return arch->bytes_flushed + arch->buffer_size - arch->size_available;
+  }
+
+int trico_reserve(void* a, uint64_t nr_of_bytes)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  return buffer_ready_for_writing(arch, nr_of_bytes);
+  }
+
+uint64_t trico_get_maximum_stream_size(enum trico_stream_type st, uint32_t count)
+  {
+  switch (st)
+    {
+    case trico_empty: return 0;
+    case trico_vertex_float_stream: return get_maximum_stream_size(trico_plane_float, 3, count, 0);
+    case trico_vertex_double_stream: return get_maximum_stream_size(trico_plane_double, 3, count, 0);
+    case trico_triangle_uint32_stream: return get_maximum_stream_size(trico_plane_lz4, 4, (uint64_t)count * 3, 0);
+    case trico_triangle_uint64_stream: return get_maximum_stream_size(trico_plane_lz4, 8, (uint64_t)count * 3, 0);
+    case trico_uv_per_vertex_float_stream: return get_maximum_stream_size(trico_plane_float, 2, count, 0);
+    case trico_uv_per_vertex_double_stream: return get_maximum_stream_size(trico_plane_double, 2, count, 0);
+    case trico_uv_per_triangle_float_stream: return get_maximum_stream_size(trico_plane_float, 2, (uint64_t)count * 3, 0);
+    case trico_uv_per_triangle_double_stream: return get_maximum_stream_size(trico_plane_double, 2, count, 0);
+    case trico_vertex_normal_float_stream: return get_maximum_stream_size(trico_plane_float, 3, count, 0);
+    case trico_vertex_normal_double_stream: return get_maximum_stream_size(trico_plane_double, 3, count, 0);
+    case trico_triangle_normal_float_stream: return get_maximum_stream_size(trico_plane_float, 3, count, 0);
+    case trico_triangle_normal_double_stream: return get_maximum_stream_size(trico_plane_double, 3, count, 0);
+    case trico_vertex_color_stream: return get_maximum_stream_size(trico_plane_lz4, 4, count, 0);
+    case trico_triangle_color_stream: return get_maximum_stream_size(trico_plane_lz4, 4, count, 0);
+    case trico_attribute_float_stream: return get_maximum_stream_size(trico_plane_float, 1, count, 0);
+    case trico_attribute_double_stream: return get_maximum_stream_size(trico_plane_double, 1, count, 0);
+    case trico_attribute_uint8_stream: return get_maximum_stream_size(trico_plane_lz4, 1, count, 0);
+    case trico_attribute_uint16_stream: return get_maximum_stream_size(trico_plane_lz4, 2, count, 0);
+    case trico_attribute_uint32_stream: return get_maximum_stream_size(trico_plane_lz4, 4, count, 0);
+    case trico_attribute_uint64_stream: return get_maximum_stream_size(trico_plane_lz4, 8, count, 0);
+    case trico_vertex_float_parallelogram_stream: return get_maximum_stream_size(trico_plane_parallelogram, 1, count, 0);
+    case trico_triangle_uint32_delta_stream: return get_maximum_stream_size(trico_plane_triangles, 1, count, 0);
+    case trico_vertex_remap_stream: return get_maximum_stream_size(trico_plane_lz4, 4, count, 0);
+    }
+  return 0;
   }
 
 uint32_t trico_get_version(void* a)
@@ -206,59 +1495,103 @@ uint32_t trico_get_version(void* a)
   return arch->version;
   }
 
-enum trico_stream_type trico_get_next_stream_type(void* a)
+void trico_set_number_of_threads(void* a, uint32_t nr_of_threads)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  return arch->next_stream_type;
+  arch->nr_of_threads = nr_of_threads;
   }
 
-static int trico_write_vec3_float(void* a, const float* vertices, uint32_t nr_of_vertices, enum trico_stream_type st)
+uint32_t trico_get_number_of_threads(void* a)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)st;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_vertices, sizeof(uint32_t), 1, arch))
-    return 0;
+  return arch->nr_of_threads;
+  }
 
-  float* x = (float*)trico_malloc(sizeof(float)*nr_of_vertices);
-  float* y = (float*)trico_malloc(sizeof(float)*nr_of_vertices);
-  float* z = (float*)trico_malloc(sizeof(float)*nr_of_vertices);
-  trico_transpose_xyz_aos_to_soa(&x, &y, &z, vertices, nr_of_vertices);
+void trico_get_default_encoder_options(struct trico_encoder_options* options)
+  {
+  for (uint32_t st = 0; st < TRICO_NUMBER_OF_STREAM_TYPES; ++st)
+    {
+    const enum trico_plane_codec codec = get_plane_codec((enum trico_stream_type)st);
+    options->hash1_size_exponent[st] = codec == trico_plane_double ? TRICO_DOUBLE_HASH1_SIZE_EXPONENT : TRICO_FLOAT_HASH1_SIZE_EXPONENT;
+    options->hash2_size_exponent[st] = codec == trico_plane_double ? TRICO_DOUBLE_HASH2_SIZE_EXPONENT : TRICO_FLOAT_HASH2_SIZE_EXPONENT;
+    options->entropy_coding[st] = trico_entropy_coding_none;
+    options->codec_selection[st] = trico_codec_selection_compressed;
+    options->lz4_level[st] = 0;
+    }
+  options->auto_tune = 0;
+  options->auto_tune_time_budget = 0.0;
+  options->triangle_coding = trico_triangle_coding_byte_planes;
+  options->auto_tune_sample_size = TRICO_AUTO_TUNE_SAMPLE_SIZE;
+  }
+
+void trico_set_encoder_options(void* a, const struct trico_encoder_options* options)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  arch->options = *options;
+  }
 
-  uint32_t nr_of_compressed_x_bytes;
-  uint8_t* compressed_x;
-  trico_compress(&nr_of_compressed_x_bytes, &compressed_x, x, nr_of_vertices, 4, 10);
+void trico_get_encoder_options(void* a, struct trico_encoder_options* options)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  *options = arch->options;
+  }
 
-  trico_free(x);
-  if (!write(&nr_of_compressed_x_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_x, 1, nr_of_compressed_x_bytes, arch))
-    return 0;
-  trico_free(compressed_x);
+void trico_set_context(void* a, void* context)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (arch->owns_context)
+    trico_destroy_context(arch->context);
+  arch->context = context;
+  arch->owns_context = 0;
+  }
 
-  uint32_t nr_of_compressed_y_bytes;
-  uint8_t* compressed_y;
-  trico_compress(&nr_of_compressed_y_bytes, &compressed_y, y, nr_of_vertices, 4, 10);
+void* trico_get_context(void* a)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  return get_context(arch);
+  }
 
-  trico_free(y);
-  if (!write(&nr_of_compressed_y_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_y, 1, nr_of_compressed_y_bytes, arch))
-    return 0;
-  trico_free(compressed_y);
+void trico_set_block_size(void* a, uint32_t block_size)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  arch->block_size = block_size;
+  }
+
+uint32_t trico_get_block_size(void* a)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  return arch->block_size;
+  }
 
-  uint32_t nr_of_compressed_z_bytes;
-  uint8_t* compressed_z;
-  trico_compress(&nr_of_compressed_z_bytes, &compressed_z, z, nr_of_vertices, 4, 10);
+enum trico_stream_type trico_get_next_stream_type(void* a)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  return arch->next_stream_type;
+  }
 
-  trico_free(z);
-  if (!write(&nr_of_compressed_z_bytes, sizeof(uint32_t), 1, arch))
+static int trico_write_vec3_float(void* a, const float* vertices, uint32_t nr_of_vertices, enum trico_stream_type st)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!write_stream_header(st, nr_of_vertices, trico_plane_float, 3, nr_of_vertices, arch))
     return 0;
-  if (!write(compressed_z, 1, nr_of_compressed_z_bytes, arch))
+  if (!auto_tune_interleaved(vertices, 3, nr_of_vertices, trico_plane_float, arch))
     return 0;
-  trico_free(compressed_z);
-  return 1;
+  if (use_interleaved_encoder(trico_plane_float, 3, nr_of_vertices, arch))
+    return write_interleaved_planes(vertices, 3, nr_of_vertices, trico_plane_float, arch);
+
+  void* planes[3];
+  if (!get_planes(planes, 3, sizeof(float) * (uint64_t)nr_of_vertices, arch))
+    return 0;
+  float* x = (float*)planes[0];
+  float* y = (float*)planes[1];
+  float* z = (float*)planes[2];
+  trico_transpose_xyz_aos_to_soa(&x, &y, &z, vertices, nr_of_vertices);
+
+  int result = write_float_plane(x, nr_of_vertices, arch) &&
+    write_float_plane(y, nr_of_vertices, arch) &&
+    write_float_plane(z, nr_of_vertices, arch);
+
+  return result;
   }
 
 int trico_write_vertices(void* a, const float* vertices, uint32_t nr_of_vertices)
@@ -266,6 +1599,15 @@ int trico_write_vertices(void* a, const float* vertices, uint32_t nr_of_vertices
   return trico_write_vec3_float(a, vertices, nr_of_vertices, trico_vertex_float_stream);
   }
 
+int trico_write_vertices_parallelogram(void* a, const float* vertices, uint32_t nr_of_vertices, const uint32_t* tria_indices, uint32_t nr_of_triangles)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!write_stream_header(trico_vertex_float_parallelogram_stream, nr_of_vertices, trico_plane_parallelogram, 1, nr_of_vertices, arch))
+    return 0;
+
+  return write_parallelogram_plane(vertices, nr_of_vertices, tria_indices, nr_of_triangles, arch);
+  }
+
 int trico_write_vertex_normals(void* a, const float* normals, uint32_t nr_of_normals)
   {
   return trico_write_vec3_float(a, normals, nr_of_normals, trico_vertex_normal_float_stream);
@@ -279,151 +1621,74 @@ int trico_write_triangle_normals(void* a, const float* normals, uint32_t nr_of_n
 int trico_write_attributes_float(void* a, const float* attrib, uint32_t nr_of_attribs)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)trico_attribute_float_stream;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_attribs, sizeof(uint32_t), 1, arch))
-    return 0;  
-
-  uint32_t nr_of_compressed_bytes;
-  uint8_t* compressed;
-  trico_compress(&nr_of_compressed_bytes, &compressed, attrib, nr_of_attribs, 4, 10);
-
-  if (!write(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  if (!write_stream_header(trico_attribute_float_stream, nr_of_attribs, trico_plane_float, 1, nr_of_attribs, arch))
     return 0;
-  if (!write(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  trico_free(compressed);  
 
-  return 1;
+  return write_float_plane(attrib, nr_of_attribs, arch);
   }
 
 int trico_write_attributes_double(void* a, const double* attrib, uint32_t nr_of_attribs)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)trico_attribute_double_stream;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_attribs, sizeof(uint32_t), 1, arch))
-    return 0;
-
-  uint32_t nr_of_compressed_bytes;
-  uint8_t* compressed;
-  trico_compress_double_precision(&nr_of_compressed_bytes, &compressed, attrib, nr_of_attribs, 20, 20);
-
-  if (!write(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  if (!write_stream_header(trico_attribute_double_stream, nr_of_attribs, trico_plane_double, 1, nr_of_attribs, arch))
     return 0;
-  if (!write(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  trico_free(compressed);
 
-  return 1;
+  return write_double_plane(attrib, nr_of_attribs, arch);
   }
 
 int trico_write_triangles(void* a, const uint32_t* tria_indices, uint32_t nr_of_triangles)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)trico_triangle_uint32_stream;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_triangles, sizeof(uint32_t), 1, arch))
-    return 0;
-
-  uint8_t* b1 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b2 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b3 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b4 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-
-  trico_transpose_uint32_aos_to_soa(&b1, &b2, &b3, &b4, tria_indices, nr_of_triangles * 3);
-
-  LZ4_stream_t lz4Stream_body;
-  LZ4_stream_t* lz4Stream = &lz4Stream_body;
-  LZ4_initStream(lz4Stream, sizeof(*lz4Stream));
-
-  unsigned estimateLen = LZ4_COMPRESSBOUND(nr_of_triangles * 3);
-  uint8_t* compressed_buf = (uint8_t*)trico_malloc(estimateLen);
-
-  uint32_t bytes_written = (uint32_t)LZ4_compress_default((const char*)b1, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b2, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b3, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  if (arch->options.triangle_coding != trico_triangle_coding_byte_planes)
+    {
+    if (!write_stream_header(trico_triangle_uint32_delta_stream, nr_of_triangles, trico_plane_triangles, 1, nr_of_triangles, arch))
+      return 0;
+    return write_triangle_plane(tria_indices, nr_of_triangles, arch);
+    }
+  if (!write_stream_header(trico_triangle_uint32_stream, nr_of_triangles, trico_plane_lz4, 4, (uint64_t)nr_of_triangles * 3, arch))
     return 0;
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b4, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  void* planes[4];
+  if (!get_planes(planes, 4, (uint64_t)nr_of_triangles * 3, arch))
     return 0;
+  uint8_t* b1 = (uint8_t*)planes[0];
+  uint8_t* b2 = (uint8_t*)planes[1];
+  uint8_t* b3 = (uint8_t*)planes[2];
+  uint8_t* b4 = (uint8_t*)planes[3];
 
-  trico_free(compressed_buf);
+  trico_transpose_uint32_aos_to_soa(&b1, &b2, &b3, &b4, tria_indices, nr_of_triangles * 3);
 
-  trico_free(b1);
-  trico_free(b2);
-  trico_free(b3);
-  trico_free(b4);
+  int result = write_lz4_plane(b1, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b2, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b3, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b4, nr_of_triangles * 3, arch);
 
-  return 1;
+  return result;
   }
 
 static int trico_write_vec3_double(void* a, const double* vertices, uint32_t nr_of_vertices, enum trico_stream_type st)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)st;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_vertices, sizeof(uint32_t), 1, arch))
-    return 0;
-
-  double* x = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
-  double* y = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
-  double* z = (double*)trico_malloc(sizeof(double)*nr_of_vertices);
-  trico_transpose_xyz_aos_to_soa_double_precision(&x, &y, &z, vertices, nr_of_vertices);
-
-  uint32_t nr_of_compressed_x_bytes;
-  uint8_t* compressed_x;
-  trico_compress_double_precision(&nr_of_compressed_x_bytes, &compressed_x, x, nr_of_vertices, 20, 20);
-
-  trico_free(x);
-  if (!write(&nr_of_compressed_x_bytes, sizeof(uint32_t), 1, arch))
+  if (!write_stream_header(st, nr_of_vertices, trico_plane_double, 3, nr_of_vertices, arch))
     return 0;
-  if (!write(compressed_x, 1, nr_of_compressed_x_bytes, arch))
+  if (!auto_tune_interleaved(vertices, 3, nr_of_vertices, trico_plane_double, arch))
     return 0;
-  trico_free(compressed_x);
+  if (use_interleaved_encoder(trico_plane_double, 3, nr_of_vertices, arch))
+    return write_interleaved_planes(vertices, 3, nr_of_vertices, trico_plane_double, arch);
 
-  uint32_t nr_of_compressed_y_bytes;
-  uint8_t* compressed_y;
-  trico_compress_double_precision(&nr_of_compressed_y_bytes, &compressed_y, y, nr_of_vertices, 20, 20);
-
-  trico_free(y);
-  if (!write(&nr_of_compressed_y_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_y, 1, nr_of_compressed_y_bytes, arch))
+  void* planes[3];
+  if (!get_planes(planes, 3, sizeof(double) * (uint64_t)nr_of_vertices, arch))
     return 0;
-  trico_free(compressed_y);
+  double* x = (double*)planes[0];
+  double* y = (double*)planes[1];
+  double* z = (double*)planes[2];
+  trico_transpose_xyz_aos_to_soa_double_precision(&x, &y, &z, vertices, nr_of_vertices);
 
-  uint32_t nr_of_compressed_z_bytes;
-  uint8_t* compressed_z;
-  trico_compress_double_precision(&nr_of_compressed_z_bytes, &compressed_z, z, nr_of_vertices, 20, 20);
+  int result = write_double_plane(x, nr_of_vertices, arch) &&
+    write_double_plane(y, nr_of_vertices, arch) &&
+    write_double_plane(z, nr_of_vertices, arch);
 
-  trico_free(z);
-  if (!write(&nr_of_compressed_z_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_z, 1, nr_of_compressed_z_bytes, arch))
-    return 0;
-  trico_free(compressed_z);
-  return 1;
+  return result;
   }
 
 int trico_write_vertices_double(void* a, const double* vertices, uint32_t nr_of_vertices)
@@ -444,129 +1709,56 @@ int trico_write_triangle_normals_double(void* a, const double* normals, uint32_t
 int trico_write_triangles_long(void* a, const uint64_t* tria_indices, uint32_t nr_of_triangles)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)trico_triangle_uint64_stream;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_triangles, sizeof(uint32_t), 1, arch))
-    return 0;
-
-  uint8_t* b1 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b2 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b3 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b4 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b5 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b6 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b7 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint8_t* b8 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-
-  trico_transpose_uint64_aos_to_soa(&b1, &b2, &b3, &b4, &b5, &b6, &b7, &b8, tria_indices, nr_of_triangles * 3);
-
-
-  LZ4_stream_t lz4Stream_body;
-  LZ4_stream_t* lz4Stream = &lz4Stream_body;
-  LZ4_initStream(lz4Stream, sizeof(*lz4Stream));
-
-  unsigned estimateLen = LZ4_COMPRESSBOUND(nr_of_triangles * 3);
-  uint8_t* compressed_buf = (uint8_t*)trico_malloc(estimateLen);
-
-  uint32_t bytes_written = (uint32_t)LZ4_compress_default((const char*)b1, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b2, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b3, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b4, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b5, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b6, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b7, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  if (!write_stream_header(trico_triangle_uint64_stream, nr_of_triangles, trico_plane_lz4, 8, (uint64_t)nr_of_triangles * 3, arch))
     return 0;
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b8, (char*)compressed_buf, (int)nr_of_triangles * 3, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  void* planes[8];
+  if (!get_planes(planes, 8, (uint64_t)nr_of_triangles * 3, arch))
     return 0;
+  uint8_t* b1 = (uint8_t*)planes[0];
+  uint8_t* b2 = (uint8_t*)planes[1];
+  uint8_t* b3 = (uint8_t*)planes[2];
+  uint8_t* b4 = (uint8_t*)planes[3];
+  uint8_t* b5 = (uint8_t*)planes[4];
+  uint8_t* b6 = (uint8_t*)planes[5];
+  uint8_t* b7 = (uint8_t*)planes[6];
+  uint8_t* b8 = (uint8_t*)planes[7];
 
-  trico_free(compressed_buf);
+  trico_transpose_uint64_aos_to_soa(&b1, &b2, &b3, &b4, &b5, &b6, &b7, &b8, tria_indices, nr_of_triangles * 3);
 
-  trico_free(b1);
-  trico_free(b2);
-  trico_free(b3);
-  trico_free(b4);
-  trico_free(b5);
-  trico_free(b6);
-  trico_free(b7);
-  trico_free(b8);
+  int result = write_lz4_plane(b1, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b2, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b3, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b4, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b5, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b6, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b7, nr_of_triangles * 3, arch) &&
+    write_lz4_plane(b8, nr_of_triangles * 3, arch);
 
-  return 1;
+  return result;
   }
 
 static int trico_write_vec2_float(void* a, const float* uv, uint32_t nr_of_vec2_positions, enum trico_stream_type st)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)st;
-  if (!write(&header, 1, 1, arch))
+  if (!write_stream_header(st, nr_of_vec2_positions, trico_plane_float, 2, nr_of_vec2_positions, arch))
     return 0;
-  if (!write(&nr_of_vec2_positions, sizeof(uint32_t), 1, arch))
+  if (!auto_tune_interleaved(uv, 2, nr_of_vec2_positions, trico_plane_float, arch))
     return 0;
+  if (use_interleaved_encoder(trico_plane_float, 2, nr_of_vec2_positions, arch))
+    return write_interleaved_planes(uv, 2, nr_of_vec2_positions, trico_plane_float, arch);
 
-  float* u = (float*)trico_malloc(sizeof(float)*nr_of_vec2_positions);
-  float* v = (float*)trico_malloc(sizeof(float)*nr_of_vec2_positions);
-  trico_transpose_uv_aos_to_soa(&u, &v, uv, nr_of_vec2_positions);
-
-  uint32_t nr_of_compressed_u_bytes;
-  uint8_t* compressed_u;
-  trico_compress(&nr_of_compressed_u_bytes, &compressed_u, u, nr_of_vec2_positions, 4, 10);
-
-  trico_free(u);
-  if (!write(&nr_of_compressed_u_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_u, 1, nr_of_compressed_u_bytes, arch))
+  void* planes[2];
+  if (!get_planes(planes, 2, sizeof(float) * (uint64_t)nr_of_vec2_positions, arch))
     return 0;
-  trico_free(compressed_u);
-
-  uint32_t nr_of_compressed_v_bytes;
-  uint8_t* compressed_v;
-  trico_compress(&nr_of_compressed_v_bytes, &compressed_v, v, nr_of_vec2_positions, 4, 10);
+  float* u = (float*)planes[0];
+  float* v = (float*)planes[1];
+  trico_transpose_uv_aos_to_soa(&u, &v, uv, nr_of_vec2_positions);
 
-  trico_free(v);
-  if (!write(&nr_of_compressed_v_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_v, 1, nr_of_compressed_v_bytes, arch))
-    return 0;
-  trico_free(compressed_v);
+  int result = write_float_plane(u, nr_of_vec2_positions, arch) &&
+    write_float_plane(v, nr_of_vec2_positions, arch);
 
-  return 1;
+  return result;
   }
 
 int trico_write_uv_per_vertex(void* a, const float* uv, uint32_t nr_of_uv_positions)
@@ -582,285 +1774,146 @@ int trico_write_uv_per_triangle(void* a, const float* uv, uint32_t nr_of_uv_posi
 static int trico_write_vec2_double(void* a, const double* uv, uint32_t nr_of_uv_positions, enum trico_stream_type st)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)st;
-  if (!write(&header, 1, 1, arch))
+  if (!write_stream_header(st, nr_of_uv_positions, trico_plane_double, 2, nr_of_uv_positions, arch))
     return 0;
-  if (!write(&nr_of_uv_positions, sizeof(uint32_t), 1, arch))
+  if (!auto_tune_interleaved(uv, 2, nr_of_uv_positions, trico_plane_double, arch))
     return 0;
+  if (use_interleaved_encoder(trico_plane_double, 2, nr_of_uv_positions, arch))
+    return write_interleaved_planes(uv, 2, nr_of_uv_positions, trico_plane_double, arch);
 
-  double* u = (double*)trico_malloc(sizeof(double)*nr_of_uv_positions);
-  double* v = (double*)trico_malloc(sizeof(double)*nr_of_uv_positions);
-  trico_transpose_uv_aos_to_soa_double_precision(&u, &v, uv, nr_of_uv_positions);
-
-  uint32_t nr_of_compressed_u_bytes;
-  uint8_t* compressed_u;
-  trico_compress_double_precision(&nr_of_compressed_u_bytes, &compressed_u, u, nr_of_uv_positions, 20, 20);
-
-  trico_free(u);
-  if (!write(&nr_of_compressed_u_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_u, 1, nr_of_compressed_u_bytes, arch))
+  void* planes[2];
+  if (!get_planes(planes, 2, sizeof(double) * (uint64_t)nr_of_uv_positions, arch))
     return 0;
-  trico_free(compressed_u);
-
-  uint32_t nr_of_compressed_v_bytes;
-  uint8_t* compressed_v;
-  trico_compress_double_precision(&nr_of_compressed_v_bytes, &compressed_v, v, nr_of_uv_positions, 20, 20);
+  double* u = (double*)planes[0];
+  double* v = (double*)planes[1];
+  trico_transpose_uv_aos_to_soa_double_precision(&u, &v, uv, nr_of_uv_positions);
 
-  trico_free(v);
-  if (!write(&nr_of_compressed_v_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_v, 1, nr_of_compressed_v_bytes, arch))
-    return 0;
-  trico_free(compressed_v);
+  int result = write_double_plane(u, nr_of_uv_positions, arch) &&
+    write_double_plane(v, nr_of_uv_positions, arch);
 
-  return 1;
+  return result;
   }
 
 int trico_write_uv_per_vertex_double(void* a, const double* uv, uint32_t nr_of_uv_positions)
   {
-  return trico_write_vec2_double(a, uv, nr_of_uv_positions, trico_uv_per_vertex_float_stream);
+  return trico_write_vec2_double(a, uv, nr_of_uv_positions, trico_uv_per_vertex_double_stream);
   }
 
 int trico_write_uv_per_triangle_double(void* a, const double* uv, uint32_t nr_of_uv_positions)
   {
-  return trico_write_vec2_double(a, uv, nr_of_uv_positions, trico_uv_per_triangle_float_stream);
+  return trico_write_vec2_double(a, uv, nr_of_uv_positions, trico_uv_per_triangle_double_stream);
   }
 
 int trico_write_attributes_uint8(void* a, const uint8_t* attrib, uint32_t nr_of_attribs)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)trico_attribute_uint8_stream;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_attribs, sizeof(uint32_t), 1, arch))
-    return 0; 
-
-  LZ4_stream_t lz4Stream_body;
-  LZ4_stream_t* lz4Stream = &lz4Stream_body;
-  LZ4_initStream(lz4Stream, sizeof(*lz4Stream));
-
-  unsigned estimateLen = LZ4_COMPRESSBOUND(nr_of_attribs);
-  uint8_t* compressed_buf = (uint8_t*)trico_malloc(estimateLen);
-
-  uint32_t bytes_written = (uint32_t)LZ4_compress_default((const char*)attrib, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  if (!write_stream_header(trico_attribute_uint8_stream, nr_of_attribs, trico_plane_lz4, 1, nr_of_attribs, arch))
     return 0;
 
-  trico_free(compressed_buf);
-
-  return 1;
+  return write_lz4_plane(attrib, nr_of_attribs, arch);
   }
 
 int trico_write_attributes_uint16(void* a, const uint16_t* attrib, uint32_t nr_of_attribs)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)trico_attribute_uint16_stream;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_attribs, sizeof(uint32_t), 1, arch))
-    return 0;
-
-  uint8_t* b1 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b2 = (uint8_t*)trico_malloc(nr_of_attribs);
-
-  trico_transpose_uint16_aos_to_soa(&b1, &b2, attrib, nr_of_attribs);
-
-  LZ4_stream_t lz4Stream_body;
-  LZ4_stream_t* lz4Stream = &lz4Stream_body;
-  LZ4_initStream(lz4Stream, sizeof(*lz4Stream));
-
-  unsigned estimateLen = LZ4_COMPRESSBOUND(nr_of_attribs);
-  uint8_t* compressed_buf = (uint8_t*)trico_malloc(estimateLen);
-
-  uint32_t bytes_written = (uint32_t)LZ4_compress_default((const char*)b1, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  if (!write_stream_header(trico_attribute_uint16_stream, nr_of_attribs, trico_plane_lz4, 2, nr_of_attribs, arch))
     return 0;
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b2, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  void* planes[2];
+  if (!get_planes(planes, 2, (uint64_t)nr_of_attribs, arch))
     return 0;
+  uint8_t* b1 = (uint8_t*)planes[0];
+  uint8_t* b2 = (uint8_t*)planes[1];
 
-  trico_free(compressed_buf);
+  trico_transpose_uint16_aos_to_soa(&b1, &b2, attrib, nr_of_attribs);
 
-  trico_free(b1);
-  trico_free(b2);
+  int result = write_lz4_plane(b1, nr_of_attribs, arch) &&
+    write_lz4_plane(b2, nr_of_attribs, arch);
 
-  return 1;
+  return result;
   }
 
 static int trico_write_uint32(void* a, const uint32_t* attrib, uint32_t nr_of_attribs, enum trico_stream_type st)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)st;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_attribs, sizeof(uint32_t), 1, arch))
-    return 0;
-
-  uint8_t* b1 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b2 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b3 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b4 = (uint8_t*)trico_malloc(nr_of_attribs);
-
-  trico_transpose_uint32_aos_to_soa(&b1, &b2, &b3, &b4, attrib, nr_of_attribs);
-
-  LZ4_stream_t lz4Stream_body;
-  LZ4_stream_t* lz4Stream = &lz4Stream_body;
-  LZ4_initStream(lz4Stream, sizeof(*lz4Stream));
-
-  unsigned estimateLen = LZ4_COMPRESSBOUND(nr_of_attribs);
-  uint8_t* compressed_buf = (uint8_t*)trico_malloc(estimateLen);
-
-  uint32_t bytes_written = (uint32_t)LZ4_compress_default((const char*)b1, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b2, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b3, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  if (!write_stream_header(st, nr_of_attribs, trico_plane_lz4, 4, nr_of_attribs, arch))
     return 0;
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b4, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  void* planes[4];
+  if (!get_planes(planes, 4, (uint64_t)nr_of_attribs, arch))
     return 0;
+  uint8_t* b1 = (uint8_t*)planes[0];
+  uint8_t* b2 = (uint8_t*)planes[1];
+  uint8_t* b3 = (uint8_t*)planes[2];
+  uint8_t* b4 = (uint8_t*)planes[3];
 
-  trico_free(compressed_buf);
+  trico_transpose_uint32_aos_to_soa(&b1, &b2, &b3, &b4, attrib, nr_of_attribs);
 
-  trico_free(b1);
-  trico_free(b2);
-  trico_free(b3);
-  trico_free(b4);
+  int result = write_lz4_plane(b1, nr_of_attribs, arch) &&
+    write_lz4_plane(b2, nr_of_attribs, arch) &&
+    write_lz4_plane(b3, nr_of_attribs, arch) &&
+    write_lz4_plane(b4, nr_of_attribs, arch);
 
-  return 1;
+  return result;
   }
 
 int trico_write_attributes_uint32(void* a, const uint32_t* attrib, uint32_t nr_of_attribs)
   {
-  return trico_write_uint32(a, attrib, nr_of_attribs, trico_attribute_uint32_stream);
-  }
-
-int trico_write_vertex_colors(void* archive, const uint32_t* color, uint32_t nr_of_colors)
-  {
-  return trico_write_uint32(archive, color, nr_of_colors, trico_vertex_color_stream);
-  }
-
-int trico_write_triangle_colors(void* archive, const uint32_t* color, uint32_t nr_of_colors)
-  {
-  return trico_write_uint32(archive, color, nr_of_colors, trico_triangle_color_stream);
-  }
-
-int trico_write_attributes_uint64(void* a, const uint64_t* attrib, uint32_t nr_of_attribs)
-  {
-  struct trico_archive* arch = (struct trico_archive*)a;
-  uint8_t header = (uint8_t)trico_attribute_uint64_stream;
-  if (!write(&header, 1, 1, arch))
-    return 0;
-  if (!write(&nr_of_attribs, sizeof(uint32_t), 1, arch))
-    return 0;
-
-  uint8_t* b1 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b2 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b3 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b4 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b5 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b6 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b7 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint8_t* b8 = (uint8_t*)trico_malloc(nr_of_attribs);
-
-  trico_transpose_uint64_aos_to_soa(&b1, &b2, &b3, &b4, &b5, &b6, &b7, &b8, attrib, nr_of_attribs);
-
-
-  LZ4_stream_t lz4Stream_body;
-  LZ4_stream_t* lz4Stream = &lz4Stream_body;
-  LZ4_initStream(lz4Stream, sizeof(*lz4Stream));
-
-  unsigned estimateLen = LZ4_COMPRESSBOUND(nr_of_attribs);
-  uint8_t* compressed_buf = (uint8_t*)trico_malloc(estimateLen);
-
-  uint32_t bytes_written = (uint32_t)LZ4_compress_default((const char*)b1, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b2, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
-
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b3, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
+  return trico_write_uint32(a, attrib, nr_of_attribs, trico_attribute_uint32_stream);
+  }
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b4, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
+int trico_write_vertex_colors(void* archive, const uint32_t* color, uint32_t nr_of_colors)
+  {
+  return trico_write_uint32(archive, color, nr_of_colors, trico_vertex_color_stream);
+  }
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b5, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
+int trico_write_triangle_colors(void* archive, const uint32_t* color, uint32_t nr_of_colors)
+  {
+  return trico_write_uint32(archive, color, nr_of_colors, trico_triangle_color_stream);
+  }
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b6, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
-    return 0;
+int trico_write_vertex_remap(void* archive, const uint32_t* original_indices, uint32_t nr_of_vertices)
+  {
+  return trico_write_uint32(archive, original_indices, nr_of_vertices, trico_vertex_remap_stream);
+  }
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b7, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+int trico_write_attributes_uint64(void* a, const uint64_t* attrib, uint32_t nr_of_attribs)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!write_stream_header(trico_attribute_uint64_stream, nr_of_attribs, trico_plane_lz4, 8, nr_of_attribs, arch))
     return 0;
 
-  bytes_written = (uint32_t)LZ4_compress_default((const char*)b8, (char*)compressed_buf, (int)nr_of_attribs, (int)estimateLen);
-  if (!write(&bytes_written, sizeof(uint32_t), 1, arch))
-    return 0;
-  if (!write(compressed_buf, 1, bytes_written, arch))
+  void* planes[8];
+  if (!get_planes(planes, 8, (uint64_t)nr_of_attribs, arch))
     return 0;
+  uint8_t* b1 = (uint8_t*)planes[0];
+  uint8_t* b2 = (uint8_t*)planes[1];
+  uint8_t* b3 = (uint8_t*)planes[2];
+  uint8_t* b4 = (uint8_t*)planes[3];
+  uint8_t* b5 = (uint8_t*)planes[4];
+  uint8_t* b6 = (uint8_t*)planes[5];
+  uint8_t* b7 = (uint8_t*)planes[6];
+  uint8_t* b8 = (uint8_t*)planes[7];
 
-  trico_free(compressed_buf);
+  trico_transpose_uint64_aos_to_soa(&b1, &b2, &b3, &b4, &b5, &b6, &b7, &b8, attrib, nr_of_attribs);
 
-  trico_free(b1);
-  trico_free(b2);
-  trico_free(b3);
-  trico_free(b4);
-  trico_free(b5);
-  trico_free(b6);
-  trico_free(b7);
-  trico_free(b8);
+  int result = write_lz4_plane(b1, nr_of_attribs, arch) &&
+    write_lz4_plane(b2, nr_of_attribs, arch) &&
+    write_lz4_plane(b3, nr_of_attribs, arch) &&
+    write_lz4_plane(b4, nr_of_attribs, arch) &&
+    write_lz4_plane(b5, nr_of_attribs, arch) &&
+    write_lz4_plane(b6, nr_of_attribs, arch) &&
+    write_lz4_plane(b7, nr_of_attribs, arch) &&
+    write_lz4_plane(b8, nr_of_attribs, arch);
 
-  return 1;
+  return result;
   }
 
 uint32_t trico_get_number_of_vertices(void* a)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  if (arch->next_stream_type == trico_vertex_float_stream || arch->next_stream_type == trico_vertex_double_stream)
+  if (arch->next_stream_type == trico_vertex_float_stream || arch->next_stream_type == trico_vertex_double_stream ||
+    arch->next_stream_type == trico_vertex_float_parallelogram_stream || arch->next_stream_type == trico_vertex_remap_stream)
     {
     uint32_t nr_vertices;
     if (!read_inplace(&nr_vertices, sizeof(uint32_t), 1, arch))
@@ -873,7 +1926,8 @@ uint32_t trico_get_number_of_vertices(void* a)
 uint32_t trico_get_number_of_triangles(void* a)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-  if (arch->next_stream_type == trico_triangle_uint32_stream || arch->next_stream_type == trico_triangle_uint64_stream)
+  if (arch->next_stream_type == trico_triangle_uint32_stream || arch->next_stream_type == trico_triangle_uint64_stream ||
+    arch->next_stream_type == trico_triangle_uint32_delta_stream)
     {
     uint32_t nr_triangles;
     if (!read_inplace(&nr_triangles, sizeof(uint32_t), 1, arch))
@@ -950,45 +2004,15 @@ static int trico_read_vec3_float(void* a, float** vertices, enum trico_stream_ty
   if (!read(&nr_vertices, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  float* decompressed_x;
-  uint32_t nr_of_floats_x;
-  trico_decompress(&nr_of_floats_x, &decompressed_x, (const uint8_t*)compressed);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  float* decompressed_y;
-  uint32_t nr_of_floats_y;
-  trico_decompress(&nr_of_floats_y, &decompressed_y, (const uint8_t*)compressed);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_float, 3, nr_vertices, arch))
     return 0;
-  float* decompressed_z;
-  uint32_t nr_of_floats_z;
-  trico_decompress(&nr_of_floats_z, &decompressed_z, (const uint8_t*)compressed);
-  trico_free(compressed);
-
-  assert(nr_of_floats_x == nr_vertices);
-  assert(nr_of_floats_x == nr_of_floats_y);
-  assert(nr_of_floats_x == nr_of_floats_z);
 
   if (vertices != NULL)
-    trico_transpose_xyz_soa_to_aos(vertices, decompressed_x, decompressed_y, decompressed_z, nr_vertices);
-
-  trico_free(decompressed_x);
-  trico_free(decompressed_y);
-  trico_free(decompressed_z);
+    {
+    if (!decompress_planes_interleaved(&planes, *vertices, arch))
+      return 0;
+    }
 
   read_next_stream_type(arch);
 
@@ -1000,6 +2024,34 @@ int trico_read_vertices(void* a, float** vertices)
   return trico_read_vec3_float(a, vertices, trico_vertex_float_stream);
   }
 
+int trico_read_vertices_parallelogram(void* a, float** vertices, const uint32_t* tria_indices, uint32_t nr_of_triangles)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (trico_get_next_stream_type(arch) != trico_vertex_float_parallelogram_stream)
+    return 0;
+
+  uint32_t nr_vertices;
+  if (!read(&nr_vertices, sizeof(uint32_t), 1, arch))
+    return 0;
+
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_parallelogram, 1, nr_vertices, arch))
+    return 0;
+
+  if (vertices != NULL)
+    {
+    planes.decompressed[0] = *vertices;
+    planes.triangles = tria_indices;
+    planes.nr_of_triangles = nr_of_triangles;
+    if (!decompress_planes(&planes, arch))
+      return 0;
+    }
+
+  read_next_stream_type(arch);
+
+  return 1;
+  }
+
 int trico_read_vertex_normals(void* a, float** normals)
   {
   return trico_read_vec3_float(a, normals, trico_vertex_normal_float_stream);
@@ -1013,7 +2065,6 @@ int trico_read_triangle_normals(void* a, float** normals)
 static int trico_read_vec3_double(void* a, double** vertices, enum trico_stream_type st)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-
   if (trico_get_next_stream_type(arch) != st)
     return 0;
 
@@ -1021,45 +2072,15 @@ static int trico_read_vec3_double(void* a, double** vertices, enum trico_stream_
   if (!read(&nr_vertices, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  double* decompressed_x;
-  uint32_t nr_of_doubles_x;
-  trico_decompress_double_precision(&nr_of_doubles_x, &decompressed_x, (const uint8_t*)compressed);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  double* decompressed_y;
-  uint32_t nr_of_doubles_y;
-  trico_decompress_double_precision(&nr_of_doubles_y, &decompressed_y, (const uint8_t*)compressed);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_double, 3, nr_vertices, arch))
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  double* decompressed_z;
-  uint32_t nr_of_doubles_z;
-  trico_decompress_double_precision(&nr_of_doubles_z, &decompressed_z, (const uint8_t*)compressed);
-  trico_free(compressed);
-
-  assert(nr_of_doubles_x == nr_vertices);
-  assert(nr_of_doubles_x == nr_of_doubles_y);
-  assert(nr_of_doubles_x == nr_of_doubles_z);
 
   if (vertices != NULL)
-    trico_transpose_xyz_soa_to_aos_double_precision(vertices, decompressed_x, decompressed_y, decompressed_z, nr_vertices);
-
-  trico_free(decompressed_x);
-  trico_free(decompressed_y);
-  trico_free(decompressed_z);
+    {
+    if (!decompress_planes_interleaved(&planes, *vertices, arch))
+      return 0;
+    }
 
   read_next_stream_type(arch);
 
@@ -1081,163 +2102,76 @@ int trico_read_triangle_normals_double(void* a, double** normals)
   return trico_read_vec3_double(a, normals, trico_triangle_normal_double_stream);
   }
 
-int trico_read_triangles(void* a, uint32_t** triangles)
+static int trico_read_triangles_delta(struct trico_archive* arch, uint32_t** triangles)
   {
-  struct trico_archive* arch = (struct trico_archive*)a;
-  if (trico_get_next_stream_type(arch) != trico_triangle_uint32_stream)
-    return 0;
-
   uint32_t nr_of_triangles;
   if (!read(&nr_of_triangles, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b1 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint32_t bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b1, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b2 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b2, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b3 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b3, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_triangles, 1, nr_of_triangles, arch))
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b4 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b4, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
 
   if (triangles != NULL)
-    trico_transpose_uint32_soa_to_aos(triangles, decompressed_b1, decompressed_b2, decompressed_b3, decompressed_b4, nr_of_triangles * 3);
-
-  trico_free(compressed);
-  trico_free(decompressed_b1);
-  trico_free(decompressed_b2);
-  trico_free(decompressed_b3);
-  trico_free(decompressed_b4);
+    {
+    planes.decompressed[0] = *triangles;
+    if (!decompress_planes(&planes, arch))
+      return 0;
+    }
 
   read_next_stream_type(arch);
 
   return 1;
   }
 
-int trico_read_triangles_long(void* a, uint64_t** triangles)
+int trico_read_triangles(void* a, uint32_t** triangles)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-
-  if (trico_get_next_stream_type(arch) != trico_triangle_uint64_stream)
+  if (trico_get_next_stream_type(arch) == trico_triangle_uint32_delta_stream)
+    return trico_read_triangles_delta(arch, triangles);
+  if (trico_get_next_stream_type(arch) != trico_triangle_uint32_stream)
     return 0;
 
   uint32_t nr_of_triangles;
   if (!read(&nr_of_triangles, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b1 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  uint32_t bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b1, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_lz4, 4, nr_of_triangles * 3, arch))
     return 0;
-  uint8_t* decompressed_b2 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b2, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b3 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b3, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
+  if (triangles != NULL)
+    {
+    if (!decompress_planes_to_scratch(&planes, 1, arch))
+      return 0;
+    trico_transpose_uint32_soa_to_aos(triangles, planes.decompressed[0], planes.decompressed[1], planes.decompressed[2], planes.decompressed[3], nr_of_triangles * 3);
+    }
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b4 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b4, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
+  read_next_stream_type(arch);
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b5 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b5, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
+  return 1;
+  }
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+int trico_read_triangles_long(void* a, uint64_t** triangles)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (trico_get_next_stream_type(arch) != trico_triangle_uint64_stream)
     return 0;
-  uint8_t* decompressed_b6 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b6, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  uint32_t nr_of_triangles;
+  if (!read(&nr_of_triangles, sizeof(uint32_t), 1, arch))
     return 0;
-  uint8_t* decompressed_b7 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b7, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_lz4, 8, nr_of_triangles * 3, arch))
     return 0;
-  uint8_t* decompressed_b8 = (uint8_t*)trico_malloc(nr_of_triangles * 3);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b8, nr_of_compressed_bytes, nr_of_triangles * 3);
-  assert(bytes_decompressed == nr_of_triangles * 3);
 
   if (triangles != NULL)
-    trico_transpose_uint64_soa_to_aos(triangles, decompressed_b1, decompressed_b2, decompressed_b3, decompressed_b4, decompressed_b5, decompressed_b6, decompressed_b7, decompressed_b8, nr_of_triangles * 3);
-
-  trico_free(compressed);
-  trico_free(decompressed_b1);
-  trico_free(decompressed_b2);
-  trico_free(decompressed_b3);
-  trico_free(decompressed_b4);
-  trico_free(decompressed_b5);
-  trico_free(decompressed_b6);
-  trico_free(decompressed_b7);
-  trico_free(decompressed_b8);
+    {
+    if (!decompress_planes_to_scratch(&planes, 1, arch))
+      return 0;
+    trico_transpose_uint64_soa_to_aos(triangles, planes.decompressed[0], planes.decompressed[1], planes.decompressed[2], planes.decompressed[3], planes.decompressed[4], planes.decompressed[5], planes.decompressed[6], planes.decompressed[7], nr_of_triangles * 3);
+    }
 
   read_next_stream_type(arch);
 
@@ -1254,35 +2188,15 @@ static int trico_read_vec2_float(void* a, float** uv, enum trico_stream_type st)
   if (!read(&nr_vec2_positions, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  float* decompressed_u;
-  uint32_t nr_of_floats_u;
-  trico_decompress(&nr_of_floats_u, &decompressed_u, (const uint8_t*)compressed);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_float, 2, nr_vec2_positions, arch))
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  float* decompressed_v;
-  uint32_t nr_of_floats_v;
-  trico_decompress(&nr_of_floats_v, &decompressed_v, (const uint8_t*)compressed);
-
-  trico_free(compressed);
-
-  assert(nr_of_floats_u == nr_vec2_positions);
-  assert(nr_of_floats_v == nr_of_floats_u);
 
   if (uv != NULL)
-    trico_transpose_uv_soa_to_aos(uv, decompressed_u, decompressed_v, nr_vec2_positions);
-
-  trico_free(decompressed_u);
-  trico_free(decompressed_v);
+    {
+    if (!decompress_planes_interleaved(&planes, *uv, arch))
+      return 0;
+    }
 
   read_next_stream_type(arch);
 
@@ -1309,35 +2223,15 @@ int trico_read_vec2_double(void* a, double** uv, enum trico_stream_type st)
   if (!read(&nr_uv_positions, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  double* decompressed_u;
-  uint32_t nr_of_doubles_u;
-  trico_decompress_double_precision(&nr_of_doubles_u, &decompressed_u, (const uint8_t*)compressed);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_double, 2, nr_uv_positions, arch))
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  double* decompressed_v;
-  uint32_t nr_of_doubles_v;
-  trico_decompress_double_precision(&nr_of_doubles_v, &decompressed_v, (const uint8_t*)compressed);
-
-  trico_free(compressed);
-
-  assert(nr_of_doubles_u == nr_uv_positions);
-  assert(nr_of_doubles_v == nr_of_doubles_u);
 
   if (uv != NULL)
-    trico_transpose_uv_soa_to_aos_double_precision(uv, decompressed_u, decompressed_v, nr_uv_positions);
-
-  trico_free(decompressed_u);
-  trico_free(decompressed_v);
+    {
+    if (!decompress_planes_interleaved(&planes, *uv, arch))
+      return 0;
+    }
 
   read_next_stream_type(arch);
 
@@ -1364,21 +2258,16 @@ int trico_read_attributes_float(void* a, float** attrib)
   if (!read(&nr_attrib, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_float, 1, nr_attrib, arch))
     return 0;
-  uint32_t nr_of_floats;
 
   if (attrib != NULL)
     {
-    trico_decompress(&nr_of_floats, attrib, (const uint8_t*)compressed);
-    assert(nr_of_floats == nr_attrib);
+    planes.decompressed[0] = *attrib;
+    if (!decompress_planes(&planes, arch))
+      return 0;
     }
-  trico_free(compressed);
-  
 
   read_next_stream_type(arch);
 
@@ -1395,23 +2284,17 @@ int trico_read_attributes_double(void* a, double** attrib)
   if (!read(&nr_attrib, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_double, 1, nr_attrib, arch))
     return 0;
-  uint32_t nr_of_doubles;
 
   if (attrib != NULL)
     {
-    trico_decompress_double_precision(&nr_of_doubles, attrib, (const uint8_t*)compressed);
-    assert(nr_of_doubles == nr_attrib);
+    planes.decompressed[0] = *attrib;
+    if (!decompress_planes(&planes, arch))
+      return 0;
     }
 
-  trico_free(compressed);
-  
-
   read_next_stream_type(arch);
 
   return 1;
@@ -1427,22 +2310,17 @@ int trico_read_attributes_uint8(void* a, uint8_t** attrib)
   if (!read(&nr_of_attribs, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_lz4, 1, nr_of_attribs, arch))
     return 0;
 
   if (attrib != NULL)
     {
-    uint32_t bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)attrib, nr_of_compressed_bytes, nr_of_attribs);
-    assert(bytes_decompressed == nr_of_attribs);
-    (void)bytes_decompressed; //suppress warning
+    planes.decompressed[0] = *attrib;
+    if (!decompress_planes(&planes, arch))
+      return 0;
     }
 
-  trico_free(compressed);  
-
   read_next_stream_type(arch);
 
   return 1;
@@ -1458,31 +2336,16 @@ int trico_read_attributes_uint16(void* a, uint16_t** attrib)
   if (!read(&nr_of_attribs, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b1 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint32_t bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b1, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_lz4, 2, nr_of_attribs, arch))
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b2 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b2, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
 
   if (attrib != NULL)
-    trico_transpose_uint16_soa_to_aos(attrib, decompressed_b1, decompressed_b2, nr_of_attribs);
-
-  trico_free(compressed);
-  trico_free(decompressed_b1);
-  trico_free(decompressed_b2);
+    {
+    if (!decompress_planes_to_scratch(&planes, 1, arch))
+      return 0;
+    trico_transpose_uint16_soa_to_aos(attrib, planes.decompressed[0], planes.decompressed[1], nr_of_attribs);
+    }
 
   read_next_stream_type(arch);
 
@@ -1499,51 +2362,16 @@ static int trico_read_uint32(void* a, uint32_t** attrib, enum trico_stream_type
   if (!read(&nr_of_attribs, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b1 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint32_t bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b1, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b2 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b2, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b3 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b3, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
-
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_lz4, 4, nr_of_attribs, arch))
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b4 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b4, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
 
   if (attrib != NULL)
-    trico_transpose_uint32_soa_to_aos(attrib, decompressed_b1, decompressed_b2, decompressed_b3, decompressed_b4, nr_of_attribs);
-
-  trico_free(compressed);
-  trico_free(decompressed_b1);
-  trico_free(decompressed_b2);
-  trico_free(decompressed_b3);
-  trico_free(decompressed_b4);
+    {
+    if (!decompress_planes_to_scratch(&planes, 1, arch))
+      return 0;
+    trico_transpose_uint32_soa_to_aos(attrib, planes.decompressed[0], planes.decompressed[1], planes.decompressed[2], planes.decompressed[3], nr_of_attribs);
+    }
 
   read_next_stream_type(arch);
 
@@ -1560,6 +2388,11 @@ int trico_read_vertex_colors(void* archive, uint32_t** color)
   return trico_read_uint32(archive, color, trico_vertex_color_stream);
   }
 
+int trico_read_vertex_remap(void* archive, uint32_t** original_indices)
+  {
+  return trico_read_uint32(archive, original_indices, trico_vertex_remap_stream);
+  }
+
 int trico_read_triangle_colors(void* archive, uint32_t** color)
   {
   return trico_read_uint32(archive, color, trico_triangle_color_stream);
@@ -1568,7 +2401,6 @@ int trico_read_triangle_colors(void* archive, uint32_t** color)
 int trico_read_attributes_uint64(void* a, uint64_t** attrib)
   {
   struct trico_archive* arch = (struct trico_archive*)a;
-
   if (trico_get_next_stream_type(arch) != trico_attribute_uint64_stream)
     return 0;
 
@@ -1576,94 +2408,190 @@ int trico_read_attributes_uint64(void* a, uint64_t** attrib)
   if (!read(&nr_of_attribs, sizeof(uint32_t), 1, arch))
     return 0;
 
-  uint32_t nr_of_compressed_bytes;
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  void* compressed = trico_malloc(nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  struct trico_planes planes;
+  if (!read_planes(&planes, trico_plane_lz4, 8, nr_of_attribs, arch))
     return 0;
-  uint8_t* decompressed_b1 = (uint8_t*)trico_malloc(nr_of_attribs);
-  uint32_t bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b1, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
-    return 0;
-  uint8_t* decompressed_b2 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b2, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
+  if (attrib != NULL)
+    {
+    if (!decompress_planes_to_scratch(&planes, 1, arch))
+      return 0;
+    trico_transpose_uint64_soa_to_aos(attrib, planes.decompressed[0], planes.decompressed[1], planes.decompressed[2], planes.decompressed[3], planes.decompressed[4], planes.decompressed[5], planes.decompressed[6], planes.decompressed[7], nr_of_attribs);
+    }
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  read_next_stream_type(arch);
+
+  return 1;
+  }
+
+/*
+Decompresses a range of a float or double stream. The archive stays positioned at the stream,
+so that several ranges of the same stream can be read.
+*/
+static int trico_read_range(struct trico_archive* arch, enum trico_plane_codec codec, uint32_t nr_of_planes, uint32_t first, uint32_t count, void* out)
+  {
+  const uint8_t* stream_start = arch->data_pointer;
+  uint32_t nr_of_values;
+  if (!read(&nr_of_values, sizeof(uint32_t), 1, arch))
     return 0;
-  uint8_t* decompressed_b3 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b3, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+  int result = 0;
+  struct trico_planes planes;
+  if (first <= nr_of_values && count <= nr_of_values - first && read_planes(&planes, codec, nr_of_planes, nr_of_values, arch))
+    result = out != NULL ? decompress_planes_range(&planes, first, count, out, arch) : 1;
+
+  arch->data_pointer = stream_start;
+  return result;
+  }
+
+int trico_read_vertices_range(void* a, uint32_t first, uint32_t count, float** vertices)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (trico_get_next_stream_type(arch) != trico_vertex_float_stream)
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  return trico_read_range(arch, trico_plane_float, 3, first, count, vertices ? *vertices : NULL);
+  }
+
+int trico_read_vertices_double_range(void* a, uint32_t first, uint32_t count, double** vertices)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (trico_get_next_stream_type(arch) != trico_vertex_double_stream)
     return 0;
-  uint8_t* decompressed_b4 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b4, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
+  return trico_read_range(arch, trico_plane_double, 3, first, count, vertices ? *vertices : NULL);
+  }
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+int trico_read_attributes_float_range(void* a, uint32_t first, uint32_t count, float** attrib)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (trico_get_next_stream_type(arch) != trico_attribute_float_stream)
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  return trico_read_range(arch, trico_plane_float, 1, first, count, attrib ? *attrib : NULL);
+  }
+
+int trico_read_attributes_double_range(void* a, uint32_t first, uint32_t count, double** attrib)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (trico_get_next_stream_type(arch) != trico_attribute_double_stream)
     return 0;
-  uint8_t* decompressed_b5 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b5, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
+  return trico_read_range(arch, trico_plane_double, 1, first, count, attrib ? *attrib : NULL);
+  }
+
+const void* trico_get_stored_plane(void* a, uint32_t plane_index, uint64_t* nr_of_bytes)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  const enum trico_stream_type st = trico_get_next_stream_type(arch);
+  const uint32_t nr_of_planes = get_number_of_planes(st);
+  if (plane_index >= nr_of_planes || !arch->next_stream_codec_ids)
+    return NULL;
+  const uint8_t* stream_start = arch->data_pointer;
+  uint32_t count;
+  const void* values = NULL;
+  struct trico_planes planes;
+  if (read(&count, sizeof(uint32_t), 1, arch) && read_planes(&planes, get_plane_codec(st), nr_of_planes, count, arch) && plane_is_stored(&planes, plane_index))
+    {
+    // the byte planes of triangles hold the 3 indices of each triangle
+    const uint64_t plane_size = (st == trico_triangle_uint32_stream || st == trico_triangle_uint64_stream) ? 3 * (uint64_t)count : count;
+    const uint64_t size = planes.nr_of_compressed_bytes[plane_index] - 1;
+    if (size == plane_size * get_stored_value_size(planes.codec))
+      {
+      values = planes.compressed[plane_index] + 1;
+      if (nr_of_bytes)
+        *nr_of_bytes = size;
+      }
+    }
+  arch->data_pointer = stream_start;
+  return values;
+  }
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+/*
+The stream index is built lazily by scanning the stream headers, so for a memory mapped archive
+only the pages that contain headers are touched.
+*/
+static int build_stream_index(struct trico_archive* arch)
+  {
+  if (arch->streams_indexed)
+    return 1;
+  if (arch->writable)
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  uint32_t capacity = 16;
+  struct trico_stream_entry* streams = (struct trico_stream_entry*)trico_malloc(capacity * sizeof(struct trico_stream_entry));
+  if (streams == NULL)
     return 0;
-  uint8_t* decompressed_b6 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b6, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
+  uint32_t nr_of_streams = 0;
+  uint64_t position = 2 * sizeof(uint32_t);
+  while (position < arch->data_size)
+    {
+    if (nr_of_streams == capacity)
+      {
+      capacity *= 2;
+      struct trico_stream_entry* new_streams = (struct trico_stream_entry*)trico_realloc(streams, capacity * sizeof(struct trico_stream_entry));
+      if (new_streams == NULL)
+        {
+        trico_free(streams);
+        return 0;
+        }
+      streams = new_streams;
+      }
+    if (!scan_stream(&streams[nr_of_streams], &position, arch))
+      {
+      trico_free(streams);
+      return 0;
+      }
+    ++nr_of_streams;
+    }
+  arch->streams = streams;
+  arch->nr_of_streams = nr_of_streams;
+  arch->streams_indexed = 1;
+  return 1;
+  }
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
-    return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+uint32_t trico_get_number_of_streams(void* a)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!build_stream_index(arch))
     return 0;
-  uint8_t* decompressed_b7 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b7, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
+  return arch->nr_of_streams;
+  }
+
+enum trico_stream_type trico_get_stream_type(void* a, uint32_t stream_index)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!build_stream_index(arch) || stream_index >= arch->nr_of_streams)
+    return trico_empty;
+  return arch->streams[stream_index].type;
+  }
 
-  if (!read(&nr_of_compressed_bytes, sizeof(uint32_t), 1, arch))
+uint32_t trico_get_stream_count(void* a, uint32_t stream_index)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!build_stream_index(arch) || stream_index >= arch->nr_of_streams)
     return 0;
-  compressed = trico_realloc(compressed, nr_of_compressed_bytes);
-  if (!read(compressed, 1, nr_of_compressed_bytes, arch))
+  return arch->streams[stream_index].count;
+  }
+
+uint64_t trico_get_stream_offset(void* a, uint32_t stream_index)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!build_stream_index(arch) || stream_index >= arch->nr_of_streams)
     return 0;
-  uint8_t* decompressed_b8 = (uint8_t*)trico_malloc(nr_of_attribs);
-  bytes_decompressed = (uint32_t)LZ4_decompress_safe((const char*)compressed, (char*)decompressed_b8, nr_of_compressed_bytes, nr_of_attribs);
-  assert(bytes_decompressed == nr_of_attribs);
+  return arch->streams[stream_index].offset;
+  }
 
-  if (attrib != NULL)
-    trico_transpose_uint64_soa_to_aos(attrib, decompressed_b1, decompressed_b2, decompressed_b3, decompressed_b4, decompressed_b5, decompressed_b6, decompressed_b7, decompressed_b8, nr_of_attribs);
-
-  trico_free(compressed);
-  trico_free(decompressed_b1);
-  trico_free(decompressed_b2);
-  trico_free(decompressed_b3);
-  trico_free(decompressed_b4);
-  trico_free(decompressed_b5);
-  trico_free(decompressed_b6);
-  trico_free(decompressed_b7);
-  trico_free(decompressed_b8);
+uint64_t trico_get_stream_size(void* a, uint32_t stream_index)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!build_stream_index(arch) || stream_index >= arch->nr_of_streams)
+    return 0;
+  return arch->streams[stream_index].size;
+  }
 
+int trico_seek_stream(void* a, uint32_t stream_index)
+  {
+  struct trico_archive* arch = (struct trico_archive*)a;
+  if (!build_stream_index(arch) || stream_index >= arch->nr_of_streams)
+    return 0;
+  arch->data_pointer = arch->data + arch->streams[stream_index].offset;
   read_next_stream_type(arch);
-
   return 1;
   }
 
@@ -1671,6 +2599,27 @@ int trico_read_attributes_uint64(void* a, uint64_t** attrib)
     {
     struct trico_archive* arch = (struct trico_archive*)a;
     enum trico_stream_type st = trico_get_next_stream_type(arch);
+    if (st != trico_empty && arch->streams_indexed)
+      {
+      // with an index (always available for version 1 archives) the stream is skipped without reading its planes
+      const uint64_t offset = (uint64_t)(arch->data_pointer - arch->data) - 1;
+      uint32_t first = 0;
+      uint32_t last = arch->nr_of_streams;
+      while (first < last)
+        {
+        const uint32_t mid = first + (last - first) / 2;
+        if (arch->streams[mid].offset < offset)
+          first = mid + 1;
+        else
+          last = mid;
+        }
+      if (first < arch->nr_of_streams && arch->streams[first].offset == offset)
+        {
+        arch->data_pointer = arch->data + offset + arch->streams[first].size;
+        read_next_stream_type(arch);
+        return 1;
+        }
+      }
     switch (st)
       {
       case trico_empty: return 1;
@@ -1694,6 +2643,9 @@ int trico_read_attributes_uint64(void* a, uint64_t** attrib)
       case trico_attribute_uint16_stream: return trico_read_attributes_uint16(arch, NULL);
       case trico_attribute_uint32_stream: return trico_read_attributes_uint32(arch, NULL);
       case trico_attribute_uint64_stream: return trico_read_attributes_uint64(arch, NULL);
+      case trico_vertex_float_parallelogram_stream: return trico_read_vertices_parallelogram(arch, NULL, NULL, 0);
+      case trico_triangle_uint32_delta_stream: return trico_read_triangles(arch, NULL);
+      case trico_vertex_remap_stream: return trico_read_vertex_remap(arch, NULL);
       }
     return 0;
     }
\ No newline at end of file
@@ -6,7 +6,10 @@ extern "C" {
 #define TRICO_TRICO_H
 
 #include "trico_api.h"
+#include "context.h"
+#include "sink.h"
 #include <stdint.h>
+#include <stdio.h>
 
 enum trico_stream_type
   {
@@ -30,11 +33,122 @@ enum trico_stream_type
   trico_attribute_uint8_stream,
   trico_attribute_uint16_stream,
   trico_attribute_uint32_stream,
-  trico_attribute_uint64_stream
+  trico_attribute_uint64_stream,
+  trico_vertex_float_parallelogram_stream,
+  trico_triangle_uint32_delta_stream,
+  trico_vertex_remap_stream
   };
 
+#define TRICO_NUMBER_OF_STREAM_TYPES (trico_vertex_remap_stream + 1)
+
+/*
+Coding of the uint32 triangle streams: byte planes compressed with lz4 (trico_triangle_uint32_stream, the default),
+or delta coded indices without or with prediction over the edges that triangles share (trico_triangle_uint32_delta_stream,
+see triangle_compression.h), which is smaller but cannot be read by older versions of trico.
+Both keep the triangles in their original order, and both are read by trico_read_triangles.
+*/
+enum trico_triangle_coding
+  {
+  trico_triangle_coding_byte_planes,
+  trico_triangle_coding_delta,
+  trico_triangle_coding_connectivity
+  };
+
+/*
+Entropy coding of a stream: none, or a static rans coder on top of the codec of the stream, which codes skewed byte statistics
+in fewer bits than lz4 and the float codecs do (see entropy_coding.h). The encoder picks the smallest of the coded and
+the plain output for each plane, so entropy coding never makes a stream larger by more than a byte per plane.
+The planes of entropy coded streams start with a codec id (see trico_codec_selection), so they cannot be read by older versions of trico.
+*/
+enum trico_entropy_coding
+  {
+  trico_entropy_coding_none,
+  trico_entropy_coding_rans
+  };
+
+/*
+Codec selection of a stream: trico_codec_selection_compressed always compresses the planes with the codec of the stream type, as older
+versions of trico did. With trico_codec_selection_smallest each plane starts with a codec id, and a plane is stored uncompressed when
+compression does not make it smaller, as for random data. trico_codec_selection_stored stores all planes uncompressed, which is the
+fastest to write and to read: stored planes are copied with memcpy, or used in place (see trico_get_stored_plane).
+Streams with codec ids cannot be read by older versions of trico. Entropy coded streams always select the smallest codec.
+*/
+enum trico_codec_selection
+  {
+  trico_codec_selection_compressed,
+  trico_codec_selection_smallest,
+  trico_codec_selection_stored
+  };
+
+/*
+Encoder options for the floating point streams.
+The hash table sizes (2^exponent entries, exponents are rounded down to even values up to 30) can be set per stream type.
+Larger tables can give better predictions on large scans, but cost more memory and time to clear.
+For each stream the tables are limited to 16 entries per value, so small meshes do not pay for large tables.
+With auto_tune the table sizes of each stream are instead chosen by compressing the first auto_tune_sample_size values
+with a grid of sizes, taking the best compression ratio, or a faster size with a comparable ratio, but never a size that compresses
+these values worse than the sizes of the options. auto_tune_time_budget limits the wall clock time in seconds that tuning a stream may take,
+0 means no limit.
+triangle_coding selects how trico_write_triangles codes the triangles, entropy_coding selects the entropy coding per stream type,
+codec_selection whether planes of a stream type may be stored uncompressed, and lz4_level the lz4 level of the byte planes of the integer
+streams and of the triangle codecs: 0 is the lz4 default, negative levels compress faster with acceleration -level, and levels 1 up to 12
+compress better but slower (see lz4_compression.h). Decompression is equally fast for all levels.
+*/
+struct trico_encoder_options
+  {
+  uint32_t hash1_size_exponent[TRICO_NUMBER_OF_STREAM_TYPES];
+  uint32_t hash2_size_exponent[TRICO_NUMBER_OF_STREAM_TYPES];
+  int auto_tune;
+  double auto_tune_time_budget;
+  uint32_t auto_tune_sample_size;
+  enum trico_triangle_coding triangle_coding;
+  enum trico_entropy_coding entropy_coding[TRICO_NUMBER_OF_STREAM_TYPES];
+  enum trico_codec_selection codec_selection[TRICO_NUMBER_OF_STREAM_TYPES];
+  int lz4_level[TRICO_NUMBER_OF_STREAM_TYPES];
+  };
+
+/*
+The defaults are exponents 4 and 10 for float streams, 20 and 20 for double streams, no auto tuning, byte plane triangles, no entropy coding, compressed planes, and lz4 level 0.
+*/
+TRICO_API void trico_get_default_encoder_options(struct trico_encoder_options* options);
+
 TRICO_API void* trico_open_archive_for_writing(uint64_t initial_buffer_size);
+/*
+Archives opened for writing to a sink hand each plane of a stream to the sink as soon as it is compressed,
+so the internal buffer only needs to hold one compressed plane instead of the complete archive.
+buffer_size is the initial size of that buffer. For these archives trico_get_buffer_pointer only returns the bytes
+that were not flushed yet, trico_get_size returns the total number of bytes written.
+Remaining bytes are flushed by trico_flush_archive, which reports write errors, or by trico_close_archive.
+*/
+TRICO_API void* trico_open_archive_for_writing_to_callback(trico_write_callback write_callback, void* user_data, uint64_t buffer_size);
+TRICO_API void* trico_open_archive_for_writing_to_file(FILE* file, uint64_t buffer_size);
+TRICO_API void* trico_open_archive_for_writing_to_file_descriptor(int fd, uint64_t buffer_size);
+TRICO_API int trico_flush_archive(void* archive);
+
+/*
+Selects the format version of an archive opened for writing, before any stream is written. The default is version 0.
+Version 1 archives end with a directory that lists the type, count, byte offset, size and codec parameters of each stream,
+so that a reader can seek to any stream without scanning the archive.
+The directory is appended by trico_finalize_archive, after which no more streams can be written.
+Archives that write to a sink are finalized by trico_close_archive if that was not done yet;
+for archives in memory, call trico_finalize_archive before using trico_get_buffer_pointer and trico_get_size.
+Version 0 and 1 archives can both be read.
+*/
+TRICO_API int trico_set_version(void* archive, uint32_t version);
+TRICO_API int trico_finalize_archive(void* archive);
+
 TRICO_API void* trico_open_archive_for_reading(const uint8_t* data, uint64_t data_size);
+
+/*
+Opens an archive by memory mapping the file, the mapping is released by trico_close_archive.
+*/
+TRICO_API void* trico_open_archive_for_reading_from_file(const char* filename);
+
+/*
+Opens the bytes of a single stream, as located by trico_get_stream_offset and trico_get_stream_size, for reading.
+Streams can so be fetched and decoded on their own, or in parallel with one archive handle per thread.
+*/
+TRICO_API void* trico_open_archive_for_reading_stream(const uint8_t* stream_data, uint64_t stream_size);
 TRICO_API void trico_close_archive(void* archive);
 
 TRICO_API int trico_write_vertices(void* archive, const float* vertices, uint32_t nr_of_vertices);
@@ -58,10 +172,68 @@ TRICO_API int trico_write_attributes_uint16(void* archive, const uint16_t* attri
 TRICO_API int trico_write_attributes_uint32(void* archive, const uint32_t* attrib, uint32_t nr_of_attribs);
 TRICO_API int trico_write_attributes_uint64(void* archive, const uint64_t* attrib, uint32_t nr_of_attribs);
 
+/*
+Writes the vertices with parallelogram prediction over the triangles (see trico_compress_parallelogram_into_with_context),
+which compresses better than trico_write_vertices for meshes, but is slower. The triangles are not written by this call:
+write them with trico_write_triangles, and pass them to trico_read_vertices_parallelogram, which reads this stream instead of trico_read_vertices.
+The stream is never written in blocks.
+*/
+TRICO_API int trico_write_vertices_parallelogram(void* archive, const float* vertices, uint32_t nr_of_vertices, const uint32_t* tria_indices, uint32_t nr_of_triangles);
+
+/*
+Writes the original index of each vertex of a mesh that was reordered before writing (see trico_optimize_triangle_order
+and trico_renumber_vertices in mesh_connectivity.h), so that a reader can restore the original vertex order.
+The stream is optional: the mesh itself is complete without it. trico_get_number_of_vertices returns its count.
+*/
+TRICO_API int trico_write_vertex_remap(void* archive, const uint32_t* original_indices, uint32_t nr_of_vertices);
+
+/*
+Worst-case number of bytes that writing a stream of the given type takes, where count is the number of elements
+as passed to the corresponding trico_write_... function.
+*/
+TRICO_API uint64_t trico_get_maximum_stream_size(enum trico_stream_type st, uint32_t count);
+
+/*
+Makes sure that at least nr_of_bytes can be written to the archive without reallocating its buffer.
+Use it with trico_get_maximum_stream_size to size an archive up front. Returns 0 if the memory is not available.
+*/
+TRICO_API int trico_reserve(void* archive, uint64_t nr_of_bytes);
+
 TRICO_API uint8_t* trico_get_buffer_pointer(void* archive);
 TRICO_API uint64_t trico_get_size(void* archive);
 
 TRICO_API uint32_t trico_get_version(void* archive);
+
+/*
+Number of threads used for decompressing the independent planes of a stream (x/y/z coordinates, or the byte planes of integer data).
+The default is 1, a value of 0 means: use all hardware threads.
+*/
+TRICO_API void trico_set_number_of_threads(void* archive, uint32_t nr_of_threads);
+TRICO_API uint32_t trico_get_number_of_threads(void* archive);
+
+/*
+Number of elements per block for the streams that are written next. Vertex, normal, uv and float or double attribute streams
+are then compressed in blocks with independent predictors, so that a range of elements can be decoded without decoding
+the complete stream, see trico_read_vertices_range. Smaller blocks give faster range reads but a slightly worse compression ratio.
+The default is 0: streams are not split in blocks. Blocks are compressed with trico_get_number_of_threads threads.
+Note that trico_get_maximum_stream_size does not take blocks into account.
+*/
+TRICO_API void trico_set_block_size(void* archive, uint32_t block_size);
+
+/*
+The options apply to the streams that are written next.
+*/
+TRICO_API void trico_set_encoder_options(void* archive, const struct trico_encoder_options* options);
+TRICO_API void trico_get_encoder_options(void* archive, struct trico_encoder_options* options);
+
+/*
+Lets the archive take its hash tables, lz4 state and scratch planes from context (see trico_create_context) instead of from
+a context of its own, so that one context per thread can be reused over any number of archives without allocating.
+The archive does not take ownership, the context must outlive the archive. Passing NULL returns to a context owned by the archive.
+*/
+TRICO_API void trico_set_context(void* archive, void* context);
+TRICO_API void* trico_get_context(void* archive);
+TRICO_API uint32_t trico_get_block_size(void* archive);
 TRICO_API enum trico_stream_type trico_get_next_stream_type(void* archive);
 
 TRICO_API uint32_t trico_get_number_of_vertices(void* archive);
@@ -91,8 +263,47 @@ TRICO_API int trico_read_attributes_uint8(void* archive, uint8_t** attrib);
 TRICO_API int trico_read_attributes_uint16(void* archive, uint16_t** attrib);
 TRICO_API int trico_read_attributes_uint32(void* archive, uint32_t** attrib);
 TRICO_API int trico_read_attributes_uint64(void* archive, uint64_t** attrib);
+TRICO_API int trico_read_vertices_parallelogram(void* archive, float** vertices, const uint32_t* tria_indices, uint32_t nr_of_triangles);
+TRICO_API int trico_read_vertex_remap(void* archive, uint32_t** original_indices);
 TRICO_API int trico_skip_next_stream(void* archive);
 
+/*
+Decompresses elements [first, first + count) of the next stream into *vertices or *attrib, which need room for count elements.
+For blocked streams (see trico_set_block_size) only the blocks that overlap with the range are decompressed.
+The archive is not moved to the next stream, so that multiple ranges can be read: use trico_skip_next_stream to continue.
+*/
+TRICO_API int trico_read_vertices_range(void* archive, uint32_t first, uint32_t count, float** vertices);
+TRICO_API int trico_read_vertices_double_range(void* archive, uint32_t first, uint32_t count, double** vertices);
+TRICO_API int trico_read_attributes_float_range(void* archive, uint32_t first, uint32_t count, float** attrib);
+TRICO_API int trico_read_attributes_double_range(void* archive, uint32_t first, uint32_t count, double** attrib);
+
+/*
+Returns plane plane_index of the next stream in place in the archive data if that plane is stored uncompressed (see trico_codec_selection),
+and sets *nr_of_bytes to its size. Returns NULL if the plane is compressed. The planes of float and double streams hold one component each
+(x, y or z, u or v), the planes of integer streams one byte of each value (the lowest byte first), and the parallelogram and delta triangle
+streams have a single plane with the interleaved vertices or triangles. The pointer is valid as long as the archive data, and need not be aligned.
+The archive is not moved to the next stream.
+*/
+TRICO_API const void* trico_get_stored_plane(void* archive, uint32_t plane_index, uint64_t* nr_of_bytes);
+
+/*
+Random access to the streams of an archive opened for reading. For version 1 archives the stream index is read
+from the directory, for version 0 archives it is built on first use from the stream headers only, without decompressing anything.
+trico_seek_stream positions the archive so that the next trico_read_... call reads the given stream,
+after which reading continues sequentially with the stream that follows it.
+*/
+TRICO_API uint32_t trico_get_number_of_streams(void* archive);
+TRICO_API enum trico_stream_type trico_get_stream_type(void* archive, uint32_t stream_index);
+TRICO_API uint32_t trico_get_stream_count(void* archive, uint32_t stream_index);
+TRICO_API int trico_seek_stream(void* archive, uint32_t stream_index);
+
+/*
+Byte range of a stream in the archive, e.g. for fetching a single stream from remote storage.
+The range can be decoded on its own with trico_open_archive_for_reading_stream.
+*/
+TRICO_API uint64_t trico_get_stream_offset(void* archive, uint32_t stream_index);
+TRICO_API uint64_t trico_get_stream_size(void* archive, uint32_t stream_index);
+
 #endif // #ifndef TRICO_TRICO_H
 
 #if defined (__cplusplus)
@@ -1,8 +1,11 @@
 #include "ioply.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <trico/alloc.h>
+#include <trico/file_mapping.h>
+#include <trico/parallel.h>
 #include <rply/rply.h>
 
 
@@ -64,7 +67,7 @@ static int read_texcoord(p_ply_argument argument)
   return 1;
   }
 
-int trico_read_ply(uint32_t* nr_of_vertices,
+static int trico_read_ply_with_rply(uint32_t* nr_of_vertices,
   float** vertices,
   float** vertex_normals,
   uint32_t** vertex_colors,
@@ -104,7 +107,7 @@ int trico_read_ply(uint32_t* nr_of_vertices,
   *nr_of_vertices = (uint32_t)nvertices_x;
 
   if (nvertices_x > 0)
-    *vertices = (float*)trico_malloc(*nr_of_vertices * 3 * sizeof(float));
+    *vertices = (float*)trico_malloc((size_t)*nr_of_vertices * 3 * sizeof(float));
   p_vertex_pointer_x = (float*)(*vertices);
   p_vertex_pointer_y = p_vertex_pointer_x + 1;
   p_vertex_pointer_z = p_vertex_pointer_x + 2;
@@ -130,7 +133,7 @@ int trico_read_ply(uint32_t* nr_of_vertices,
     }
 
   if (nnormals_x > 0)
-    *vertex_normals = (float*)trico_malloc(*nr_of_vertices * 3 * sizeof(float));
+    *vertex_normals = (float*)trico_malloc((size_t)*nr_of_vertices * 3 * sizeof(float));
   p_normal_pointer_x = (float*)(*vertex_normals);
   p_normal_pointer_y = p_normal_pointer_x + 1;
   p_normal_pointer_z = p_normal_pointer_x + 2;
@@ -178,7 +181,7 @@ int trico_read_ply(uint32_t* nr_of_vertices,
       ply_close(ply);
       return 0;
       }
-    *vertex_colors = (uint32_t*)trico_malloc(*nr_of_vertices * sizeof(uint32_t));
+    *vertex_colors = (uint32_t*)trico_malloc((size_t)*nr_of_vertices * sizeof(uint32_t));
     uint32_t* p_clr = *vertex_colors;
     for (uint32_t c = 0; c < *nr_of_vertices; ++c)
       *p_clr++ = 0xffffffff;
@@ -198,7 +201,7 @@ int trico_read_ply(uint32_t* nr_of_vertices,
   *nr_of_triangles = (uint32_t)ntriangles;
 
   if (ntriangles > 0)
-    *triangles = (uint32_t*)trico_malloc(*nr_of_triangles * 3 * sizeof(uint32_t));
+    *triangles = (uint32_t*)trico_malloc((size_t)*nr_of_triangles * 3 * sizeof(uint32_t));
 
   p_tria_index = (uint32_t*)(*triangles);
 
@@ -229,7 +232,7 @@ int trico_read_ply(uint32_t* nr_of_vertices,
     }
 
   if (ntexcoords > 0)
-    *texcoords = (float*)trico_malloc(*nr_of_triangles * 6 * sizeof(float));
+    *texcoords = (float*)trico_malloc((size_t)*nr_of_triangles * 6 * sizeof(float));
 
   p_uv = (float*)(*texcoords);
 
@@ -241,6 +244,525 @@ int trico_read_ply(uint32_t* nr_of_vertices,
   return 1;
   }
 
+#define TRICO_PLY_MAX_ELEMENTS 16
+#define TRICO_PLY_MAX_PROPERTIES 64
+#define TRICO_PLY_MAX_NAME_LENGTH 64
+#define TRICO_PLY_VERTICES_PER_TASK (1 << 16)
+
+enum trico_ply_type
+  {
+  trico_ply_type_none,
+  trico_ply_type_int8,
+  trico_ply_type_uint8,
+  trico_ply_type_int16,
+  trico_ply_type_uint16,
+  trico_ply_type_int32,
+  trico_ply_type_uint32,
+  trico_ply_type_float32,
+  trico_ply_type_float64
+  };
+
+typedef struct trico_ply_property
+  {
+  char name[TRICO_PLY_MAX_NAME_LENGTH];
+  enum trico_ply_type type; // the type of the items for a list
+  enum trico_ply_type count_type; // trico_ply_type_none if the property is not a list
+  uint32_t offset; // in the record, if the element has no lists
+  } trico_ply_property;
+
+typedef struct trico_ply_element
+  {
+  char name[TRICO_PLY_MAX_NAME_LENGTH];
+  uint64_t count;
+  uint32_t nr_of_properties;
+  uint32_t record_size; // 0 if the element has lists
+  trico_ply_property properties[TRICO_PLY_MAX_PROPERTIES];
+  } trico_ply_element;
+
+typedef struct trico_ply_header
+  {
+  int swap; // the file's byte order differs from the machine's
+  uint32_t nr_of_elements;
+  trico_ply_element elements[TRICO_PLY_MAX_ELEMENTS];
+  const uint8_t* data;
+  } trico_ply_header;
+
+static uint32_t trico_ply_type_size(enum trico_ply_type type)
+  {
+  static const uint32_t sizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+  return sizes[type];
+  }
+
+static enum trico_ply_type trico_ply_type_from_name(const char* name)
+  {
+  static const char* names[] = { "char", "int8", "uchar", "uint8", "short", "int16", "ushort", "uint16", "int", "int32", "uint", "uint32", "float", "float32", "double", "float64" };
+  for (int i = 0; i < 16; ++i)
+    {
+    if (strcmp(name, names[i]) == 0)
+      return (enum trico_ply_type)(i / 2 + 1);
+    }
+  return trico_ply_type_none;
+  }
+
+/*
+Reads the value at p as a double, which is how rply hands out values, so that both readers convert values in the same way.
+*/
+static double trico_ply_get_value(const uint8_t* p, enum trico_ply_type type, int swap)
+  {
+  uint8_t bytes[8];
+  const uint32_t size = trico_ply_type_size(type);
+  for (uint32_t i = 0; i < size; ++i)
+    bytes[i] = swap ? p[size - 1 - i] : p[i];
+  switch (type)
+    {
+    case trico_ply_type_int8: { int8_t v; memcpy(&v, bytes, 1); return (double)v; }
+    case trico_ply_type_uint8: { uint8_t v; memcpy(&v, bytes, 1); return (double)v; }
+    case trico_ply_type_int16: { int16_t v; memcpy(&v, bytes, 2); return (double)v; }
+    case trico_ply_type_uint16: { uint16_t v; memcpy(&v, bytes, 2); return (double)v; }
+    case trico_ply_type_int32: { int32_t v; memcpy(&v, bytes, 4); return (double)v; }
+    case trico_ply_type_uint32: { uint32_t v; memcpy(&v, bytes, 4); return (double)v; }
+    case trico_ply_type_float32: { float v; memcpy(&v, bytes, 4); return (double)v; }
+    case trico_ply_type_float64: { double v; memcpy(&v, bytes, 8); return v; }
+    default: return 0.0;
+    }
+  }
+
+/*
+Parses the header of a binary ply file. Returns 0 for ascii files, invalid headers, and headers with more elements or properties
+than this reader supports, which are left to rply.
+*/
+static int trico_parse_ply_header(trico_ply_header* header, const uint8_t* data, uint64_t size)
+  {
+  const char* s = (const char*)data;
+  const char* end = s + size;
+  int format_found = 0;
+  int is_little_endian_machine = 1;
+  is_little_endian_machine = *(char*)&is_little_endian_machine == 1;
+  header->nr_of_elements = 0;
+  for (uint32_t line_index = 0; s < end; ++line_index)
+    {
+    const char* line_end = memchr(s, '\n', (size_t)(end - s));
+    if (!line_end)
+      return 0;
+    char line[256];
+    size_t length = (size_t)(line_end - s);
+    if (length && s[length - 1] == '\r')
+      --length;
+    if (length >= sizeof(line))
+      length = sizeof(line) - 1; // only comments are this long
+    memcpy(line, s, length);
+    line[length] = 0;
+    s = line_end + 1;
+
+    char words[5][TRICO_PLY_MAX_NAME_LENGTH];
+    char format[2];
+    int nr_of_words = sscanf(line, "%63s %63s %63s %63s %63s %1s", words[0], words[1], words[2], words[3], words[4], format);
+    if (line_index == 0)
+      {
+      if (nr_of_words != 1 || strcmp(words[0], "ply") != 0)
+        return 0;
+      }
+    else if (nr_of_words <= 0 || strcmp(words[0], "comment") == 0 || strcmp(words[0], "obj_info") == 0)
+      continue;
+    else if (strcmp(words[0], "format") == 0)
+      {
+      if (nr_of_words != 3)
+        return 0;
+      if (strcmp(words[1], "binary_little_endian") == 0)
+        header->swap = !is_little_endian_machine;
+      else if (strcmp(words[1], "binary_big_endian") == 0)
+        header->swap = is_little_endian_machine;
+      else
+        return 0;
+      format_found = 1;
+      }
+    else if (strcmp(words[0], "element") == 0)
+      {
+      char* count_end;
+      if (nr_of_words != 3 || header->nr_of_elements == TRICO_PLY_MAX_ELEMENTS)
+        return 0;
+      trico_ply_element* element = header->elements + header->nr_of_elements++;
+      strcpy(element->name, words[1]);
+      element->count = strtoull(words[2], &count_end, 10);
+      if (*count_end || words[2][0] == '-')
+        return 0;
+      element->nr_of_properties = 0;
+      element->record_size = 0;
+      }
+    else if (strcmp(words[0], "property") == 0)
+      {
+      if (header->nr_of_elements == 0)
+        return 0;
+      trico_ply_element* element = header->elements + header->nr_of_elements - 1;
+      if (element->nr_of_properties == TRICO_PLY_MAX_PROPERTIES)
+        return 0;
+      trico_ply_property* property = element->properties + element->nr_of_properties++;
+      if (nr_of_words == 3)
+        {
+        property->count_type = trico_ply_type_none;
+        property->type = trico_ply_type_from_name(words[1]);
+        strcpy(property->name, words[2]);
+        }
+      else if (nr_of_words == 5 && strcmp(words[1], "list") == 0)
+        {
+        property->count_type = trico_ply_type_from_name(words[2]);
+        property->type = trico_ply_type_from_name(words[3]);
+        strcpy(property->name, words[4]);
+        if (property->count_type == trico_ply_type_none || property->count_type == trico_ply_type_float32 || property->count_type == trico_ply_type_float64)
+          return 0;
+        }
+      else
+        return 0;
+      if (property->type == trico_ply_type_none)
+        return 0;
+      }
+    else if (strcmp(words[0], "end_header") == 0 && nr_of_words == 1)
+      {
+      if (!format_found)
+        return 0;
+      header->data = (const uint8_t*)s;
+      for (uint32_t e = 0; e < header->nr_of_elements; ++e)
+        {
+        trico_ply_element* element = header->elements + e;
+        uint32_t offset = 0;
+        for (uint32_t p = 0; p < element->nr_of_properties && offset != UINT32_MAX; ++p)
+          {
+          element->properties[p].offset = offset;
+          offset = element->properties[p].count_type == trico_ply_type_none ? offset + trico_ply_type_size(element->properties[p].type) : UINT32_MAX;
+          }
+        element->record_size = offset == UINT32_MAX ? 0 : offset;
+        }
+      return 1;
+      }
+    else
+      return 0;
+    }
+  return 0;
+  }
+
+static const trico_ply_element* trico_find_ply_element(const trico_ply_header* header, const char* name)
+  {
+  for (uint32_t e = 0; e < header->nr_of_elements; ++e)
+    {
+    if (strcmp(header->elements[e].name, name) == 0)
+      return header->elements + e;
+    }
+  return NULL;
+  }
+
+static const trico_ply_property* trico_find_ply_property(const trico_ply_element* element, const char* name)
+  {
+  if (!element)
+    return NULL;
+  for (uint32_t p = 0; p < element->nr_of_properties; ++p)
+    {
+    if (strcmp(element->properties[p].name, name) == 0)
+      return element->properties + p;
+    }
+  return NULL;
+  }
+
+/*
+Returns 0 for the layouts that are left to rply: vertices with lists, and faces with single values for indices or texture coordinates.
+*/
+static int trico_has_supported_ply_layout(const trico_ply_header* header)
+  {
+  const trico_ply_element* vertex_element = trico_find_ply_element(header, "vertex");
+  const trico_ply_element* face_element = trico_find_ply_element(header, "face");
+  if (vertex_element && vertex_element->record_size == 0)
+    return 0;
+  const char* list_names[3] = { "vertex_indices", "vertex_index", "texcoord" };
+  for (int i = 0; i < 3; ++i)
+    {
+    const trico_ply_property* property = trico_find_ply_property(face_element, list_names[i]);
+    if (property && property->count_type == trico_ply_type_none)
+      return 0;
+    }
+  return 1;
+  }
+
+/*
+A vertex property that is read into a column of floats or of color bytes, with the given stride in the output.
+*/
+typedef struct trico_ply_column
+  {
+  const trico_ply_property* property;
+  float* floats;
+  uint8_t* bytes;
+  uint32_t stride;
+  } trico_ply_column;
+
+typedef struct trico_ply_vertex_reader
+  {
+  const uint8_t* records;
+  uint32_t record_size;
+  uint64_t nr_of_vertices;
+  int swap;
+  uint32_t nr_of_columns;
+  trico_ply_column columns[10];
+  } trico_ply_vertex_reader;
+
+/*
+Converts the vertex properties of one task column by column. Floats in the byte order of the machine and uchar colors, the
+common case, are copied directly, other types go through trico_ply_get_value.
+*/
+static void trico_read_ply_vertices(void* user_data, uint32_t task_index, uint32_t thread_index)
+  {
+  (void)thread_index;
+  const trico_ply_vertex_reader* reader = (const trico_ply_vertex_reader*)user_data;
+  const uint64_t begin = (uint64_t)task_index * TRICO_PLY_VERTICES_PER_TASK;
+  uint64_t end = begin + TRICO_PLY_VERTICES_PER_TASK;
+  if (end > reader->nr_of_vertices)
+    end = reader->nr_of_vertices;
+  for (uint32_t c = 0; c < reader->nr_of_columns; ++c)
+    {
+    const trico_ply_column* column = reader->columns + c;
+    const uint8_t* record = reader->records + begin * reader->record_size + column->property->offset;
+    const enum trico_ply_type type = column->property->type;
+    if (column->floats)
+      {
+      float* out = column->floats + begin * column->stride;
+      if (type == trico_ply_type_float32 && !reader->swap)
+        {
+        for (uint64_t i = begin; i < end; ++i, record += reader->record_size, out += column->stride)
+          memcpy(out, record, sizeof(float));
+        }
+      else
+        {
+        for (uint64_t i = begin; i < end; ++i, record += reader->record_size, out += column->stride)
+          *out = (float)trico_ply_get_value(record, type, reader->swap);
+        }
+      }
+    else
+      {
+      uint8_t* out = column->bytes + begin * column->stride;
+      if (type == trico_ply_type_uint8)
+        {
+        for (uint64_t i = begin; i < end; ++i, record += reader->record_size, out += column->stride)
+          *out = *record;
+        }
+      else
+        {
+        for (uint64_t i = begin; i < end; ++i, record += reader->record_size, out += column->stride)
+          *out = (uint8_t)trico_ply_get_value(record, type, reader->swap);
+        }
+      }
+    }
+  }
+
+/*
+Walks over the records of an element with lists, and reads the first 3 vertex indices and the first 6 texture coordinates
+of each face as rply does. Returns the end of the element's data, or NULL if the file ends before it.
+*/
+static const uint8_t* trico_read_ply_list_element(const trico_ply_element* element, const trico_ply_property* indices_property, const trico_ply_property* texcoord_property,
+  uint32_t** p_tria_index, float** p_uv, const uint8_t* data, const uint8_t* end, int swap)
+  {
+  for (uint64_t r = 0; r < element->count; ++r)
+    {
+    for (uint32_t p = 0; p < element->nr_of_properties; ++p)
+      {
+      const trico_ply_property* property = element->properties + p;
+      const uint32_t type_size = trico_ply_type_size(property->type);
+      if (property->count_type == trico_ply_type_none)
+        {
+        if ((uint64_t)(end - data) < type_size)
+          return NULL;
+        data += type_size;
+        continue;
+        }
+      const uint32_t count_size = trico_ply_type_size(property->count_type);
+      if ((uint64_t)(end - data) < count_size)
+        return NULL;
+      const double count_value = trico_ply_get_value(data, property->count_type, swap);
+      const uint64_t length = count_value > 0 ? (uint64_t)count_value : 0;
+      data += count_size;
+      if ((uint64_t)(end - data) < length * type_size)
+        return NULL;
+      if (property == indices_property)
+        {
+        if (length == 3 && !swap && (property->type == trico_ply_type_int32 || property->type == trico_ply_type_uint32))
+          {
+          memcpy(*p_tria_index, data, 3 * sizeof(uint32_t));
+          *p_tria_index += 3;
+          }
+        else
+          {
+          for (uint64_t i = 0; i < length && i < 3; ++i)
+            *(*p_tria_index)++ = (uint32_t)trico_ply_get_value(data + i * type_size, property->type, swap);
+          }
+        }
+      else if (property == texcoord_property)
+        {
+        for (uint64_t i = 0; i < length && i < 6; ++i)
+          *(*p_uv)++ = (float)trico_ply_get_value(data + i * type_size, property->type, swap);
+        for (uint64_t i = length; i < 6; ++i) // fewer than 6 texture coordinates, also none, are padded with 0.f
+          *(*p_uv)++ = 0.f;
+        }
+      data += length * type_size;
+      }
+    }
+  return data;
+  }
+
+static void trico_free_ply(uint32_t* nr_of_vertices, float** vertices, float** vertex_normals, uint32_t** vertex_colors, uint32_t* nr_of_triangles, uint32_t** triangles, float** texcoords)
+  {
+  trico_free(*vertices);
+  trico_free(*vertex_normals);
+  trico_free(*vertex_colors);
+  trico_free(*triangles);
+  trico_free(*texcoords);
+  *nr_of_vertices = 0;
+  *vertices = NULL;
+  *vertex_normals = NULL;
+  *vertex_colors = NULL;
+  *nr_of_triangles = 0;
+  *triangles = NULL;
+  *texcoords = NULL;
+  }
+
+static int trico_read_binary_ply(const trico_ply_header* header, const uint8_t* end,
+  uint32_t* nr_of_vertices,
+  float** vertices,
+  float** vertex_normals,
+  uint32_t** vertex_colors,
+  uint32_t* nr_of_triangles,
+  uint32_t** triangles,
+  float** texcoords)
+  {
+  const trico_ply_element* vertex_element = trico_find_ply_element(header, "vertex");
+  const trico_ply_element* face_element = trico_find_ply_element(header, "face");
+  static const char* color_names[4][3] = { { "red", "r", "diffuse_red" }, { "green", "g", "diffuse_green" }, { "blue", "b", "diffuse_blue" }, { "alpha", "a", "diffuse_alpha" } };
+  const char* column_names[6] = { "x", "y", "z", "nx", "ny", "nz" };
+  trico_ply_vertex_reader reader;
+  reader.nr_of_columns = 0;
+  for (int c = 0; c < 6; ++c)
+    {
+    reader.columns[c].property = trico_find_ply_property(vertex_element, column_names[c]);
+    reader.columns[c].bytes = NULL;
+    }
+  int nr_of_colors = 0;
+  for (int c = 0; c < 4; ++c)
+    {
+    reader.columns[6 + c].property = NULL;
+    reader.columns[6 + c].floats = NULL;
+    for (int n = 0; n < 3 && !reader.columns[6 + c].property; ++n)
+      reader.columns[6 + c].property = trico_find_ply_property(vertex_element, color_names[c][n]);
+    nr_of_colors += reader.columns[6 + c].property != NULL;
+    }
+  const int has_vertices = reader.columns[0].property != NULL;
+  const int has_normals = reader.columns[3].property != NULL;
+  if (has_vertices != (reader.columns[1].property != NULL) || has_vertices != (reader.columns[2].property != NULL)
+    || has_normals != (reader.columns[4].property != NULL) || has_normals != (reader.columns[5].property != NULL)
+    || ((has_normals || nr_of_colors) && !has_vertices))
+    return 0;
+  const trico_ply_property* indices_property = trico_find_ply_property(face_element, "vertex_indices");
+  if (!indices_property)
+    indices_property = trico_find_ply_property(face_element, "vertex_index");
+  const trico_ply_property* texcoord_property = trico_find_ply_property(face_element, "texcoord");
+  if (texcoord_property && !indices_property)
+    return 0;
+  if ((has_vertices && vertex_element->count > UINT32_MAX) || (indices_property && face_element->count > UINT32_MAX))
+    return 0;
+
+  *nr_of_vertices = has_vertices ? (uint32_t)vertex_element->count : 0;
+  *nr_of_triangles = indices_property ? (uint32_t)face_element->count : 0;
+  if (*nr_of_vertices)
+    *vertices = (float*)trico_malloc((size_t)*nr_of_vertices * 3 * sizeof(float));
+  if (*nr_of_vertices && has_normals)
+    *vertex_normals = (float*)trico_malloc((size_t)*nr_of_vertices * 3 * sizeof(float));
+  if (*nr_of_vertices && nr_of_colors)
+    {
+    *vertex_colors = (uint32_t*)trico_malloc((size_t)*nr_of_vertices * sizeof(uint32_t));
+    if (*vertex_colors)
+      memset(*vertex_colors, 0xff, (size_t)*nr_of_vertices * sizeof(uint32_t));
+    }
+  if (*nr_of_triangles)
+    *triangles = (uint32_t*)trico_calloc((size_t)*nr_of_triangles * 3, sizeof(uint32_t));
+  if (*nr_of_triangles && texcoord_property)
+    *texcoords = (float*)trico_calloc((size_t)*nr_of_triangles * 6, sizeof(float));
+  if ((*nr_of_vertices && (!*vertices || (has_normals && !*vertex_normals) || (nr_of_colors && !*vertex_colors))) || (*nr_of_triangles && (!*triangles || (texcoord_property && !*texcoords))))
+    return 0;
+
+  for (int c = 0; c < 10; ++c)
+    {
+    if (!reader.columns[c].property)
+      continue;
+    trico_ply_column column = reader.columns[c];
+    column.floats = c < 3 ? *vertices + c : (c < 6 ? *vertex_normals + c - 3 : NULL);
+    column.bytes = c < 6 ? NULL : (uint8_t*)(*vertex_colors) + c - 6;
+    column.stride = c < 6 ? 3 : 4;
+    reader.columns[reader.nr_of_columns++] = column;
+    }
+
+  uint32_t* p_tria_index = *triangles;
+  float* p_uv = *texcoords;
+  const uint8_t* data = header->data;
+  for (uint32_t e = 0; e < header->nr_of_elements; ++e)
+    {
+    const trico_ply_element* element = header->elements + e;
+    if (element->record_size)
+      {
+      if ((uint64_t)(end - data) / element->record_size < element->count)
+        return 0;
+      if (element == vertex_element && has_vertices)
+        {
+        reader.records = data;
+        reader.record_size = element->record_size;
+        reader.nr_of_vertices = element->count;
+        reader.swap = header->swap;
+        const uint32_t nr_of_tasks = (uint32_t)((element->count + TRICO_PLY_VERTICES_PER_TASK - 1) / TRICO_PLY_VERTICES_PER_TASK);
+        trico_parallel_for(&trico_read_ply_vertices, &reader, nr_of_tasks, 0);
+        }
+      data += element->count * element->record_size;
+      }
+    else
+      {
+      const int is_face_element = element == face_element;
+      data = trico_read_ply_list_element(element, is_face_element ? indices_property : NULL, is_face_element ? texcoord_property : NULL, &p_tria_index, &p_uv, data, end, header->swap);
+      if (!data)
+        return 0;
+      }
+    }
+  return 1;
+  }
+
+int trico_read_ply(uint32_t* nr_of_vertices,
+  float** vertices,
+  float** vertex_normals,
+  uint32_t** vertex_colors,
+  uint32_t* nr_of_triangles,
+  uint32_t** triangles,
+  float** texcoords,
+  const char* filename)
+  {
+  *nr_of_vertices = 0;
+  *vertices = NULL;
+  *vertex_normals = NULL;
+  *vertex_colors = NULL;
+  *nr_of_triangles = 0;
+  *triangles = NULL;
+  *texcoords = NULL;
+
+  void* mapped_file = trico_map_file(filename);
+  if (!mapped_file)
+    return 0;
+  trico_ply_header* header = (trico_ply_header*)trico_malloc(sizeof(trico_ply_header));
+  const uint8_t* data = trico_get_mapped_data(mapped_file);
+  const uint64_t size = trico_get_mapped_size(mapped_file);
+  if (!header || !trico_parse_ply_header(header, data, size) || !trico_has_supported_ply_layout(header))
+    {
+    trico_free(header);
+    trico_unmap_file(mapped_file);
+    return trico_read_ply_with_rply(nr_of_vertices, vertices, vertex_normals, vertex_colors, nr_of_triangles, triangles, texcoords, filename);
+    }
+  int result = trico_read_binary_ply(header, data + size, nr_of_vertices, vertices, vertex_normals, vertex_colors, nr_of_triangles, triangles, texcoords);
+  trico_free(header);
+  trico_unmap_file(mapped_file);
+  if (!result)
+    trico_free_ply(nr_of_vertices, vertices, vertex_normals, vertex_colors, nr_of_triangles, triangles, texcoords);
+  return result;
+  }
+
 int trico_write_ply(const uint32_t nr_of_vertices, const float* vertices, const float* vertex_normals, const uint32_t* vertex_colors, const uint32_t nr_of_triangles, const uint32_t* triangles, const float* texcoords, const char* filename)
   {
   if (!vertices)
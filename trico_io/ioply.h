@@ -9,6 +9,12 @@ extern "C" {
 
 #include <stdint.h>
 
+/*
+Returns 1 if no errors.
+Memory of the output arrays should be cleaned up with trico_free.
+Binary ply files are memory mapped and their vertex properties are converted column by column in parallel. ascii files
+and unusual layouts, such as vertices with list properties, are read with rply.
+*/
 TRICO_IO_API int trico_read_ply(uint32_t* nr_of_vertices, float** vertices, float** vertex_normals, uint32_t** vertex_colors, uint32_t* nr_of_triangles, uint32_t** triangles, float** texcoords, const char* filename);
 
 TRICO_IO_API int trico_write_ply(const uint32_t nr_of_vertices, const float* vertices, const float* vertex_normals, const uint32_t* vertex_colors, const uint32_t nr_of_triangles, const uint32_t* triangles, const float* texcoords, const char* filename);
@@ -1,261 +1,506 @@
 #include "iostl.h"
 
 #include <trico/alloc.h>
+#include <trico/file_mapping.h>
+#include <trico/parallel.h>
 
+#include <float.h>
+#include <locale.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-static inline int trico_less_vertices(float* left, float* right)
+static uint64_t trico_hash_vertex(const uint32_t* bits)
   {
-  if (left[0] == right[0])
-    {
-    if (left[1] == right[1])
-      return left[2] < right[2] ? 1 : 0;
-    else
-      return left[1] < right[1] ? 1 : 0;
-    }
-  else
-    return left[0] < right[0] ? 1 : 0;
+  uint64_t h = (uint64_t)bits[0] * 0x9e3779b97f4a7c15ull;
+  h = (h ^ bits[1]) * 0xc2b2ae3d27d4eb4full;
+  h = (h ^ bits[2]) * 0x165667b19e3779f9ull;
+  return h ^ (h >> 32);
   }
 
-static inline int trico_equal_vertices(float* left, float* right)
+/*
+Welds the corners of the triangles into vertices: corners with bitwise equal coordinates become one vertex, and the vertices
+are numbered in order of first occurrence. The corners are looked up in an open addressing hash table on the bits of their
+coordinates, which takes expected linear time whatever the order of the input. On entry vertex c holds the coordinates of corner c
+and triangles[c] == c, the welded vertices are compacted in place. Returns 0 if the memory is not available.
+*/
+static int trico_remove_duplicate_vertices(uint32_t* nr_of_vertices, float* vertices, uint32_t nr_of_triangles, uint32_t* triangles)
   {
-  if ((left[0] == right[0]) && (left[1] == right[1]) && (left[2] == right[2]))
-    return 1;
-  return 0;
+  const uint64_t nr_of_corners = 3 * (uint64_t)nr_of_triangles;
+  uint64_t capacity = 16;
+  while (capacity < 2 * nr_of_corners)
+    capacity *= 2;
+  const uint64_t mask = capacity - 1;
+  uint32_t* table = (uint32_t*)trico_calloc(capacity, sizeof(uint32_t)); // vertex index + 1, 0 for an empty slot
+  if (!table)
+    return 0;
+
+  float* vert = vertices;
+  uint32_t* tria = triangles;
+  uint32_t nr_of_welded = 0;
+  for (uint64_t c = 0; c < nr_of_corners; ++c)
+    {
+    uint32_t bits[3];
+    memcpy(bits, vert + 3 * c, sizeof(bits));
+    uint64_t slot = trico_hash_vertex(bits) & mask;
+    while (table[slot] && memcmp(vert + 3 * (uint64_t)(table[slot] - 1), bits, sizeof(bits)) != 0)
+      slot = (slot + 1) & mask;
+    if (!table[slot])
+      {
+      memcpy(vert + 3 * (uint64_t)nr_of_welded, bits, sizeof(bits));
+      table[slot] = ++nr_of_welded;
+      }
+    tria[c] = table[slot] - 1;
+    }
+  *nr_of_vertices = nr_of_welded;
+
+  trico_free(table);
+  return 1;
   }
 
-static inline void trico_swap_vertices(float* a, float* b)
+#define TRICO_STL_HEADER_SIZE 84
+#define TRICO_STL_TRIANGLE_SIZE 50
+#define TRICO_STL_TRIANGLES_PER_TASK (1 << 16)
+#define TRICO_ASCII_STL_BYTES_PER_TASK (1 << 20)
+#define TRICO_ASCII_STL_MIN_FACET_SIZE 80 // "facet normal 0 0 0 outer loop vertex 0 0 0 vertex 0 0 0 vertex 0 0 0 endloop endfacet"
+
+typedef struct trico_ascii_stl_chunk
+  {
+  const char* begin;
+  const char* end;
+  uint64_t first_triangle; // the facets of the chunk are parsed to here, and moved together afterwards
+  uint64_t nr_of_triangles;
+  int valid;
+  } trico_ascii_stl_chunk;
+
+typedef struct trico_stl_parser
+  {
+  const uint8_t* records;
+  trico_ascii_stl_chunk* chunks;
+  uint64_t nr_of_triangles;
+  float* vertices;
+  float* normals;
+  uint16_t* attributes;
+  } trico_stl_parser;
+
+/*
+Copies the triangle records of one task. The records are 50 bytes, so their fields are not aligned: memcpy of the 36 bytes
+of corners at once lets the compiler use unaligned vector loads.
+*/
+static void trico_parse_stl_records(void* user_data, uint32_t task_index, uint32_t thread_index)
   {
-  for (int j = 0; j < 4; ++j)
+  (void)thread_index;
+  trico_stl_parser* parser = (trico_stl_parser*)user_data;
+  const uint64_t begin = (uint64_t)task_index * TRICO_STL_TRIANGLES_PER_TASK;
+  uint64_t end = begin + TRICO_STL_TRIANGLES_PER_TASK;
+  if (end > parser->nr_of_triangles)
+    end = parser->nr_of_triangles;
+  const uint8_t* record = parser->records + begin * TRICO_STL_TRIANGLE_SIZE;
+  float* vert_it = parser->vertices + 9 * begin;
+  for (uint64_t t = begin; t < end; ++t, record += TRICO_STL_TRIANGLE_SIZE, vert_it += 9)
+    memcpy(vert_it, record + 12, 9 * sizeof(float));
+  if (parser->normals)
     {
-    float temp = a[j];
-    a[j] = b[j];
-    b[j] = temp;
+    record = parser->records + begin * TRICO_STL_TRIANGLE_SIZE;
+    float* norm_it = parser->normals + 3 * begin;
+    for (uint64_t t = begin; t < end; ++t, record += TRICO_STL_TRIANGLE_SIZE, norm_it += 3)
+      memcpy(norm_it, record, 3 * sizeof(float));
+    }
+  if (parser->attributes)
+    {
+    record = parser->records + begin * TRICO_STL_TRIANGLE_SIZE;
+    for (uint64_t t = begin; t < end; ++t, record += TRICO_STL_TRIANGLE_SIZE)
+      memcpy(parser->attributes + t, record + 48, sizeof(uint16_t));
     }
   }
 
-static uint64_t trico_partition_vertices(float* L, int64_t left, int64_t right)
+static int trico_allocate_stl_triangles(trico_stl_parser* parser, uint64_t nr_of_triangles, int with_normals, int with_attributes)
   {
-  int64_t pivot = right;
-  float p_val[4];
-  p_val[0] = L[pivot * 4];
-  p_val[1] = L[pivot * 4 + 1];
-  p_val[2] = L[pivot * 4 + 2];
-  p_val[3] = L[pivot * 4 + 3];
-
-  int64_t i = (left - 1);
-  for (int64_t j = left; j < right; ++j)
+  parser->vertices = (float*)trico_malloc(nr_of_triangles * 9 * sizeof(float));
+  parser->normals = with_normals ? (float*)trico_malloc(nr_of_triangles * 3 * sizeof(float)) : NULL;
+  parser->attributes = with_attributes ? (uint16_t*)trico_calloc(nr_of_triangles, sizeof(uint16_t)) : NULL;
+  if (nr_of_triangles && (!parser->vertices || (with_normals && !parser->normals) || (with_attributes && !parser->attributes)))
     {
-    // If current element is smaller than the pivot
-    if (trico_less_vertices(L + j * 4, p_val))
-      {
-      ++i;    // increment index of smaller element
-      trico_swap_vertices(L + i * 4, L + j * 4);
-      }
+    trico_free(parser->vertices);
+    trico_free(parser->normals);
+    trico_free(parser->attributes);
+    return 0;
     }
-  trico_swap_vertices(L + (i + 1) * 4, L + right * 4);
-  return (i + 1);
+  return 1;
   }
 
-static void trico_quicksort_vertices(float* L, int64_t start, int64_t end)
+static int trico_parse_binary_stl(trico_stl_parser* parser, const uint8_t* data, int with_normals, int with_attributes)
   {
-  if (start >= end)
-    return;
-  int64_t splitPoint = trico_partition_vertices(L, start, end);
-  trico_quicksort_vertices(L, start, splitPoint - 1);
-  trico_quicksort_vertices(L, splitPoint + 1, end);
+  uint32_t count;
+  memcpy(&count, data + 80, sizeof(uint32_t));
+  if (!trico_allocate_stl_triangles(parser, count, with_normals, with_attributes))
+    return 0;
+  parser->records = data + TRICO_STL_HEADER_SIZE;
+  parser->nr_of_triangles = count;
+  const uint32_t nr_of_tasks = (uint32_t)(((uint64_t)count + TRICO_STL_TRIANGLES_PER_TASK - 1) / TRICO_STL_TRIANGLES_PER_TASK);
+  trico_parallel_for(&trico_parse_stl_records, parser, nr_of_tasks, 0);
+  return 1;
   }
 
-static void trico_remove_duplicate_vertices(uint32_t* nr_of_vertices, float** vertices, uint32_t nr_of_triangles, uint32_t** triangles)
+static int trico_is_space(char c)
   {
-  if (nr_of_triangles == 0)
-    return;
-
-  float* vert = (float*)trico_malloc(nr_of_triangles * 3 * sizeof(float) * 4);
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+  }
 
-  float* p_vert = vert;
-  for (uint32_t i = 0; i < nr_of_triangles; ++i)
-    {
-    const uint32_t id0 = i * 3;
-    const uint32_t id1 = id0 + 1;
-    const uint32_t id2 = id1 + 1;
-    const uint32_t v0 = (*triangles)[id0];
-    const uint32_t v1 = (*triangles)[id1];
-    const uint32_t v2 = (*triangles)[id2];
-
-
-    *p_vert++ = (*vertices)[v0 * 3];
-    *p_vert++ = (*vertices)[v0 * 3 + 1];
-    *p_vert++ = (*vertices)[v0 * 3 + 2];
-    *p_vert++ = *(const float*)(&id0);
-
-    *p_vert++ = (*vertices)[v1 * 3];
-    *p_vert++ = (*vertices)[v1 * 3 + 1];
-    *p_vert++ = (*vertices)[v1 * 3 + 2];
-    *p_vert++ = *(const float*)(&id1);
-
-    *p_vert++ = (*vertices)[v2 * 3];
-    *p_vert++ = (*vertices)[v2 * 3 + 1];
-    *p_vert++ = (*vertices)[v2 * 3 + 2];
-    *p_vert++ = *(const float*)(&id2);
-    }
+static const char* trico_skip_spaces(const char* s, const char* end)
+  {
+  while (s < end && trico_is_space(*s))
+    ++s;
+  return s;
+  }
 
-  trico_quicksort_vertices(vert, 0, (3 * nr_of_triangles) - 1);
+static const char* trico_skip_line(const char* s, const char* end)
+  {
+  while (s < end && *s != '\n')
+    ++s;
+  return s;
+  }
 
-  float* first = vert;
-  float* last = vert + 3 * nr_of_triangles * 4;
+/*
+Checks whether the token at s is keyword, and if so moves s past it.
+*/
+static int trico_parse_keyword(const char** s, const char* end, const char* keyword)
+  {
+  const size_t length = strlen(keyword);
+  if ((size_t)(end - *s) < length || memcmp(*s, keyword, length) != 0 || (*s + length < end && !trico_is_space((*s)[length])))
+    return 0;
+  *s += length;
+  return 1;
+  }
 
-  *nr_of_vertices = 0;
+/*
+Parses a float token with the C library, for the cases that the fast path cannot round correctly.
+The decimal point is replaced by the one of the current locale, so that files are read the same in any locale.
+*/
+static int trico_parse_float_slow(const char* token, const char* token_end, float* value)
+  {
+  char buffer[128];
+  const size_t length = (size_t)(token_end - token);
+  if (length == 0 || length >= sizeof(buffer))
+    return 0;
+  const char decimal_point = localeconv()->decimal_point[0];
+  for (size_t i = 0; i < length; ++i)
+    buffer[i] = token[i] == '.' ? decimal_point : token[i];
+  buffer[length] = 0;
+  char* parsed_end;
+  *value = strtof(buffer, &parsed_end);
+  return parsed_end == buffer + length;
+  }
 
-  float* result = first;
-  (*vertices)[*nr_of_vertices * 3] = result[0];
-  (*vertices)[*nr_of_vertices * 3 + 1] = result[1];
-  (*vertices)[*nr_of_vertices * 3 + 2] = result[2];
-  (*triangles)[*(uint32_t*)(&(result[3]))] = *nr_of_vertices;
-  while ((first += 4) != last)
+/*
+Parses the float token at s and moves s past it. Decimal numbers with at most 19 significant digits are read into an integer
+mantissa and a power of 10, which are converted with one correctly rounded multiplication or division when both are exact
+in float or else in double (Clinger's fast path). Rounding the double result to float can only differ from rounding the decimal
+number when the double lies exactly halfway between two floats, or in the subnormal range of float. Those cases, longer
+mantissas, larger powers of 10, inf and nan are converted by strtof.
+*/
+static int trico_parse_float(const char** s, const char* end, float* value)
+  {
+  static const float float_powers_of_10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+  static const double double_powers_of_10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  const char* token = *s;
+  const char* token_end = token;
+  while (token_end < end && !trico_is_space(*token_end))
+    ++token_end;
+  *s = token_end;
+
+  const char* p = token;
+  int negative = 0;
+  if (p < token_end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+  uint64_t mantissa = 0;
+  int nr_of_digits = 0;
+  int nr_of_significant_digits = 0;
+  int64_t exponent = 0;
+  for (; p < token_end && *p >= '0' && *p <= '9'; ++p, ++nr_of_digits)
     {
-    if (trico_equal_vertices(result, first) == 0)
+    if (mantissa || *p != '0')
+      ++nr_of_significant_digits;
+    mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+    }
+  if (p < token_end && *p == '.')
+    {
+    for (++p; p < token_end && *p >= '0' && *p <= '9'; ++p, ++nr_of_digits)
       {
-      while ((result += 4) != first)
-        {
-        (*triangles)[*(uint32_t*)(&(result[3]))] = *nr_of_vertices;
-        }
-      ++(*nr_of_vertices);
-      (*vertices)[*nr_of_vertices * 3] = result[0];
-      (*vertices)[*nr_of_vertices * 3 + 1] = result[1];
-      (*vertices)[*nr_of_vertices * 3 + 2] = result[2];
-      (*triangles)[*(uint32_t*)(&(result[3]))] = *nr_of_vertices;
+      if (mantissa || *p != '0')
+        ++nr_of_significant_digits;
+      mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+      --exponent;
       }
     }
-  while ((result += 4) != first)
+  if (nr_of_digits && p < token_end && (*p == 'e' || *p == 'E'))
     {
-    (*triangles)[*(uint32_t*)(&(result[3]))] = *nr_of_vertices;
+    ++p;
+    int negative_exponent = 0;
+    if (p < token_end && (*p == '-' || *p == '+'))
+      negative_exponent = *p++ == '-';
+    const char* exponent_digits = p;
+    int64_t e = 0;
+    for (; p < token_end && *p >= '0' && *p <= '9'; ++p)
+      {
+      if (e < 100000)
+        e = e * 10 + (*p - '0');
+      }
+    if (p == exponent_digits)
+      return 0;
+    exponent += negative_exponent ? -e : e;
     }
-  ++(*nr_of_vertices);
+  if (!nr_of_digits || p != token_end || nr_of_significant_digits > 19)
+    return trico_parse_float_slow(token, token_end, value);
 
-  trico_free(vert);
+  if (mantissa == 0)
+    {
+    *value = negative ? -0.f : 0.f;
+    return 1;
+    }
+  if (mantissa <= ((uint64_t)1 << 24) && exponent >= -10 && exponent <= 10)
+    {
+    float f = (float)mantissa;
+    f = exponent < 0 ? f / float_powers_of_10[-exponent] : f * float_powers_of_10[exponent];
+    *value = negative ? -f : f;
+    return 1;
+    }
+  if (mantissa <= ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22)
+    {
+    double d = (double)mantissa;
+    d = exponent < 0 ? d / double_powers_of_10[-exponent] : d * double_powers_of_10[exponent];
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(uint64_t));
+    if (d >= FLT_MIN && (bits & 0x1fffffff) != 0x10000000) // 29 bits of the mantissa are rounded off
+      {
+      *value = negative ? -(float)d : (float)d;
+      return 1;
+      }
+    }
+  return trico_parse_float_slow(token, token_end, value);
   }
 
+static int trico_parse_floats(const char** s, const char* end, float* values, int nr_of_values)
+  {
+  for (int i = 0; i < nr_of_values; ++i)
+    {
+    *s = trico_skip_spaces(*s, end);
+    if (!trico_parse_float(s, end, values + i))
+      return 0;
+    }
+  return 1;
+  }
 
-int trico_read_stl(uint32_t* nr_of_vertices, float** vertices, uint32_t* nr_of_triangles, uint32_t** triangles, const char* filename)
+static int trico_parse_keywords(const char** s, const char* end, const char* keyword_0, const char* keyword_1)
   {
-  *vertices = NULL;
-  *triangles = NULL;
-  *nr_of_vertices = 0;
-  *nr_of_triangles = 0;
-  FILE* inputfile = fopen(filename, "rb");
-  if (!inputfile)
+  *s = trico_skip_spaces(*s, end);
+  if (!trico_parse_keyword(s, end, keyword_0))
     return 0;
+  if (!keyword_1)
+    return 1;
+  *s = trico_skip_spaces(*s, end);
+  return trico_parse_keyword(s, end, keyword_1);
+  }
 
-  if (!inputfile)
-    return 0;
+/*
+Parses the facets of one chunk of an ascii stl file into the triangles from chunk->first_triangle on. The chunks start at lines
+that start with "facet", so that the parsing of each chunk starts in a known state. The lines with "solid" and "endsolid" are
+skipped with their names.
+*/
+static void trico_parse_ascii_stl_chunk(void* user_data, uint32_t task_index, uint32_t thread_index)
+  {
+  (void)thread_index;
+  trico_stl_parser* parser = (trico_stl_parser*)user_data;
+  trico_ascii_stl_chunk* chunk = parser->chunks + task_index;
+  const uint64_t capacity = (uint64_t)(chunk->end - chunk->begin) / TRICO_ASCII_STL_MIN_FACET_SIZE + 1;
+  float* vert_it = parser->vertices + 9 * chunk->first_triangle;
+  float* norm_it = parser->normals ? parser->normals + 3 * chunk->first_triangle : NULL;
+  const char* s = chunk->begin;
+  const char* end = chunk->end;
+  chunk->valid = 0;
+  chunk->nr_of_triangles = 0;
+  for (s = trico_skip_spaces(s, end); s < end; s = trico_skip_spaces(s, end))
+    {
+    if (trico_parse_keyword(&s, end, "solid") || trico_parse_keyword(&s, end, "endsolid"))
+      {
+      s = trico_skip_line(s, end);
+      continue;
+      }
+    float normal[3];
+    if (chunk->nr_of_triangles == capacity || !trico_parse_keywords(&s, end, "facet", "normal") || !trico_parse_floats(&s, end, normal, 3) || !trico_parse_keywords(&s, end, "outer", "loop"))
+      return;
+    for (int corner = 0; corner < 3; ++corner)
+      {
+      if (!trico_parse_keywords(&s, end, "vertex", NULL) || !trico_parse_floats(&s, end, vert_it, 3))
+        return;
+      vert_it += 3;
+      }
+    if (!trico_parse_keywords(&s, end, "endloop", NULL) || !trico_parse_keywords(&s, end, "endfacet", NULL))
+      return;
+    if (norm_it)
+      {
+      memcpy(norm_it, normal, sizeof(normal));
+      norm_it += 3;
+      }
+    ++chunk->nr_of_triangles;
+    }
+  chunk->valid = 1;
+  }
 
-  char buffer[80];
-  fread(buffer, 1, 80, inputfile);
+/*
+Returns the start of the first line at or after s that starts with "facet", or end.
+*/
+static const char* trico_find_facet_line(const char* s, const char* begin, const char* end)
+  {
+  if (s > begin && s[-1] != '\n')
+    {
+    s = trico_skip_line(s, end);
+    if (s < end)
+      ++s;
+    }
+  while (s < end)
+    {
+    const char* token = s;
+    while (token < end && (*token == ' ' || *token == '\t'))
+      ++token;
+    if (trico_parse_keyword(&token, end, "facet"))
+      return s;
+    s = trico_skip_line(s, end);
+    if (s < end)
+      ++s;
+    }
+  return end;
+  }
 
-  if (buffer[0] == 's' && buffer[1] == 'o' && buffer[2] == 'l' && buffer[3] == 'i' && buffer[4] == 'd')
+/*
+Parses an ascii stl file in parallel chunks of about TRICO_ASCII_STL_BYTES_PER_TASK bytes. Each chunk gets room for as many
+facets as fit in its bytes, and the parsed facets are moved together afterwards. ascii stl files have no attributes, so these are 0.
+*/
+static int trico_parse_ascii_stl(trico_stl_parser* parser, const uint8_t* data, uint64_t size, int with_normals, int with_attributes)
+  {
+  const char* begin = (const char*)data;
+  const char* end = begin + size;
+  const uint32_t nr_of_chunks = (uint32_t)(size / TRICO_ASCII_STL_BYTES_PER_TASK + 1);
+  parser->chunks = (trico_ascii_stl_chunk*)trico_malloc(nr_of_chunks * sizeof(trico_ascii_stl_chunk));
+  if (!parser->chunks)
+    return 0;
+  uint64_t capacity = 0;
+  for (uint32_t k = 0; k < nr_of_chunks; ++k)
+    {
+    trico_ascii_stl_chunk* chunk = parser->chunks + k;
+    chunk->begin = begin;
+    if (k > 0)
+      {
+      const char* split = begin + size * k / nr_of_chunks;
+      chunk->begin = trico_find_facet_line(split > chunk[-1].begin ? split : chunk[-1].begin, begin, end);
+      chunk[-1].end = chunk->begin;
+      }
+    chunk->end = end;
+    }
+  for (uint32_t k = 0; k < nr_of_chunks; ++k)
+    {
+    parser->chunks[k].first_triangle = capacity;
+    capacity += (uint64_t)(parser->chunks[k].end - parser->chunks[k].begin) / TRICO_ASCII_STL_MIN_FACET_SIZE + 1;
+    }
+  if (!trico_allocate_stl_triangles(parser, capacity, with_normals, 0))
     {
-    fclose(inputfile);
+    trico_free(parser->chunks);
     return 0;
     }
+  trico_parallel_for(&trico_parse_ascii_stl_chunk, parser, nr_of_chunks, 0);
 
-  fread((void*)(nr_of_triangles), sizeof(uint32_t), 1, inputfile);
-  *triangles = (uint32_t*)trico_malloc(*nr_of_triangles * 3 * sizeof(uint32_t));
-  uint32_t count_triangles = 0;
-  *nr_of_vertices = 0;
-  *vertices = (float*)trico_malloc(*nr_of_triangles * 9 * sizeof(float));
-
-  uint32_t* tria_it = *triangles;
-  float* vert_it = *vertices;
-  while (!feof(inputfile) && count_triangles < *nr_of_triangles)
+  uint64_t nr_of_triangles = 0;
+  int valid = 1;
+  for (uint32_t k = 0; k < nr_of_chunks; ++k)
     {
-    ++count_triangles;
-    fread(buffer, 1, 50, inputfile);
-    *vert_it++ = *(float*)(&(buffer[12]));
-    *vert_it++ = *(float*)(&(buffer[16]));
-    *vert_it++ = *(float*)(&(buffer[20]));
-    *vert_it++ = *(float*)(&(buffer[24]));
-    *vert_it++ = *(float*)(&(buffer[28]));
-    *vert_it++ = *(float*)(&(buffer[32]));
-    *vert_it++ = *(float*)(&(buffer[36]));
-    *vert_it++ = *(float*)(&(buffer[40]));
-    *vert_it++ = *(float*)(&(buffer[44]));
-    *tria_it++ = (*nr_of_vertices)++;
-    *tria_it++ = (*nr_of_vertices)++;
-    *tria_it++ = (*nr_of_vertices)++;
+    const trico_ascii_stl_chunk* chunk = parser->chunks + k;
+    valid &= chunk->valid;
+    memmove(parser->vertices + 9 * nr_of_triangles, parser->vertices + 9 * chunk->first_triangle, chunk->nr_of_triangles * 9 * sizeof(float));
+    if (parser->normals)
+      memmove(parser->normals + 3 * nr_of_triangles, parser->normals + 3 * chunk->first_triangle, chunk->nr_of_triangles * 3 * sizeof(float));
+    nr_of_triangles += chunk->nr_of_triangles;
     }
-  fclose(inputfile);
-  if (count_triangles != *nr_of_triangles)
+  trico_free(parser->chunks);
+  if (with_attributes)
+    parser->attributes = (uint16_t*)trico_calloc(nr_of_triangles + 1, sizeof(uint16_t));
+  if (!valid || 3 * nr_of_triangles > UINT32_MAX || (with_attributes && !parser->attributes))
+    {
+    trico_free(parser->vertices);
+    trico_free(parser->normals);
+    trico_free(parser->attributes);
     return 0;
-
-  trico_remove_duplicate_vertices(nr_of_vertices, vertices, *nr_of_triangles, triangles);
-  *vertices = (float*)trico_realloc(*vertices, *nr_of_vertices * 3 * sizeof(float));
+    }
+  parser->nr_of_triangles = nr_of_triangles;
+  parser->vertices = (float*)trico_realloc(parser->vertices, (nr_of_triangles + 1) * 9 * sizeof(float));
+  if (parser->normals)
+    parser->normals = (float*)trico_realloc(parser->normals, (nr_of_triangles + 1) * 3 * sizeof(float));
   return 1;
   }
 
-int trico_read_stl_full(uint32_t* nr_of_vertices, float** vertices, uint32_t* nr_of_triangles, uint32_t** triangles, float** normals, uint16_t** attributes, const char* filename)
+/*
+Reads a binary or ascii stl file: the file is mapped into memory and parsed in parallel, and the corners are welded.
+A binary file's size is checked against the number of triangles in its header before anything is allocated. A file that
+starts with "solid" is ascii, unless it has exactly the size of a binary file, as some writers put "solid" in the binary header.
+normals and attributes may be NULL.
+*/
+static int trico_read_stl_file(uint32_t* nr_of_vertices, float** vertices, uint32_t* nr_of_triangles, uint32_t** triangles, float** normals, uint16_t** attributes, const char* filename)
   {
   *vertices = NULL;
   *triangles = NULL;
   *nr_of_vertices = 0;
   *nr_of_triangles = 0;
-  FILE* inputfile = fopen(filename, "rb");
-  if (!inputfile)
+  if (normals)
+    *normals = NULL;
+  if (attributes)
+    *attributes = NULL;
+  void* mapped_file = trico_map_file(filename);
+  if (!mapped_file)
     return 0;
-
-  if (!inputfile)
+  const uint8_t* data = trico_get_mapped_data(mapped_file);
+  const uint64_t size = trico_get_mapped_size(mapped_file);
+  uint32_t count = 0;
+  if (size >= TRICO_STL_HEADER_SIZE)
+    memcpy(&count, data + 80, sizeof(uint32_t));
+  const uint64_t binary_size = TRICO_STL_HEADER_SIZE + (uint64_t)count * TRICO_STL_TRIANGLE_SIZE;
+  const int ascii = size >= 5 && memcmp(data, "solid", 5) == 0 && size != binary_size;
+  trico_stl_parser parser;
+  int parsed = 0;
+  if (ascii)
+    parsed = trico_parse_ascii_stl(&parser, data, size, normals != NULL, attributes != NULL);
+  else if (size >= TRICO_STL_HEADER_SIZE && size >= binary_size && 3 * (uint64_t)count <= UINT32_MAX)
+    parsed = trico_parse_binary_stl(&parser, data, normals != NULL, attributes != NULL);
+  trico_unmap_file(mapped_file);
+  if (!parsed)
     return 0;
 
-  char buffer[80];
-  fread(buffer, 1, 80, inputfile);
-
-  if (buffer[0] == 's' && buffer[1] == 'o' && buffer[2] == 'l' && buffer[3] == 'i' && buffer[4] == 'd')
+  const uint32_t count_triangles = (uint32_t)parser.nr_of_triangles;
+  uint32_t* tria = (uint32_t*)trico_malloc(((uint64_t)count_triangles + 1) * 3 * sizeof(uint32_t));
+  if (!tria || !trico_remove_duplicate_vertices(nr_of_vertices, parser.vertices, count_triangles, tria))
     {
-    fclose(inputfile);
+    trico_free(parser.vertices);
+    trico_free(parser.normals);
+    trico_free(parser.attributes);
+    trico_free(tria);
     return 0;
     }
+  *vertices = (float*)trico_realloc(parser.vertices, *nr_of_vertices * 3 * sizeof(float));
+  *triangles = tria;
+  *nr_of_triangles = count_triangles;
+  if (normals)
+    *normals = parser.normals;
+  if (attributes)
+    *attributes = parser.attributes;
+  return 1;
+  }
 
-  fread((void*)(nr_of_triangles), sizeof(uint32_t), 1, inputfile);
-  *triangles = (uint32_t*)trico_malloc(*nr_of_triangles * 3 * sizeof(uint32_t));
-  *normals = (float*)trico_malloc(*nr_of_triangles * 3 * sizeof(float));
-  *attributes = (uint16_t*)trico_malloc(*nr_of_triangles * sizeof(uint16_t));
-  uint32_t count_triangles = 0;
-  *nr_of_vertices = 0;
-  *vertices = (float*)trico_malloc(*nr_of_triangles * 9 * sizeof(float));
-
-  uint32_t* tria_it = *triangles;
-  float* vert_it = *vertices;
-  float* norm_it = *normals;
-  uint16_t* attr_it = *attributes;
-  while (!feof(inputfile) && count_triangles < *nr_of_triangles)
-    {
-    ++count_triangles;
-    fread(buffer, 1, 50, inputfile);
-    *norm_it++ = *(float*)(&(buffer[0]));
-    *norm_it++ = *(float*)(&(buffer[4]));
-    *norm_it++ = *(float*)(&(buffer[8]));
-    *vert_it++ = *(float*)(&(buffer[12]));
-    *vert_it++ = *(float*)(&(buffer[16]));
-    *vert_it++ = *(float*)(&(buffer[20]));
-    *vert_it++ = *(float*)(&(buffer[24]));
-    *vert_it++ = *(float*)(&(buffer[28]));
-    *vert_it++ = *(float*)(&(buffer[32]));
-    *vert_it++ = *(float*)(&(buffer[36]));
-    *vert_it++ = *(float*)(&(buffer[40]));
-    *vert_it++ = *(float*)(&(buffer[44]));
-    *attr_it++ = *(uint16_t*)(&(buffer[48]));
-    *tria_it++ = (*nr_of_vertices)++;
-    *tria_it++ = (*nr_of_vertices)++;
-    *tria_it++ = (*nr_of_vertices)++;
-    }
-  fclose(inputfile);
-  if (count_triangles != *nr_of_triangles)
-    return 0;
+int trico_read_stl(uint32_t* nr_of_vertices, float** vertices, uint32_t* nr_of_triangles, uint32_t** triangles, const char* filename)
+  {
+  return trico_read_stl_file(nr_of_vertices, vertices, nr_of_triangles, triangles, NULL, NULL, filename);
+  }
 
-  trico_remove_duplicate_vertices(nr_of_vertices, vertices, *nr_of_triangles, triangles);
-  *vertices = (float*)trico_realloc(*vertices, *nr_of_vertices * 3 * sizeof(float));
-  return 1;
+int trico_read_stl_full(uint32_t* nr_of_vertices, float** vertices, uint32_t* nr_of_triangles, uint32_t** triangles, float** normals, uint16_t** attributes, const char* filename)
+  {
+  return trico_read_stl_file(nr_of_vertices, vertices, nr_of_triangles, triangles, normals, attributes, filename);
   }
 
 int trico_write_stl(const float* vertices, const uint32_t* triangles, const uint32_t nr_of_triangles, const float* triangle_normals, const uint16_t* attributes, const char* filename)
@@ -12,6 +12,8 @@ extern "C" {
 /*
 Returns 1 if no errors.
 Memory of vertices and triangles should be cleaned up with free.
+Binary and ascii stl files are memory mapped and parsed in parallel. A binary file that is smaller than the triangle count in its
+header says is rejected. Floats in ascii files are read with a '.' as decimal point whatever the locale, and rounded as strtof does.
 */
 
 TRICO_IO_API int trico_read_stl(uint32_t* nr_of_vertices, float** vertices, uint32_t* nr_of_triangles, uint32_t** triangles, const char* filename);